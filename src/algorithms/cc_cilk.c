@@ -6,12 +6,15 @@
  * components in an undirected graph using OpenCilk:
  *
  * - Label Propagation (variant 0): Iteratively propagates minimum labels
- *   until convergence with per-worker local flags and relaxed atomics.
+ *   until convergence as min-select SpMV on the core engine (core/spmv.h).
  *
  * - Union-Find with Rem's Algorithm (variant 1): Lock-free parallel
- *   union-find using compare-and-swap operations and dynamic task scheduling.
+ *   union-find using compare-and-swap operations and dynamic task scheduling,
+ *   counting components online from the successful unions.
  *
- * Both algorithms return the count of unique connected components.
+ * Variant 2 is the shared cc_ldd() (see connected_components.h).
+ *
+ * Each returns the count of unique connected components.
  */
 
 #include <stdlib.h>
@@ -21,110 +24,82 @@
 #include <cilk/cilk_api.h>
 
 #include "connected_components.h"
+#include "cc_primitives.h"
 
 /* ========================================================================== */
-/*                           UNION-FIND UTILITIES                             */
+/*                           UNION-FIND KERNELS                               */
 /* ========================================================================== */
 
-/**
- * @brief Finds the root of a node with path compression.
- *
- * Traverses parent pointers until reaching the root, and compresses the
- * path by making all nodes along the path point directly to the root.
- * The early-exit optimization avoids redundant writes if the path is
- * already compressed.
- *
- * @param label Array of parent pointers representing disjoint sets
- * @param x Node index to find the root for
- * @return Root of the set containing x
- */
-static inline uint32_t
-find_compress(uint32_t *label, uint32_t x)
-{
-	uint32_t root = x;
-	
-	/* Find the root */
-	while (label[root] != root)
-		root = label[root];
-	
-	/* Compress the path */
-	while (x != root) {
-		uint32_t next = label[x];
-		if (label[x] == next)
-			break;  /* Already compressed */
-		label[x] = root;
-		x = next;
-	}
-	
-	return root;
-}
+/* Path halving with relaxed atomics; rows outside the label array are skipped */
+CC_DEFINE_FIND(find_root, uint32_t, HALVING, RELAXED)
+CC_DEFINE_UNION(union_rem, uint32_t, find_root, RELAXED)
+CC_DEFINE_UNION_EDGES(union_column, uint32_t, union_rem, CHECKED)
+
+/* Full compression, for the flatten of cc_labels() */
+CC_DEFINE_FIND(find_compress, uint32_t, FULL, RELAXED)
+
+/* ========================================================================== */
+/*                         UNION-FIND ALGORITHM                               */
+/* ========================================================================== */
+
+/* Columns per parallel chunk */
+#define UF_CHUNK 2048
 
 /**
- * @brief Unites two disjoint sets using Rem's algorithm.
+ * @brief Builds the union-find forest of a matrix.
  *
- * Implements lock-free parallel union-find using compare-and-swap (CAS)
- * operations. Retries up to MAX_RETRIES times before falling back to a
- * simpler atomic store. Canonical ordering (smaller index as root) ensures
- * deterministic results in parallel execution.
+ * Algorithm phases:
+ * 1. Initialize each node as its own root (parallel with cilk_for)
+ * 2. Perform parallel union operations on edges, each chunk of columns
+ *    counting the unions that merged two sets
+ *
+ * Every successful link removes one set, so the count is n minus the
+ * merges and no flatten or root counting pass is needed. The chunk counts
+ * are added to a shared total, and the remaining chunks are skipped once
+ * it shows a single set. Each root is the smallest vertex of its tree.
  *
- * @param label Array of parent pointers representing disjoint sets
- * @param a First node
- * @param b Second node
+ * @param matrix Sparse CSC binary matrix representing graph (at least one vertex)
+ * @param label Output: csc_num_vertices() parent links
+ * @return Number of unions that merged two sets
  */
-static inline void
-union_rem(uint32_t *label, uint32_t a, uint32_t b)
+static uint32_t
+uf_unite(const CSCBinaryMatrix *matrix, uint32_t *label)
 {
-	const int MAX_RETRIES = 10;
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
+	const uint32_t off = (uint32_t)csc_col_offset(matrix);
+	const uint32_t n_chunks = (uint32_t)((matrix->ncols + UF_CHUNK - 1) / UF_CHUNK);
 	
-	/* Retry loop with CAS operations */
-	for (int retry = 0; retry < MAX_RETRIES; retry++) {
-		a = find_compress(label, a);
-		b = find_compress(label, b);
-		
-		if (a == b)
-			return;
-		
-		/* Canonical ordering: smaller index as root */
-		if (a > b) {
-			uint32_t temp = a;
-			a = b;
-			b = temp;
-		}
+	/* Initialize: each node as its own parent */
+	cilk_for (uint32_t i = 0; i < n; i++)
+		label[i] = i;
+	
+	CC_PROBE_PHASE_START("uf_union");
+	/* Process all edges: union connected nodes until one set remains */
+	uint32_t unions = 0;
+	cilk_for (uint32_t ch = 0; ch < n_chunks; ch++) {
+		if (__atomic_load_n(&unions, __ATOMIC_RELAXED) == n - 1)
+			continue;
 		
-		uint32_t expected = b;
-		if (__atomic_compare_exchange_n(&label[b], &expected, a,
-		                                0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
-			return;
+		const uint32_t begin = ch * UF_CHUNK;
+		const uint32_t end = begin + UF_CHUNK < matrix->ncols ? begin + UF_CHUNK : matrix->ncols;
+		uint32_t merged = 0;
+		for (uint32_t col = begin; col < end; col++) {
+			merged += union_column(label, n, matrix->row_idx, matrix->col_ptr[col],
+			                       matrix->col_ptr[col + 1], off + col);
 		}
-		
-		b = expected;
+		if (merged)
+			__atomic_fetch_add(&unions, merged, __ATOMIC_RELAXED);
 	}
+	CC_PROBE_PHASE_END("uf_union");
 	
-	/* Fallback after maximum retries */
-	a = find_compress(label, a);
-	b = find_compress(label, b);
-	if (a != b) {
-		if (a > b) {
-			uint32_t temp = a;
-			a = b;
-			b = temp;
-		}
-		__atomic_store_n(&label[b], a, __ATOMIC_RELEASE);
-	}
+	return unions;
 }
 
-/* ========================================================================== */
-/*                         UNION-FIND ALGORITHM                               */
-/* ========================================================================== */
-
 /**
  * @brief Computes connected components using parallel union-find.
  *
- * Algorithm phases:
- * 1. Initialize each node as its own root (parallel with cilk_for)
- * 2. Perform parallel union operations on edges
- * 3. Flatten all paths to roots for accurate counting (parallel)
- * 4. Count roots in parallel using atomic increments
+ * Counts the components online (see uf_unite()); the forest is discarded
+ * without being flattened.
  *
  * @param matrix Sparse CSC binary matrix representing graph
  * @return Number of connected components, or -1 on error
@@ -132,44 +107,18 @@ union_rem(uint32_t *label, uint32_t a, uint32_t b)
 static int
 cc_union_find(const CSCBinaryMatrix *matrix)
 {
-	if (!matrix || matrix->nrows == 0)
+	if (!matrix || csc_num_vertices(matrix) == 0)
 		return 0;
 	
-	const uint32_t n = (uint32_t)matrix->nrows;
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
 	uint32_t *label = malloc(n * sizeof(uint32_t));
 	if (!label)
 		return -1;
 	
-	/* Initialize: each node as its own parent */
-	cilk_for (uint32_t i = 0; i < n; i++)
-		label[i] = i;
-	
-	/* Process all edges: union connected nodes */
-	cilk_for (uint32_t col = 0; col < matrix->ncols; col++) {
-		uint32_t start = matrix->col_ptr[col];
-		uint32_t end = matrix->col_ptr[col + 1];
-		
-		for (uint32_t j = start; j < end; j++) {
-			uint32_t row = matrix->row_idx[j];
-			if (row < n)
-				union_rem(label, row, col);
-		}
-	}
-	
-	/* Final compression pass: flatten all paths */
-	cilk_for (uint32_t i = 0; i < n; i++)
-		find_compress(label, i);
-	
-	/* Count roots (each root represents one component) */
-	uint32_t count = 0;
-	cilk_for (uint32_t i = 0; i < n; i++) {
-		if (label[i] == i) {
-			__atomic_fetch_add(&count, 1, __ATOMIC_RELAXED);
-		}
-	}
+	const uint32_t unions = uf_unite(matrix, label);
 	
 	free(label);
-	return (int)count;
+	return (int)(n - unions);
 }
 
 /* ========================================================================== */
@@ -179,15 +128,9 @@ cc_union_find(const CSCBinaryMatrix *matrix)
 /**
  * @brief Computes connected components using parallel label propagation.
  *
- * Algorithm steps:
- * 1. Initialize each node with its own index as label
- * 2. Iterate over all edges in parallel, propagating minimum labels
- * 3. Use relaxed atomic operations to update labels
- * 4. Repeat until no labels change (convergence)
- * 5. Count unique components using bitmap with hardware popcount
- *
- * Key optimization: Per-column processing with per-worker local change
- * flags minimizes atomic operations while maintaining correctness.
+ * Runs the shared min-label propagation driver on the semiring SpMV
+ * engine (see cc_label_propagation_spmv()), whose kernels are compiled
+ * for OpenCilk (the runtime chooses the number of workers).
  *
  * @param matrix Sparse CSC binary matrix representing graph
  * @return Number of connected components, or -1 on error
@@ -195,76 +138,7 @@ cc_union_find(const CSCBinaryMatrix *matrix)
 static int
 cc_label_propagation(const CSCBinaryMatrix *matrix)
 {
-	if (!matrix || matrix->nrows == 0)
-		return 0;
-	
-	uint32_t *label = malloc(sizeof(uint32_t) * matrix->nrows);
-	if (!label)
-		return -1;
-	
-	/* Initialize: each node labeled with its own index */
-	for (size_t i = 0; i < matrix->nrows; i++)
-		label[i] = i;
-	
-	/* Iterate until convergence */
-	uint8_t finished;
-	do {
-		finished = 1;
-		
-		/* Per-column processing with per-worker local change flag */
-		cilk_for (size_t col = 0; col < matrix->ncols; col++) {
-			uint8_t local_changed = 0;
-			
-			for (uint32_t j = matrix->col_ptr[col]; j < matrix->col_ptr[col + 1]; j++) {
-				uint32_t row = matrix->row_idx[j];
-				uint32_t label_col = label[col];
-				uint32_t label_row = label[row];
-				
-				if (label_col != label_row) {
-					uint32_t min_label = label_col < label_row ? label_col : label_row;
-					
-					/* Update labels with relaxed atomics */
-					if (label_col != min_label)
-						__atomic_store_n(&label[col], min_label, __ATOMIC_RELAXED);
-					else
-						__atomic_store_n(&label[row], min_label, __ATOMIC_RELAXED);
-					
-					local_changed = 1;
-				}
-			}
-			
-			/* Mark global flag if any change occurred in this worker */
-			if (local_changed)
-				finished = 0;
-		}
-		
-	} while (!finished);
-	
-	/* Count unique components using a bitmap */
-	size_t bitmap_size = (matrix->nrows + 63) / 64;
-	uint64_t *bitmap = calloc(bitmap_size, sizeof(uint64_t));
-	if (!bitmap) {
-		free(label);
-		return -1;
-	}
-	
-	/* Bitmap construction: set bit for each unique label */
-	for (size_t i = 0; i < matrix->nrows; i++) {
-		uint32_t val = label[i];
-		size_t word = val >> 6;            /* Divide by 64 */
-		uint64_t bit = 1ULL << (val & 63); /* Modulo 64 */
-		bitmap[word] |= bit;
-	}
-	
-	/* Count set bits using hardware popcount */
-	uint32_t count = 0;
-	for (size_t i = 0; i < bitmap_size; i++) {
-		count += __builtin_popcountll(bitmap[i]);
-	}
-	
-	free(bitmap);
-	free(label);
-	return (int)count;
+	return cc_label_propagation_spmv(matrix, 0);
 }
 
 /* ========================================================================== */
@@ -275,16 +149,16 @@ cc_label_propagation(const CSCBinaryMatrix *matrix)
  * @brief Computes connected components using OpenCilk parallel algorithms.
  *
  * This is the main entry point for OpenCilk connected components computation.
- * It dispatches to one of two algorithm implementations based on the variant
- * parameter.
+ * It dispatches to the algorithm selected by the variant parameter.
  *
  * Supported variants:
  *   0: Label propagation
  *   1: Union-find with Rem's algorithm
+ *   2: Low-diameter decomposition (see cc_ldd())
  *
  * @param matrix Sparse binary matrix in CSC format
  * @param n_threads Unused (Cilk manages threads automatically)
- * @param algorithm_variant Algorithm selection (0 or 1)
+ * @param algorithm_variant Algorithm selection (0, 1 or 2)
  * @return Number of connected components, or -1 on error
  */
 int
@@ -297,8 +171,41 @@ cc_cilk(const CSCBinaryMatrix *matrix,
 		return cc_label_propagation(matrix);
 	case 1:
 		return cc_union_find(matrix);
+	case 2:
+		return cc_ldd(matrix, 0);
 	default:
 		break;
 	}
 	return -1;
 }
+
+/**
+ * @brief Labels every vertex with the smallest vertex of its component.
+ *
+ * Builds the union-find forest (see uf_unite()), then flattens it: every
+ * vertex is pointed at its root, the smallest vertex of its component.
+ * Only label consumers pay for the flatten.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Unused (Cilk manages threads automatically)
+ * @param label Output: csc_num_vertices() labels
+ * @return 0 on success, -1 on error
+ */
+int
+cc_labels(const CSCBinaryMatrix *matrix,
+          const unsigned int n_threads __attribute__((unused)),
+          uint32_t *label)
+{
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
+	if (n == 0)
+		return 0;
+	
+	uf_unite(matrix, label);
+	
+	CC_PROBE_PHASE_START("uf_flatten");
+	cilk_for (uint32_t i = 0; i < n; i++)
+		find_compress(label, i);
+	CC_PROBE_PHASE_END("uf_flatten");
+	
+	return 0;
+}
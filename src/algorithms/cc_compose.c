@@ -0,0 +1,568 @@
+/**
+ * @file cc_compose.c
+ * @brief Connected components composed of a sampling and a finish phase.
+ *
+ * After ConnectIt (Dhulipala, Hong and Shun), a run is split in two:
+ *
+ * 1. Sampling links a cheap subset of the edges into a union-find forest
+ *    with Rem's unions: the first CC_KOUT edges of every column (k-out),
+ *    the tree of one breadth-first search, or the clusters of one
+ *    low-diameter decomposition level (see cc_ldd_sample()). The forest is
+ *    flattened, so every vertex points at the smallest vertex of its tree,
+ *    and the largest tree is found from the labels of a sample of
+ *    vertices. On most real graphs it already holds most of the vertices.
+ * 2. Finishing processes every edge, except those with both ends in the
+ *    largest tree, which are already connected:
+ *    - rem:  Rem union-find, linking the root with the larger index
+ *    - rand: union-find linking the root with the lower random priority
+ *    - sv:   Shiloach-Vishkin hooking of roots under smaller roots, with
+ *            shortcutting to stars after every round
+ *    - lp:   min-label propagation on the SpMV engine of variant 0 (see
+ *            cc_primitives.h), starting from the sampled labels
+ *
+ * Every phase starts from, and the union-find and SV finishes keep, a
+ * forest of parent pointers, so any sampling can precede any finish. The
+ * roots of Rem's unions are the smallest vertices of their trees, so the
+ * flattened forest is also a valid starting labelling for propagation.
+ * Propagation cannot skip the largest tree, as its vertices are labelled
+ * one by one, but a good sample leaves few labels to change, so it drops
+ * to sparse pushes from the changed labels almost at once; full sweeps
+ * would take as many rounds as the diameter. Components are the vertices
+ * left labelled with themselves.
+ *
+ * Every pass is a parallel_for() over columns or vertices, or an SpMV
+ * kernel, so every combination runs on whichever backend this file is
+ * compiled for.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connected_components.h"
+#include "cc_primitives.h"
+#include "parallel.h"
+#include "spmv.h"
+#include "error.h"
+
+#define CC_KOUT         2      /* Edges sampled per column */
+#define COMPOSE_GRAIN   1024   /* Columns or vertices per chunk */
+#define COMPOSE_PROBES  1024   /* Vertices sampled to find the largest tree */
+#define COMPOSE_UNSET   UINT32_MAX
+
+/* Full compression for flattening (parents are smaller than children
+ * after Rem's unions), halving for the finish phases */
+CC_DEFINE_FIND(find_compress, uint32_t, FULL, RELAXED)
+CC_DEFINE_FIND(find_halving, uint32_t, HALVING, RELAXED)
+CC_DEFINE_UNION(union_rem, uint32_t, find_halving, RELAXED)
+
+static const char *const sample_names[CC_SAMPLE_COUNT] = {
+	[CC_SAMPLE_NONE] = "none",
+	[CC_SAMPLE_KOUT] = "kout",
+	[CC_SAMPLE_BFS]  = "bfs",
+	[CC_SAMPLE_LDD]  = "ldd",
+};
+
+static const char *const finish_names[CC_FINISH_COUNT] = {
+	[CC_FINISH_REM]  = "rem",
+	[CC_FINISH_RAND] = "rand",
+	[CC_FINISH_LP]   = "lp",
+	[CC_FINISH_SV]   = "sv",
+};
+
+/**
+ * @struct ComposeCtx
+ * @brief State shared by the parallel passes of one run.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;
+	uint32_t n;                 /* Vertices */
+	uint32_t off;               /* Vertex of column 0 */
+	uint32_t *label;            /* Union-find parents */
+	const uint32_t *cluster;    /* Sampled cluster of each vertex (bfs, ldd) */
+	uint8_t *big;               /* Vertex is in the largest sampled tree, or NULL */
+	uint32_t largest;           /* Root of the largest sampled tree */
+	int changed;                /* A parent changed in this round (sv) */
+	size_t roots;               /* Components counted */
+} ComposeCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static inline uint32_t
+hash32(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+/**
+ * @brief Whether the entry (r, v) can be skipped: both ends are in the
+ * largest sampled tree, or r is outside the vertex range.
+ */
+static inline int
+skip_entry(const ComposeCtx *c, uint32_t r, uint32_t v)
+{
+	return r >= c->n || (c->big && c->big[r] && c->big[v]);
+}
+
+/**
+ * @brief Lowers *p to v if v is smaller.
+ * @return 1 if *p was lowered
+ */
+static inline int
+write_min(uint32_t *p, uint32_t v)
+{
+	uint32_t cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+	while (v < cur) {
+		if (__atomic_compare_exchange_n(p, &cur, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Unites the sets of a and b, linking the root with the lower
+ * random priority under the other.
+ *
+ * Priorities are a hash of the vertex, with the vertex breaking ties, so
+ * they are a total order and links never form a cycle.
+ */
+static inline int
+union_random(uint32_t *label, uint32_t a, uint32_t b)
+{
+	for (;;) {
+		a = find_halving(label, a);
+		b = find_halving(label, b);
+		if (a == b)
+			return 0;
+		const uint64_t pa = (uint64_t)hash32(a) << 32 | a;
+		const uint64_t pb = (uint64_t)hash32(b) << 32 | b;
+		if (pa < pb) {
+			uint32_t t = a;
+			a = b;
+			b = t;
+		}
+		uint32_t expected = b;
+		if (__atomic_compare_exchange_n(&label[b], &expected, a, 0,
+		                                __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			return 1;
+		CC_PROBE2(union__retry, a, b);
+	}
+}
+
+static void
+init_labels(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->label[v] = (uint32_t)v;
+}
+
+static void
+sample_kout(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t v = c->off + (uint32_t)j;
+		unsigned int taken = 0;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1] && taken < CC_KOUT; k++) {
+			const uint32_t r = m->row_idx[k];
+			if (r >= c->n || r == v)
+				continue;
+			union_rem(c->label, r, v);
+			taken++;
+		}
+	}
+}
+
+static void
+sample_clusters(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	for (size_t v = begin; v < end; v++) {
+		const uint32_t centre = c->cluster[v];
+		if (centre != COMPOSE_UNSET && centre != v)
+			union_rem(c->label, (uint32_t)v, centre);
+	}
+}
+
+static void
+flatten(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->label[v] = find_compress(c->label, (uint32_t)v);
+}
+
+static void
+mark_big(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->big[v] = (c->label[v] == c->largest);
+}
+
+static void
+finish_rem(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t v = c->off + (uint32_t)j;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1]; k++) {
+			const uint32_t r = m->row_idx[k];
+			if (!skip_entry(c, r, v))
+				union_rem(c->label, r, v);
+		}
+	}
+}
+
+static void
+finish_rand(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t v = c->off + (uint32_t)j;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1]; k++) {
+			const uint32_t r = m->row_idx[k];
+			if (!skip_entry(c, r, v))
+				union_random(c->label, r, v);
+		}
+	}
+}
+
+/**
+ * @brief Hooks the root of the larger parent under the smaller parent of
+ * the ends of every edge.
+ */
+static void
+hook_sv(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	uint32_t *p = c->label;
+	int changed = 0;
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t v = c->off + (uint32_t)j;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1]; k++) {
+			const uint32_t r = m->row_idx[k];
+			if (skip_entry(c, r, v))
+				continue;
+			const uint32_t pr = __atomic_load_n(&p[r], __ATOMIC_RELAXED);
+			const uint32_t pv = __atomic_load_n(&p[v], __ATOMIC_RELAXED);
+			if (pr == pv)
+				continue;
+			const uint32_t lo = pr < pv ? pr : pv, hi = pr < pv ? pv : pr;
+			if (__atomic_load_n(&p[hi], __ATOMIC_RELAXED) == hi)
+				changed |= write_min(&p[hi], lo);
+		}
+	}
+
+	if (changed)
+		__atomic_store_n(&c->changed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Points every vertex at its root, turning the trees into stars.
+ */
+static void
+shortcut_sv(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	uint32_t *p = c->label;
+
+	for (size_t v = begin; v < end; v++) {
+		uint32_t root = __atomic_load_n(&p[v], __ATOMIC_RELAXED), next;
+		while ((next = __atomic_load_n(&p[root], __ATOMIC_RELAXED)) != root)
+			root = next;
+		__atomic_store_n(&p[v], root, __ATOMIC_RELAXED);
+	}
+}
+
+static void
+count_roots(void *arg, size_t begin, size_t end)
+{
+	ComposeCtx *c = arg;
+	size_t roots = 0;
+
+	for (size_t v = begin; v < end; v++)
+		roots += (c->label[v] == v);
+
+	if (roots)
+		__atomic_fetch_add(&c->roots, roots, __ATOMIC_RELAXED);
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+	const uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Most common root among a sample of vertices of the flattened
+ * forest.
+ */
+static uint32_t
+largest_tree(const ComposeCtx *c)
+{
+	uint32_t probe[COMPOSE_PROBES];
+	for (uint32_t i = 0; i < COMPOSE_PROBES; i++)
+		probe[i] = c->label[hash32(i) % c->n];
+	qsort(probe, COMPOSE_PROBES, sizeof(uint32_t), cmp_u32);
+
+	uint32_t best = probe[0], best_len = 0;
+	for (uint32_t i = 0, len = 1; i < COMPOSE_PROBES; i++, len++) {
+		if (i + 1 < COMPOSE_PROBES && probe[i + 1] == probe[i])
+			continue;
+		if (len > best_len) {
+			best = probe[i];
+			best_len = len;
+		}
+		len = 0;
+	}
+	return best;
+}
+
+/**
+ * @brief Column with the most entries, as the source of the sampling
+ * search: it most likely lies in the largest component.
+ */
+static uint32_t
+search_source(const ComposeCtx *c)
+{
+	const CSCBinaryMatrix *m = c->m;
+	size_t best = 0;
+	for (size_t j = 1; j < m->ncols; j++)
+		if (m->col_ptr[j + 1] - m->col_ptr[j] > m->col_ptr[best + 1] - m->col_ptr[best])
+			best = j;
+	return c->off + (uint32_t)best;
+}
+
+/**
+ * @brief Runs the sampling phase, flattens the forest and marks its
+ * largest tree.
+ *
+ * @return 0 on success, -1 on error
+ */
+static int
+sample(ComposeCtx *c, CCSample kind, unsigned int n_threads)
+{
+	const CSCBinaryMatrix *m = c->m;
+
+	switch (kind) {
+	case CC_SAMPLE_NONE:
+		return 0;
+
+	case CC_SAMPLE_KOUT:
+		parallel_for(m->ncols, COMPOSE_GRAIN, n_threads, sample_kout, c);
+		break;
+
+	case CC_SAMPLE_BFS:
+	case CC_SAMPLE_LDD: {
+		uint32_t *cluster = malloc((size_t)c->n * sizeof(uint32_t));
+		if (!cluster) {
+			print_error(__func__, "malloc() failed", errno);
+			return -1;
+		}
+		const uint32_t source = (kind == CC_SAMPLE_BFS && m->ncols) ? search_source(c)
+		                                                            : COMPOSE_UNSET;
+		if (cc_ldd_sample(m, n_threads, source, cluster)) {
+			free(cluster);
+			return -1;
+		}
+		c->cluster = cluster;
+		parallel_for(c->n, COMPOSE_GRAIN, n_threads, sample_clusters, c);
+		c->cluster = NULL;
+		free(cluster);
+		break;
+	}
+
+	default:
+		return -1;
+	}
+
+	parallel_for(c->n, COMPOSE_GRAIN, n_threads, flatten, c);
+
+	c->big = malloc(c->n);
+	if (!c->big) {
+		print_error(__func__, "malloc() failed", errno);
+		return -1;
+	}
+	c->largest = largest_tree(c);
+	parallel_for(c->n, COMPOSE_GRAIN, n_threads, mark_big, c);
+	return 0;
+}
+
+/**
+ * @brief Min-label propagation from the sampled labels: dense sweeps while
+ * many labels change, then sparse pushes from the changed labels, as in
+ * cc_propagate_labels_spmv().
+ *
+ * @return 0 on success, -1 on error
+ */
+static int
+finish_lp(ComposeCtx *c, unsigned int n_threads)
+{
+	SpmvEngine *e = spmv_init(c->m, n_threads);
+	SpmvFrontier cur = { NULL, 0 }, next = { NULL, 0 };
+	long changed = -1;
+	if (!e || spmv_frontier_init(e, &cur) || spmv_frontier_init(e, &next))
+		goto out;
+
+	do {
+		changed = spmv_dense(e, SPMV_MIN_SELECT, SPMV_BOTH, SPMV_PUSH, c->label, c->label, NULL);
+	} while (changed > (long)(c->n / LP_DENSE_DIVISOR));
+
+	if (changed > 0)
+		changed = spmv_dense(e, SPMV_MIN_SELECT, SPMV_BOTH, SPMV_PUSH, c->label, c->label, &cur);
+	while (changed > 0) {
+		changed = spmv_sparse(e, SPMV_MIN_SELECT, SPMV_BOTH, c->label, &cur, c->label, &next);
+
+		SpmvFrontier tmp = cur;
+		cur = next;
+		next = tmp;
+	}
+
+out:
+	spmv_frontier_free(&cur);
+	spmv_frontier_free(&next);
+	spmv_free(e);
+	return changed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Runs the finish phase on the sampled forest.
+ *
+ * @return 0 on success, -1 on error
+ */
+static int
+finish(ComposeCtx *c, CCFinish kind, unsigned int n_threads)
+{
+	const size_t ncols = c->m->ncols;
+
+	switch (kind) {
+	case CC_FINISH_REM:
+		parallel_for(ncols, COMPOSE_GRAIN, n_threads, finish_rem, c);
+		return 0;
+
+	case CC_FINISH_RAND:
+		parallel_for(ncols, COMPOSE_GRAIN, n_threads, finish_rand, c);
+		return 0;
+
+	case CC_FINISH_LP:
+		return finish_lp(c, n_threads);
+
+	case CC_FINISH_SV:
+		do {
+			c->changed = 0;
+			parallel_for(ncols, COMPOSE_GRAIN, n_threads, hook_sv, c);
+			parallel_for(c->n, COMPOSE_GRAIN, n_threads, shortcut_sv, c);
+		} while (c->changed);
+		return 0;
+
+	default:
+		return -1;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc cc_compose_parse()
+ */
+int
+cc_compose_parse(const char *spec, CCComposition *comp)
+{
+	const char *plus = strchr(spec, '+');
+	const char *finish_name = plus ? plus + 1 : spec;
+	const size_t sample_len = plus ? (size_t)(plus - spec) : 0;
+
+	comp->sample = CC_SAMPLE_NONE;
+	if (plus) {
+		unsigned int s;
+		for (s = 0; s < CC_SAMPLE_COUNT; s++)
+			if (strlen(sample_names[s]) == sample_len &&
+			    strncmp(spec, sample_names[s], sample_len) == 0)
+				break;
+		if (s == CC_SAMPLE_COUNT)
+			return 1;
+		comp->sample = (CCSample)s;
+	}
+
+	for (unsigned int f = 0; f < CC_FINISH_COUNT; f++) {
+		if (strcmp(finish_name, finish_names[f]) == 0) {
+			comp->finish = (CCFinish)f;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @copydoc cc_compose_name()
+ */
+void
+cc_compose_name(CCComposition comp, char *buf, size_t size)
+{
+	snprintf(buf, size, "%s+%s", sample_names[comp.sample], finish_names[comp.finish]);
+}
+
+/**
+ * @copydoc cc_compose()
+ */
+int
+cc_compose(const CSCBinaryMatrix *matrix, unsigned int n_threads, CCComposition comp)
+{
+	if (!matrix || csc_num_vertices(matrix) == 0)
+		return 0;
+
+	ComposeCtx c;
+	memset(&c, 0, sizeof(c));
+	c.m = matrix;
+	c.n = (uint32_t)csc_num_vertices(matrix);
+	c.off = (uint32_t)csc_col_offset(matrix);
+	c.label = malloc((size_t)c.n * sizeof(uint32_t));
+	if (!c.label) {
+		print_error(__func__, "malloc() failed", errno);
+		return -1;
+	}
+
+	int ret = -1;
+	parallel_for(c.n, COMPOSE_GRAIN, n_threads, init_labels, &c);
+
+	CC_PROBE_PHASE_START("compose_sample");
+	int err = sample(&c, comp.sample, n_threads);
+	CC_PROBE_PHASE_END("compose_sample");
+	if (err)
+		goto out;
+
+	CC_PROBE_PHASE_START("compose_finish");
+	err = finish(&c, comp.finish, n_threads);
+	CC_PROBE_PHASE_END("compose_finish");
+	if (err)
+		goto out;
+
+	parallel_for(c.n, COMPOSE_GRAIN, n_threads, count_roots, &c);
+	ret = (int)c.roots;
+
+out:
+	free(c.label);
+	free(c.big);
+	return ret;
+}
@@ -0,0 +1,886 @@
+/**
+ * @file cc_external.c
+ * @brief External-memory connected components by sort and contract.
+ *
+ * For graphs whose vertex set does not fit in memory. The entries of the
+ * matrix file are streamed into a temporary edge list, whose vertices are
+ * then labelled recursively (after Abello, Buchsbaum and Westbrook):
+ *
+ * 1. If the edges fit in the memory budget, label their vertices in memory
+ *    with the sequential union-find kernels.
+ * 2. Otherwise label the first half of the edges recursively.
+ * 3. Contract the second half: relabel both endpoints of every edge with
+ *    those labels (an external sort and a merge join per endpoint),
+ *    dropping self-loops and duplicate edges.
+ * 4. Label the contracted edges recursively.
+ * 5. Compose the two labellings (two more sorts and joins).
+ *
+ * A labelling maps every vertex of its edges to the smallest vertex of its
+ * component and is stored sorted by vertex. The number of components is
+ * the number of vertices labelled with themselves, plus the vertices that
+ * no edge touches.
+ *
+ * Every record on disk is a uint64_t packing two vertices, with the sort
+ * key in the high half, so edges and labellings share one external merge
+ * sort. Temporary files are unlinked as soon as they are created.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "connected_components.h"
+#include "cc_primitives.h"
+#include "error.h"
+
+#define EXT_MIN_MEMORY  (1u << 20)  /* Smallest accepted budget, in bytes */
+#define EXT_BUF_RECORDS 8192        /* Records per stream buffer */
+#define EXT_BATCH       4096        /* Entries per batch read from the input */
+
+#define EXT_PACK(hi, lo)  (((uint64_t)(hi) << 32) | (uint32_t)(lo))
+#define EXT_HI(x)         ((uint32_t)((x) >> 32))
+#define EXT_LO(x)         ((uint32_t)(x))
+
+/* Path halving and union by index, as in the sequential backend */
+CC_DEFINE_FIND(find_root_halving, uint32_t, HALVING, PLAIN)
+CC_DEFINE_UNION(union_nodes_by_index, uint32_t, find_root_halving, PLAIN)
+
+/**
+ * @struct ExtCtx
+ * @brief Settings and accounting of one external-memory run.
+ */
+typedef struct {
+	size_t mem_records;      /* Memory budget, in records */
+	const char *tmp_dir;     /* Directory of the temporary files */
+	ExternalStats *stats;    /* I/O accounting */
+} ExtCtx;
+
+/* ========================================================================== */
+/*                              FILE STREAMS                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Creates an anonymous temporary file.
+ *
+ * @return File descriptor, or -1 on error
+ */
+static int
+ext_tmpfile(const ExtCtx *c)
+{
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/cc_external_XXXXXX", c->tmp_dir);
+
+	int fd = mkstemp(path);
+	if (fd < 0) {
+		print_error(__func__, "mkstemp() failed", errno);
+		return -1;
+	}
+	unlink(path);  /* Removed once closed */
+	return fd;
+}
+
+/**
+ * @brief Closes a file descriptor if open and marks it closed.
+ */
+static void
+ext_close(int *fd)
+{
+	if (*fd >= 0)
+		close(*fd);
+	*fd = -1;
+}
+
+/**
+ * @brief Reads n records at record offset pos.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_read(ExtCtx *c, int fd, uint64_t *buf, size_t n, uint64_t pos)
+{
+	char *p = (char *)buf;
+	size_t left = n * sizeof(uint64_t);
+	off_t off = (off_t)(pos * sizeof(uint64_t));
+
+	while (left > 0) {
+		ssize_t got = pread(fd, p, left, off);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0) {
+			print_error(__func__, "pread() failed", got < 0 ? errno : 0);
+			return 1;
+		}
+		p += got;
+		off += got;
+		left -= (size_t)got;
+	}
+
+	c->stats->bytes_read += n * sizeof(uint64_t);
+	return 0;
+}
+
+/**
+ * @brief Appends n records to a file.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_write(ExtCtx *c, int fd, const uint64_t *buf, size_t n)
+{
+	const char *p = (const char *)buf;
+	size_t left = n * sizeof(uint64_t);
+
+	while (left > 0) {
+		ssize_t put = write(fd, p, left);
+		if (put < 0 && errno == EINTR)
+			continue;
+		if (put < 0) {
+			print_error(__func__, "write() failed", errno);
+			return 1;
+		}
+		p += put;
+		left -= (size_t)put;
+	}
+
+	c->stats->bytes_written += n * sizeof(uint64_t);
+	return 0;
+}
+
+/**
+ * @struct ExtReader
+ * @brief Buffered sequential reader over a range of records.
+ */
+typedef struct {
+	ExtCtx *c;
+	int fd;
+	uint64_t pos;      /* Next record to fetch from the file */
+	uint64_t end;      /* One past the last record of the range */
+	uint64_t *buf;
+	size_t cap;        /* Buffer capacity */
+	size_t len;        /* Records in the buffer */
+	size_t i;          /* Next record in the buffer */
+} ExtReader;
+
+static void
+reader_init(ExtReader *r, ExtCtx *c, int fd, uint64_t begin, uint64_t n,
+            uint64_t *buf, size_t cap)
+{
+	r->c = c;
+	r->fd = fd;
+	r->pos = begin;
+	r->end = begin + n;
+	r->buf = buf;
+	r->cap = cap;
+	r->len = 0;
+	r->i = 0;
+}
+
+/**
+ * @brief Returns the next record without consuming it.
+ *
+ * @return 1 with *x set, 0 at the end of the range, -1 on error
+ */
+static int
+reader_peek(ExtReader *r, uint64_t *x)
+{
+	if (r->i == r->len) {
+		if (r->pos == r->end)
+			return 0;
+		size_t want = r->end - r->pos < r->cap ? (size_t)(r->end - r->pos) : r->cap;
+		if (ext_read(r->c, r->fd, r->buf, want, r->pos))
+			return -1;
+		r->pos += want;
+		r->len = want;
+		r->i = 0;
+	}
+	*x = r->buf[r->i];
+	return 1;
+}
+
+/**
+ * @struct ExtWriter
+ * @brief Buffered appending writer of records.
+ */
+typedef struct {
+	ExtCtx *c;
+	int fd;
+	uint64_t n;        /* Records written, including buffered ones */
+	uint64_t *buf;
+	size_t len;        /* Records in the buffer */
+} ExtWriter;
+
+/**
+ * @brief Creates a temporary file and a writer to it.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+writer_open(ExtWriter *w, ExtCtx *c)
+{
+	w->c = c;
+	w->n = 0;
+	w->len = 0;
+	w->buf = malloc(EXT_BUF_RECORDS * sizeof(uint64_t));
+	if (!w->buf) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+	w->fd = ext_tmpfile(c);
+	if (w->fd < 0) {
+		free(w->buf);
+		return 1;
+	}
+	return 0;
+}
+
+static int
+writer_put(ExtWriter *w, uint64_t x)
+{
+	w->buf[w->len++] = x;
+	w->n++;
+	if (w->len < EXT_BUF_RECORDS)
+		return 0;
+	w->len = 0;
+	return ext_write(w->c, w->fd, w->buf, EXT_BUF_RECORDS);
+}
+
+/**
+ * @brief Flushes a writer and frees its buffer, keeping the file.
+ *
+ * On error the file is closed as well.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+writer_close(ExtWriter *w, int failed)
+{
+	if (!failed && w->len)
+		failed = ext_write(w->c, w->fd, w->buf, w->len);
+	free(w->buf);
+	w->buf = NULL;
+	if (failed)
+		ext_close(&w->fd);
+	return failed;
+}
+
+/* ========================================================================== */
+/*                             EXTERNAL SORT                                  */
+/* ========================================================================== */
+
+/**
+ * @brief Defines `void name(T *a, T *tmp, size_t n)`, an LSD radix sort.
+ *
+ * Byte-wide digits; digits equal across all keys are skipped.
+ */
+#define EXT_DEFINE_RADIX_SORT(name, T)                                        \
+static void                                                                   \
+name(T *a, T *tmp, size_t n)                                                  \
+{                                                                             \
+	T *const orig = a;                                                    \
+	size_t count[256];                                                    \
+	if (n < 2)                                                            \
+		return;                                                       \
+	for (unsigned int shift = 0; shift < 8 * sizeof(T); shift += 8) {     \
+		memset(count, 0, sizeof(count));                              \
+		for (size_t i = 0; i < n; i++)                                \
+			count[(a[i] >> shift) & 0xff]++;                      \
+		if (count[(a[0] >> shift) & 0xff] == n)                       \
+			continue;                                             \
+		size_t sum = 0;                                               \
+		for (unsigned int d = 0; d < 256; d++) {                      \
+			size_t c = count[d];                                  \
+			count[d] = sum;                                       \
+			sum += c;                                             \
+		}                                                             \
+		for (size_t i = 0; i < n; i++)                                \
+			tmp[count[(a[i] >> shift) & 0xff]++] = a[i];          \
+		T *s = a;                                                     \
+		a = tmp;                                                      \
+		tmp = s;                                                      \
+	}                                                                     \
+	if (a != orig)                                                        \
+		memcpy(orig, a, n * sizeof(T));                               \
+}
+
+EXT_DEFINE_RADIX_SORT(radix_sort_u64, uint64_t)
+EXT_DEFINE_RADIX_SORT(radix_sort_u32, uint32_t)
+
+/**
+ * @brief Merges k consecutive sorted runs into a writer.
+ *
+ * Runs are [first + i * run_len, first + (i + 1) * run_len), clipped to n.
+ * Each gets a reader buffer of EXT_BUF_RECORDS records from @p bufs, and
+ * the smallest head is selected with a binary heap.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_merge_runs(ExtCtx *c, int fd, uint64_t n, uint64_t first, uint64_t run_len,
+               size_t k, uint64_t *bufs, ExtWriter *w)
+{
+	ExtReader *rd = malloc(k * sizeof(ExtReader));
+	uint64_t *head = malloc(k * sizeof(uint64_t));
+	size_t *heap = malloc(k * sizeof(size_t));
+	size_t size = 0;
+	int ret = 1;
+
+	if (!rd || !head || !heap) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+
+	for (size_t i = 0; i < k; i++) {
+		uint64_t begin = first + i * run_len;
+		uint64_t len = n - begin < run_len ? n - begin : run_len;
+		reader_init(&rd[i], c, fd, begin, len, bufs + i * EXT_BUF_RECORDS, EXT_BUF_RECORDS);
+
+		int st = reader_peek(&rd[i], &head[i]);
+		if (st < 0)
+			goto out;
+		if (st == 0)
+			continue;
+
+		/* Sift up */
+		size_t j = size++;
+		while (j > 0 && head[heap[(j - 1) / 2]] > head[i]) {
+			heap[j] = heap[(j - 1) / 2];
+			j = (j - 1) / 2;
+		}
+		heap[j] = i;
+	}
+
+	while (size > 0) {
+		size_t top = heap[0];
+		if (writer_put(w, head[top]))
+			goto out;
+
+		rd[top].i++;
+		int st = reader_peek(&rd[top], &head[top]);
+		if (st < 0)
+			goto out;
+		if (st == 0)
+			top = heap[--size];
+
+		/* Sift down */
+		size_t j = 0;
+		for (;;) {
+			size_t l = 2 * j + 1, m = j;
+			uint64_t v = head[top];
+			if (l < size && head[heap[l]] < v) {
+				m = l;
+				v = head[heap[l]];
+			}
+			if (l + 1 < size && head[heap[l + 1]] < v)
+				m = l + 1;
+			if (m == j)
+				break;
+			heap[j] = heap[m];
+			j = m;
+		}
+		if (size > 0)
+			heap[j] = top;
+	}
+	ret = 0;
+
+out:
+	free(rd);
+	free(head);
+	free(heap);
+	return ret;
+}
+
+/**
+ * @brief Sorts records [begin, begin + n) of fd into a new temporary file.
+ *
+ * Runs of half the budget are radix sorted in memory, then merged with
+ * the largest fan-in whose buffers fit the budget, over as many passes as
+ * needed.
+ *
+ * @return File descriptor of the sorted records, or -1 on error
+ */
+static int
+ext_sort(ExtCtx *c, int fd, uint64_t begin, uint64_t n)
+{
+	uint64_t run_len = c->mem_records / 2;
+	uint64_t *buf = malloc(run_len * sizeof(uint64_t));
+	uint64_t *tmp = malloc(run_len * sizeof(uint64_t));
+	int rf = -1;
+
+	if (!buf || !tmp) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+
+	/* Run formation */
+	if ((rf = ext_tmpfile(c)) < 0)
+		goto fail;
+	for (uint64_t pos = 0; pos < n; pos += run_len) {
+		size_t len = n - pos < run_len ? (size_t)(n - pos) : (size_t)run_len;
+		if (ext_read(c, fd, buf, len, begin + pos))
+			goto fail;
+		radix_sort_u64(buf, tmp, len);
+		if (ext_write(c, rf, buf, len))
+			goto fail;
+	}
+	c->stats->passes++;
+
+	free(buf);
+	free(tmp);
+	buf = tmp = NULL;
+
+	/* Merge passes */
+	size_t fan_in = c->mem_records / EXT_BUF_RECORDS - 1;
+	if (fan_in < 2)
+		fan_in = 2;
+
+	uint64_t n_runs = (n + run_len - 1) / run_len;
+	while (n_runs > 1) {
+		size_t k_max = n_runs < fan_in ? (size_t)n_runs : fan_in;
+		buf = malloc(k_max * EXT_BUF_RECORDS * sizeof(uint64_t));
+		if (!buf) {
+			print_error(__func__, "malloc() failed", errno);
+			goto fail;
+		}
+
+		ExtWriter w;
+		if (writer_open(&w, c))
+			goto fail;
+		int failed = 0;
+		for (uint64_t r = 0; r < n_runs && !failed; r += fan_in) {
+			size_t k = n_runs - r < fan_in ? (size_t)(n_runs - r) : fan_in;
+			failed = ext_merge_runs(c, rf, n, r * run_len, run_len, k, buf, &w);
+		}
+		if (writer_close(&w, failed))
+			goto fail;
+
+		free(buf);
+		buf = NULL;
+		ext_close(&rf);
+		rf = w.fd;
+		run_len *= fan_in;
+		n_runs = (n_runs + fan_in - 1) / fan_in;
+		c->stats->passes++;
+	}
+
+	return rf;
+
+fail:
+	free(buf);
+	free(tmp);
+	ext_close(&rf);
+	return -1;
+}
+
+/* ========================================================================== */
+/*                              MERGE JOINS                                   */
+/* ========================================================================== */
+
+/**
+ * @brief Relabels the keys of sorted records and swaps their halves.
+ *
+ * Streams records (key, val) sorted by key alongside a labelling sorted by
+ * vertex and writes (val, label(key)) for each; keys missing from the
+ * labelling keep their own id. With no labelling (lfd < 0) the halves are
+ * only swapped. With @p contract, self-loops and repeats of the previous
+ * record are dropped.
+ *
+ * @param out Output: new file of the written records
+ * @param out_n Output: number of records written
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_relabel(ExtCtx *c, int fd, uint64_t n, int lfd, uint64_t ln, int contract,
+            int *out, uint64_t *out_n)
+{
+	uint64_t *bufs = malloc(2 * EXT_BUF_RECORDS * sizeof(uint64_t));
+	if (!bufs) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	ExtWriter w;
+	if (writer_open(&w, c)) {
+		free(bufs);
+		return 1;
+	}
+
+	ExtReader in, lab;
+	reader_init(&in, c, fd, 0, n, bufs, EXT_BUF_RECORDS);
+	reader_init(&lab, c, lfd, 0, lfd < 0 ? 0 : ln, bufs + EXT_BUF_RECORDS, EXT_BUF_RECORDS);
+
+	uint64_t rec, l = 0, prev = 0;
+	int have_prev = 0, st, lst = reader_peek(&lab, &l);
+	int failed = lst < 0;
+
+	while (!failed && (st = reader_peek(&in, &rec)) != 0) {
+		if (st < 0) {
+			failed = 1;
+			break;
+		}
+		in.i++;
+
+		if (contract && have_prev && rec == prev)
+			continue;
+		prev = rec;
+		have_prev = 1;
+
+		/* Advance the labelling to the key */
+		uint32_t key = EXT_HI(rec), label = key;
+		while (lst > 0 && EXT_HI(l) < key) {
+			lab.i++;
+			lst = reader_peek(&lab, &l);
+		}
+		if (lst < 0) {
+			failed = 1;
+			break;
+		}
+		if (lst > 0 && EXT_HI(l) == key)
+			label = EXT_LO(l);
+
+		if (contract && label == EXT_LO(rec))
+			continue;
+		failed = writer_put(&w, EXT_PACK(EXT_LO(rec), label));
+	}
+
+	c->stats->passes++;
+	free(bufs);
+	if (writer_close(&w, failed))
+		return 1;
+	*out = w.fd;
+	*out_n = w.n;
+	return 0;
+}
+
+/**
+ * @brief Merges two labellings sorted by vertex.
+ *
+ * Vertices in both keep their label from @p afd.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_merge_labels(ExtCtx *c, int afd, uint64_t an, int bfd, uint64_t bn,
+                 int *out, uint64_t *out_n)
+{
+	uint64_t *bufs = malloc(2 * EXT_BUF_RECORDS * sizeof(uint64_t));
+	if (!bufs) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	ExtWriter w;
+	if (writer_open(&w, c)) {
+		free(bufs);
+		return 1;
+	}
+
+	ExtReader a, b;
+	reader_init(&a, c, afd, 0, an, bufs, EXT_BUF_RECORDS);
+	reader_init(&b, c, bfd, 0, bn, bufs + EXT_BUF_RECORDS, EXT_BUF_RECORDS);
+
+	uint64_t x = 0, y = 0;
+	int sa = reader_peek(&a, &x), sb = reader_peek(&b, &y);
+	int failed = 0;
+
+	while (!failed && sa >= 0 && sb >= 0 && (sa > 0 || sb > 0)) {
+		if (sb == 0 || (sa > 0 && EXT_HI(x) <= EXT_HI(y))) {
+			if (sb > 0 && EXT_HI(x) == EXT_HI(y)) {
+				b.i++;
+				sb = reader_peek(&b, &y);
+			}
+			failed = writer_put(&w, x);
+			a.i++;
+			sa = reader_peek(&a, &x);
+		} else {
+			failed = writer_put(&w, y);
+			b.i++;
+			sb = reader_peek(&b, &y);
+		}
+	}
+	failed |= sa < 0 || sb < 0;
+
+	c->stats->passes++;
+	free(bufs);
+	if (writer_close(&w, failed))
+		return 1;
+	*out = w.fd;
+	*out_n = w.n;
+	return 0;
+}
+
+/* ========================================================================== */
+/*                          SORT AND CONTRACT                                 */
+/* ========================================================================== */
+
+/**
+ * @brief Returns the index of v in the sorted array a[0..n).
+ */
+static inline uint32_t
+vertex_index(const uint32_t *a, uint32_t n, uint32_t v)
+{
+	uint32_t lo = 0, hi = n;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (a[mid] < v)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+/**
+ * @brief Labels the vertices of edges that fit in memory.
+ *
+ * The distinct endpoints are sorted and numbered densely, so the
+ * union-find array only spans the vertices present. Since union by index
+ * keeps the smallest index as root, every root is the smallest vertex of
+ * its component.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_label_in_memory(ExtCtx *c, int fd, uint64_t begin, uint64_t n,
+                    int *out, uint64_t *out_n)
+{
+	uint64_t *edge = malloc((n ? n : 1) * sizeof(uint64_t));
+	uint32_t *vert = malloc((n ? 2 * n : 1) * sizeof(uint32_t));
+	uint32_t *tmp = malloc((n ? 2 * n : 1) * sizeof(uint32_t));
+	int failed = 1;
+
+	if (!edge || !vert || !tmp) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+	if (ext_read(c, fd, edge, n, begin))
+		goto out;
+	c->stats->passes++;
+
+	/* Number the distinct endpoints */
+	for (uint64_t i = 0; i < n; i++) {
+		vert[2 * i] = EXT_HI(edge[i]);
+		vert[2 * i + 1] = EXT_LO(edge[i]);
+	}
+	radix_sort_u32(vert, tmp, 2 * n);
+	uint32_t k = 0;
+	for (uint64_t i = 0; i < 2 * n; i++)
+		if (k == 0 || vert[i] != vert[k - 1])
+			vert[k++] = vert[i];
+
+	/* Union-find over the dense ids */
+	uint32_t *label = tmp;
+	for (uint32_t i = 0; i < k; i++)
+		label[i] = i;
+	for (uint64_t i = 0; i < n; i++)
+		union_nodes_by_index(label, vertex_index(vert, k, EXT_HI(edge[i])),
+		                     vertex_index(vert, k, EXT_LO(edge[i])));
+
+	ExtWriter w;
+	if (writer_open(&w, c))
+		goto out;
+	failed = 0;
+	for (uint32_t i = 0; i < k && !failed; i++)
+		failed = writer_put(&w, EXT_PACK(vert[i], vert[find_root_halving(label, i)]));
+	if (writer_close(&w, failed)) {
+		failed = 1;
+		goto out;
+	}
+	*out = w.fd;
+	*out_n = w.n;
+
+out:
+	free(edge);
+	free(vert);
+	free(tmp);
+	return failed;
+}
+
+/**
+ * @brief Labels the vertices of the edges [begin, begin + n) of fd.
+ *
+ * @param depth Recursion depth
+ * @param out Output: labelling file, sorted by vertex
+ * @param out_n Output: number of labelled vertices
+ * @return 0 on success, 1 on error
+ */
+static int
+ext_label(ExtCtx *c, int fd, uint64_t begin, uint64_t n, unsigned int depth,
+          int *out, uint64_t *out_n)
+{
+	if (depth + 1 > c->stats->levels)
+		c->stats->levels = depth + 1;
+
+	/* Edges, endpoints and their sort buffer: 24 bytes per edge */
+	if (n <= c->mem_records / 3)
+		return ext_label_in_memory(c, fd, begin, n, out, out_n);
+
+	const uint64_t half = n / 2;
+	int l1 = -1, l2 = -1, e2 = -1, s = -1, t = -1;
+	uint64_t l1_n, l2_n, e2_n, t_n;
+	int ret = 1;
+
+	/* Label the first half */
+	if (ext_label(c, fd, begin, half, depth + 1, &l1, &l1_n))
+		goto out;
+
+	/* Contract the second half: relabel one endpoint per sort-and-join */
+	if ((s = ext_sort(c, fd, begin + half, n - half)) < 0 ||
+	    ext_relabel(c, s, n - half, l1, l1_n, 1, &t, &t_n))
+		goto out;
+	ext_close(&s);
+	if ((s = ext_sort(c, t, 0, t_n)) < 0)
+		goto out;
+	ext_close(&t);
+	if (ext_relabel(c, s, t_n, l1, l1_n, 1, &e2, &e2_n))
+		goto out;
+	ext_close(&s);
+
+	/* Nothing left: the second half joined no new components */
+	if (e2_n == 0) {
+		*out = l1;
+		*out_n = l1_n;
+		l1 = -1;
+		ret = 0;
+		goto out;
+	}
+
+	/* Label the contracted edges */
+	if (ext_label(c, e2, 0, e2_n, depth + 1, &l2, &l2_n))
+		goto out;
+	ext_close(&e2);
+
+	/* Compose: (vertex, label) -> (label, vertex) -> (vertex, new label) */
+	if (ext_relabel(c, l1, l1_n, -1, 0, 0, &t, &t_n))
+		goto out;
+	ext_close(&l1);
+	if ((s = ext_sort(c, t, 0, t_n)) < 0)
+		goto out;
+	ext_close(&t);
+	if (ext_relabel(c, s, t_n, l2, l2_n, 0, &t, &t_n))
+		goto out;
+	ext_close(&s);
+	if ((s = ext_sort(c, t, 0, t_n)) < 0)
+		goto out;
+	ext_close(&t);
+
+	/* Add the vertices only the second half touches */
+	if (ext_merge_labels(c, s, t_n, l2, l2_n, out, out_n))
+		goto out;
+	ret = 0;
+
+out:
+	ext_close(&l1);
+	ext_close(&l2);
+	ext_close(&e2);
+	ext_close(&s);
+	ext_close(&t);
+	return ret;
+}
+
+/* ========================================================================== */
+/*                              PUBLIC INTERFACE                              */
+/* ========================================================================== */
+
+/**
+ * @copydoc cc_external()
+ */
+long
+cc_external(const char *path, int bipartite, size_t mem_bytes, ExternalStats *stats)
+{
+	ExternalStats local;
+	if (!stats)
+		stats = &local;
+	memset(stats, 0, sizeof(*stats));
+
+	if (mem_bytes < EXT_MIN_MEMORY) {
+		print_error(__func__, "memory budget below 1 MiB", 0);
+		return -1;
+	}
+
+	const char *tmp_dir = getenv("TMPDIR");
+	ExtCtx c = {
+		.mem_records = mem_bytes / sizeof(uint64_t),
+		.tmp_dir = (tmp_dir && *tmp_dir) ? tmp_dir : "/tmp",
+		.stats = stats
+	};
+
+	CSCBinaryMatrix shape;
+	CSCEdgeStream *in = csc_open_edges(path, &shape);
+	if (!in)
+		return -1;
+
+	shape.bipartite = bipartite;
+	const size_t n = csc_num_vertices(&shape);
+	const size_t off = csc_col_offset(&shape);
+	if (n > UINT32_MAX) {
+		print_error(__func__, "too many vertices for 32-bit labels", 0);
+		csc_close_edges(in);
+		return -1;
+	}
+
+	/* Copy the edges to a temporary list, dropping self-loops */
+	ExtWriter w;
+	if (writer_open(&w, &c)) {
+		csc_close_edges(in);
+		return -1;
+	}
+
+	uint32_t row[EXT_BATCH], col[EXT_BATCH];
+	long got;
+	int failed = 0;
+	while (!failed && (got = csc_read_edges(in, row, col, EXT_BATCH)) != 0) {
+		if (got < 0) {
+			failed = 1;
+			break;
+		}
+		for (long i = 0; i < got && !failed; i++) {
+			uint32_t u = row[i], v = (uint32_t)(off + col[i]);
+			if (u != v)
+				failed = writer_put(&w, EXT_PACK(u, v));
+		}
+	}
+	stats->bytes_read += csc_edges_bytes(in);
+	stats->passes++;
+	csc_close_edges(in);
+	if (writer_close(&w, failed))
+		return -1;
+
+	int edges = w.fd, labels = -1;
+	uint64_t n_labelled = 0;
+	long count = -1;
+
+	if (ext_label(&c, edges, 0, w.n, 0, &labels, &n_labelled))
+		goto out;
+	ext_close(&edges);
+
+	/* Roots label themselves; untouched vertices are singletons */
+	uint64_t *buf = malloc(EXT_BUF_RECORDS * sizeof(uint64_t));
+	if (!buf) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+
+	ExtReader r;
+	reader_init(&r, &c, labels, 0, n_labelled, buf, EXT_BUF_RECORDS);
+	uint64_t x, roots = 0;
+	int st;
+	while ((st = reader_peek(&r, &x)) > 0) {
+		roots += EXT_HI(x) == EXT_LO(x);
+		r.i++;
+	}
+	stats->passes++;
+	free(buf);
+
+	if (st == 0)
+		count = (long)(roots + (n - n_labelled));
+
+out:
+	ext_close(&edges);
+	ext_close(&labels);
+	return count;
+}
@@ -0,0 +1,826 @@
+/**
+ * @file cc_ldd.c
+ * @brief Connected components by low-diameter decomposition and contraction.
+ *
+ * Work-efficient and low-depth, after Shun, Dhulipala and Blelloch:
+ *
+ * 1. Decompose the graph into clusters of low diameter (Miller, Peng and
+ *    Xu). Every vertex v draws a shift d_v from an exponential distribution
+ *    of rate LDD_BETA and, unless it has been reached by then, starts a
+ *    breadth-first search from itself at round floor(d_max - d_v). All
+ *    searches advance one level per round, and each vertex joins the
+ *    cluster of the first search to claim it.
+ * 2. Contract every cluster to one vertex, keeping one copy of each edge
+ *    between clusters (deduplicated in a hash table). Clusters without such
+ *    edges are whole components: they are counted and dropped.
+ * 3. Repeat on the contracted graph until no vertex is left.
+ *
+ * In expectation a decomposition cuts O(beta m) edges and its clusters
+ * have diameter O(log n / beta), so the total work is O(m) and the depth
+ * polylogarithmic whatever the diameter of the input. Long chains and
+ * grids, on which label propagation needs a pass per unit of diameter,
+ * shrink by a constant factor per level instead.
+ *
+ * Every step is a parallel_for() over vertices or frontier entries, so the
+ * algorithm runs on whichever backend this file is compiled for. The
+ * shifts are hashes of the vertex and the level, so runs are reproducible.
+ *
+ * One decomposition, or a single search, also serves as a sampling phase
+ * of cc_compose() (see cc_ldd_sample()).
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connected_components.h"
+#include "cc_primitives.h"
+#include "parallel.h"
+#include "error.h"
+
+#define LDD_BETA        0.2         /* Rate of the exponential shifts */
+#define LDD_GRAIN       2048        /* Vertices per chunk */
+#define LDD_FRONT_GRAIN 256         /* Frontier entries per chunk */
+#define LDD_FLUSH       256         /* Frontier appends buffered per chunk */
+#define LDD_UNSET       UINT32_MAX  /* Cluster of a vertex not reached yet */
+#define LDD_NO_EDGE     UINT64_MAX  /* Empty edge table slot */
+
+/**
+ * @struct LddGraph
+ * @brief Undirected graph as adjacency arrays.
+ */
+typedef struct {
+	size_t n;          /* Number of vertices */
+	size_t *off;       /* Adjacency offsets (n + 1) */
+	uint32_t *adj;     /* Neighbours, each edge stored in both directions */
+} LddGraph;
+
+/**
+ * @struct LddCtx
+ * @brief State shared by the parallel passes of one level.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;   /* Input, while building the first graph */
+	LddGraph *g;                /* Graph being decomposed */
+	LddGraph *out;              /* Contracted graph */
+	size_t *pos;                /* Fill cursor of each adjacency list */
+	unsigned int level;
+
+	/* Decomposition */
+	double *chunk_max;          /* Largest shift of each chunk */
+	double shift_max;
+	size_t n_rounds;
+	size_t *hist;               /* Per-chunk counts of each round, then offsets */
+	uint32_t *order;            /* Vertices sorted by start round */
+	uint32_t *cluster;          /* Centre of the cluster of each vertex */
+	const uint32_t *src;        /* Entries the current pass reads */
+	uint32_t *dst;              /* Frontier the current pass appends to */
+	size_t dst_len;
+
+	/* Contraction */
+	size_t *cdeg;               /* Edges leaving each cluster, by centre */
+	size_t *chunk_count;        /* Cut edges, then kept clusters of each chunk */
+	size_t *chunk_done;         /* Finished clusters of each chunk */
+	uint64_t *table;            /* Edges between clusters, centre pairs */
+	size_t table_mask;          /* Slots - 1 (a power of two) */
+	uint32_t *new_id;           /* Vertex of each kept cluster in the contracted graph */
+	size_t *chunk_sum;          /* Scan scratch */
+	size_t *scan;               /* Array being scanned */
+} LddCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+graph_free(LddGraph *g)
+{
+	if (!g)
+		return;
+	free(g->off);
+	free(g->adj);
+	free(g);
+}
+
+/**
+ * @brief Shift of a vertex at a level, exponentially distributed.
+ */
+static inline double
+vertex_shift(uint32_t v, unsigned int level)
+{
+	uint64_t z = ((uint64_t)level << 32 | v) + 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	z ^= z >> 31;
+
+	/* Uniform in (0, 1), never 0 */
+	const double u = ((double)(z >> 11) + 0.5) * 0x1.0p-53;
+	return -log(u) / LDD_BETA;
+}
+
+static inline uint32_t
+vertex_round(const LddCtx *c, uint32_t v)
+{
+	return (uint32_t)(c->shift_max - vertex_shift(v, c->level));
+}
+
+/**
+ * @brief Appends a buffer to the frontier being built.
+ */
+static inline void
+frontier_flush(LddCtx *c, const uint32_t *buf, size_t len)
+{
+	if (!len)
+		return;
+	size_t at = __atomic_fetch_add(&c->dst_len, len, __ATOMIC_RELAXED);
+	memcpy(c->dst + at, buf, len * sizeof(uint32_t));
+}
+
+/* Scans of size_t arrays: per-chunk sums, then offsets */
+
+static void
+scan_sum(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t sum = 0;
+		for (size_t i = cb; i < ce; i++)
+			sum += c->scan[i];
+		c->chunk_sum[cb / LDD_GRAIN] = sum;
+	}
+}
+
+static void
+scan_apply(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t sum = c->chunk_sum[cb / LDD_GRAIN];
+		for (size_t i = cb; i < ce; i++) {
+			sum += c->scan[i];
+			c->scan[i] = sum;
+		}
+	}
+}
+
+/**
+ * @brief Turns a[1..n] of degrees into adjacency offsets (a[0] = 0).
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+degrees_to_offsets(LddCtx *c, size_t *a, size_t n, unsigned int n_threads)
+{
+	const size_t n_chunks = (n + LDD_GRAIN - 1) / LDD_GRAIN;
+	c->chunk_sum = malloc((n_chunks ? n_chunks : 1) * sizeof(size_t));
+	if (!c->chunk_sum) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	c->scan = a + 1;
+	parallel_for(n, LDD_GRAIN, n_threads, scan_sum, c);
+	size_t total = 0;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		size_t sum = c->chunk_sum[ch];
+		c->chunk_sum[ch] = total;
+		total += sum;
+	}
+	parallel_for(n, LDD_GRAIN, n_threads, scan_apply, c);
+	a[0] = 0;
+
+	free(c->chunk_sum);
+	c->chunk_sum = NULL;
+	return 0;
+}
+
+/**
+ * @brief Allocates the neighbour array and fill cursors of a graph whose
+ * offsets are set.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+graph_alloc_adjacency(LddCtx *c, LddGraph *g)
+{
+	const size_t m = g->off[g->n];
+	g->adj = malloc((m ? m : 1) * sizeof(uint32_t));
+	c->pos = malloc((g->n ? g->n : 1) * sizeof(size_t));
+	if (!g->adj || !c->pos) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+	memcpy(c->pos, g->off, g->n * sizeof(size_t));
+	return 0;
+}
+
+static void
+input_degrees(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	const size_t n = c->out->n, off = csc_col_offset(m);
+	size_t *deg = c->out->off + 1;
+
+	for (size_t j = begin; j < end; j++) {
+		const size_t v = off + j;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1]; k++) {
+			const size_t r = m->row_idx[k];
+			if (r >= n || r == v)
+				continue;
+			__atomic_fetch_add(&deg[r], 1, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&deg[v], 1, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/**
+ * @brief Places both directions of every edge in the adjacency arrays.
+ *
+ * The slots are claimed for a batch of edges before any neighbour is
+ * stored: a locked increment waits for the stores before it to complete,
+ * so interleaving them with the scattered stores would serialise every
+ * cache miss.
+ */
+static void
+input_fill(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	const size_t n = c->out->n, off = csc_col_offset(m);
+	uint32_t *adj = c->out->adj;
+	size_t at[LDD_FLUSH];
+	uint32_t val[LDD_FLUSH];
+	size_t len = 0;
+
+	for (size_t j = begin; j < end; j++) {
+		const size_t v = off + j;
+		for (uint32_t k = m->col_ptr[j]; k < m->col_ptr[j + 1]; k++) {
+			const size_t r = m->row_idx[k];
+			if (r >= n || r == v)
+				continue;
+			at[len] = __atomic_fetch_add(&c->pos[r], 1, __ATOMIC_RELAXED);
+			val[len++] = (uint32_t)v;
+			at[len] = __atomic_fetch_add(&c->pos[v], 1, __ATOMIC_RELAXED);
+			val[len++] = (uint32_t)r;
+			if (len == LDD_FLUSH) {
+				for (size_t i = 0; i < len; i++)
+					adj[at[i]] = val[i];
+				len = 0;
+			}
+		}
+	}
+	for (size_t i = 0; i < len; i++)
+		adj[at[i]] = val[i];
+}
+
+/**
+ * @brief Builds the undirected graph of a matrix, without self-loops.
+ *
+ * Rows outside the vertex range (rectangular inputs) are skipped.
+ */
+static LddGraph *
+graph_from_matrix(LddCtx *c, const CSCBinaryMatrix *m, unsigned int n_threads)
+{
+	LddGraph *g = calloc(1, sizeof(LddGraph));
+	if (!g) {
+		print_error(__func__, "calloc() failed", errno);
+		return NULL;
+	}
+	g->n = csc_num_vertices(m);
+	g->off = calloc(g->n + 1, sizeof(size_t));
+	if (!g->off) {
+		print_error(__func__, "calloc() failed", errno);
+		goto fail;
+	}
+
+	c->m = m;
+	c->out = g;
+	parallel_for(m->ncols, 0, n_threads, input_degrees, c);
+	if (degrees_to_offsets(c, g->off, g->n, n_threads))
+		goto fail;
+	if (graph_alloc_adjacency(c, g))
+		goto fail;
+	parallel_for(m->ncols, 0, n_threads, input_fill, c);
+
+	free(c->pos);
+	c->pos = NULL;
+	c->out = NULL;
+	return g;
+
+fail:
+	free(c->pos);
+	c->pos = NULL;
+	c->out = NULL;
+	graph_free(g);
+	return NULL;
+}
+
+static void
+shift_max(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		double max = 0.0;
+		for (size_t v = cb; v < ce; v++) {
+			const double d = vertex_shift((uint32_t)v, c->level);
+			if (d > max)
+				max = d;
+		}
+		c->chunk_max[cb / LDD_GRAIN] = max;
+	}
+}
+
+static void
+round_count(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t *h = c->hist + (cb / LDD_GRAIN) * c->n_rounds;
+		for (size_t v = cb; v < ce; v++) {
+			h[vertex_round(c, (uint32_t)v)]++;
+			c->cluster[v] = LDD_UNSET;
+		}
+	}
+}
+
+static void
+round_scatter(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t *h = c->hist + (cb / LDD_GRAIN) * c->n_rounds;
+		for (size_t v = cb; v < ce; v++)
+			c->order[h[vertex_round(c, (uint32_t)v)]++] = (uint32_t)v;
+	}
+}
+
+/**
+ * @brief Starts a search from every vertex of the round not reached yet.
+ */
+static void
+start_centres(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	uint32_t buf[LDD_FLUSH];
+	size_t len = 0;
+
+	for (size_t k = begin; k < end; k++) {
+		const uint32_t v = c->src[k];
+		uint32_t expected = LDD_UNSET;
+		if (!__atomic_compare_exchange_n(&c->cluster[v], &expected, v, 0,
+		                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			continue;
+		buf[len++] = v;
+		if (len == LDD_FLUSH) {
+			frontier_flush(c, buf, len);
+			len = 0;
+		}
+	}
+	frontier_flush(c, buf, len);
+}
+
+/**
+ * @brief Advances every search by one level from the frontier.
+ */
+static void
+expand_frontier(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	const LddGraph *g = c->g;
+	uint32_t buf[LDD_FLUSH];
+	size_t len = 0;
+
+	for (size_t k = begin; k < end; k++) {
+		const uint32_t u = c->src[k];
+		const uint32_t centre = c->cluster[u];
+		for (size_t e = g->off[u]; e < g->off[u + 1]; e++) {
+			const uint32_t w = g->adj[e];
+			uint32_t expected = LDD_UNSET;
+			if (__atomic_load_n(&c->cluster[w], __ATOMIC_RELAXED) != LDD_UNSET ||
+			    !__atomic_compare_exchange_n(&c->cluster[w], &expected, centre, 0,
+			                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				continue;
+			buf[len++] = w;
+			if (len == LDD_FLUSH) {
+				frontier_flush(c, buf, len);
+				len = 0;
+			}
+		}
+	}
+	frontier_flush(c, buf, len);
+}
+
+/**
+ * @brief Assigns every vertex of c->g to a cluster (c->cluster).
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+decompose(LddCtx *c, unsigned int n_threads)
+{
+	const size_t n = c->g->n;
+	const size_t n_chunks = (n + LDD_GRAIN - 1) / LDD_GRAIN;
+	uint32_t *front = NULL, *next = NULL;
+	int ret = 1;
+
+	c->chunk_max = malloc(n_chunks * sizeof(double));
+	c->order = malloc(n * sizeof(uint32_t));
+	front = malloc(n * sizeof(uint32_t));
+	next = malloc(n * sizeof(uint32_t));
+	if (!c->chunk_max || !c->order || !front || !next) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+
+	/* Start rounds, sorted by a counting sort, chunk-major per round */
+	parallel_for(n, LDD_GRAIN, n_threads, shift_max, c);
+	c->shift_max = 0.0;
+	for (size_t ch = 0; ch < n_chunks; ch++)
+		if (c->chunk_max[ch] > c->shift_max)
+			c->shift_max = c->chunk_max[ch];
+	c->n_rounds = (size_t)c->shift_max + 1;
+
+	c->hist = calloc(n_chunks * c->n_rounds, sizeof(size_t));
+	size_t *round_start = malloc((c->n_rounds + 1) * sizeof(size_t));
+	if (!c->hist || !round_start) {
+		print_error(__func__, "malloc() failed", errno);
+		free(round_start);
+		goto out;
+	}
+	parallel_for(n, LDD_GRAIN, n_threads, round_count, c);
+
+	size_t at = 0;
+	for (size_t r = 0; r < c->n_rounds; r++) {
+		round_start[r] = at;
+		for (size_t ch = 0; ch < n_chunks; ch++) {
+			size_t count = c->hist[ch * c->n_rounds + r];
+			c->hist[ch * c->n_rounds + r] = at;
+			at += count;
+		}
+	}
+	round_start[c->n_rounds] = at;
+	parallel_for(n, LDD_GRAIN, n_threads, round_scatter, c);
+
+	/* All searches advance one level per round */
+	size_t front_len = 0;
+	for (size_t r = 0; r < c->n_rounds || front_len > 0; r++) {
+		c->dst = front;
+		c->dst_len = front_len;
+		if (r < c->n_rounds) {
+			c->src = c->order + round_start[r];
+			parallel_for(round_start[r + 1] - round_start[r], LDD_FRONT_GRAIN,
+			             n_threads, start_centres, c);
+		}
+		front_len = c->dst_len;
+
+		c->src = front;
+		c->dst = next;
+		c->dst_len = 0;
+		parallel_for(front_len, LDD_FRONT_GRAIN, n_threads, expand_frontier, c);
+
+		uint32_t *tmp = front;
+		front = next;
+		next = tmp;
+		front_len = c->dst_len;
+	}
+	free(round_start);
+	ret = 0;
+
+out:
+	free(c->chunk_max);
+	free(c->hist);
+	free(c->order);
+	free(front);
+	free(next);
+	c->chunk_max = NULL;
+	c->hist = NULL;
+	c->order = NULL;
+	return ret;
+}
+
+static void
+clear_clusters(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->cluster[v] = LDD_UNSET;
+}
+
+/**
+ * @brief Breadth-first search of c->g from one vertex, labelling every
+ * vertex it reaches with the source (c->cluster).
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+search_from(LddCtx *c, uint32_t source, unsigned int n_threads)
+{
+	const size_t n = c->g->n;
+	uint32_t *front = malloc(n * sizeof(uint32_t));
+	uint32_t *next = malloc(n * sizeof(uint32_t));
+	if (!front || !next) {
+		print_error(__func__, "malloc() failed", errno);
+		free(front);
+		free(next);
+		return 1;
+	}
+
+	parallel_for(n, LDD_GRAIN, n_threads, clear_clusters, c);
+	c->cluster[source] = source;
+	front[0] = source;
+
+	for (size_t front_len = 1; front_len > 0; front_len = c->dst_len) {
+		c->src = front;
+		c->dst = next;
+		c->dst_len = 0;
+		parallel_for(front_len, LDD_FRONT_GRAIN, n_threads, expand_frontier, c);
+
+		uint32_t *tmp = front;
+		front = next;
+		next = tmp;
+	}
+
+	free(front);
+	free(next);
+	return 0;
+}
+
+static void
+count_cut(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	const LddGraph *g = c->g;
+
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t cut = 0;
+		for (size_t u = cb; u < ce; u++) {
+			const uint32_t cu = c->cluster[u];
+			for (size_t e = g->off[u]; e < g->off[u + 1]; e++)
+				cut += (c->cluster[g->adj[e]] != cu);
+		}
+		c->chunk_count[cb / LDD_GRAIN] = cut;
+	}
+}
+
+/**
+ * @brief Hash table slot of an edge between clusters.
+ */
+static inline size_t
+edge_slot(uint64_t key, size_t mask)
+{
+	key = (key ^ (key >> 33)) * 0xff51afd7ed558ccdULL;
+	key = (key ^ (key >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+	return (size_t)(key ^ (key >> 33)) & mask;
+}
+
+/**
+ * @brief Inserts every edge between clusters into the table once, counting
+ * the distinct edges leaving each cluster.
+ */
+static void
+insert_cut(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	const LddGraph *g = c->g;
+
+	for (size_t u = begin; u < end; u++) {
+		const uint32_t cu = c->cluster[u];
+		uint32_t last = cu;
+		for (size_t e = g->off[u]; e < g->off[u + 1]; e++) {
+			const uint32_t cw = c->cluster[g->adj[e]];
+			if (cw == cu || cw == last)
+				continue;
+			last = cw;
+
+			const uint64_t key = (uint64_t)cu << 32 | cw;
+			for (size_t i = edge_slot(key, c->table_mask);; i = (i + 1) & c->table_mask) {
+				uint64_t seen = __atomic_load_n(&c->table[i], __ATOMIC_RELAXED);
+				if (seen == LDD_NO_EDGE &&
+				    __atomic_compare_exchange_n(&c->table[i], &seen, key, 0,
+				                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+					__atomic_fetch_add(&c->cdeg[cu], 1, __ATOMIC_RELAXED);
+					break;
+				}
+				if (seen == key)
+					break;
+			}
+		}
+	}
+}
+
+static void
+count_clusters(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t kept = 0, done = 0;
+		for (size_t v = cb; v < ce; v++) {
+			if (c->cluster[v] != v)
+				continue;
+			kept += (c->cdeg[v] != 0);
+			done += (c->cdeg[v] == 0);
+		}
+		c->chunk_count[cb / LDD_GRAIN] = kept;
+		c->chunk_done[cb / LDD_GRAIN] = done;
+	}
+}
+
+static void
+number_clusters(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += LDD_GRAIN) {
+		size_t ce = cb + LDD_GRAIN < end ? cb + LDD_GRAIN : end;
+		size_t id = c->chunk_count[cb / LDD_GRAIN];
+		for (size_t v = cb; v < ce; v++) {
+			if (c->cluster[v] != v || c->cdeg[v] == 0)
+				continue;
+			c->new_id[v] = (uint32_t)id;
+			c->out->off[id + 1] = c->cdeg[v];
+			id++;
+		}
+	}
+}
+
+static void
+contract_edges(void *arg, size_t begin, size_t end)
+{
+	LddCtx *c = arg;
+
+	for (size_t i = begin; i < end; i++) {
+		const uint64_t key = c->table[i];
+		if (key == LDD_NO_EDGE)
+			continue;
+		const uint32_t a = c->new_id[key >> 32];
+		const size_t at = __atomic_fetch_add(&c->pos[a], 1, __ATOMIC_RELAXED);
+		c->out->adj[at] = c->new_id[(uint32_t)key];
+	}
+}
+
+/**
+ * @brief Contracts the clusters of c->g into c->out.
+ *
+ * The edges between clusters go through a hash table, so the contracted
+ * graph has no parallel edges.
+ *
+ * @param finished Output: clusters without outgoing edges
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+contract(LddCtx *c, unsigned int n_threads, size_t *finished)
+{
+	const size_t n = c->g->n;
+	const size_t n_chunks = (n + LDD_GRAIN - 1) / LDD_GRAIN;
+	int ret = 1;
+
+	c->cdeg = calloc(n, sizeof(size_t));
+	c->chunk_count = malloc(n_chunks * sizeof(size_t));
+	c->chunk_done = malloc(n_chunks * sizeof(size_t));
+	c->new_id = malloc(n * sizeof(uint32_t));
+	c->out = calloc(1, sizeof(LddGraph));
+	if (!c->cdeg || !c->chunk_count || !c->chunk_done || !c->new_id || !c->out) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+
+	/* Table of at least 1.5 slots per edge between clusters */
+	parallel_for(n, LDD_GRAIN, n_threads, count_cut, c);
+	size_t cut = 0, slots = 1;
+	for (size_t ch = 0; ch < n_chunks; ch++)
+		cut += c->chunk_count[ch];
+	while (slots < cut + cut / 2)
+		slots <<= 1;
+	c->table = malloc(slots * sizeof(uint64_t));
+	if (!c->table) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+	memset(c->table, 0xff, slots * sizeof(uint64_t));
+	c->table_mask = slots - 1;
+	parallel_for(n, 0, n_threads, insert_cut, c);
+
+	/* Number the clusters that still have edges; the others are done */
+	parallel_for(n, LDD_GRAIN, n_threads, count_clusters, c);
+	*finished = 0;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		size_t kept = c->chunk_count[ch];
+		c->chunk_count[ch] = c->out->n;
+		c->out->n += kept;
+		*finished += c->chunk_done[ch];
+	}
+
+	c->out->off = calloc(c->out->n + 1, sizeof(size_t));
+	if (!c->out->off) {
+		print_error(__func__, "calloc() failed", errno);
+		goto out;
+	}
+	parallel_for(n, LDD_GRAIN, n_threads, number_clusters, c);
+	if (degrees_to_offsets(c, c->out->off, c->out->n, n_threads))
+		goto out;
+	if (graph_alloc_adjacency(c, c->out))
+		goto out;
+	parallel_for(slots, 0, n_threads, contract_edges, c);
+	ret = 0;
+
+out:
+	if (ret) {
+		graph_free(c->out);
+		c->out = NULL;
+	}
+	free(c->pos);
+	free(c->cdeg);
+	free(c->chunk_count);
+	free(c->chunk_done);
+	free(c->new_id);
+	free(c->table);
+	c->pos = NULL;
+	c->cdeg = NULL;
+	c->chunk_count = NULL;
+	c->chunk_done = NULL;
+	c->new_id = NULL;
+	c->table = NULL;
+	return ret;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc cc_ldd()
+ */
+int
+cc_ldd(const CSCBinaryMatrix *matrix, unsigned int n_threads)
+{
+	if (!matrix || csc_num_vertices(matrix) == 0)
+		return 0;
+
+	LddCtx c;
+	memset(&c, 0, sizeof(c));
+	long count = -1;
+
+	CC_PROBE_PHASE_START("ldd");
+	LddGraph *g = graph_from_matrix(&c, matrix, n_threads);
+	if (!g)
+		goto out;
+
+	size_t components = 0;
+	for (c.level = 0; g->n > 0; c.level++) {
+		c.g = g;
+		c.cluster = malloc(g->n * sizeof(uint32_t));
+		if (!c.cluster) {
+			print_error(__func__, "malloc() failed", errno);
+			goto out;
+		}
+
+		size_t finished;
+		if (decompose(&c, n_threads) || contract(&c, n_threads, &finished))
+			goto out;
+		components += finished;
+
+		free(c.cluster);
+		c.cluster = NULL;
+		graph_free(g);
+		g = c.out;
+		c.out = NULL;
+	}
+	count = (long)components;
+
+out:
+	CC_PROBE_PHASE_END("ldd");
+	free(c.cluster);
+	graph_free(g);
+	return (int)count;
+}
+
+/**
+ * @copydoc cc_ldd_sample()
+ */
+int
+cc_ldd_sample(const CSCBinaryMatrix *matrix, unsigned int n_threads,
+              uint32_t source, uint32_t *cluster)
+{
+	LddCtx c;
+	memset(&c, 0, sizeof(c));
+
+	LddGraph *g = graph_from_matrix(&c, matrix, n_threads);
+	if (!g)
+		return -1;
+
+	c.g = g;
+	c.cluster = cluster;
+	int ret = (source < g->n) ? search_from(&c, source, n_threads)
+	                          : decompose(&c, n_threads);
+
+	graph_free(g);
+	return ret ? -1 : 0;
+}
@@ -0,0 +1,348 @@
+/**
+ * @file cc_primitives.h
+ * @brief Specialised union-find kernels and bitmap counting shared by the backends.
+ *
+ * The union-find kernels are generated by macros and specialised at compile
+ * time along four axes, so every backend (and the micro-benchmark suite)
+ * instantiates the combination that suits it instead of keeping its own
+ * hand-edited copy:
+ *
+ * - Index width:   any unsigned integer type (`uint32_t`, `uint64_t`)
+ * - Compression:   `FULL` (two-pass), `HALVING` (point at grandparent, skip
+ *                  to it) or `SPLITTING` (point at grandparent, step to parent)
+ * - Memory order:  `PLAIN` (single-threaded), `RELAXED` or `ACQREL` atomics
+ * - Bounds check:  `CHECKED` skips rows outside [0, n), `UNCHECKED` trusts them
+ *
+ * Example, in a backend source file:
+ *
+ *     CC_DEFINE_FIND(find_root, uint32_t, SPLITTING, RELAXED)
+ *     CC_DEFINE_UNION(union_rem, uint32_t, find_root, RELAXED)
+ *     CC_DEFINE_UNION_EDGES(union_column, uint32_t, union_rem, CHECKED)
+ *
+ * Every specialisation is `static inline` and branches only on compile-time
+ * constants, so each instance compiles down to a single straight-line kernel.
+ *
+ * Label propagation is shared the same way, as a driver over the semiring
+ * SpMV engine in core/spmv.h.
+ */
+
+#ifndef CC_PRIMITIVES_H
+#define CC_PRIMITIVES_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "checkpoint.h"
+#include "matrix.h"
+#include "probe.h"
+#include "spmv.h"
+
+/* ========================================================================== */
+/*                          SPECIALISATION AXES                               */
+/* ========================================================================== */
+
+/* Compression strategies */
+#define CC_COMPRESS_FULL      0
+#define CC_COMPRESS_HALVING   1
+#define CC_COMPRESS_SPLITTING 2
+
+/* Bounds checking of row indices */
+#define CC_BOUNDS_CHECKED   1
+#define CC_BOUNDS_UNCHECKED 0
+
+/* Memory orders: load, store and compare-and-swap of one label */
+#define CC_LOAD_PLAIN(p)          (*(p))
+#define CC_STORE_PLAIN(p, v)      (*(p) = (v))
+#define CC_CAS_PLAIN(p, e, v)     (*(p) == *(e) ? (*(p) = (v), 1) : (*(e) = *(p), 0))
+
+#define CC_LOAD_RELAXED(p)        __atomic_load_n((p), __ATOMIC_RELAXED)
+#define CC_STORE_RELAXED(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define CC_CAS_RELAXED(p, e, v)   __atomic_compare_exchange_n((p), (e), (v), 0, \
+                                  __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+
+#define CC_LOAD_ACQREL(p)         __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define CC_STORE_ACQREL(p, v)     __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define CC_CAS_ACQREL(p, e, v)    __atomic_compare_exchange_n((p), (e), (v), 0, \
+                                  __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+
+#define CC_LOAD(order, p)         CC_LOAD_##order(p)
+#define CC_STORE(order, p, v)     CC_STORE_##order(p, v)
+#define CC_CAS(order, p, e, v)    CC_CAS_##order(p, e, v)
+
+/* ========================================================================== */
+/*                           UNION-FIND KERNELS                               */
+/* ========================================================================== */
+
+/**
+ * @brief Defines `T name(T *label, T x)`, returning the root of x.
+ *
+ * Compression strategies:
+ * - FULL: finds the root, then points every node on the path at it.
+ * - HALVING: points each visited node at its grandparent and jumps there.
+ * - SPLITTING: points each visited node at its grandparent and steps to
+ *   its old parent, so every node on the path is shortened.
+ *
+ * All three only ever replace a non-root's parent by one of its ancestors,
+ * which keeps them safe alongside concurrent CAS links of roots. FULL relies
+ * on every parent being smaller than its child (see CC_DEFINE_UNION()): if
+ * the root found in the first pass is linked under a smaller one meanwhile,
+ * the second pass stops at it instead of pointing the new root back down.
+ *
+ * @param name Function name
+ * @param T Index type
+ * @param strategy FULL, HALVING or SPLITTING
+ * @param order PLAIN, RELAXED or ACQREL
+ */
+#define CC_DEFINE_FIND(name, T, strategy, order)                              \
+static inline T                                                               \
+name(T *label, T x)                                                           \
+{                                                                             \
+	if (CC_COMPRESS_##strategy == CC_COMPRESS_FULL) {                     \
+		T root = x, p;                                                \
+		while ((p = CC_LOAD(order, &label[root])) != root)            \
+			root = p;                                             \
+		while (x > root) {                                            \
+			T next = CC_LOAD(order, &label[x]);                   \
+			if (next <= root)                                     \
+				break;  /* Rest of the path is compressed */  \
+			CC_STORE(order, &label[x], root);                     \
+			x = next;                                             \
+		}                                                             \
+		return root;                                                  \
+	}                                                                     \
+	for (;;) {                                                            \
+		T p = CC_LOAD(order, &label[x]);                              \
+		if (p == x)                                                   \
+			return x;                                             \
+		T gp = CC_LOAD(order, &label[p]);                             \
+		if (gp == p)                                                  \
+			return p;                                             \
+		CC_STORE(order, &label[x], gp);                               \
+		x = (CC_COMPRESS_##strategy == CC_COMPRESS_HALVING) ? gp : p; \
+	}                                                                     \
+}
+
+/**
+ * @brief Defines `int name(T *label, T a, T b)`, uniting the sets of a and b.
+ *
+ * Rem-style union by index: the root with the larger index is linked under
+ * the smaller one with a compare-and-swap, so representatives are always
+ * the minimum node of their component. A failed CAS means another thread
+ * linked that root first; the roots are looked up again and the link is
+ * retried until the sets are merged. Each retry fires the `union__retry`
+ * probe (see probe.h).
+ *
+ * @param name Function name
+ * @param T Index type
+ * @param find Find function defined with CC_DEFINE_FIND() for the same T
+ * @param order PLAIN, RELAXED or ACQREL
+ * @return 1 if this call merged two sets, 0 if they were already merged
+ */
+#define CC_DEFINE_UNION(name, T, find, order)                                 \
+static inline int                                                             \
+name(T *label, T a, T b)                                                      \
+{                                                                             \
+	for (;;) {                                                            \
+		a = find(label, a);                                           \
+		b = find(label, b);                                           \
+		if (a == b)                                                   \
+			return 0;                                             \
+		if (a > b) {  /* Canonical ordering: smaller index as root */ \
+			T temp = a;                                           \
+			a = b;                                                \
+			b = temp;                                             \
+		}                                                             \
+		T expected = b;                                               \
+		if (CC_CAS(order, &label[b], &expected, a))                   \
+			return 1;                                             \
+		CC_PROBE2(union__retry, a, b);                                \
+		b = expected;                                                 \
+	}                                                                     \
+}
+
+/**
+ * @brief Defines `T name(T *label, T n, const uint32_t *row_idx,
+ *                      uint32_t begin, uint32_t end, T col)`.
+ *
+ * Unites column col with every row in row_idx[begin..end), i.e. processes
+ * one CSC column. CHECKED skips rows >= n (rectangular inputs).
+ *
+ * @param name Function name
+ * @param T Index type
+ * @param unite Union function defined with CC_DEFINE_UNION() for the same T
+ * @param bounds CHECKED or UNCHECKED
+ * @return Number of unions that merged two sets
+ */
+#define CC_DEFINE_UNION_EDGES(name, T, unite, bounds)                         \
+static inline T                                                               \
+name(T *label, T n, const uint32_t *row_idx, uint32_t begin, uint32_t end,   \
+     T col)                                                                   \
+{                                                                             \
+	T merged = 0;                                                         \
+	(void)n;                                                              \
+	for (uint32_t j = begin; j < end; j++) {                              \
+		T row = row_idx[j];                                           \
+		if (CC_BOUNDS_##bounds && row >= n)                           \
+			continue;                                             \
+		merged += unite(label, row, col);                             \
+	}                                                                     \
+	return merged;                                                        \
+}
+
+/* ========================================================================== */
+/*                            COMPONENT COUNTING                              */
+/* ========================================================================== */
+
+/**
+ * @brief Counts the distinct values of a label array.
+ *
+ * Sets one bit per label in a bitmap of n bits and counts the set bits
+ * with hardware popcount. Every label must be smaller than n.
+ *
+ * @param label Label array
+ * @param n Number of labels (and upper bound on their values)
+ * @return Number of distinct labels, or -1 on allocation failure
+ */
+static inline int
+count_labels_bitmap(const uint32_t *label, size_t n)
+{
+	size_t bitmap_size = (n + 63) / 64;
+	uint64_t *bitmap = calloc(bitmap_size ? bitmap_size : 1, sizeof(uint64_t));
+	if (!bitmap)
+		return -1;
+
+	/* Bitmap construction: set bit for each unique label */
+	for (size_t i = 0; i < n; i++) {
+		uint32_t val = label[i];
+		bitmap[val >> 6] |= (1ULL << (val & 63));
+	}
+
+	/* Count set bits using hardware popcount */
+	uint32_t count = 0;
+	for (size_t i = 0; i < bitmap_size; i++)
+		count += __builtin_popcountll(bitmap[i]);
+
+	free(bitmap);
+	return (int)count;
+}
+
+/* ========================================================================== */
+/*                            LABEL PROPAGATION                               */
+/* ========================================================================== */
+
+/* Dense sweeps continue while more than n / LP_DENSE_DIVISOR labels change */
+#define LP_DENSE_DIVISOR 16
+
+/**
+ * @brief Labels every vertex with the smallest vertex of its component.
+ *
+ * Labels are relaxed as repeated min-select SpMV over both edge directions,
+ * in place:
+ * 1. Dense push sweeps over every edge while many labels change
+ * 2. One more dense sweep recording the changed labels
+ * 3. Sparse pushes from the labels changed by the previous pass only,
+ *    until none change
+ *
+ * The engine runs on the backend the core was compiled for. Every pass
+ * fires the `lp__iteration` probe and convergence `lp__done` (see probe.h).
+ * If checkpointing is enabled, every pass is offered to the checkpoint
+ * writer and a resumed run starts from the stored labels (see
+ * checkpoint.h).
+ *
+ * @param matrix Sparse CSC binary matrix representing graph
+ * @param n_threads Number of threads for the SpMV kernels
+ * @param label Output: one label per vertex (csc_num_vertices() entries)
+ * @return 0 on success, -1 on error
+ */
+static inline int
+cc_propagate_labels_spmv(const CSCBinaryMatrix *matrix, unsigned int n_threads,
+                         uint32_t *label)
+{
+	SpmvEngine *e = spmv_init(matrix, n_threads);
+	if (!e)
+		return -1;
+
+	const size_t n = spmv_num_vertices(e);
+	SpmvFrontier cur = { NULL, 0 }, next = { NULL, 0 };
+	Checkpoint *ck = NULL;
+	long changed = -1;
+	unsigned long iter = 0;
+	if (spmv_frontier_init(e, &cur) || spmv_frontier_init(e, &next))
+		goto out;
+
+	/* Initialize: each node labeled with its own index, unless resuming */
+	int resumed = checkpoint_begin(matrix, n, label, &iter, &ck);
+	if (resumed < 0)
+		goto out;
+	if (!resumed)
+		for (size_t i = 0; i < n; i++)
+			label[i] = (uint32_t)i;
+
+	CC_PROBE_PHASE_START("lp");
+
+	/* Dense sweeps while many labels change */
+	do {
+		changed = spmv_dense(e, SPMV_MIN_SELECT, SPMV_BOTH, SPMV_PUSH, label, label, NULL);
+		iter++;
+		CC_PROBE3(lp__iteration, iter, changed, 0);
+		checkpoint_offer(ck, label, iter);
+	} while (changed > (long)(n / LP_DENSE_DIVISOR));
+
+	/* Then sparse pushes from the labels changed by the previous pass */
+	if (changed > 0) {
+		changed = spmv_dense(e, SPMV_MIN_SELECT, SPMV_BOTH, SPMV_PUSH, label, label, &cur);
+		iter++;
+		CC_PROBE3(lp__iteration, iter, changed, 0);
+		checkpoint_offer(ck, label, iter);
+	}
+	while (changed > 0) {
+		changed = spmv_sparse(e, SPMV_MIN_SELECT, SPMV_BOTH, label, &cur, label, &next);
+		iter++;
+		CC_PROBE3(lp__iteration, iter, changed, 1);
+		checkpoint_offer(ck, label, iter);
+
+		SpmvFrontier tmp = cur;
+		cur = next;
+		next = tmp;
+	}
+
+	if (changed == 0)
+		CC_PROBE1(lp__done, iter);
+	CC_PROBE_PHASE_END("lp");
+
+out:
+	if (checkpoint_end(ck))
+		changed = -1;
+	spmv_frontier_free(&cur);
+	spmv_frontier_free(&next);
+	spmv_free(e);
+	return changed == 0 ? 0 : -1;
+}
+
+/**
+ * @brief Computes connected components by min-label propagation.
+ *
+ * Runs cc_propagate_labels_spmv() and counts the distinct labels with
+ * count_labels_bitmap().
+ *
+ * @param matrix Sparse CSC binary matrix representing graph
+ * @param n_threads Number of threads for the SpMV kernels
+ * @return Number of connected components, or -1 on error
+ */
+static inline int
+cc_label_propagation_spmv(const CSCBinaryMatrix *matrix, unsigned int n_threads)
+{
+	const size_t n = csc_num_vertices(matrix);
+	uint32_t *label = malloc((n ? n : 1) * sizeof(uint32_t));
+	if (!label)
+		return -1;
+
+	int count = -1;
+	if (cc_propagate_labels_spmv(matrix, n_threads, label) == 0)
+		count = count_labels_bitmap(label, n);
+
+	free(label);
+	return count;
+}
+
+#endif /* CC_PRIMITIVES_H */
@@ -6,15 +6,18 @@
  * components in an undirected graph using Pthreads:
  *
  * - Label Propagation (variant 0): Iterative parallel label propagation
- *   with optimized atomic updates and bitmap-based counting.
+ *   as min-select SpMV on the core engine (core/spmv.h), with bitmap-based
+ *   counting.
  *
  * - Union-Find with Rem's Algorithm (variant 1): Lock-free parallel
- *   union-find using compare-and-swap (CAS) operations and path compression.
+ *   union-find using compare-and-swap (CAS) operations and path compression,
+ *   counting components online from the successful unions.
+ *
+ * Variant 2 is the shared cc_ldd() (see connected_components.h).
  *
  * Key optimizations:
- * - Label propagation: Conditional atomics to reduce contention
  * - Union-find: Dynamic work scheduling with atomic column counter
- * - Both: Large chunks to reduce scheduling overhead
+ * - Large chunks to reduce scheduling overhead
  */
 
 #include <stdlib.h>
@@ -23,97 +26,19 @@
 #include <stdatomic.h>
 
 #include "connected_components.h"
+#include "cc_primitives.h"
 
 /* ========================================================================== */
-/*                           UNION-FIND UTILITIES                             */
+/*                           UNION-FIND KERNELS                               */
 /* ========================================================================== */
 
-/**
- * @brief Finds the root of a node with path compression.
- *
- * Traverses parent pointers until reaching the root, and compresses the
- * path by making all nodes along the path point directly to the root.
- * The early-exit optimization avoids redundant writes if the path is
- * already compressed.
- *
- * @param label Array of parent pointers representing disjoint sets
- * @param x Node index to find the root for
- * @return Root of the set containing x
- */
-static inline uint32_t
-find_compress(uint32_t *label, uint32_t x)
-{
-	uint32_t root = x;
-	
-	/* Find the root */
-	while (label[root] != root)
-		root = label[root];
-	
-	/* Compress the path */
-	while (x != root) {
-		uint32_t next = label[x];
-		if (label[x] == next)
-			break;  /* Already compressed */
-		label[x] = root;
-		x = next;
-	}
-	
-	return root;
-}
+/* Path halving with relaxed atomics; square inputs, so rows are not checked */
+CC_DEFINE_FIND(find_root, uint32_t, HALVING, RELAXED)
+CC_DEFINE_UNION(union_rem, uint32_t, find_root, RELAXED)
+CC_DEFINE_UNION_EDGES(union_column, uint32_t, union_rem, UNCHECKED)
 
-/**
- * @brief Unites two disjoint sets using Rem's algorithm.
- *
- * Implements lock-free parallel union-find using compare-and-swap (CAS)
- * operations. Retries up to MAX_RETRIES times before falling back to a
- * simpler atomic store. Canonical ordering (smaller index as root) ensures
- * deterministic results in parallel execution.
- *
- * @param label Array of parent pointers representing disjoint sets
- * @param a First node
- * @param b Second node
- */
-static inline void
-union_rem(uint32_t *label, uint32_t a, uint32_t b)
-{
-	const int MAX_RETRIES = 10;
-	
-	/* Retry loop with CAS operations */
-	for (int retry = 0; retry < MAX_RETRIES; retry++) {
-		a = find_compress(label, a);
-		b = find_compress(label, b);
-		
-		if (a == b)
-			return;
-		
-		/* Canonical ordering: smaller index as root */
-		if (a > b) {
-			uint32_t temp = a;
-			a = b;
-			b = temp;
-		}
-		
-		uint32_t expected = b;
-		if (__atomic_compare_exchange_n(&label[b], &expected, a,
-		                                0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
-			return;
-		}
-		
-		b = expected;
-	}
-	
-	/* Fallback after maximum retries */
-	a = find_compress(label, a);
-	b = find_compress(label, b);
-	if (a != b) {
-		if (a > b) {
-			uint32_t temp = a;
-			a = b;
-			b = temp;
-		}
-		__atomic_store_n(&label[b], a, __ATOMIC_RELEASE);
-	}
-}
+/* Full compression, for the flatten of cc_labels() */
+CC_DEFINE_FIND(find_compress, uint32_t, FULL, RELAXED)
 
 /* ========================================================================== */
 /*                       UNION-FIND WORKER THREAD                             */
@@ -130,6 +55,7 @@ typedef struct {
 	const CSCBinaryMatrix *matrix; /* Input CSC binary matrix */
 	uint32_t *label;               /* Label array representing disjoint sets */
 	atomic_uint *next_col;         /* Atomic counter for dynamic column scheduling */
+	atomic_uint *unions;           /* Unions that merged two sets, all threads */
 	uint32_t num_cols;             /* Total number of columns in the matrix */
 } union_find_args_t;
 
@@ -138,7 +64,8 @@ typedef struct {
  *
  * Each thread grabs a chunk of columns from the global atomic counter
  * and performs union operations on all edges in those columns using
- * lock-free CAS operations.
+ * lock-free CAS operations. The merging unions of each chunk are added to
+ * the shared total, and the thread stops once it shows a single set.
  *
  * @param arg Pointer to union_find_args_t structure containing arguments
  * @return NULL
@@ -148,8 +75,10 @@ union_find_worker(void *arg)
 {
 	union_find_args_t *args = arg;
 	const uint32_t CHUNK_SIZE = 4096;
+	const uint32_t n = (uint32_t)csc_num_vertices(args->matrix);
+	const uint32_t off = (uint32_t)csc_col_offset(args->matrix);
 	
-	while (1) {
+	while (atomic_load_explicit(args->unions, memory_order_relaxed) < n - 1) {
 		/* Grab next chunk of columns */
 		uint32_t col = atomic_fetch_add(args->next_col, CHUNK_SIZE);
 		if (col >= args->num_cols)
@@ -160,57 +89,45 @@ union_find_worker(void *arg)
 			end_col = args->num_cols;
 		
 		/* Process all edges in this chunk */
-		for (uint32_t c = col; c < end_col; c++) {
-			uint32_t start = args->matrix->col_ptr[c];
-			uint32_t end = args->matrix->col_ptr[c + 1];
-			
-			for (uint32_t j = start; j < end; j++) {
-				uint32_t row = args->matrix->row_idx[j];
-				union_rem(args->label, row, c);
-			}
-		}
+		uint32_t merged = 0;
+		for (uint32_t c = col; c < end_col; c++)
+			merged += union_column(args->label, n, args->matrix->row_idx,
+			                       args->matrix->col_ptr[c], args->matrix->col_ptr[c + 1], off + c);
+		if (merged)
+			atomic_fetch_add_explicit(args->unions, merged, memory_order_relaxed);
 	}
 	
 	return NULL;
 }
 
 /* ========================================================================== */
-/*                       COUNT ROOTS WORKER THREAD                            */
+/*                         FLATTEN WORKER THREAD                              */
 /* ========================================================================== */
 
 /**
- * @struct count_roots_args_t
- * @brief Arguments for counting roots in a subset of the label array.
- *
- * Each thread counts the number of roots in its assigned range.
+ * @struct flatten_args_t
+ * @brief Arguments for flattening a range of the union-find forest.
  */
 typedef struct {
 	uint32_t *label;    /* Label array representing disjoint sets */
 	uint32_t begin;     /* Start index of the range */
 	uint32_t end;       /* End index of the range (exclusive) */
-	uint32_t local;     /* Thread-local count of roots */
-} count_roots_args_t;
+} flatten_args_t;
 
 /**
- * @brief Worker function to count roots in a given range.
+ * @brief Worker function pointing every vertex of a range at its root.
  *
- * Each thread iterates over its assigned slice of the label array and
- * counts how many elements are roots (label[i] == i).
- *
- * @param arg Pointer to count_roots_args_t
+ * @param arg Pointer to flatten_args_t
  * @return NULL
  */
 static void *
-count_roots_worker(void *arg)
+flatten_worker(void *arg)
 {
-	count_roots_args_t *args = arg;
-	uint32_t count = 0;
+	flatten_args_t *args = arg;
 	
 	for (uint32_t i = args->begin; i < args->end; i++)
-		if (args->label[i] == i)
-			count++;
+		find_compress(args->label, i);
 	
-	args->local = count;
 	return NULL;
 }
 
@@ -219,43 +136,44 @@ count_roots_worker(void *arg)
 /* ========================================================================== */
 
 /**
- * @brief Computes connected components using parallel union-find.
+ * @brief Builds the union-find forest of a matrix.
  *
  * Algorithm phases:
  * 1. Initialize each node as its own root
- * 2. Perform parallel union operations on edges using multiple threads
- * 3. Flatten all paths to roots for accurate counting
- * 4. Count roots in parallel using thread-local accumulation
+ * 2. Perform parallel union operations on edges using multiple threads,
+ *    counting the unions that merged two sets
  *
- * @param matrix Sparse CSC binary matrix representing graph
+ * Every successful link removes one set, so the count is n minus the
+ * merges and no flatten or root counting pass is needed. The workers stop
+ * early once a single set remains. Each root is the smallest vertex of
+ * its tree.
+ *
+ * @param matrix Sparse CSC binary matrix representing graph (at least one vertex)
  * @param n_threads Number of Pthreads to use
- * @return Number of connected components, or -1 on error
+ * @param label Output: csc_num_vertices() parent links
+ * @return Number of unions that merged two sets
  */
-static int
-cc_union_find(const CSCBinaryMatrix *matrix, unsigned int n_threads)
+static uint32_t
+uf_unite(const CSCBinaryMatrix *matrix, unsigned int n_threads, uint32_t *label)
 {
-	if (!matrix || matrix->nrows == 0)
-		return 0;
-	
-	const uint32_t n = matrix->nrows;
-	
-	uint32_t *label = malloc(n * sizeof(uint32_t));
-	if (!label)
-		return -1;
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
 	
 	/* Initialize: each node as its own parent */
 	for (uint32_t i = 0; i < n; i++)
 		label[i] = i;
 	
-	/* Process all edges: union connected nodes */
-	atomic_uint next_col;
+	CC_PROBE_PHASE_START("uf_union");
+	/* Process all edges: union connected nodes until one set remains */
+	atomic_uint next_col, unions;
 	atomic_store(&next_col, 0);
+	atomic_store(&unions, 0);
 	
 	pthread_t threads[n_threads];
 	union_find_args_t args = {
 		.matrix = matrix,
 		.label = label,
 		.next_col = &next_col,
+		.unions = &unions,
 		.num_cols = matrix->ncols
 	};
 	
@@ -263,109 +181,37 @@ cc_union_find(const CSCBinaryMatrix *matrix, unsigned int n_threads)
 		pthread_create(&threads[i], NULL, union_find_worker, &args);
 	for (unsigned i = 0; i < n_threads; i++)
 		pthread_join(threads[i], NULL);
+	CC_PROBE_PHASE_END("uf_union");
 	
-	/* Final compression pass: flatten all paths */
-	for (uint32_t i = 0; i < n; i++)
-		find_compress(label, i);
-	
-	/* Count roots (each root represents one component) */
-	uint32_t total = 0;
-	uint32_t chunk = (n + n_threads - 1) / n_threads;
-	count_roots_args_t count_args[n_threads];
-	
-	for (unsigned i = 0; i < n_threads; i++) {
-		count_args[i].label = label;
-		count_args[i].begin = i * chunk;
-		count_args[i].end = (count_args[i].begin + chunk > n ? n : count_args[i].begin + chunk);
-		pthread_create(&threads[i], NULL, count_roots_worker, &count_args[i]);
-	}
-	for (unsigned i = 0; i < n_threads; i++) {
-		pthread_join(threads[i], NULL);
-		total += count_args[i].local;
-	}
-	
-	free(label);
-	return (int)total;
+	return atomic_load(&unions);
 }
 
-/* ========================================================================== */
-/*                   LABEL PROPAGATION WORKER THREAD                          */
-/* ========================================================================== */
-
 /**
- * @struct label_propagation_args_t
- * @brief Arguments for the label propagation worker thread.
- *
- * Each thread processes a subset of columns and updates labels atomically.
- */
-typedef struct {
-	const CSCBinaryMatrix *matrix; /* Input CSC binary matrix */
-	uint32_t *label;               /* Label array */
-	atomic_uint *next_col;         /* Atomic column counter for dynamic scheduling */
-	atomic_uint *global_change;    /* Atomic flag indicating if any label changed */
-} label_propagation_args_t;
-
-/**
- * @brief Worker function for optimized parallel label propagation.
- *
- * Each thread grabs a chunk of columns dynamically, then iterates over all
- * edges in the chunk, updating the labels of connected nodes to the minimum
- * value using conditional atomic stores. Sets a global flag if any label
- * changed.
+ * @brief Computes connected components using parallel union-find.
  *
- * Key optimization: Only performs atomic stores when the value actually
- * changes, dramatically reducing atomic operation overhead and contention.
+ * Counts the components online (see uf_unite()); the forest is discarded
+ * without being flattened.
  *
- * @param arg Pointer to label_propagation_args_t structure
- * @return NULL
+ * @param matrix Sparse CSC binary matrix representing graph
+ * @param n_threads Number of Pthreads to use
+ * @return Number of connected components, or -1 on error
  */
-static void *
-label_propagation_worker(void *arg)
+static int
+cc_union_find(const CSCBinaryMatrix *matrix, unsigned int n_threads)
 {
-	label_propagation_args_t *args = arg;
-	const uint32_t CHUNK_SIZE = 4096;  /* Larger chunks for less overhead */
+	if (!matrix || csc_num_vertices(matrix) == 0)
+		return 0;
 	
-	while (1) {
-		/* Grab next chunk of columns */
-		uint32_t col = atomic_fetch_add(args->next_col, CHUNK_SIZE);
-		if (col >= args->matrix->ncols)
-			break;
-		
-		uint32_t end_col = col + CHUNK_SIZE;
-		if (end_col > args->matrix->ncols)
-			end_col = args->matrix->ncols;
-		
-		uint8_t changed = 0;
-		
-		/* Process all edges in this chunk */
-		for (uint32_t c = col; c < end_col; c++) {
-			for (uint32_t j = args->matrix->col_ptr[c]; j < args->matrix->col_ptr[c + 1]; j++) {
-				uint32_t row = args->matrix->row_idx[j];
-				uint32_t label_col = args->label[c];
-				uint32_t label_row = args->label[row];
-				
-				if (label_col != label_row) {
-					uint32_t min_label = label_col < label_row ? label_col : label_row;
-					
-					/* Conditional atomic stores: only update if value changes */
-					if (label_col > min_label) {
-						__atomic_store_n(&args->label[c], min_label, __ATOMIC_RELAXED);
-						changed = 1;
-					}
-					if (label_row > min_label) {
-						__atomic_store_n(&args->label[row], min_label, __ATOMIC_RELAXED);
-						changed = 1;
-					}
-				}
-			}
-		}
-		
-		/* Update global change flag if any local changes occurred */
-		if (changed)
-			atomic_store(args->global_change, 1);
-	}
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
 	
-	return NULL;
+	uint32_t *label = malloc(n * sizeof(uint32_t));
+	if (!label)
+		return -1;
+	
+	const uint32_t unions = uf_unite(matrix, n_threads, label);
+	
+	free(label);
+	return (int)(n - unions);
 }
 
 /* ========================================================================== */
@@ -373,17 +219,11 @@ label_propagation_worker(void *arg)
 /* ========================================================================== */
 
 /**
- * @brief Computes connected components using optimized parallel label propagation.
+ * @brief Computes connected components using parallel label propagation.
  *
- * Algorithm steps:
- * 1. Initialize each node with its own label
- * 2. Iterate until convergence:
- *    - Each thread updates labels of connected nodes with conditional atomics
- *    - A global atomic flag indicates whether any changes occurred
- * 3. Construct a bitmap of unique labels to count components efficiently
- *
- * Key optimization: Only perform atomic stores when values actually change,
- * which dramatically reduces atomic operation overhead.
+ * Runs the shared min-label propagation driver on the semiring SpMV
+ * engine (see cc_label_propagation_spmv()), whose kernels are compiled
+ * for Pthreads and claim column chunks from an atomic counter.
  *
  * @param matrix Sparse CSC binary matrix representing graph
  * @param n_threads Number of Pthreads to use
@@ -392,60 +232,7 @@ label_propagation_worker(void *arg)
 static int
 cc_label_propagation(const CSCBinaryMatrix *matrix, unsigned int n_threads)
 {
-	const uint32_t n = matrix->nrows;
-	uint32_t *label = malloc(n * sizeof(uint32_t));
-	if (!label)
-		return -1;
-	
-	/* Initialize: each node labeled with its own index */
-	for (uint32_t i = 0; i < n; i++)
-		label[i] = i;
-	
-	/* Iterate until convergence */
-	atomic_uint global_change;
-	
-	do {
-		atomic_store(&global_change, 0);
-		atomic_uint next_col;
-		atomic_store(&next_col, 0);
-		
-		pthread_t threads[n_threads];
-		label_propagation_args_t args = {
-			.matrix = matrix,
-			.label = label,
-			.next_col = &next_col,
-			.global_change = &global_change
-		};
-		
-		for (unsigned i = 0; i < n_threads; i++)
-			pthread_create(&threads[i], NULL, label_propagation_worker, &args);
-		for (unsigned i = 0; i < n_threads; i++)
-			pthread_join(threads[i], NULL);
-		
-	} while (atomic_load(&global_change));
-	
-	/* Count unique components using a bitmap */
-	size_t bitmap_size = (n + 63) / 64;
-	uint64_t *bitmap = calloc(bitmap_size, sizeof(uint64_t));
-	if (!bitmap) {
-		free(label);
-		return -1;
-	}
-	
-	/* Bitmap construction: set bit for each unique label */
-	for (uint32_t i = 0; i < n; i++) {
-		uint32_t val = label[i];
-		bitmap[val >> 6] |= (1ULL << (val & 63));
-	}
-	
-	/* Count set bits using hardware popcount */
-	uint32_t count = 0;
-	for (size_t i = 0; i < bitmap_size; i++)
-		count += __builtin_popcountll(bitmap[i]);
-	
-	free(bitmap);
-	free(label);
-	return count;
+	return cc_label_propagation_spmv(matrix, n_threads);
 }
 
 /* ========================================================================== */
@@ -456,16 +243,16 @@ cc_label_propagation(const CSCBinaryMatrix *matrix, unsigned int n_threads)
  * @brief Computes connected components using Pthreads parallel algorithms.
  *
  * This is the main entry point for Pthreads connected components computation.
- * It dispatches to one of two algorithm implementations based on the variant
- * parameter.
+ * It dispatches to the algorithm selected by the variant parameter.
  *
  * Supported variants:
  *   0: Label propagation
  *   1: Union-find with Rem's algorithm
+ *   2: Low-diameter decomposition (see cc_ldd())
  *
  * @param matrix Sparse binary matrix in CSC format
  * @param n_threads Number of threads to use
- * @param algorithm_variant Algorithm selection (0 or 1)
+ * @param algorithm_variant Algorithm selection (0, 1 or 2)
  * @return Number of connected components, or -1 on error
  */
 int
@@ -478,8 +265,52 @@ cc_pthreads(const CSCBinaryMatrix *matrix,
 		return cc_label_propagation(matrix, n_threads);
 	case 1:
 		return cc_union_find(matrix, n_threads);
+	case 2:
+		return cc_ldd(matrix, n_threads);
 	default:
 		break;
 	}
 	return -1;
 }
+
+/**
+ * @brief Labels every vertex with the smallest vertex of its component.
+ *
+ * Builds the union-find forest (see uf_unite()), then flattens it: every
+ * vertex is pointed at its root, the smallest vertex of its component.
+ * Only label consumers pay for the flatten, which splits the vertices
+ * evenly over the threads.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Number of threads to use
+ * @param label Output: csc_num_vertices() labels
+ * @return 0 on success, -1 on error
+ */
+int
+cc_labels(const CSCBinaryMatrix *matrix,
+          const unsigned int n_threads,
+          uint32_t *label)
+{
+	const uint32_t n = (uint32_t)csc_num_vertices(matrix);
+	if (n == 0)
+		return 0;
+	
+	uf_unite(matrix, n_threads, label);
+	
+	CC_PROBE_PHASE_START("uf_flatten");
+	const uint32_t chunk = (n + n_threads - 1) / n_threads;
+	pthread_t threads[n_threads];
+	flatten_args_t args[n_threads];
+	
+	for (unsigned i = 0; i < n_threads; i++) {
+		args[i].label = label;
+		args[i].begin = i * chunk < n ? i * chunk : n;
+		args[i].end = args[i].begin + chunk < n ? args[i].begin + chunk : n;
+		pthread_create(&threads[i], NULL, flatten_worker, &args[i]);
+	}
+	for (unsigned i = 0; i < n_threads; i++)
+		pthread_join(threads[i], NULL);
+	CC_PROBE_PHASE_END("uf_flatten");
+	
+	return 0;
+}
@@ -6,84 +6,79 @@
  * components in an undirected graph represented as a sparse binary matrix:
  *
  * - Label Propagation (variant 0): Iteratively propagates minimum labels
- *   until convergence with early termination optimization.
+ *   until convergence as min-select SpMV on the core engine (core/spmv.h).
  *
  * - Union-Find (variant 1): Uses disjoint-set data structure with path
  *   halving optimization. Generally faster and more scalable.
  *
- * Both algorithms return the count of unique connected components.
+ * Variant 2 is the shared cc_ldd() (see connected_components.h).
+ *
+ * Each returns the count of unique connected components.
  */
 
 #include <stdlib.h>
 #include <errno.h>
 #include "connected_components.h"
+#include "cc_primitives.h"
 #include "error.h"
 
 /* ========================================================================== */
 /*                           UNION-FIND ALGORITHM                             */
 /* ========================================================================== */
 
-/**
- * @brief Finds the root of a node with path halving optimization.
- *
- * Path halving is a one-pass variant of path compression that makes every
- * node point to its grandparent, effectively halving the path length on
- * each traversal. This provides nearly the same performance as full path
- * compression with less overhead.
- *
- * @param label Array where label[i] is the parent of node i
- * @param i Node to find root for
- * @return Root node (where label[root] == root)
- */
-static inline uint32_t
-find_root_halving(uint32_t *label, uint32_t i)
-{
-	while (label[i] != i) {
-		label[i] = label[label[i]];  /* Path halving: skip one level */
-		i = label[i];
-	}
-	return i;
-}
+/* Path halving and union by index, single-threaded */
+CC_DEFINE_FIND(find_root_halving, uint32_t, HALVING, PLAIN)
+CC_DEFINE_UNION(union_nodes_by_index, uint32_t, find_root_halving, PLAIN)
+
+/* Full compression, for the flatten of cc_labels() */
+CC_DEFINE_FIND(find_compress, uint32_t, FULL, PLAIN)
 
 /**
- * @brief Unites two nodes by attaching their roots.
+ * @brief Builds the union-find forest of a matrix.
  *
- * This performs union-by-index, where the root with the larger index is
- * always attached to the root with the smaller index. This maintains a
- * canonical form where component representatives are always the minimum
- * node index in each component.
+ * Algorithm steps:
+ * 1. Initialize each node as its own parent (singleton sets)
+ * 2. For each edge (i,j), union the sets containing i and j, counting the
+ *    unions that merge two sets
+ * 3. Stop early once everything is merged into one set
  *
- * @param label Array of parent pointers
- * @param i First node
- * @param j Second node
- * @return 1 if union was performed, 0 if nodes already in same set
+ * Every merge removes one set, so the count is n minus the merges and the
+ * trees never need to be flattened or their roots counted. Each root is
+ * the smallest vertex of its tree.
+ *
+ * @param matrix Sparse binary matrix in CSC format representing graph
+ * @param label Output: csc_num_vertices() parent links
+ * @return Number of unions that merged two sets
  */
-static inline int
-union_nodes_by_index(uint32_t *label, uint32_t i, uint32_t j)
+static size_t
+uf_unite(const CSCBinaryMatrix *matrix, uint32_t *label)
 {
-	uint32_t root_i = find_root_halving(label, i);
-	uint32_t root_j = find_root_halving(label, j);
+	const size_t n = csc_num_vertices(matrix);
+	const size_t off = csc_col_offset(matrix);
 	
-	if (root_i == root_j)
-		return 0;
+	/* Initialize: each node is its own parent */
+	for (size_t i = 0; i < n; i++) {
+		label[i] = i;
+	}
 	
-	/* Attach larger index to smaller (maintains canonical form) */
-	if (root_i < root_j) {
-		label[root_j] = root_i;
-	} else {
-		label[root_i] = root_j;
+	CC_PROBE_PHASE_START("uf_union");
+	/* Process all edges until a single set remains */
+	size_t unions = 0;
+	for (size_t i = 0; i < matrix->ncols && n - unions > 1; i++) {
+		for (uint32_t j = matrix->col_ptr[i]; j < matrix->col_ptr[i + 1]; j++) {
+			unions += union_nodes_by_index(label, off + i, matrix->row_idx[j]);
+		}
 	}
-	return 1;
+	CC_PROBE_PHASE_END("uf_union");
+	
+	return unions;
 }
 
 /**
  * @brief Computes connected components using union-find algorithm.
  *
- * Algorithm steps:
- * 1. Initialize each node as its own parent (singleton sets)
- * 2. For each edge (i,j), union the sets containing i and j
- * 3. Perform final path compression to flatten all trees
- * 4. Count nodes that are their own parent (roots = components)
+ * Counts the components online (see uf_unite()); the forest is discarded
+ * without being flattened.
  *
  * @param matrix Sparse binary matrix in CSC format representing graph
  * @return Number of connected components, or -1 on error
@@ -91,39 +86,17 @@ union_nodes_by_index(uint32_t *label, uint32_t i, uint32_t j)
 static int
 cc_union_find(const CSCBinaryMatrix *matrix)
 {
-	uint32_t *label = malloc(matrix->nrows * sizeof(uint32_t));
+	const size_t n = csc_num_vertices(matrix);
+	uint32_t *label = malloc((n ? n : 1) * sizeof(uint32_t));
 	if (!label) {
 		print_error(__func__, "malloc() failed", errno);
 		return -1;
 	}
 	
-	/* Initialize: each node is its own parent */
-	for (size_t i = 0; i < matrix->nrows; i++) {
-		label[i] = i;
-	}
-	
-	/* Process all edges: union connected nodes */
-	for (size_t i = 0; i < matrix->ncols; i++) {
-		for (uint32_t j = matrix->col_ptr[i]; j < matrix->col_ptr[i + 1]; j++) {
-			union_nodes_by_index(label, i, matrix->row_idx[j]);
-		}
-	}
-	
-	/* Final compression pass: flatten all paths for accurate counting */
-	for (size_t i = 0; i < matrix->nrows; i++) {
-		find_root_halving(label, i);
-	}
-	
-	/* Count roots (each root represents one component) */
-	uint32_t unique_count = 0;
-	for (size_t i = 0; i < matrix->nrows; i++) {
-		if (label[i] == i) {
-			unique_count++;
-		}
-	}
+	const size_t unions = uf_unite(matrix, label);
 	
 	free(label);
-	return (int)unique_count;
+	return (int)(n - unions);
 }
 
 /* ========================================================================== */
@@ -131,17 +104,11 @@ cc_union_find(const CSCBinaryMatrix *matrix)
 /* ========================================================================== */
 
 /**
- * @brief Computes connected components using optimized label propagation.
+ * @brief Computes connected components using label propagation.
  *
- * Algorithm steps:
- * 1. Initialize each node with its own index as label
- * 2. Iterate over all edges, propagating minimum labels
- * 3. Use cached column label to reduce redundant reads
- * 4. Repeat until no labels change (convergence)
- * 5. Count unique components using bitmap with hardware popcount
- *
- * Optimization: Cache the column label in the inner loop to avoid
- * redundant memory reads when processing multiple edges in the same column.
+ * Runs the shared min-label propagation driver on the semiring SpMV
+ * engine (see cc_label_propagation_spmv()), whose kernels are compiled
+ * single-threaded with plain loads and stores.
  *
  * @param matrix Sparse binary matrix in CSC format representing graph
  * @return Number of connected components, or -1 on error
@@ -149,71 +116,7 @@ cc_union_find(const CSCBinaryMatrix *matrix)
 static int
 cc_label_propagation(const CSCBinaryMatrix *matrix)
 {
-	uint32_t *label = malloc(sizeof(uint32_t) * matrix->nrows);
-	if (!label) {
-		return -1;
-	}
-	
-	/* Initialize: each node labeled with its own index */
-	for (size_t i = 0; i < matrix->nrows; i++) {
-		label[i] = i;
-	}
-	
-	/* Iterate until convergence */
-	uint8_t finished;
-	do {
-		finished = 1;
-		
-		/* Process all edges, propagating minimum labels */
-		for (size_t i = 0; i < matrix->ncols; i++) {
-			uint32_t col_label = label[i];  /* Cache column label */
-			
-			for (uint32_t j = matrix->col_ptr[i]; j < matrix->col_ptr[i + 1]; j++) {
-				uint32_t row = matrix->row_idx[j];
-				uint32_t row_label = label[row];
-				
-				if (col_label != row_label) {
-					uint32_t min_label = col_label < row_label ? col_label : row_label;
-					
-					/* Update column label if needed (and cache it) */
-					if (col_label > min_label) {
-						label[i] = col_label = min_label;
-						finished = 0;
-					}
-					
-					/* Update row label if needed */
-					if (row_label > min_label) {
-						label[row] = min_label;
-						finished = 0;
-					}
-				}
-			}
-		}
-	} while (!finished);
-	
-	/* Count unique components using a bitmap */
-	size_t bitmap_size = (matrix->nrows + 63) / 64;
-	uint64_t *bitmap = calloc(bitmap_size, sizeof(uint64_t));
-	if (!bitmap) {
-		free(label);
-		return -1;
-	}
-	
-	/* Bitmap construction: set bit for each unique label */
-	for (uint32_t i = 0; i < matrix->nrows; i++) {
-		uint32_t val = label[i];
-		bitmap[val >> 6] |= (1ULL << (val & 63));
-	}
-	
-	/* Count set bits using hardware popcount */
-	uint32_t count = 0;
-	for (size_t i = 0; i < bitmap_size; i++) {
-		count += __builtin_popcountll(bitmap[i]);
-	}
-	
-	free(label);
-	free(bitmap);
-	return (int)count;
+	return cc_label_propagation_spmv(matrix, 1);
 }
 
 /* ========================================================================== */
@@ -224,16 +127,17 @@ cc_label_propagation(const CSCBinaryMatrix *matrix)
  * @brief Computes connected components using sequential algorithms.
  *
  * This is the main entry point for sequential connected components
- * computation. It dispatches to one of two algorithm implementations
- * based on the variant parameter.
+ * computation. It dispatches to the algorithm selected by the variant
+ * parameter.
  *
  * Supported variants:
  *   0: Label propagation
  *   1: Union-find
+ *   2: Low-diameter decomposition (see cc_ldd())
  *
  * @param matrix Sparse binary matrix in CSC format
  * @param n_threads Unused (for API compatibility with parallel versions)
- * @param algorithm_variant Algorithm selection (0 or 1)
+ * @param algorithm_variant Algorithm selection (0, 1 or 2)
  * @return Number of connected components, or -1 on error
  */
 int
@@ -246,8 +150,39 @@ cc_sequential(const CSCBinaryMatrix *matrix,
 		return cc_label_propagation(matrix);
 	case 1:
 		return cc_union_find(matrix);
+	case 2:
+		return cc_ldd(matrix, 1);
 	default:
 		break;
 	}
 	return -1;
 }
+
+/**
+ * @brief Labels every vertex with the smallest vertex of its component.
+ *
+ * Builds the union-find forest (see uf_unite()), then flattens it: every
+ * vertex is pointed at its root, the smallest vertex of its component.
+ * Only label consumers pay for the flatten.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Unused (for API compatibility with parallel versions)
+ * @param label Output: csc_num_vertices() labels
+ * @return 0 on success, -1 on error
+ */
+int
+cc_labels(const CSCBinaryMatrix *matrix,
+          const unsigned int n_threads __attribute__((unused)),
+          uint32_t *label)
+{
+	const size_t n = csc_num_vertices(matrix);
+	
+	uf_unite(matrix, label);
+	
+	CC_PROBE_PHASE_START("uf_flatten");
+	for (size_t i = 0; i < n; i++)
+		find_compress(label, (uint32_t)i);
+	CC_PROBE_PHASE_END("uf_flatten");
+	
+	return 0;
+}
@@ -0,0 +1,467 @@
+/**
+ * @file cc_stream.c
+ * @brief Connected components of an edge stream read from a pipe.
+ *
+ * The input is read once, in blocks of whole lines, by the reader thread
+ * of a LineStream (see linestream.h). While it fills one block, the lines
+ * of the other are split over parallel_for() chunks, parsed and united at
+ * once in a concurrent Rem union-find, so no edge is ever stored:
+ *
+ * - Matrix Market input (`%%MatrixMarket matrix coordinate ...`) declares
+ *   its shape in the header, so the labels are allocated up front and
+ *   every entry (i, j) unites vertices i - 1 and j - 1 (or the column
+ *   vertex, in bipartite mode).
+ * - Edge lists name vertices by arbitrary 64-bit ids. Each new id takes
+ *   the next dense vertex number in a concurrent open-addressing table.
+ *   Before every block the table and the labels grow, outside the
+ *   parallel region, to hold every id the block could add (two per line),
+ *   so workers never have to wait for a resize.
+ *
+ * The components are the vertices left as roots, plus, for Matrix Market
+ * input, the vertices that no entry touches.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connected_components.h"
+#include "cc_primitives.h"
+#include "linestream.h"
+#include "parallel.h"
+#include "error.h"
+
+#define STREAM_BLOCK    (4u << 20)   /* Bytes per block */
+#define STREAM_GRAIN    (64u << 10)  /* Bytes of lines per chunk */
+#define STREAM_EMPTY    UINT64_MAX   /* Free slot of the id table */
+#define STREAM_UNSET    UINT32_MAX   /* Slot claimed, vertex not yet published */
+#define STREAM_NO_ERROR UINT64_MAX
+
+CC_DEFINE_FIND(find_halving, uint32_t, HALVING, RELAXED)
+CC_DEFINE_UNION(union_rem, uint32_t, find_halving, RELAXED)
+
+/**
+ * @struct StreamCtx
+ * @brief State shared by the workers of one streamed run.
+ */
+typedef struct {
+	/* Block being parsed */
+	const char *data;
+	size_t len;
+	uint64_t offset;            /* Input offset of data[0] */
+
+	/* Matrix Market shape */
+	int matrix_market;
+	uint64_t nrows, ncols, nnz;
+	uint32_t col_off;           /* Vertex of column 1 */
+
+	/* Union-find labels */
+	uint32_t *label;
+	size_t n_labels;            /* Allocated labels */
+	size_t n_vertices;          /* Vertices to count at the end */
+
+	/* Edge-list id table */
+	uint64_t *keys;
+	uint32_t *index;
+	size_t mask;                /* Slots - 1 */
+	const uint64_t *old_keys;   /* Table being moved by reserve_ids() */
+	const uint32_t *old_index;
+	uint32_t n_ids;             /* Vertices numbered so far */
+
+	uint64_t entries;           /* Entries united */
+	uint64_t bad;               /* Offset of the first malformed line */
+	size_t roots;
+} StreamCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static inline uint64_t
+mix64(uint64_t z)
+{
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief Parses an unsigned decimal after optional blanks; it must be
+ * followed by a blank or the end of the line.
+ *
+ * @return 1 on success, 0 if there is none or it overflows
+ */
+static inline int
+parse_id(const char **p, uint64_t *out)
+{
+	const char *q = *p;
+	while (*q == ' ' || *q == '\t')
+		q++;
+	if (*q < '0' || *q > '9')
+		return 0;
+
+	uint64_t v = 0;
+	for (; *q >= '0' && *q <= '9'; q++) {
+		const unsigned int d = (unsigned int)(*q - '0');
+		if (v > (UINT64_MAX - d) / 10)
+			return 0;
+		v = v * 10 + d;
+	}
+	if (*q != ' ' && *q != '\t' && *q != '\r' && *q != '\n')
+		return 0;
+
+	*p = q;
+	*out = v;
+	return 1;
+}
+
+static void
+mark_bad(StreamCtx *c, uint64_t offset)
+{
+	uint64_t cur = __atomic_load_n(&c->bad, __ATOMIC_RELAXED);
+	while (offset < cur &&
+	       !__atomic_compare_exchange_n(&c->bad, &cur, offset, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/**
+ * @brief Vertex of an edge-list id, numbering it if it is new.
+ */
+static inline uint32_t
+vertex_of(StreamCtx *c, uint64_t id)
+{
+	for (size_t h = mix64(id) & c->mask;; h = (h + 1) & c->mask) {
+		uint64_t k = __atomic_load_n(&c->keys[h], __ATOMIC_ACQUIRE);
+		if (k == STREAM_EMPTY) {
+			if (__atomic_compare_exchange_n(&c->keys[h], &k, id, 0,
+			                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+				const uint32_t v = __atomic_fetch_add(&c->n_ids, 1, __ATOMIC_RELAXED);
+				__atomic_store_n(&c->index[h], v, __ATOMIC_RELEASE);
+				return v;
+			}
+		}
+		if (k == id) {
+			/* Claimed by another worker, which publishes its vertex next */
+			uint32_t v;
+			while ((v = __atomic_load_n(&c->index[h], __ATOMIC_ACQUIRE)) == STREAM_UNSET);
+			return v;
+		}
+	}
+}
+
+static void
+place_ids(void *arg, size_t begin, size_t end)
+{
+	StreamCtx *c = arg;
+
+	for (size_t s = begin; s < end; s++) {
+		const uint64_t id = c->old_keys[s];
+		if (id == STREAM_EMPTY)
+			continue;
+		for (size_t h = mix64(id) & c->mask;; h = (h + 1) & c->mask) {
+			uint64_t k = STREAM_EMPTY;
+			if (__atomic_compare_exchange_n(&c->keys[h], &k, id, 0,
+			                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				c->index[h] = c->old_index[s];
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Numbers the labels allocated beyond c->n_labels.
+ */
+static void
+init_labels(void *arg, size_t begin, size_t end)
+{
+	StreamCtx *c = arg;
+	for (size_t v = begin > c->n_labels ? begin : c->n_labels; v < end; v++)
+		c->label[v] = (uint32_t)v;
+}
+
+/**
+ * @brief Grows the labels to @p need, keeping those in use.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+grow_labels(StreamCtx *c, size_t need, unsigned int n_threads)
+{
+	if (need <= c->n_labels)
+		return 0;
+	if (need < 2 * c->n_labels)
+		need = 2 * c->n_labels;
+
+	uint32_t *label = realloc(c->label, need * sizeof(uint32_t));
+	if (!label) {
+		print_error(__func__, "realloc() failed", errno);
+		return 1;
+	}
+
+	c->label = label;
+	parallel_for(need, STREAM_GRAIN, n_threads, init_labels, c);
+	c->n_labels = need;
+	return 0;
+}
+
+/**
+ * @brief Makes room for the ids of a block of @p len bytes.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+reserve_ids(StreamCtx *c, const char *data, size_t len, unsigned int n_threads)
+{
+	size_t lines = 0;
+	for (const char *p = data; (p = memchr(p, '\n', len - (size_t)(p - data))); p++)
+		lines++;
+
+	const size_t need = (size_t)c->n_ids + 2 * lines;
+	if (need >= STREAM_UNSET) {
+		print_error(__func__, "too many vertices for 32-bit labels", 0);
+		return 1;
+	}
+	if (grow_labels(c, need, n_threads))
+		return 1;
+
+	/* Keep the table at most half full */
+	size_t slots = c->keys ? c->mask + 1 : 0;
+	if (2 * need <= slots)
+		return 0;
+	while (slots < 2 * need)
+		slots = slots ? 2 * slots : 1024;
+
+	uint64_t *keys = malloc(slots * sizeof(uint64_t));
+	uint32_t *index = malloc(slots * sizeof(uint32_t));
+	if (!keys || !index) {
+		print_error(__func__, "malloc() failed", errno);
+		free(keys);
+		free(index);
+		return 1;
+	}
+	memset(keys, 0xff, slots * sizeof(uint64_t));
+	memset(index, 0xff, slots * sizeof(uint32_t));
+
+	/* Move the numbered ids over */
+	const size_t old_slots = c->keys ? c->mask + 1 : 0;
+	c->old_keys = c->keys;
+	c->old_index = c->index;
+	c->keys = keys;
+	c->index = index;
+	c->mask = slots - 1;
+	if (old_slots)
+		parallel_for(old_slots, STREAM_GRAIN, n_threads, place_ids, c);
+	free((void *)c->old_keys);
+	free((void *)c->old_index);
+	c->old_keys = NULL;
+	c->old_index = NULL;
+	return 0;
+}
+
+/**
+ * @brief Parses and unites the lines that start in bytes [begin, end) of
+ * the block.
+ */
+static void
+unite_lines(void *arg, size_t begin, size_t end)
+{
+	StreamCtx *c = arg;
+	const char *data = c->data;
+	uint64_t entries = 0;
+
+	/* The line under way at begin belongs to the previous chunk */
+	size_t pos = begin;
+	if (pos > 0 && data[pos - 1] != '\n')
+		pos = (size_t)((const char *)memchr(data + pos, '\n', c->len - pos) - data) + 1;
+
+	while (pos < end) {
+		const char *p = data + pos;
+		const size_t line = pos;
+		pos = (size_t)((const char *)memchr(p, '\n', c->len - pos) - data) + 1;
+
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '\n' || *p == '\r' || *p == '#' || *p == '%')
+			continue;
+
+		uint64_t a, b;
+		if (!parse_id(&p, &a) || !parse_id(&p, &b)) {
+			mark_bad(c, c->offset + line);
+			continue;
+		}
+
+		uint32_t u, v;
+		if (c->matrix_market) {
+			if (a < 1 || a > c->nrows || b < 1 || b > c->ncols) {
+				mark_bad(c, c->offset + line);
+				continue;
+			}
+			u = (uint32_t)(a - 1);
+			v = c->col_off + (uint32_t)(b - 1);
+		} else {
+			if (a == STREAM_EMPTY || b == STREAM_EMPTY) {
+				mark_bad(c, c->offset + line);
+				continue;
+			}
+			u = vertex_of(c, a);
+			v = vertex_of(c, b);
+		}
+
+		union_rem(c->label, u, v);
+		entries++;
+	}
+
+	if (entries)
+		__atomic_fetch_add(&c->entries, entries, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Reads the Matrix Market header at the start of the first block.
+ *
+ * @param skip Output: bytes up to the first entry
+ * @return 0 on success, 1 on error
+ */
+static int
+parse_header(StreamCtx *c, const char *data, size_t len, int bipartite, size_t *skip)
+{
+	const char *nl = memchr(data, '\n', len);
+	char banner[256], format[32];
+	size_t n = (size_t)(nl - data) < sizeof(banner) - 1 ? (size_t)(nl - data) : sizeof(banner) - 1;
+	memcpy(banner, data, n);
+	banner[n] = '\0';
+
+	if (sscanf(banner, "%%%%MatrixMarket matrix %31s", format) != 1 ||
+	    strcmp(format, "coordinate") != 0) {
+		print_error(__func__, "only coordinate Matrix Market input can be streamed", 0);
+		return 1;
+	}
+
+	/* Comments, then the size line */
+	for (size_t pos = (size_t)(nl - data) + 1; pos < len;) {
+		const char *p = data + pos;
+		pos = (size_t)((const char *)memchr(p, '\n', len - pos) - data) + 1;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '%' || *p == '\n' || *p == '\r')
+			continue;
+
+		if (!parse_id(&p, &c->nrows) || !parse_id(&p, &c->ncols) || !parse_id(&p, &c->nnz)) {
+			print_error(__func__, "invalid Matrix Market size line", 0);
+			return 1;
+		}
+
+		const uint64_t vertices = bipartite ? c->nrows + c->ncols
+		                                    : (c->nrows > c->ncols ? c->nrows : c->ncols);
+		if (vertices >= STREAM_UNSET) {
+			print_error(__func__, "too many vertices for 32-bit labels", 0);
+			return 1;
+		}
+		c->matrix_market = 1;
+		c->n_vertices = (size_t)vertices;
+		c->col_off = bipartite ? (uint32_t)c->nrows : 0;
+		*skip = pos;
+		return 0;
+	}
+
+	print_error(__func__, "Matrix Market header does not fit in the first block", 0);
+	return 1;
+}
+
+static void
+count_roots(void *arg, size_t begin, size_t end)
+{
+	StreamCtx *c = arg;
+	size_t roots = 0;
+	for (size_t v = begin; v < end; v++)
+		roots += (c->label[v] == v);
+	if (roots)
+		__atomic_fetch_add(&c->roots, roots, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc cc_stream()
+ */
+long
+cc_stream(const char *path, int bipartite, unsigned int n_threads, StreamStats *stats)
+{
+	LineStream *s = line_stream_open(path, STREAM_BLOCK);
+	if (!s)
+		return -1;
+
+	StreamCtx c;
+	memset(&c, 0, sizeof(c));
+	c.bad = STREAM_NO_ERROR;
+
+	long ret = -1;
+	const char *data;
+	uint64_t offset;
+	long len;
+
+	for (int first = 1; (len = line_stream_next(s, &data, &offset)) > 0; first = 0) {
+		size_t skip = 0;
+		if (first && (size_t)len >= 14 && memcmp(data, "%%MatrixMarket", 14) == 0) {
+			if (parse_header(&c, data, (size_t)len, bipartite, &skip) ||
+			    grow_labels(&c, c.n_vertices, n_threads))
+				goto out;
+		} else if (first && bipartite) {
+			print_error(__func__, "edge lists cannot be streamed in bipartite mode", 0);
+			goto out;
+		}
+
+		if (!c.matrix_market && reserve_ids(&c, data, (size_t)len, n_threads))
+			goto out;
+
+		c.data = data + skip;
+		c.len = (size_t)len - skip;
+		c.offset = offset + skip;
+		parallel_for(c.len, STREAM_GRAIN, n_threads, unite_lines, &c);
+
+		if (c.bad != STREAM_NO_ERROR) {
+			char err[96];
+			snprintf(err, sizeof(err), "malformed line at byte %llu of the input",
+			         (unsigned long long)c.bad);
+			print_error(__func__, err, 0);
+			goto out;
+		}
+	}
+	if (len < 0)
+		goto out;
+
+	if (c.matrix_market && c.entries != c.nnz) {
+		char err[128];
+		snprintf(err, sizeof(err), "input ended after %llu of %llu entries",
+		         (unsigned long long)c.entries, (unsigned long long)c.nnz);
+		print_error(__func__, err, 0);
+		goto out;
+	}
+	if (!c.matrix_market) {
+		c.n_vertices = c.n_ids;
+		c.nrows = c.ncols = c.n_ids;
+	}
+
+	parallel_for(c.n_vertices, STREAM_GRAIN, n_threads, count_roots, &c);
+	ret = (long)c.roots;
+
+	if (stats) {
+		stats->nrows = c.nrows;
+		stats->ncols = c.ncols;
+		stats->entries = c.entries;
+		stats->bytes_read = line_stream_bytes(s);
+		stats->matrix_market = c.matrix_market;
+	}
+
+out:
+	line_stream_close(s);
+	free(c.label);
+	free(c.keys);
+	free(c.index);
+	return ret;
+}
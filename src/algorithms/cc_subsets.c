@@ -0,0 +1,184 @@
+/**
+ * @file cc_subsets.c
+ * @brief Connected components of up to 64 edge subsets in one pass.
+ *
+ * Each subset has its own union-find forest over all the vertices, but the
+ * labels are stored vertex-major: the parents of vertex v in the k subsets
+ * are `label[v * k .. v * k + k)`, side by side. The columns are walked
+ * once, and every entry is united in each subset its mask names. All those
+ * unions start from the same two label vectors, one per endpoint, so one
+ * or two cache lines per endpoint serve every subset, and a subset whose
+ * endpoints already share a parent is skipped without a find. Only the
+ * deeper steps of a find leave these lines, since the forests of the
+ * subsets differ. Each subset counts the unions that merged two of its
+ * sets, and its components are the vertices minus its merges.
+ *
+ * Subsets share no state, so the kernels are the relaxed Rem unions with
+ * path halving of the parallel backends, run over columns with
+ * parallel_for(). The labels of a subset are k words apart, which the
+ * CC_DEFINE_FIND() kernels cannot express, so they are spelt out here.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "connected_components.h"
+#include "cc_primitives.h"
+#include "parallel.h"
+#include "error.h"
+
+#define SUBSETS_GRAIN 1024  /* Columns per chunk */
+
+/**
+ * @struct SubsetCtx
+ * @brief State shared by the parallel passes of one run.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;
+	size_t n;                          /* Vertices */
+	unsigned int n_subsets;
+	uint64_t counted;                  /* Mask of the subsets counted */
+	uint32_t *label;                   /* n_subsets labels per vertex, vertex-major */
+	uint64_t unions[CSC_MAX_SUBSETS];  /* Merging unions of each subset */
+} SubsetCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Root of x in the forest whose labels are k words apart, with path
+ * halving (see CC_DEFINE_FIND()).
+ *
+ * @param label Label of vertex 0 in the subset
+ */
+static inline uint32_t
+find_root(uint32_t *label, size_t k, uint32_t x)
+{
+	for (;;) {
+		uint32_t p = CC_LOAD(RELAXED, &label[x * k]);
+		if (p == x)
+			return x;
+		uint32_t gp = CC_LOAD(RELAXED, &label[p * k]);
+		if (gp == p)
+			return p;
+		CC_STORE(RELAXED, &label[x * k], gp);
+		x = gp;
+	}
+}
+
+/**
+ * @brief Rem union of a and b in the forest whose labels are k words apart
+ * (see CC_DEFINE_UNION()).
+ *
+ * @return 1 if this call merged two sets, 0 if they were already merged
+ */
+static inline int
+union_rem(uint32_t *label, size_t k, uint32_t a, uint32_t b)
+{
+	for (;;) {
+		a = find_root(label, k, a);
+		b = find_root(label, k, b);
+		if (a == b)
+			return 0;
+		if (a > b) {
+			uint32_t temp = a;
+			a = b;
+			b = temp;
+		}
+		uint32_t expected = b;
+		if (CC_CAS(RELAXED, &label[b * k], &expected, a))
+			return 1;
+		CC_PROBE2(union__retry, a, b);
+		b = expected;
+	}
+}
+
+static void
+init_labels(void *arg, size_t begin, size_t end)
+{
+	SubsetCtx *c = arg;
+	const size_t k = c->n_subsets;
+	for (size_t v = begin; v < end; v++)
+		for (size_t s = 0; s < k; s++)
+			c->label[v * k + s] = (uint32_t)v;
+}
+
+static void
+union_columns(void *arg, size_t begin, size_t end)
+{
+	SubsetCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	const uint32_t n = (uint32_t)c->n;
+	const uint32_t off = (uint32_t)csc_col_offset(m);
+	const size_t k = c->n_subsets;
+	uint64_t merged[CSC_MAX_SUBSETS] = { 0 };
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t v = off + (uint32_t)j;
+		const uint32_t *lv = c->label + v * k;
+		for (uint32_t e = m->col_ptr[j]; e < m->col_ptr[j + 1]; e++) {
+			const uint32_t r = m->row_idx[e];
+			if (r >= n)
+				continue;
+			const uint32_t *lr = c->label + r * k;
+			for (uint64_t bits = m->edge_mask[e] & c->counted; bits; bits &= bits - 1) {
+				const unsigned int s = (unsigned int)__builtin_ctzll(bits);
+				/* A shared parent means the endpoints are already united */
+				if (CC_LOAD(RELAXED, &lr[s]) == CC_LOAD(RELAXED, &lv[s]))
+					continue;
+				merged[s] += union_rem(c->label + s, k, r, v);
+			}
+		}
+	}
+
+	for (unsigned int s = 0; s < c->n_subsets; s++)
+		if (merged[s])
+			__atomic_fetch_add(&c->unions[s], merged[s], __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc cc_subsets()
+ */
+int
+cc_subsets(const CSCBinaryMatrix *matrix, unsigned int n_threads,
+           unsigned int n_subsets, uint32_t *counts)
+{
+	if (!matrix->edge_mask) {
+		print_error(__func__, "matrix has no edge subsets", 0);
+		return -1;
+	}
+	if (n_subsets == 0 || n_subsets > CSC_MAX_SUBSETS) {
+		print_error(__func__, "between 1 and 64 subsets can be counted", 0);
+		return -1;
+	}
+
+	SubsetCtx c;
+	memset(&c, 0, sizeof(c));
+	c.m = matrix;
+	c.n = csc_num_vertices(matrix);
+	c.n_subsets = n_subsets;
+	c.counted = (n_subsets == CSC_MAX_SUBSETS) ? UINT64_MAX : ((uint64_t)1 << n_subsets) - 1;
+	c.label = malloc((c.n ? c.n * n_subsets : 1) * sizeof(uint32_t));
+	if (!c.label) {
+		print_error(__func__, "malloc() failed", errno);
+		return -1;
+	}
+
+	parallel_for(c.n, 0, n_threads, init_labels, &c);
+
+	CC_PROBE_PHASE_START("subsets");
+	parallel_for(matrix->ncols, SUBSETS_GRAIN, n_threads, union_columns, &c);
+	CC_PROBE_PHASE_END("subsets");
+
+	for (unsigned int s = 0; s < n_subsets; s++)
+		counts[s] = (uint32_t)(c.n - c.unions[s]);
+
+	free(c.label);
+	return 0;
+}
@@ -2,8 +2,13 @@
  * @file connected_components.h
  * @brief Connected components counting algorithms for sparse binary matrices.
  *
- * Provides sequential and parallel implementations of label propagation
- * algorithms to count connected components in a sparse binary matrix (CSC format).
+ * Provides sequential and parallel implementations of connected components
+ * counting on a sparse binary matrix (CSC format), selected by variant:
+ *
+ * - 0: label propagation, implemented by every backend
+ * - 1: union-find, implemented by every backend
+ * - 2: low-diameter decomposition, one implementation shared by all
+ *   backends (see cc_ldd())
  *
  * Implementations:
  * - Sequential
@@ -15,6 +20,8 @@
 #ifndef CONNECTED_COMPONENTS_H
 #define CONNECTED_COMPONENTS_H
 
+#include <stdint.h>
+
 #include "matrix.h"
 
 /**
@@ -23,10 +30,11 @@
  * Supported variants:
  *   0: Label propagation (simple, slower)
  *   1: Union-find (more complex, faster)
+ *   2: Low-diameter decomposition (see cc_ldd())
  *
  * @param matrix Sparse binary matrix in CSC format
  * @param n_threads Unused (for API compatibility with parallel version)
- * @param algorithm_variant Algorithm selection (0 or 1)
+ * @param algorithm_variant Algorithm selection (0, 1 or 2)
  * @return Number of connected components, or -1 on error
  */
 int cc_sequential(const CSCBinaryMatrix *matrix, const unsigned int n_threads, const unsigned int algorithm_variant);
@@ -37,37 +45,222 @@ int cc_sequential(const CSCBinaryMatrix *matrix, const unsigned int n_threads, c
  * Supported variants:
  *   0: Label propagation (simple, slower)
  *   1: Union-find with Rem's algorithm (more complex, faster)
+ *   2: Low-diameter decomposition (see cc_ldd())
  *
- * Both algorithms use OpenMP for parallelization and are designed to
+ * Variants 0 and 1 use OpenMP for parallelization and are designed to
  * scale efficiently across multiple cores.
  *
  * @param matrix Sparse binary matrix in CSC format
  * @param n_threads Number of OpenMP threads to use
- * @param algorithm_variant Algorithm selection (0 or 1)
+ * @param algorithm_variant Algorithm selection (0, 1 or 2)
  * @return Number of connected components, or -1 on error
  */
 int cc_openmp(const CSCBinaryMatrix *matrix, const unsigned int n_threads, const unsigned int algorithm_variant);
 
 /**
- * @brief Count connected components using parallel label propagation with opencilk
+ * @brief Computes connected components using OpenCilk parallel algorithms.
  * @param matrix Input sparse binary matrix in CSC format
  * @param n_threads Number of threads to use
- * @param algorithm_variant Algorithm variant to use:
- *                          - 0: TODO: add variants.
- *                          - 1: TODO: add variants.
+ * @param algorithm_variant Algorithm selection (0, 1 or 2, see above)
  * @return Number of connected components, or -1 on error
  */
 int cc_cilk(const CSCBinaryMatrix *matrix, const unsigned int n_threads, const unsigned int algorithm_variant);
 
 /**
- * @brief Count connected components using parallel label propagation with pthreads
+ * @brief Computes connected components using Pthreads parallel algorithms.
  * @param matrix Input sparse binary matrix in CSC format
  * @param n_threads Number of threads to use
- * @param algorithm_variant Algorithm variant to use:
- *                          - 0: TODO: add variants.
- *                          - 1: TODO: add variants.
+ * @param algorithm_variant Algorithm selection (0, 1 or 2, see above)
  * @return Number of connected components, or -1 on error
  */
 int cc_pthreads(const CSCBinaryMatrix *matrix, const unsigned int n_threads, const unsigned int algorithm_variant);
 
+/**
+ * @brief Computes connected components by low-diameter decomposition.
+ *
+ * Variant 2 of every backend. Repeatedly splits the graph into clusters
+ * of low diameter with exponentially shifted parallel breadth-first
+ * searches and contracts them, which is work-efficient and low-depth
+ * regardless of the graph diameter (see cc_ldd.c). Linked into every
+ * backend and run on its parallel_for().
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @return Number of connected components, or -1 on error
+ */
+int cc_ldd(const CSCBinaryMatrix *matrix, unsigned int n_threads);
+
+/**
+ * @brief Clusters a graph for a sampling phase of cc_compose().
+ *
+ * With @p source below the vertex count, runs one parallel breadth-first
+ * search from it and gives every vertex it reaches @p source as cluster.
+ * Otherwise runs one level of the low-diameter decomposition of cc_ldd()
+ * and gives every vertex the centre of its cluster. Vertices left out get
+ * UINT32_MAX.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @param source Search source, or UINT32_MAX for a decomposition
+ * @param cluster Output: csc_num_vertices() cluster centres
+ * @return 0 on success, -1 on error
+ */
+int cc_ldd_sample(const CSCBinaryMatrix *matrix, unsigned int n_threads,
+                  uint32_t source, uint32_t *cluster);
+
+/**
+ * @enum CCSample
+ * @brief Sampling phases of cc_compose().
+ */
+typedef enum {
+	CC_SAMPLE_NONE = 0,  /**< Every vertex starts alone */
+	CC_SAMPLE_KOUT,      /**< First few edges of every column */
+	CC_SAMPLE_BFS,       /**< Search from the column with the most entries */
+	CC_SAMPLE_LDD,       /**< One low-diameter decomposition level */
+	CC_SAMPLE_COUNT
+} CCSample;
+
+/**
+ * @enum CCFinish
+ * @brief Finish phases of cc_compose().
+ */
+typedef enum {
+	CC_FINISH_REM = 0,   /**< Rem union-find, linking by index */
+	CC_FINISH_RAND,      /**< Union-find linking by random priority */
+	CC_FINISH_LP,        /**< Min-label propagation */
+	CC_FINISH_SV,        /**< Shiloach-Vishkin hooking and shortcutting */
+	CC_FINISH_COUNT
+} CCFinish;
+
+/**
+ * @struct CCComposition
+ * @brief A sampling phase followed by a finish phase.
+ */
+typedef struct {
+	CCSample sample;
+	CCFinish finish;
+} CCComposition;
+
+/**
+ * @brief Parses a composition such as "kout+rem".
+ *
+ * Sampling phases are none, kout, bfs and ldd; finish phases are rem,
+ * rand, lp and sv. A finish phase alone ("sv") samples nothing.
+ *
+ * @return 0 on success, 1 if the string names no composition
+ */
+int cc_compose_parse(const char *spec, CCComposition *comp);
+
+/**
+ * @brief Writes the name of a composition ("sample+finish") to @p buf.
+ */
+void cc_compose_name(CCComposition comp, char *buf, size_t size);
+
+/**
+ * @brief Computes connected components with a composed algorithm.
+ *
+ * The sampling phase links a subset of the edges into a union-find
+ * forest and finds its largest tree; the finish phase then processes the
+ * edges. The union-find and hooking finishes skip the edges with both
+ * ends in that tree (see cc_compose.c). Every phase runs on
+ * parallel_for(), so every combination runs on every backend. Linked into
+ * every backend.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @param comp Phases to run
+ * @return Number of connected components, or -1 on error
+ */
+int cc_compose(const CSCBinaryMatrix *matrix, unsigned int n_threads, CCComposition comp);
+
+/**
+ * @brief Counts the connected components of many edge subsets at once.
+ *
+ * Entry k of the matrix belongs to subset s if bit s of
+ * `matrix->edge_mask[k]` is set. Every subset spans all the vertices, so a
+ * vertex without edges in a subset is a component of it on its own. One
+ * pass over the matrix serves all the subsets, whose union-find labels are
+ * stored side by side per vertex (see cc_subsets.c). Linked into every
+ * backend and run on its parallel_for().
+ *
+ * @param matrix Sparse binary matrix in CSC format, with `edge_mask`
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @param n_subsets Subsets to count (1 to CSC_MAX_SUBSETS): bits 0..n_subsets-1
+ * @param counts Output: components of each subset
+ * @return 0 on success, -1 on error
+ */
+int cc_subsets(const CSCBinaryMatrix *matrix, unsigned int n_threads,
+               unsigned int n_subsets, uint32_t *counts);
+
+/**
+ * @brief Labels every vertex with the smallest vertex of its component.
+ *
+ * Implemented by each backend (only one is linked into a binary), using
+ * its own threading model.
+ *
+ * @param matrix Sparse binary matrix in CSC format
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @param label Output: csc_num_vertices() labels
+ * @return 0 on success, -1 on error
+ */
+int cc_labels(const CSCBinaryMatrix *matrix, const unsigned int n_threads, uint32_t *label);
+
+/**
+ * @struct ExternalStats
+ * @brief I/O accounting of one cc_external() run.
+ */
+typedef struct {
+	uint64_t bytes_read;     /**< Bytes read from the input and temporary files */
+	uint64_t bytes_written;  /**< Bytes written to temporary files */
+	unsigned int passes;     /**< Sequential passes over on-disk data */
+	unsigned int levels;     /**< Depth of the contraction recursion */
+} ExternalStats;
+
+/**
+ * @brief Counts connected components of a matrix file in external memory.
+ *
+ * Streams the entries of a `.csc` or coordinate `.mtx` file from disk and
+ * never holds more than about @p mem_bytes of graph data in memory, so
+ * neither the edges nor the vertices need to fit. Temporary files are
+ * created in `$TMPDIR` (default `/tmp`). Linked into every backend; the
+ * engine itself is sequential.
+ *
+ * @param path Matrix file
+ * @param bipartite Rows and columns are distinct vertices (see matrix.h)
+ * @param mem_bytes Memory budget in bytes
+ * @param stats Output: I/O volume and passes (may be NULL)
+ * @return Number of connected components, or -1 on error
+ */
+long cc_external(const char *path, int bipartite, size_t mem_bytes, ExternalStats *stats);
+
+/**
+ * @struct StreamStats
+ * @brief Shape and volume of one cc_stream() run.
+ */
+typedef struct {
+	uint64_t nrows;          /**< Rows (distinct ids, for edge lists) */
+	uint64_t ncols;          /**< Columns (distinct ids, for edge lists) */
+	uint64_t entries;        /**< Entries or edges read */
+	uint64_t bytes_read;     /**< Bytes read from the input */
+	int matrix_market;       /**< The input was Matrix Market, not an edge list */
+} StreamStats;
+
+/**
+ * @brief Counts connected components of a graph read once from a pipe.
+ *
+ * Reads standard input (`-`) or a named pipe as a coordinate Matrix
+ * Market stream, if it starts with its banner, or as an edge list (see
+ * csc_load_edgelist()). A reader thread fills one block while the workers
+ * parse the lines of the other and unite their endpoints in a concurrent
+ * union-find, so the edges are never stored (see cc_stream.c). Linked
+ * into every backend and run on its parallel_for().
+ *
+ * @param path `-` or the path of a named pipe
+ * @param bipartite Rows and columns are distinct vertices (Matrix Market only)
+ * @param n_threads Number of threads to use (ignored by OpenCilk)
+ * @param stats Output: shape and bytes read (may be NULL)
+ * @return Number of connected components, or -1 on error
+ */
+long cc_stream(const char *path, int bipartite, unsigned int n_threads, StreamStats *stats);
+
 #endif
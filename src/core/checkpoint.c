@@ -0,0 +1,420 @@
+/**
+ * @file checkpoint.c
+ * @brief Label propagation checkpoints in a memory-mapped file.
+ *
+ * The helper thread sleeps on a condition variable until a pass offers
+ * the labels. It then copies them into the mapping, syncs the labels, and
+ * only then records their pass count in the header and syncs it. A run
+ * pre-empted before the first header update therefore starts afresh, and
+ * one pre-empted later resumes from a valid mix of labels (see
+ * checkpoint.h).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "error.h"
+#include "parallel.h"
+#include "reorder.h"
+
+#define CHECKPOINT_MAGIC "CCLPCK02"
+
+/** @brief Words hashed per chunk of the matrix hash. */
+#define HASH_BLOCK ((size_t)1 << 16)
+
+/**
+ * @struct CheckpointHeader
+ * @brief On-disk header of a checkpoint file.
+ */
+typedef struct {
+	char magic[8];         /**< CHECKPOINT_MAGIC */
+	uint64_t nrows;        /**< Shape of the matrix the labels belong to */
+	uint64_t ncols;
+	uint64_t nnz;
+	uint64_t n;            /**< Number of labels */
+	uint64_t iteration;    /**< Passes behind the stored labels; 0 if none stored */
+	uint64_t hash;         /**< Hash of col_ptr and row_idx, as ordered */
+	uint64_t order_seed;   /**< Seed of the edge order; 0 for the file order */
+	uint32_t order;        /**< Edge order (CSCOrder) */
+	uint32_t bipartite;
+} CheckpointHeader;
+
+/**
+ * @brief Block hashes of a word array, filled by parallel_for().
+ */
+typedef struct {
+	const uint32_t *w;
+	size_t n;
+	uint64_t *block;
+} HashCtx;
+
+/**
+ * @brief State of the checkpoints of one run.
+ */
+struct Checkpoint {
+	int fd;
+	void *map;                  /* Header and labels */
+	size_t map_len;
+	CheckpointHeader *hdr;
+	uint32_t *stored;           /* Labels in the mapping */
+	size_t n;
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	const uint32_t *label;      /* Labels to copy (protected by lock) */
+	unsigned long iter;         /* Pass count of the copy in progress */
+	int busy;                   /* A copy is pending or in progress */
+	int stop;                   /* Helper should exit once idle */
+	int failed;                 /* A copy could not be synced */
+	double last;                /* Start of the last copy */
+};
+
+/* Process-wide settings (see checkpoint_configure()) */
+static const char *config_path = NULL;
+static double config_interval = 60.0;
+static int config_resume = 0;
+
+/* Identity of the matrix being propagated (see checkpoint_identify()) */
+static const CSCBinaryMatrix *ident_matrix = NULL;
+static uint64_t ident_hash;
+static uint64_t ident_seed;
+static uint32_t ident_order;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static double
+now_sec(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief FNV-1a over the words of each block in [begin, end).
+ */
+static void
+hash_blocks(void *arg, size_t begin, size_t end)
+{
+	HashCtx *c = arg;
+	for (size_t b = begin; b < end; b++) {
+		const size_t lo = b * HASH_BLOCK;
+		const size_t hi = lo + HASH_BLOCK < c->n ? lo + HASH_BLOCK : c->n;
+		uint64_t h = 0xcbf29ce484222325u;
+		for (size_t i = lo; i < hi; i++)
+			h = (h ^ c->w[i]) * 0x100000001b3u;
+		c->block[b] = h;
+	}
+}
+
+/**
+ * @brief Hashes a word array: blocks in parallel, then their hashes in order.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+hash_words(const uint32_t *w, size_t n, unsigned int n_threads, uint64_t *h)
+{
+	const size_t n_blocks = (n + HASH_BLOCK - 1) / HASH_BLOCK;
+	HashCtx c = { w, n, malloc((n_blocks ? n_blocks : 1) * sizeof(uint64_t)) };
+	if (!c.block) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	parallel_for(n_blocks, 1, n_threads, hash_blocks, &c);
+	for (size_t b = 0; b < n_blocks; b++)
+		*h = (*h ^ c.block[b]) * 0x100000001b3u;
+	*h = (*h ^ n) * 0x100000001b3u;
+
+	free(c.block);
+	return 0;
+}
+
+/**
+ * @brief Copies the labels into the mapping and syncs them, then the header.
+ *
+ * The sweeps keep writing the labels, so they are read one at a time with
+ * relaxed atomic loads.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+write_checkpoint(Checkpoint *ck, const uint32_t *label, unsigned long iter)
+{
+	for (size_t i = 0; i < ck->n; i++)
+		ck->stored[i] = __atomic_load_n(&label[i], __ATOMIC_RELAXED);
+
+	if (msync(ck->map, ck->map_len, MS_SYNC) != 0) {
+		print_error(__func__, "msync() failed", errno);
+		return 1;
+	}
+
+	/* The header goes last: its pass count vouches for the labels */
+	ck->hdr->iteration = iter;
+	if (msync(ck->map, sizeof(CheckpointHeader), MS_SYNC) != 0) {
+		print_error(__func__, "msync() failed", errno);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Helper thread: writes each offered checkpoint until stopped.
+ */
+static void *
+checkpoint_worker(void *arg)
+{
+	Checkpoint *ck = arg;
+
+	pthread_mutex_lock(&ck->lock);
+	for (;;) {
+		while (!ck->busy && !ck->stop)
+			pthread_cond_wait(&ck->cond, &ck->lock);
+		if (!ck->busy)
+			break;
+
+		const uint32_t *label = ck->label;
+		unsigned long iter = ck->iter;
+		pthread_mutex_unlock(&ck->lock);
+
+		int failed = write_checkpoint(ck, label, iter);
+
+		pthread_mutex_lock(&ck->lock);
+		ck->failed |= failed;
+		ck->busy = 0;
+		pthread_cond_broadcast(&ck->cond);
+	}
+	pthread_mutex_unlock(&ck->lock);
+
+	return NULL;
+}
+
+/**
+ * @brief Loads the stored labels if the header matches the matrix.
+ *
+ * @return 1 if loaded, 0 if the file holds no usable labels
+ */
+static int
+load_checkpoint(const Checkpoint *ck, const CheckpointHeader *want,
+                uint32_t *label, unsigned long *iter)
+{
+	const CheckpointHeader *h = ck->hdr;
+
+	if (memcmp(h->magic, CHECKPOINT_MAGIC, sizeof(h->magic)) != 0 ||
+	    h->nrows != want->nrows || h->ncols != want->ncols || h->nnz != want->nnz ||
+	    h->bipartite != want->bipartite || h->n != want->n || h->hash != want->hash ||
+	    h->order != want->order || h->order_seed != want->order_seed || h->iteration == 0)
+		return 0;
+
+	/* Labels only ever decrease from the vertex's own id */
+	for (size_t i = 0; i < ck->n; i++) {
+		if (ck->stored[i] > i)
+			return 0;
+		label[i] = ck->stored[i];
+	}
+
+	*iter = (unsigned long)h->iteration;
+	return 1;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc checkpoint_configure()
+ */
+void
+checkpoint_configure(const char *path, double interval_s, int resume)
+{
+	config_path = path;
+	config_interval = interval_s;
+	config_resume = resume;
+}
+
+/**
+ * @copydoc checkpoint_identify()
+ */
+int
+checkpoint_identify(const CSCBinaryMatrix *m, const char *order, uint64_t seed,
+                    unsigned int n_threads)
+{
+	CSCOrder o = CSC_ORDER_FILE;
+	if (order && csc_order_parse(order, &o))
+		o = CSC_ORDER_FILE;
+
+	uint64_t h = 0xcbf29ce484222325u;
+	if (hash_words(m->col_ptr, m->ncols + 1, n_threads, &h) ||
+	    hash_words(m->row_idx, m->nnz, n_threads, &h))
+		return 1;
+
+	ident_matrix = m;
+	ident_hash = h;
+	ident_order = (uint32_t)o;
+	ident_seed = o == CSC_ORDER_FILE ? 0 : seed;
+	return 0;
+}
+
+/**
+ * @copydoc checkpoint_begin()
+ */
+int
+checkpoint_begin(const CSCBinaryMatrix *m, size_t n, uint32_t *label,
+                 unsigned long *iter, Checkpoint **out)
+{
+	*out = NULL;
+	*iter = 0;
+	if (!config_path)
+		return 0;
+
+	/* Only the first run of the process resumes (the benchmark skips its
+	 * warm-up when resuming, so this is the first timed trial) */
+	const int resume = config_resume;
+	config_resume = 0;
+
+	Checkpoint *ck = calloc(1, sizeof(Checkpoint));
+	if (!ck) {
+		print_error(__func__, "calloc() failed", errno);
+		return -1;
+	}
+	ck->n = n;
+	ck->map_len = sizeof(CheckpointHeader) + n * sizeof(uint32_t);
+
+	ck->fd = open(config_path, O_RDWR | O_CREAT, 0644);
+	if (ck->fd < 0) {
+		print_error(__func__, "failed to open checkpoint file", errno);
+		free(ck);
+		return -1;
+	}
+
+	struct stat st;
+	int fits = fstat(ck->fd, &st) == 0 && (size_t)st.st_size == ck->map_len;
+	if (!fits && ftruncate(ck->fd, (off_t)ck->map_len) != 0) {
+		print_error(__func__, "ftruncate() failed", errno);
+		goto fail;
+	}
+
+	ck->map = mmap(NULL, ck->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, ck->fd, 0);
+	if (ck->map == MAP_FAILED) {
+		print_error(__func__, "mmap() failed", errno);
+		ck->map = NULL;
+		goto fail;
+	}
+	ck->hdr = ck->map;
+	ck->stored = (uint32_t *)(ck->hdr + 1);
+
+	CheckpointHeader want;
+	memset(&want, 0, sizeof(want));
+	memcpy(want.magic, CHECKPOINT_MAGIC, sizeof(want.magic));
+	want.nrows = m->nrows;
+	want.ncols = m->ncols;
+	want.nnz = m->nnz;
+	want.bipartite = m->bipartite ? 1 : 0;
+	want.n = n;
+	if (m == ident_matrix) {
+		want.hash = ident_hash;
+		want.order = ident_order;
+		want.order_seed = ident_seed;
+	}
+
+	int loaded = 0;
+	if (resume) {
+		loaded = fits && load_checkpoint(ck, &want, label, iter);
+		if (!loaded)
+			print_error(__func__, "no matching checkpoint to resume from, starting afresh", 0);
+	}
+
+	/* A fresh run invalidates the old labels before writing new ones */
+	if (!loaded) {
+		*ck->hdr = want;
+		if (msync(ck->map, sizeof(CheckpointHeader), MS_SYNC) != 0) {
+			print_error(__func__, "msync() failed", errno);
+			goto fail;
+		}
+	}
+
+	pthread_mutex_init(&ck->lock, NULL);
+	pthread_cond_init(&ck->cond, NULL);
+	ck->last = now_sec();
+	if (pthread_create(&ck->thread, NULL, checkpoint_worker, ck) != 0) {
+		print_error(__func__, "pthread_create() failed", 0);
+		pthread_mutex_destroy(&ck->lock);
+		pthread_cond_destroy(&ck->cond);
+		goto fail;
+	}
+
+	*out = ck;
+	return loaded;
+
+fail:
+	if (ck->map)
+		munmap(ck->map, ck->map_len);
+	close(ck->fd);
+	free(ck);
+	*iter = 0;
+	return -1;
+}
+
+/**
+ * @copydoc checkpoint_offer()
+ */
+void
+checkpoint_offer(Checkpoint *ck, const uint32_t *label, unsigned long iter)
+{
+	if (!ck)
+		return;
+
+	double now = now_sec();
+	if (now - ck->last < config_interval)
+		return;
+
+	pthread_mutex_lock(&ck->lock);
+	if (!ck->busy) {
+		ck->label = label;
+		ck->iter = iter;
+		ck->busy = 1;
+		ck->last = now;
+		pthread_cond_signal(&ck->cond);
+	}
+	pthread_mutex_unlock(&ck->lock);
+}
+
+/**
+ * @copydoc checkpoint_end()
+ */
+int
+checkpoint_end(Checkpoint *ck)
+{
+	if (!ck)
+		return 0;
+
+	pthread_mutex_lock(&ck->lock);
+	ck->stop = 1;
+	pthread_cond_broadcast(&ck->cond);
+	pthread_mutex_unlock(&ck->lock);
+	pthread_join(ck->thread, NULL);
+
+	int failed = ck->failed;
+	pthread_mutex_destroy(&ck->lock);
+	pthread_cond_destroy(&ck->cond);
+	munmap(ck->map, ck->map_len);
+	close(ck->fd);
+	free(ck);
+	return failed;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file checkpoint.h
+ * @brief Periodic checkpoints of label propagation, for resuming long runs.
+ *
+ * While checkpointing is enabled, label propagation offers its label array
+ * to a helper thread at the end of every pass. At most once per interval,
+ * the helper copies the array into a memory-mapped file and syncs it,
+ * while the sweeps carry on. A later run can resume from the file instead
+ * of starting over.
+ *
+ * The copy is not a consistent snapshot, since the sweeps keep lowering
+ * labels while it is taken. It does not need to be: every label ever held
+ * by a vertex is a vertex of its component no larger than itself, and the
+ * smallest vertex of a component always holds its own id. So any mix of
+ * old and new labels converges to the same components. For the same
+ * reason, a file torn by pre-emption in the middle of a copy is still a
+ * valid starting point.
+ *
+ * Labels only carry over to the exact matrix they were computed on: the
+ * header records its shape, its edge order and seed, and a hash of its
+ * col_ptr and row_idx arrays, and a run resumes only if all of them match.
+ * The same graph under another order numbers the same components
+ * differently, and the labels of another graph of the same shape can join
+ * separate components.
+ *
+ * File layout: an 80-byte header followed by one uint32_t label per vertex,
+ * native-endian.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/** @brief Opaque state of the checkpoints of one run. */
+typedef struct Checkpoint Checkpoint;
+
+/**
+ * @brief Enables checkpointing for the label propagation runs of this process.
+ *
+ * @param path Checkpoint file, created if needed (the string must outlive the runs)
+ * @param interval_s Minimum number of seconds between two checkpoints
+ * @param resume Start the next run from the labels stored in @p path
+ */
+void checkpoint_configure(const char *path, double interval_s, int resume);
+
+/**
+ * @brief Records the identity of the matrix the runs propagate labels over.
+ *
+ * Hashes the matrix on @p n_threads threads, so call it once, after the
+ * edge order is applied and before the timed runs. A run over any other
+ * matrix does not resume.
+ *
+ * @param m Matrix, as ordered for the runs
+ * @param order Name of the edge order applied to @p m, or NULL for none
+ * @param seed Seed of the edge order
+ * @param n_threads Number of threads
+ * @return 0 on success, 1 on error
+ */
+int checkpoint_identify(const CSCBinaryMatrix *m, const char *order, uint64_t seed,
+                        unsigned int n_threads);
+
+/**
+ * @brief Opens the checkpoint file for a run, if checkpointing is enabled.
+ *
+ * When resuming is requested (for the first run of the process only), the
+ * stored labels and pass count are loaded into @p label and @p iter. The
+ * file must have been written for the same matrix, as identified by
+ * checkpoint_identify(). Otherwise the file is reset, and the caller
+ * initialises the labels itself.
+ *
+ * @param m Matrix the labels belong to
+ * @param n Number of labels
+ * @param label Label array; filled when resuming
+ * @param iter Output: pass count of the loaded labels
+ * @param ck Output: checkpoint state, or NULL if checkpointing is disabled
+ * @return 1 if labels were loaded, 0 if the run starts afresh, -1 on error
+ */
+int checkpoint_begin(const CSCBinaryMatrix *m, size_t n, uint32_t *label,
+                     unsigned long *iter, Checkpoint **ck);
+
+/**
+ * @brief Offers the labels after a pass. Never blocks.
+ *
+ * Starts a copy on the helper thread if the interval has elapsed since the
+ * last one and none is in progress. @p label must stay allocated until
+ * checkpoint_end(). Does nothing if @p ck is NULL.
+ *
+ * @param ck Checkpoint state
+ * @param label Label array being propagated
+ * @param iter Number of passes completed
+ */
+void checkpoint_offer(Checkpoint *ck, const uint32_t *label, unsigned long iter);
+
+/**
+ * @brief Waits for a copy in progress, then stops the helper and closes the file.
+ *
+ * Safe to call with NULL.
+ *
+ * @return 0 on success, 1 if a checkpoint could not be written
+ */
+int checkpoint_end(Checkpoint *ck);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,381 @@
+/**
+ * @file edgelist.c
+ * @brief Edge-list loading and vertex id compaction.
+ *
+ * Compaction is a parallel sort-unique over all endpoint ids:
+ * 1. LSD radix sort, one byte per pass, with one histogram per chunk.
+ *    Passes whose byte is the same for every id are skipped, so ids that
+ *    only use their low bits cost fewer passes.
+ * 2. Unique, each chunk counting the ids that differ from their
+ *    predecessor and writing them at its offset of the prefix sum.
+ * 3. Every endpoint replaced by the rank of its id, found by binary search
+ *    in the unique ids.
+ *
+ * The sorted unique ids are the reverse map, so it comes for free.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "edgelist.h"
+#include "parallel.h"
+#include "error.h"
+
+#define EDGELIST_GRAIN 65536                   /* Ids per chunk */
+#define RADIX_BITS     8
+#define RADIX_BUCKETS  (1u << RADIX_BITS)
+
+/**
+ * @struct CompactCtx
+ * @brief State shared by the parallel phases of one compaction.
+ */
+typedef struct {
+	const uint64_t *in;       /* Ids being sorted this pass, then sorted ids */
+	uint64_t *out;            /* Destination of the pass, then unique ids */
+	size_t n;                 /* Number of ids (2 per edge) */
+	size_t grain;             /* Ids per chunk */
+	unsigned int shift;       /* Byte of the current radix pass */
+	size_t *hist;             /* Per-chunk bucket counts, then offsets */
+	size_t *chunk_count;      /* Unique ids per chunk, then offsets */
+
+	const uint64_t *src;      /* Edge endpoints */
+	const uint64_t *dst;
+	size_t n_ids;             /* Number of unique ids */
+	uint32_t *row;            /* Compacted endpoints */
+	uint32_t *col;
+} CompactCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+radix_count(void *arg, size_t begin, size_t end)
+{
+	CompactCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		size_t *h = c->hist + (cb / c->grain) * RADIX_BUCKETS;
+		for (size_t i = cb; i < ce; i++)
+			h[(c->in[i] >> c->shift) & (RADIX_BUCKETS - 1)]++;
+	}
+}
+
+static void
+radix_scatter(void *arg, size_t begin, size_t end)
+{
+	CompactCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		size_t *h = c->hist + (cb / c->grain) * RADIX_BUCKETS;
+		for (size_t i = cb; i < ce; i++)
+			c->out[h[(c->in[i] >> c->shift) & (RADIX_BUCKETS - 1)]++] = c->in[i];
+	}
+}
+
+static void
+count_unique(void *arg, size_t begin, size_t end)
+{
+	CompactCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		size_t count = 0;
+		for (size_t i = cb; i < ce; i++)
+			count += (i == 0 || c->in[i] != c->in[i - 1]);
+		c->chunk_count[cb / c->grain] = count;
+	}
+}
+
+static void
+write_unique(void *arg, size_t begin, size_t end)
+{
+	CompactCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		size_t pos = c->chunk_count[cb / c->grain];
+		for (size_t i = cb; i < ce; i++)
+			if (i == 0 || c->in[i] != c->in[i - 1])
+				c->out[pos++] = c->in[i];
+	}
+}
+
+/**
+ * @brief Rank of an id among the unique ids (which must contain it).
+ */
+static inline uint32_t
+id_rank(const CompactCtx *c, uint64_t id)
+{
+	size_t lo = 0, hi = c->n_ids;
+	while (hi - lo > 1) {
+		size_t mid = lo + (hi - lo) / 2;
+		if (c->out[mid] <= id)
+			lo = mid;
+		else
+			hi = mid;
+	}
+	return (uint32_t)lo;
+}
+
+static void
+map_edges(void *arg, size_t begin, size_t end)
+{
+	CompactCtx *c = arg;
+	for (size_t k = begin; k < end; k++) {
+		c->row[k] = id_rank(c, c->src[k]);
+		c->col[k] = id_rank(c, c->dst[k]);
+	}
+}
+
+/**
+ * @brief Sorts c->n ids from keys, using tmp as the second buffer.
+ *
+ * @return The buffer holding the sorted ids
+ */
+static uint64_t *
+radix_sort(CompactCtx *c, uint64_t *keys, uint64_t *tmp, unsigned int n_threads)
+{
+	const size_t n_chunks = (c->n + c->grain - 1) / c->grain;
+
+	for (unsigned int shift = 0; shift < 64; shift += RADIX_BITS) {
+		c->in = keys;
+		c->out = tmp;
+		c->shift = shift;
+		memset(c->hist, 0, n_chunks * RADIX_BUCKETS * sizeof(size_t));
+		parallel_for(c->n, c->grain, n_threads, radix_count, c);
+
+		/* Exclusive scan, bucket-major, so each chunk scatters in order */
+		size_t pos = 0;
+		int skip = 0;
+		for (size_t b = 0; b < RADIX_BUCKETS && !skip; b++) {
+			const size_t start = pos;
+			for (size_t ch = 0; ch < n_chunks; ch++) {
+				size_t count = c->hist[ch * RADIX_BUCKETS + b];
+				c->hist[ch * RADIX_BUCKETS + b] = pos;
+				pos += count;
+			}
+			skip = (pos - start == c->n);
+		}
+		if (skip)
+			continue;
+
+		parallel_for(c->n, c->grain, n_threads, radix_scatter, c);
+		uint64_t *swap = keys;
+		keys = tmp;
+		tmp = swap;
+	}
+
+	return keys;
+}
+
+/**
+ * @brief Parses an edge list, with a subset mask per edge if @p masked.
+ */
+static CSCBinaryMatrix *
+load_edgelist(const char *path, unsigned int n_threads, int masked)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		print_error(__func__, "failed to open edge list", errno);
+		return NULL;
+	}
+
+	uint64_t *src = NULL, *dst = NULL, *mask = NULL;
+	size_t n_edges = 0, cap = 0, lineno = 0;
+	CSCBinaryMatrix *m = NULL;
+	char *line = NULL;
+	size_t line_cap = 0;
+
+	while (getline(&line, &line_cap, f) != -1) {
+		lineno++;
+
+		char *p = line;
+		while (isspace((unsigned char)*p))
+			p++;
+		if (*p == '\0' || *p == '#' || *p == '%')
+			continue;
+
+		/* Two ids, then the mask (any base) if masked */
+		uint64_t id[3];
+		for (int k = 0; k < 2 + masked; k++) {
+			while (*p == ' ' || *p == '\t')
+				p++;
+			char *endp;
+			errno = 0;
+			id[k] = strtoull(p, &endp, k < 2 ? 10 : 0);
+			if (!isdigit((unsigned char)*p) || endp == p || errno == ERANGE) {
+				char err[128];
+				snprintf(err, sizeof(err), "bad %s on line %zu",
+				         k < 2 ? "edge" : "subset mask", lineno);
+				print_error(__func__, err, 0);
+				goto out;
+			}
+			p = endp;
+		}
+
+		if (n_edges == cap) {
+			cap = cap ? 2 * cap : 1024;
+			uint64_t *s = realloc(src, cap * sizeof(uint64_t));
+			if (s)
+				src = s;
+			uint64_t *d = s ? realloc(dst, cap * sizeof(uint64_t)) : NULL;
+			if (d)
+				dst = d;
+			uint64_t *b = (d && masked) ? realloc(mask, cap * sizeof(uint64_t)) : NULL;
+			if (!d || (masked && !b)) {
+				print_error(__func__, "realloc() failed", errno);
+				goto out;
+			}
+			if (masked)
+				mask = b;
+		}
+		src[n_edges] = id[0];
+		dst[n_edges] = id[1];
+		if (masked)
+			mask[n_edges] = id[2];
+		n_edges++;
+	}
+
+	if (ferror(f)) {
+		print_error(__func__, "failed to read edge list", errno);
+		goto out;
+	}
+
+	m = csc_compact_edges(src, dst, mask, n_edges, n_threads);
+
+out:
+	fclose(f);
+	free(line);
+	free(src);
+	free(dst);
+	free(mask);
+	return m;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc csc_compact_edges()
+ */
+CSCBinaryMatrix *
+csc_compact_edges(const uint64_t *src, const uint64_t *dst, const uint64_t *mask,
+                  size_t n_edges, unsigned int n_threads)
+{
+	if (n_edges > UINT32_MAX) {
+		print_error(__func__, "too many edges for 32-bit column pointers", 0);
+		return NULL;
+	}
+
+	CompactCtx c;
+	memset(&c, 0, sizeof(c));
+	c.n = 2 * n_edges;
+	c.grain = EDGELIST_GRAIN;
+	c.src = src;
+	c.dst = dst;
+
+	const size_t n_chunks = c.n ? (c.n + c.grain - 1) / c.grain : 1;
+	const size_t n_keys = c.n ? c.n : 1;
+	CSCBinaryMatrix *m = NULL;
+	uint64_t *keys = malloc(n_keys * sizeof(uint64_t));
+	uint64_t *tmp = malloc(n_keys * sizeof(uint64_t));
+	c.hist = malloc(n_chunks * RADIX_BUCKETS * sizeof(size_t));
+	c.chunk_count = calloc(n_chunks, sizeof(size_t));
+	c.row = malloc((n_edges ? n_edges : 1) * sizeof(uint32_t));
+	c.col = malloc((n_edges ? n_edges : 1) * sizeof(uint32_t));
+	if (!keys || !tmp || !c.hist || !c.chunk_count || !c.row || !c.col) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+
+	/* Sort-unique every endpoint id */
+	memcpy(keys, src, n_edges * sizeof(uint64_t));
+	memcpy(keys + n_edges, dst, n_edges * sizeof(uint64_t));
+	uint64_t *sorted = radix_sort(&c, keys, tmp, n_threads);
+	uint64_t *unique = (sorted == keys) ? tmp : keys;
+
+	c.in = sorted;
+	c.out = unique;
+	parallel_for(c.n, c.grain, n_threads, count_unique, &c);
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		size_t count = c.chunk_count[ch];
+		c.chunk_count[ch] = c.n_ids;
+		c.n_ids += count;
+	}
+	if (c.n_ids > UINT32_MAX) {
+		print_error(__func__, "too many vertices for 32-bit labels", 0);
+		goto out;
+	}
+	parallel_for(c.n, c.grain, n_threads, write_unique, &c);
+
+	/* Endpoints to ranks */
+	parallel_for(n_edges, 0, n_threads, map_edges, &c);
+
+	m = calloc(1, sizeof(CSCBinaryMatrix));
+	if (!m) {
+		print_error(__func__, "calloc() failed", errno);
+		goto out;
+	}
+	m->nrows = c.n_ids;
+	m->ncols = c.n_ids;
+	m->nnz = n_edges;
+	m->row_idx = malloc((n_edges ? n_edges : 1) * sizeof(uint32_t));
+	m->col_ptr = calloc(c.n_ids + 1, sizeof(uint32_t));
+	m->vertex_ids = malloc((c.n_ids ? c.n_ids : 1) * sizeof(uint64_t));
+	if (mask)
+		m->edge_mask = malloc((n_edges ? n_edges : 1) * sizeof(uint64_t));
+	if (!m->row_idx || !m->col_ptr || !m->vertex_ids || (mask && !m->edge_mask)) {
+		print_error(__func__, "malloc() failed", errno);
+		csc_free_matrix(m);
+		m = NULL;
+		goto out;
+	}
+	memcpy(m->vertex_ids, unique, c.n_ids * sizeof(uint64_t));
+
+	/* COO to CSC: count per column, scan, place, then shift the pointers back */
+	for (size_t k = 0; k < n_edges; k++)
+		m->col_ptr[c.col[k] + 1]++;
+	for (size_t j = 0; j < c.n_ids; j++)
+		m->col_ptr[j + 1] += m->col_ptr[j];
+	for (size_t k = 0; k < n_edges; k++) {
+		const uint32_t at = m->col_ptr[c.col[k]]++;
+		m->row_idx[at] = c.row[k];
+		if (mask)
+			m->edge_mask[at] = mask[k];
+	}
+	for (size_t j = c.n_ids; j > 0; j--)
+		m->col_ptr[j] = m->col_ptr[j - 1];
+	m->col_ptr[0] = 0;
+
+out:
+	free(keys);
+	free(tmp);
+	free(c.hist);
+	free(c.chunk_count);
+	free(c.row);
+	free(c.col);
+	return m;
+}
+
+/**
+ * @copydoc csc_load_edgelist()
+ */
+CSCBinaryMatrix *
+csc_load_edgelist(const char *path, unsigned int n_threads)
+{
+	return load_edgelist(path, n_threads, 0);
+}
+
+/**
+ * @copydoc csc_load_edgelist_masked()
+ */
+CSCBinaryMatrix *
+csc_load_edgelist_masked(const char *path, unsigned int n_threads)
+{
+	return load_edgelist(path, n_threads, 1);
+}
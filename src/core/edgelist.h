@@ -0,0 +1,69 @@
+/**
+ * @file edgelist.h
+ * @brief Edge-list input with compaction of sparse 64-bit vertex ids.
+ *
+ * Raw edge lists name their vertices by arbitrary 64-bit ids, spread over
+ * a space far larger than the number of vertices actually present. Loading
+ * them as is would size the matrix, and every label array, by the largest
+ * id. Instead the ids are compacted to 0..n-1 in ascending order by a
+ * parallel sort-unique, and the original id of every vertex is kept in
+ * CSCBinaryMatrix.vertex_ids for output.
+ */
+
+#ifndef EDGELIST_H
+#define EDGELIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * @brief Builds a matrix from edges between sparse 64-bit vertex ids.
+ *
+ * Every distinct id among the endpoints becomes a vertex, numbered by rank,
+ * and every edge (u, v) the entry at row u and column v. The result is a
+ * square adjacency matrix whose `vertex_ids` maps each vertex back to its
+ * id. Duplicate edges are kept. If @p mask is given, the subset mask of
+ * every edge is carried to `edge_mask`, aligned with its entry.
+ *
+ * @param src Source id of every edge
+ * @param dst Destination id of every edge
+ * @param mask Subset mask of every edge, or NULL
+ * @param n_edges Number of edges
+ * @param n_threads Number of threads
+ * @return Newly allocated matrix, or NULL on error (including more than
+ *         UINT32_MAX vertices or edges)
+ */
+CSCBinaryMatrix *csc_compact_edges(const uint64_t *src, const uint64_t *dst,
+                                   const uint64_t *mask, size_t n_edges,
+                                   unsigned int n_threads);
+
+/**
+ * @brief Loads a text edge list with sparse vertex ids.
+ *
+ * One edge per line, as two unsigned 64-bit ids separated by whitespace;
+ * anything after them (e.g. a weight) is ignored, as are blank lines and
+ * lines starting with `#` or `%`.
+ *
+ * @param path Path to the edge list (conventionally ending in ".el")
+ * @param n_threads Number of threads used for compaction
+ * @return Newly allocated matrix (see csc_compact_edges()), or NULL on error
+ */
+CSCBinaryMatrix *csc_load_edgelist(const char *path, unsigned int n_threads);
+
+/**
+ * @brief Loads a text edge list whose edges belong to edge subsets.
+ *
+ * As csc_load_edgelist(), but every edge needs a third field: its subset
+ * mask, a 64-bit integer (decimal, or hexadecimal with `0x`) whose bit s
+ * is set if the edge belongs to subset s. The masks are returned in
+ * `edge_mask`.
+ *
+ * @param path Path to the edge list
+ * @param n_threads Number of threads used for compaction
+ * @return Newly allocated matrix, or NULL on error
+ */
+CSCBinaryMatrix *csc_load_edgelist_masked(const char *path, unsigned int n_threads);
+
+#endif /* EDGELIST_H */
@@ -0,0 +1,283 @@
+/**
+ * @file linestream.c
+ * @brief Double-buffered reading of text from pipes and standard input.
+ *
+ * The helper thread fills the two blocks in turn, each as far as the input
+ * allows, and cuts it after its last newline; the rest is copied to the
+ * start of the next block. It waits whenever the block it would fill next
+ * is still held by the caller, so reading one block overlaps parsing the
+ * other and memory stays at two blocks whatever the input size.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "linestream.h"
+#include "error.h"
+
+/**
+ * @brief State of one stream, shared with its reader thread.
+ */
+struct LineStream {
+	int fd;
+	int own_fd;                 /* Close fd on exit (not standard input) */
+	size_t cap;                 /* Bytes per block */
+	char *block[2];             /* cap + 1 bytes, for a final newline */
+	size_t len[2];              /* Bytes of whole lines in each block */
+	uint64_t start[2];          /* Input offset of each block */
+	char *carry;                /* Partial line left by the last fill */
+	size_t carry_len;
+	uint64_t bytes;             /* Bytes read so far */
+
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int full[2];                /* Block is filled and not yet handed back */
+	int held;                   /* Block held by the caller, or -1 */
+	int next;                   /* Block the caller takes next */
+	int done;                   /* Reader has exited */
+	int failed;                 /* Reader stopped on an error */
+	int stop;                   /* Reader should exit */
+};
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Fills block @p i after the carried partial line.
+ *
+ * @param eof Output: the input has ended
+ * @return Bytes of whole lines in the block, or -1 on error
+ */
+static long
+fill_block(LineStream *s, int i, int *eof)
+{
+	char *b = s->block[i];
+	size_t pos = s->carry_len;
+	memcpy(b, s->carry, pos);
+
+	*eof = 0;
+	while (pos < s->cap) {
+		ssize_t got = read(s->fd, b + pos, s->cap - pos);
+		if (got < 0) {
+			if (errno == EINTR)
+				continue;
+			print_error(__func__, "read() failed", errno);
+			return -1;
+		}
+		if (got == 0) {
+			*eof = 1;
+			break;
+		}
+		pos += (size_t)got;
+		__atomic_fetch_add(&s->bytes, (uint64_t)got, __ATOMIC_RELAXED);
+	}
+
+	if (*eof) {
+		s->carry_len = 0;
+		if (pos && b[pos - 1] != '\n')
+			b[pos++] = '\n';
+		return (long)pos;
+	}
+
+	size_t end = pos;
+	while (end > 0 && b[end - 1] != '\n')
+		end--;
+	if (end == 0) {
+		print_error(__func__, "line longer than a stream block", 0);
+		return -1;
+	}
+
+	s->carry_len = pos - end;
+	memcpy(s->carry, b + end, s->carry_len);
+	return (long)end;
+}
+
+/**
+ * @brief Reader thread: fills the blocks in turn until the input ends.
+ */
+static void *
+reader_main(void *arg)
+{
+	LineStream *s = arg;
+	uint64_t offset = 0;
+
+	for (int i = 0;; i ^= 1) {
+		pthread_mutex_lock(&s->lock);
+		while (s->full[i] && !s->stop)
+			pthread_cond_wait(&s->cond, &s->lock);
+		const int stop = s->stop;
+		pthread_mutex_unlock(&s->lock);
+		if (stop)
+			break;
+
+		int eof;
+		long len = fill_block(s, i, &eof);
+
+		pthread_mutex_lock(&s->lock);
+		if (len > 0) {
+			s->len[i] = (size_t)len;
+			s->start[i] = offset;
+			s->full[i] = 1;
+			offset += (uint64_t)len;
+		}
+		s->failed = (len < 0);
+		pthread_cond_broadcast(&s->cond);
+		pthread_mutex_unlock(&s->lock);
+
+		if (len < 0 || eof)
+			break;
+	}
+
+	pthread_mutex_lock(&s->lock);
+	s->done = 1;
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc line_stream_is_pipe()
+ */
+int
+line_stream_is_pipe(const char *path)
+{
+	if (strcmp(path, "-") == 0)
+		return 1;
+
+	struct stat st;
+	return stat(path, &st) == 0 && S_ISFIFO(st.st_mode);
+}
+
+/**
+ * @copydoc line_stream_open()
+ */
+LineStream *
+line_stream_open(const char *path, size_t block_size)
+{
+	LineStream *s = calloc(1, sizeof(LineStream));
+	if (!s) {
+		print_error(__func__, "calloc() failed", errno);
+		return NULL;
+	}
+	s->cap = block_size;
+	s->held = -1;
+
+	s->block[0] = malloc(block_size + 1);
+	s->block[1] = malloc(block_size + 1);
+	s->carry = malloc(block_size);
+	if (!s->block[0] || !s->block[1] || !s->carry) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+
+	if (strcmp(path, "-") == 0) {
+		s->fd = STDIN_FILENO;
+	} else {
+		/* Blocks until a pipe has a writer */
+		s->fd = open(path, O_RDONLY);
+		if (s->fd < 0) {
+			print_error(__func__, "failed to open input", errno);
+			goto fail;
+		}
+		s->own_fd = 1;
+	}
+
+	pthread_mutex_init(&s->lock, NULL);
+	pthread_cond_init(&s->cond, NULL);
+	int err = pthread_create(&s->thread, NULL, reader_main, s);
+	if (err) {
+		print_error(__func__, "pthread_create() failed", err);
+		pthread_mutex_destroy(&s->lock);
+		pthread_cond_destroy(&s->cond);
+		if (s->own_fd)
+			close(s->fd);
+		goto fail;
+	}
+	return s;
+
+fail:
+	free(s->block[0]);
+	free(s->block[1]);
+	free(s->carry);
+	free(s);
+	return NULL;
+}
+
+/**
+ * @copydoc line_stream_next()
+ */
+long
+line_stream_next(LineStream *s, const char **data, uint64_t *offset)
+{
+	long ret;
+
+	pthread_mutex_lock(&s->lock);
+	if (s->held >= 0) {
+		s->full[s->held] = 0;
+		s->held = -1;
+		pthread_cond_broadcast(&s->cond);
+	}
+
+	while (!s->full[s->next] && !s->done)
+		pthread_cond_wait(&s->cond, &s->lock);
+
+	if (s->full[s->next]) {
+		s->held = s->next;
+		*data = s->block[s->held];
+		*offset = s->start[s->held];
+		ret = (long)s->len[s->held];
+		s->next ^= 1;
+	} else {
+		ret = s->failed ? -1 : 0;
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	return ret;
+}
+
+/**
+ * @copydoc line_stream_bytes()
+ */
+uint64_t
+line_stream_bytes(const LineStream *s)
+{
+	return __atomic_load_n(&s->bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @copydoc line_stream_close()
+ */
+void
+line_stream_close(LineStream *s)
+{
+	if (!s)
+		return;
+
+	pthread_mutex_lock(&s->lock);
+	s->stop = 1;
+	pthread_cond_broadcast(&s->cond);
+	pthread_mutex_unlock(&s->lock);
+	pthread_join(s->thread, NULL);
+
+	pthread_mutex_destroy(&s->lock);
+	pthread_cond_destroy(&s->cond);
+	if (s->own_fd)
+		close(s->fd);
+	free(s->block[0]);
+	free(s->block[1]);
+	free(s->carry);
+	free(s);
+}
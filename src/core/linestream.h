@@ -0,0 +1,61 @@
+/**
+ * @file linestream.h
+ * @brief Double-buffered reading of text from pipes and standard input.
+ *
+ * Inputs that can only be read once, such as the standard input (`-`) or
+ * a named pipe fed by an extractor, cannot be mapped or loaded in two
+ * passes like the matrix files. A helper thread reads them instead into
+ * one of two blocks while the caller parses the other, and hands over
+ * whole lines only: the partial line at the end of a block is carried
+ * over to the start of the next.
+ */
+
+#ifndef LINESTREAM_H
+#define LINESTREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct LineStream LineStream;
+
+/**
+ * @brief Whether a path names an input that can only be read once.
+ *
+ * @return 1 for `-` (standard input) and named pipes, 0 otherwise
+ */
+int line_stream_is_pipe(const char *path);
+
+/**
+ * @brief Opens a path (`-` for standard input) and starts reading it.
+ *
+ * @param path Input to read
+ * @param block_size Bytes per block; no line may be longer
+ * @return Stream, or NULL on error (reported with print_error())
+ */
+LineStream *line_stream_open(const char *path, size_t block_size);
+
+/**
+ * @brief Hands back the previous block and waits for the next one.
+ *
+ * Every block holds whole lines and ends with a newline; a last line
+ * without one gets it added. The block stays valid until the next call.
+ *
+ * @param s Stream from line_stream_open()
+ * @param data Output: the lines of the block
+ * @param offset Output: input offset of the block's first byte
+ * @return Bytes in the block, 0 at the end of the input, or -1 on error
+ *         (reported with print_error())
+ */
+long line_stream_next(LineStream *s, const char **data, uint64_t *offset);
+
+/**
+ * @brief Total bytes read from the input so far.
+ */
+uint64_t line_stream_bytes(const LineStream *s);
+
+/**
+ * @brief Stops the reader and closes the input. Safe to call with NULL.
+ */
+void line_stream_close(LineStream *s);
+
+#endif /* LINESTREAM_H */
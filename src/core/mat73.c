@@ -0,0 +1,582 @@
+/**
+ * @file mat73.c
+ * @brief Parallel chunked reader for MATLAB v7.3 sparse matrices.
+ *
+ * The index datasets are read in three steps:
+ * 1. Check that the dataset is a little-endian integer vector stored in
+ *    chunks, whose filters are only deflate and shuffle. Otherwise read it
+ *    with hyperslabs instead.
+ * 2. Look up the file address and stored size of every chunk, serially,
+ *    since the HDF5 library is not thread-safe.
+ * 3. Read, decompress and narrow the chunks in parallel, outside the
+ *    library. Each chunk owns a disjoint slice of the output.
+ *
+ * Only one compressed and one decompressed chunk per thread are held at a
+ * time, on top of the output arrays themselves.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mat73.h"
+#include "error.h"
+
+#define MAT73_HEADER "MATLAB 7.3 MAT-file"
+
+#if defined(CC_HAVE_HDF5)
+
+#include <hdf5.h>
+#include <zlib.h>
+
+#include "parallel.h"
+
+#define MAT73_MAX_FILTERS 2
+#define MAT73_BLOCK       (1u << 22)  /* Elements per hyperslab read */
+
+/**
+ * @struct ChunkRef
+ * @brief Location of one stored chunk and the elements it provides.
+ */
+typedef struct {
+	size_t first;          /* Index of its first element */
+	size_t count;          /* Elements used from it */
+	haddr_t addr;          /* File offset, or HADDR_UNDEF if never written */
+	hsize_t size;          /* Stored (compressed) bytes */
+	unsigned int mask;     /* Filters skipped for this chunk */
+} ChunkRef;
+
+/**
+ * @struct ChunkReader
+ * @brief State shared by the parallel chunk reads of one dataset.
+ */
+typedef struct {
+	int fd;
+	const ChunkRef *chunks;
+	size_t chunk_bytes;    /* Bytes of a decompressed chunk */
+	size_t elem_size;      /* 4 or 8 */
+	int is_signed;
+	H5Z_filter_t filters[MAT73_MAX_FILTERS];  /* Pipeline, in write order */
+	int n_filters;
+	uint32_t *dst;
+	int failed;            /* First error: 1 read, 2 decompress, 3 out of range */
+} ChunkReader;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+set_failed(ChunkReader *r, int err)
+{
+	int none = 0;
+	__atomic_compare_exchange_n(&r->failed, &none, err, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Reads exactly len bytes at offset, retrying short reads.
+ */
+static int
+pread_full(int fd, void *buf, size_t len, off_t offset)
+{
+	char *p = buf;
+	while (len > 0) {
+		ssize_t got = pread(fd, p, len, offset);
+		if (got < 0 && errno == EINTR)
+			continue;
+		if (got <= 0)
+			return 1;
+		p += got;
+		len -= (size_t)got;
+		offset += got;
+	}
+	return 0;
+}
+
+/**
+ * @brief Undoes the shuffle filter: byte b of element i is at in[b * n + i].
+ */
+static void
+unshuffle(unsigned char *out, const unsigned char *in, size_t len, size_t elem_size)
+{
+	const size_t n = len / elem_size;
+	for (size_t b = 0; b < elem_size; b++)
+		for (size_t i = 0; i < n; i++)
+			out[i * elem_size + b] = in[b * n + i];
+	memcpy(out + n * elem_size, in + n * elem_size, len - n * elem_size);
+}
+
+/**
+ * @brief Narrows little-endian integers to uint32_t.
+ *
+ * @return 0 on success, 1 if a value does not fit
+ */
+static int
+narrow(uint32_t *dst, const unsigned char *src, size_t count, size_t elem_size, int is_signed)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint64_t v;
+		if (elem_size == 8) {
+			memcpy(&v, src + 8 * i, 8);
+			if ((is_signed && (int64_t)v < 0) || v > UINT32_MAX)
+				return 1;
+		} else {
+			uint32_t w;
+			memcpy(&w, src + 4 * i, 4);
+			if (is_signed && (int32_t)w < 0)
+				return 1;
+			v = w;
+		}
+		dst[i] = (uint32_t)v;
+	}
+	return 0;
+}
+
+static void
+read_chunks(void *arg, size_t begin, size_t end)
+{
+	ChunkReader *r = arg;
+
+	for (size_t k = begin; k < end; k++) {
+		const ChunkRef *c = &r->chunks[k];
+		if (c->addr == HADDR_UNDEF) {
+			memset(r->dst + c->first, 0, c->count * sizeof(uint32_t));
+			continue;
+		}
+
+		unsigned char *buf = malloc(c->size ? c->size : 1);
+		size_t len = c->size;
+		if (!buf || pread_full(r->fd, buf, len, (off_t)c->addr)) {
+			set_failed(r, 1);
+			free(buf);
+			return;
+		}
+
+		/* Undo the filters in reverse order */
+		for (int f = r->n_filters - 1; f >= 0; f--) {
+			if (c->mask & (1u << f))
+				continue;
+
+			unsigned char *out = malloc(r->filters[f] == H5Z_FILTER_DEFLATE ? r->chunk_bytes : len);
+			if (!out) {
+				set_failed(r, 1);
+				free(buf);
+				return;
+			}
+			if (r->filters[f] == H5Z_FILTER_DEFLATE) {
+				uLongf out_len = r->chunk_bytes;
+				if (uncompress(out, &out_len, buf, len) != Z_OK) {
+					set_failed(r, 2);
+					free(out);
+					free(buf);
+					return;
+				}
+				len = out_len;
+			} else {
+				unshuffle(out, buf, len, r->elem_size);
+			}
+			free(buf);
+			buf = out;
+		}
+
+		if (len < c->count * r->elem_size) {
+			set_failed(r, 2);
+			free(buf);
+			return;
+		}
+		if (narrow(r->dst + c->first, buf, c->count, r->elem_size, r->is_signed))
+			set_failed(r, 3);
+		free(buf);
+	}
+}
+
+/**
+ * @brief Reads elements [0, count) with hyperslab reads, narrowed by HDF5.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+read_hyperslabs(hid_t dset, hid_t space, int axis, uint32_t *dst, size_t count)
+{
+	for (size_t start = 0; start < count; start += MAT73_BLOCK) {
+		hsize_t n = count - start < MAT73_BLOCK ? count - start : MAT73_BLOCK;
+		hsize_t offset[2] = { 0, 0 }, block[2] = { 1, 1 };
+		offset[axis] = start;
+		block[axis] = n;
+
+		hid_t mspace = H5Screate_simple(1, &n, NULL);
+		herr_t err = mspace < 0 ? -1 :
+		             H5Sselect_hyperslab(space, H5S_SELECT_SET, offset, NULL, block, NULL);
+		if (err >= 0)
+			err = H5Dread(dset, H5T_NATIVE_UINT32, mspace, space, H5P_DEFAULT, dst + start);
+		if (mspace >= 0)
+			H5Sclose(mspace);
+		if (err < 0)
+			return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Fills r with the filter pipeline of a dataset, if it is supported.
+ *
+ * @return 1 if every filter is deflate or shuffle, 0 otherwise
+ */
+static int
+supported_filters(hid_t dcpl, ChunkReader *r)
+{
+	int n = H5Pget_nfilters(dcpl);
+	if (n < 0 || n > MAT73_MAX_FILTERS)
+		return 0;
+
+	for (int f = 0; f < n; f++) {
+		unsigned int flags;
+		size_t cd_nelmts = 0;
+		H5Z_filter_t id = H5Pget_filter2(dcpl, (unsigned int)f, &flags, &cd_nelmts, NULL,
+		                                 0, NULL, NULL);
+		if (id != H5Z_FILTER_DEFLATE && id != H5Z_FILTER_SHUFFLE)
+			return 0;
+		r->filters[f] = id;
+	}
+	r->n_filters = n;
+	return 1;
+}
+
+/**
+ * @brief Reads the first count elements of an integer vector dataset.
+ *
+ * @param grp Group holding the dataset
+ * @param name Dataset name
+ * @param fd File descriptor of the file, for the parallel reads
+ * @param userblock Size of the MATLAB header before the HDF5 data
+ * @param dst Output: count narrowed elements
+ * @return 0 on success, 1 on error
+ */
+static int
+read_index(hid_t grp, const char *name, int fd, hsize_t userblock, uint32_t *dst,
+           size_t count, unsigned int n_threads)
+{
+	char err[128];
+	int ret = 1;
+	hid_t dset = H5Dopen2(grp, name, H5P_DEFAULT);
+	hid_t space = dset < 0 ? H5I_INVALID_HID : H5Dget_space(dset);
+	hid_t type = dset < 0 ? H5I_INVALID_HID : H5Dget_type(dset);
+	hid_t dcpl = dset < 0 ? H5I_INVALID_HID : H5Dget_create_plist(dset);
+	ChunkRef *chunks = NULL;
+
+	if (dset < 0 || space < 0 || type < 0 || dcpl < 0) {
+		snprintf(err, sizeof(err), "cannot open dataset \"%s\"", name);
+		print_error(__func__, err, 0);
+		goto out;
+	}
+
+	/* A vector: one dimension, or two with one of them 1 */
+	hsize_t dims[2] = { 1, 1 };
+	int rank = H5Sget_simple_extent_ndims(space);
+	if (rank < 1 || rank > 2 || H5Sget_simple_extent_dims(space, dims, NULL) < 0 ||
+	    (rank == 2 && dims[0] != 1 && dims[1] != 1) || H5Tget_class(type) != H5T_INTEGER) {
+		snprintf(err, sizeof(err), "dataset \"%s\" is not an integer vector", name);
+		print_error(__func__, err, 0);
+		goto out;
+	}
+	const int axis = (rank == 2 && dims[0] == 1) ? 1 : 0;
+	if (dims[axis] < count) {
+		snprintf(err, sizeof(err), "dataset \"%s\" is too short", name);
+		print_error(__func__, err, 0);
+		goto out;
+	}
+
+	ChunkReader r;
+	memset(&r, 0, sizeof(r));
+	r.fd = fd;
+	r.dst = dst;
+	r.elem_size = H5Tget_size(type);
+	r.is_signed = H5Tget_sign(type) == H5T_SGN_2;
+
+	hsize_t cdims[2] = { 1, 1 };
+	int fast = (r.elem_size == 4 || r.elem_size == 8) &&
+	           H5Tget_order(type) == H5T_ORDER_LE &&
+	           __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ &&
+	           H5Pget_layout(dcpl) == H5D_CHUNKED &&
+	           H5Pget_chunk(dcpl, rank, cdims) == rank &&
+	           (rank == 1 || cdims[1 - axis] == 1) &&
+	           supported_filters(dcpl, &r);
+	if (!fast) {
+		ret = read_hyperslabs(dset, space, axis, dst, count);
+		if (ret) {
+			snprintf(err, sizeof(err), "failed to read dataset \"%s\"", name);
+			print_error(__func__, err, 0);
+		}
+		goto out;
+	}
+
+	/* Chunk addresses, serially through the library */
+	const size_t chunk_elems = cdims[axis];
+	const size_t n_chunks = (count + chunk_elems - 1) / chunk_elems;
+	chunks = malloc((n_chunks ? n_chunks : 1) * sizeof(ChunkRef));
+	if (!chunks) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+	for (size_t k = 0; k < n_chunks; k++) {
+		hsize_t coord[2] = { 0, 0 };
+		coord[axis] = k * chunk_elems;
+		chunks[k].first = k * chunk_elems;
+		chunks[k].count = count - chunks[k].first < chunk_elems ? count - chunks[k].first : chunk_elems;
+		if (H5Dget_chunk_info_by_coord(dset, coord, &chunks[k].mask, &chunks[k].addr,
+		                               &chunks[k].size) < 0) {
+			snprintf(err, sizeof(err), "cannot locate the chunks of \"%s\"", name);
+			print_error(__func__, err, 0);
+			goto out;
+		}
+		if (chunks[k].addr != HADDR_UNDEF)
+			chunks[k].addr += userblock;
+	}
+
+	/* Then read, decompress and narrow them in parallel */
+	r.chunks = chunks;
+	r.chunk_bytes = chunk_elems * r.elem_size;
+	parallel_for(n_chunks, 1, n_threads, read_chunks, &r);
+	if (r.failed) {
+		snprintf(err, sizeof(err), "dataset \"%s\": %s", name,
+		         r.failed == 1 ? "chunk read failed" :
+		         r.failed == 2 ? "corrupt compressed chunk" : "index exceeds 32 bits");
+		print_error(__func__, err, 0);
+		goto out;
+	}
+	ret = 0;
+
+out:
+	free(chunks);
+	if (dcpl >= 0)
+		H5Pclose(dcpl);
+	if (type >= 0)
+		H5Tclose(type);
+	if (space >= 0)
+		H5Sclose(space);
+	if (dset >= 0)
+		H5Dclose(dset);
+	return ret;
+}
+
+/**
+ * @struct SparseGroup
+ * @brief Open handles and shape of the `Problem.A` group.
+ */
+typedef struct {
+	hid_t file;
+	hid_t grp;
+	uint64_t nrows;        /* From the MATLAB_sparse attribute */
+	uint64_t n_jc;         /* Column pointers, one more than the columns */
+	hsize_t jc_dims[2];    /* Extent of jc */
+	int jc_rank;
+} SparseGroup;
+
+/**
+ * @brief Opens `Problem.A` and reads its row count and column pointer count.
+ *
+ * The handles are left in @p g for close_sparse() even on error.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+open_sparse(const char *path, SparseGroup *g)
+{
+	g->file = H5Fopen(path, H5F_ACC_RDONLY, H5P_DEFAULT);
+	g->grp = H5I_INVALID_HID;
+	if (g->file < 0) {
+		print_error(__func__, "[hdf5] failed to open file", 0);
+		return 1;
+	}
+
+	g->grp = H5Gopen2(g->file, "/Problem/A", H5P_DEFAULT);
+	hid_t attr = g->grp < 0 ? H5I_INVALID_HID : H5Aopen(g->grp, "MATLAB_sparse", H5P_DEFAULT);
+	g->nrows = 0;
+	int ok = attr >= 0 && H5Aread(attr, H5T_NATIVE_UINT64, &g->nrows) >= 0;
+	if (attr >= 0)
+		H5Aclose(attr);
+	if (!ok) {
+		print_error(__func__, "[hdf5] Problem.A not found or not sparse", 0);
+		return 1;
+	}
+
+	/* jc has one entry per column plus one */
+	hid_t jc = H5Dopen2(g->grp, "jc", H5P_DEFAULT);
+	hid_t space = jc < 0 ? H5I_INVALID_HID : H5Dget_space(jc);
+	g->jc_dims[0] = g->jc_dims[1] = 1;
+	g->jc_rank = space < 0 ? -1 : H5Sget_simple_extent_dims(space, g->jc_dims, NULL);
+	if (space >= 0)
+		H5Sclose(space);
+	if (jc >= 0)
+		H5Dclose(jc);
+	if (g->jc_rank < 1 || g->jc_rank > 2) {
+		print_error(__func__, "[hdf5] invalid column pointers", 0);
+		return 1;
+	}
+	g->n_jc = g->jc_rank == 1 ? g->jc_dims[0] : g->jc_dims[0] * g->jc_dims[1];
+	if (g->n_jc == 0 || g->nrows > UINT32_MAX || g->n_jc - 1 > UINT32_MAX) {
+		print_error(__func__, "matrix exceeds 32-bit index range", 0);
+		return 1;
+	}
+	return 0;
+}
+
+static void
+close_sparse(SparseGroup *g)
+{
+	if (g->grp >= 0)
+		H5Gclose(g->grp);
+	if (g->file >= 0)
+		H5Fclose(g->file);
+}
+
+#endif /* CC_HAVE_HDF5 */
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc csc_is_mat73()
+ */
+int
+csc_is_mat73(const char *path)
+{
+	char header[sizeof(MAT73_HEADER) - 1];
+
+	FILE *f = fopen(path, "rb");
+	if (!f)
+		return 0;
+	int is = fread(header, 1, sizeof(header), f) == sizeof(header) &&
+	         memcmp(header, MAT73_HEADER, sizeof(header)) == 0;
+	fclose(f);
+	return is;
+}
+
+#if defined(CC_HAVE_HDF5)
+
+/**
+ * @copydoc csc_shape_mat73()
+ */
+int
+csc_shape_mat73(const char *path, CSCBinaryMatrix *shape)
+{
+	H5E_auto2_t old_func;
+	void *old_data;
+	H5Eget_auto2(H5E_DEFAULT, &old_func, &old_data);
+	H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+
+	SparseGroup g;
+	int ret = 1;
+	if (open_sparse(path, &g))
+		goto out;
+
+	/* The entry count is the last column pointer: read that element only */
+	uint64_t nnz = 0;
+	hsize_t last[2] = { g.jc_dims[0] - 1, g.jc_dims[1] - 1 };
+	hsize_t one[2] = { 1, 1 };
+	hid_t jc = H5Dopen2(g.grp, "jc", H5P_DEFAULT);
+	hid_t space = jc < 0 ? H5I_INVALID_HID : H5Dget_space(jc);
+	hid_t mem = H5Screate_simple(1, one, NULL);
+	if (space >= 0 && mem >= 0 &&
+	    H5Sselect_hyperslab(space, H5S_SELECT_SET, last, NULL, one, NULL) >= 0 &&
+	    H5Dread(jc, H5T_NATIVE_UINT64, mem, space, H5P_DEFAULT, &nnz) >= 0) {
+		memset(shape, 0, sizeof(*shape));
+		shape->nrows = g.nrows;
+		shape->ncols = g.n_jc - 1;
+		shape->nnz = nnz;
+		ret = 0;
+	} else {
+		print_error(__func__, "[hdf5] invalid column pointers", 0);
+	}
+	if (mem >= 0)
+		H5Sclose(mem);
+	if (space >= 0)
+		H5Sclose(space);
+	if (jc >= 0)
+		H5Dclose(jc);
+
+out:
+	close_sparse(&g);
+	H5Eset_auto2(H5E_DEFAULT, old_func, old_data);
+	return ret;
+}
+
+/**
+ * @copydoc csc_load_mat73()
+ */
+CSCBinaryMatrix *
+csc_load_mat73(const char *path, unsigned int n_threads)
+{
+	CSCBinaryMatrix *m = NULL;
+	SparseGroup g = { .file = H5I_INVALID_HID, .grp = H5I_INVALID_HID };
+	hid_t fcpl = H5I_INVALID_HID;
+
+	/* Errors are reported here rather than by the library */
+	H5E_auto2_t old_func;
+	void *old_data;
+	H5Eget_auto2(H5E_DEFAULT, &old_func, &old_data);
+	H5Eset_auto2(H5E_DEFAULT, NULL, NULL);
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		print_error(__func__, "failed to open .mat file", errno);
+		goto out;
+	}
+
+	if (open_sparse(path, &g))
+		goto out;
+
+	hsize_t userblock = 0;
+	fcpl = H5Fget_create_plist(g.file);
+	if (fcpl < 0 || H5Pget_userblock(fcpl, &userblock) < 0) {
+		print_error(__func__, "[hdf5] failed to open file", 0);
+		goto out;
+	}
+
+	m = calloc(1, sizeof(CSCBinaryMatrix));
+	if (!m) {
+		print_error(__func__, "calloc() failed", errno);
+		goto out;
+	}
+	m->nrows = g.nrows;
+	m->ncols = g.n_jc - 1;
+	m->col_ptr = malloc((m->ncols + 1) * sizeof(uint32_t));
+	if (!m->col_ptr) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+	if (read_index(g.grp, "jc", fd, userblock, m->col_ptr, m->ncols + 1, n_threads))
+		goto fail;
+
+	/* ir may hold spare room past the last entry, and is absent if empty */
+	m->nnz = m->col_ptr[m->ncols];
+	m->row_idx = malloc((m->nnz ? m->nnz : 1) * sizeof(uint32_t));
+	if (!m->row_idx) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+	if (m->nnz && read_index(g.grp, "ir", fd, userblock, m->row_idx, m->nnz, n_threads))
+		goto fail;
+	goto out;
+
+fail:
+	csc_free_matrix(m);
+	m = NULL;
+
+out:
+	if (fcpl >= 0)
+		H5Pclose(fcpl);
+	close_sparse(&g);
+	if (fd >= 0)
+		close(fd);
+	H5Eset_auto2(H5E_DEFAULT, old_func, old_data);
+	return m;
+}
+
+#endif /* CC_HAVE_HDF5 */
@@ -0,0 +1,63 @@
+/**
+ * @file mat73.h
+ * @brief Parallel reader for MATLAB v7.3 (HDF5) sparse matrices.
+ *
+ * A v7.3 MAT-file is an HDF5 file behind a 512-byte MATLAB header. Its
+ * `Problem.A` sparse matrix is the group `/Problem/A`, holding the row
+ * indices in the dataset `ir`, the column pointers in `jc` and the row
+ * count in the attribute `MATLAB_sparse`. Going through matio decodes the
+ * whole variable on one thread into 64-bit buffers, which are then copied.
+ *
+ * This reader uses HDF5 only for the metadata: the file address of every
+ * chunk of `ir` and `jc`. The chunks are then read with pread() and
+ * decompressed (deflate, with or without shuffle) on all threads, each
+ * straight into its slice of `row_idx` or `col_ptr` as 32-bit indices.
+ * Datasets stored any other way are read with HDF5 hyperslab reads, one
+ * block at a time, converting to 32 bits on the way.
+ *
+ * Available when built with HDF5 support (`make HDF5=1`, which defines
+ * CC_HAVE_HDF5).
+ */
+
+#ifndef MAT73_H
+#define MAT73_H
+
+#include "matrix.h"
+
+/**
+ * @brief Checks whether a file is a MATLAB v7.3 MAT-file.
+ *
+ * Only the text header is inspected, so this works without HDF5 support.
+ *
+ * @return 1 if it is, 0 otherwise
+ */
+int csc_is_mat73(const char *path);
+
+#if defined(CC_HAVE_HDF5)
+
+/**
+ * @brief Loads `Problem.A` from a MATLAB v7.3 MAT-file.
+ *
+ * Values are ignored: every stored entry is a non-zero.
+ *
+ * @param path Path to the .mat file
+ * @param n_threads Number of threads reading and decompressing chunks
+ * @return Newly allocated matrix, or NULL on error
+ */
+CSCBinaryMatrix *csc_load_mat73(const char *path, unsigned int n_threads);
+
+/**
+ * @brief Reads the shape of `Problem.A` without loading it.
+ *
+ * Only the row count attribute, the extent of the column pointers and
+ * their last element are read.
+ *
+ * @param path Path to the .mat file
+ * @param shape Output: nrows, ncols and nnz; the arrays are left NULL
+ * @return 0 on success, 1 on error
+ */
+int csc_shape_mat73(const char *path, CSCBinaryMatrix *shape);
+
+#endif
+
+#endif /* MAT73_H */
@@ -6,13 +6,29 @@
  * matrices in CSC format. Two input formats are supported:
  *
  * - **MAT files (.mat)** using MATIO, expecting a struct `Problem.A`
- *   containing a MATLAB sparse matrix.
+ *   containing a MATLAB sparse matrix. With HDF5 support, v7.3 files are
+ *   read by the parallel chunked reader of mat73.c instead.
  *
- * - **Matrix Market files (.mtx)** in `coordinate` or `array` format.
+ * - **Matrix Market files (.mtx)** in `coordinate` or `array` format,
+ *   mapped and parsed in two passes straight into the CSC arrays.
+ *
+ * - **Binary CSC files (.csc)**, a raw dump of the CSC arrays used as a
+ *   load cache for repeated benchmark runs (see csc_save_matrix()).
+ *
+ * - **Edge lists (.el)** with sparse 64-bit vertex ids, compacted by
+ *   edgelist.c.
  *
  * Only binary matrices are represented. Any non-zero numeric values in
  * the input are treated as 1.
+ *
+ * Coordinate `.mtx` and `.csc` files can also be streamed entry by entry
+ * (see csc_open_edges()) for out-of-core processing, and a loaded matrix
+ * can be handed to child processes through shared memory in the `.csc`
+ * layout (see csc_share_matrix()).
  */
+
+#define _POSIX_C_SOURCE 200809L
+
 #include <ctype.h>
 #include <errno.h>
 #include <math.h>
@@ -20,10 +36,86 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "matrix.h"
+#include "edgelist.h"
+#include "mat73.h"
+#include "parallel.h"
 #include "error.h"
 
+/* ------------------------------------------------------------------------- */
+/*                            Binary Cache Format                            */
+/* ------------------------------------------------------------------------- */
+
+#define CSC_BINARY_MAGIC "CSCBIN01"
+
+/**
+ * @struct CSCBinaryHeader
+ * @brief On-disk header of the binary CSC cache format.
+ *
+ * Followed by `ncols + 1` column pointers and `nnz` row indices, all stored
+ * as native-endian uint32_t.
+ */
+typedef struct {
+	char magic[8];         /**< CSC_BINARY_MAGIC */
+	uint64_t nrows;        /**< Number of rows */
+	uint64_t ncols;        /**< Number of columns */
+	uint64_t nnz;          /**< Number of non-zero entries */
+	uint64_t reserved[4];  /**< Pads the header to 64 bytes */
+} CSCBinaryHeader;
+
+/* ------------------------------------------------------------------------- */
+/*                           Matrix Market Parsing                           */
+/* ------------------------------------------------------------------------- */
+
+#define MTX_CHUNK  (1u << 20)  /* Bytes of coordinate entries per chunk */
+#define MTX_FLUSH  64          /* Entries scattered per batch of slot claims */
+
+/**
+ * @struct MtxChunk
+ * @brief Results of parsing one chunk of a .mtx body.
+ */
+typedef struct {
+	size_t entries;      /* Entries parsed */
+	size_t stored;       /* Non-zeros stored, mirrors included */
+	int failed;          /* Malformed or out of range entry, or MTX_MAP_FAILED */
+} MtxChunk;
+
+#define MTX_MAP_FAILED 2
+
+/**
+ * @struct MtxCtx
+ * @brief State shared by the two parallel passes over a .mtx body.
+ *
+ * The body is split into `chunk` byte ranges, and each chunk parses the
+ * lines that start in its range. A chunk maps the file from its range to
+ * the end only while it is parsed, so the file's pages leave the resident
+ * set behind the parsers instead of piling up over both passes. The first
+ * pass counts the non-zeros of
+ * every column into `col_ptr[j + 1]`. After the scan `col_ptr[j]` is the
+ * start of column j, and the second pass claims the slots of the entries
+ * by advancing it, which leaves it at the start of column j + 1.
+ */
+typedef struct {
+	int fd;              /* The .mtx file */
+	size_t page;         /* Page size, the alignment of the chunk mappings */
+	size_t body;         /* Offset of the first entry */
+	size_t size;         /* Size of the file */
+	size_t chunk;        /* Bytes per chunk */
+	int is_coordinate;
+	int is_pattern;
+	int mirror;          /* Symmetric: store (j, i) along with (i, j) */
+	size_t nrows;
+	size_t ncols;
+	uint32_t *col_ptr;
+	uint32_t *row_idx;   /* NULL during the counting pass */
+	MtxChunk *chunks;
+} MtxCtx;
+
 /* ------------------------------------------------------------------------- */
 /*                            Static Helper Functions                        */
 /* ------------------------------------------------------------------------- */
@@ -50,13 +142,23 @@ num_digits(int n)
  *
  * Expects a struct named "Problem" with a sparse matrix field "A".
  * The matrix must be 2-D, real-valued, and stored in MATLAB sparse format.
+ * With HDF5 support, v7.3 files go to csc_load_mat73() instead.
  *
  * @param filename Path to the .mat file.
+ * @param n_threads Number of threads for v7.3 files.
  * @return Newly allocated CSCBinaryMatrix on success, NULL on error.
  */
 static CSCBinaryMatrix*
-csc_load_matrix_mat(const char *filename)
+csc_load_matrix_mat(const char *filename, unsigned int n_threads)
 {
+#if defined(CC_HAVE_HDF5)
+	/* v7.3 files are HDF5: read their chunks in parallel instead */
+	if (csc_is_mat73(filename))
+		return csc_load_mat73(filename, n_threads);
+#else
+	(void)n_threads;
+#endif
+
 	const char matrix_name[] = "Problem";
 	const char field_name[]  = "A";
 
@@ -109,6 +211,11 @@ csc_load_matrix_mat(const char *filename)
 	m->nrows = field->dims[0];
 	m->ncols = field->dims[1];
 	m->nnz   = s->jc[m->ncols];
+	m->bipartite = 0;
+	m->vertex_ids = NULL;
+	m->edge_mask = NULL;
+	m->map = NULL;
+	m->map_size = 0;
 
 	m->row_idx = malloc(sizeof(uint32_t) * m->nnz);
 	m->col_ptr = malloc(sizeof(uint32_t) * (m->ncols + 1));
@@ -158,6 +265,229 @@ mm_skip_comments(FILE *f)
 	}
 }
 
+/**
+ * @brief Parse a 1-based index no larger than @p max.
+ *
+ * @return 0 on success, 1 if the token is not such an index.
+ */
+static int
+mm_parse_index(const char **pp, const char *eol, size_t max, size_t *out)
+{
+	const char *p = *pp;
+	size_t v = 0;
+
+	while (p < eol && (*p == ' ' || *p == '\t'))
+		p++;
+	if (p == eol || !isdigit((unsigned char)*p))
+		return 1;
+	for (; p < eol && isdigit((unsigned char)*p); p++) {
+		v = v * 10 + (size_t)(*p - '0');
+		if (v > max)
+			return 1;
+	}
+	if (v == 0 || (p < eol && !isspace((unsigned char)*p)))
+		return 1;
+
+	*pp = p;
+	*out = v;
+	return 0;
+}
+
+/**
+ * @brief Parse a numeric value, only as far as telling whether it is zero.
+ *
+ * The mapped file is not NUL-terminated, so strtod() cannot be used.
+ *
+ * @return 1 if non-zero, 0 if zero, -1 if the token is not a number.
+ */
+static int
+mm_parse_value(const char **pp, const char *eol)
+{
+	const char *p = *pp;
+	int digits = 0, nonzero = 0;
+
+	while (p < eol && (*p == ' ' || *p == '\t'))
+		p++;
+	if (p < eol && (*p == '+' || *p == '-'))
+		p++;
+	for (; p < eol && (isdigit((unsigned char)*p) || *p == '.'); p++) {
+		if (*p != '.') {
+			digits = 1;
+			nonzero |= (*p != '0');
+		}
+	}
+
+	if (!digits) {
+		/* inf or nan */
+		if (p == eol || !isalpha((unsigned char)*p))
+			return -1;
+		while (p < eol && isalpha((unsigned char)*p))
+			p++;
+		nonzero = 1;
+	} else if (p < eol && (*p == 'e' || *p == 'E')) {
+		p++;
+		if (p < eol && (*p == '+' || *p == '-'))
+			p++;
+		if (p == eol || !isdigit((unsigned char)*p))
+			return -1;
+		while (p < eol && isdigit((unsigned char)*p))
+			p++;
+	}
+	if (p < eol && !isspace((unsigned char)*p))
+		return -1;
+
+	*pp = p;
+	return nonzero;
+}
+
+/**
+ * @brief Claim the slots of a batch of entries, then store their rows.
+ *
+ * Claiming every slot before the first store keeps the atomic increments
+ * from waiting on the cache misses of the stores.
+ */
+static void
+mm_flush(MtxCtx *c, const uint32_t *rows, const uint32_t *cols, unsigned int len)
+{
+	uint32_t slot[MTX_FLUSH];
+
+	for (unsigned int k = 0; k < len; k++)
+		slot[k] = __atomic_fetch_add(&c->col_ptr[cols[k]], 1, __ATOMIC_RELAXED);
+	for (unsigned int k = 0; k < len; k++)
+		c->row_idx[slot[k]] = rows[k];
+}
+
+/**
+ * @brief Parse one chunk: count its non-zeros, or scatter them.
+ */
+static void
+mm_parse_chunk(MtxCtx *c, size_t ch)
+{
+	MtxChunk *s = &c->chunks[ch];
+	uint32_t rows[MTX_FLUSH], cols[MTX_FLUSH];
+	unsigned int len = 0;
+
+	/* Map from the page holding the byte before the chunk, which tells
+	 * whether its first line starts in the previous chunk, to the end of
+	 * the file, where its last line may end */
+	const size_t start = c->body + ch * c->chunk;
+	const size_t off = (start - (ch > 0)) / c->page * c->page;
+	const size_t map_len = c->size - off;
+	char *map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, c->fd, (off_t)off);
+	if (map == MAP_FAILED) {
+		s->failed = MTX_MAP_FAILED;
+		return;
+	}
+	posix_madvise(map, map_len, POSIX_MADV_SEQUENTIAL);
+
+	const char *end = map + map_len;
+	const char *p = map + (start - off);
+	const char *stop = (size_t)(end - p) > c->chunk ? p + c->chunk : end;
+
+	/* A line starting in the previous chunk is parsed there */
+	if (ch > 0 && p[-1] != '\n') {
+		while (p < end && *p != '\n')
+			p++;
+		p += (p < end);
+	}
+
+	s->entries = s->stored = 0;
+	s->failed = 0;
+
+	/* The index of the first entry of a chunk is only known for the first */
+	size_t k = 0;
+
+	while (p < stop) {
+		const char *eol = memchr(p, '\n', (size_t)(end - p));
+		if (!eol)
+			eol = end;
+
+		const char *q = p;
+		while (q < eol && isspace((unsigned char)*q))
+			q++;
+		if (q == eol || *q == '%') {
+			p = eol + 1;
+			continue;
+		}
+
+		size_t i, j;
+		int nz = 1;
+		if (c->is_coordinate) {
+			if (mm_parse_index(&q, eol, c->nrows, &i) ||
+			    mm_parse_index(&q, eol, c->ncols, &j) ||
+			    (!c->is_pattern && (nz = mm_parse_value(&q, eol)) < 0))
+			{
+				s->failed = 1;
+				goto out;
+			}
+			i--;
+			j--;
+		} else {
+			/* One or more values per line, stored column by column */
+			while (q < eol) {
+				if ((nz = mm_parse_value(&q, eol)) < 0) {
+					s->failed = 1;
+					goto out;
+				}
+				if (nz && k < c->nrows * c->ncols) {
+					if (c->row_idx) {
+						rows[len] = (uint32_t)(k % c->nrows);
+						cols[len] = (uint32_t)(k / c->nrows);
+						if (++len == MTX_FLUSH) {
+							mm_flush(c, rows, cols, len);
+							len = 0;
+						}
+					} else {
+						c->col_ptr[k / c->nrows + 1]++;
+					}
+					s->stored++;
+				}
+				k++;
+				s->entries++;
+				while (q < eol && isspace((unsigned char)*q))
+					q++;
+			}
+			p = eol + 1;
+			continue;
+		}
+
+		s->entries++;
+		if (nz) {
+			const int both = c->mirror && i != j;
+			if (c->row_idx) {
+				rows[len] = (uint32_t)i;
+				cols[len++] = (uint32_t)j;
+				if (both) {
+					rows[len] = (uint32_t)j;
+					cols[len++] = (uint32_t)i;
+				}
+				if (len >= MTX_FLUSH - 1) {
+					mm_flush(c, rows, cols, len);
+					len = 0;
+				}
+			} else {
+				__atomic_fetch_add(&c->col_ptr[j + 1], 1, __ATOMIC_RELAXED);
+				if (both)
+					__atomic_fetch_add(&c->col_ptr[i + 1], 1, __ATOMIC_RELAXED);
+			}
+			s->stored += 1 + both;
+		}
+		p = eol + 1;
+	}
+
+	if (len)
+		mm_flush(c, rows, cols, len);
+out:
+	munmap(map, map_len);
+}
+
+static void
+mm_parse_chunks(void *arg, size_t begin, size_t end)
+{
+	for (size_t ch = begin; ch < end; ch++)
+		mm_parse_chunk(arg, ch);
+}
+
 /**
  * @brief Load a CSC matrix from a Matrix Market (.mtx) file.
  *
@@ -169,11 +499,19 @@ mm_skip_comments(FILE *f)
  *
  * Only non-zero entries are stored (binary interpretation).
  *
+ * The file is mapped and parsed twice: once to count the entries of each
+ * column, and once to scatter the rows into place, so nothing but the
+ * final arrays is allocated. Each chunk is mapped only while it is parsed
+ * (see MtxCtx). Coordinate files are parsed on @p n_threads
+ * threads; array files, whose entries are located by their position, on
+ * one.
+ *
  * @param filename Path to the .mtx file.
+ * @param n_threads Number of threads.
  * @return Newly allocated CSCBinaryMatrix on success, NULL on error.
  */
 static CSCBinaryMatrix*
-csc_load_matrix_mtx(const char *filename)
+csc_load_matrix_mtx(const char *filename, unsigned int n_threads)
 {
 	FILE *f = fopen(filename, "r");
 	if (!f) {
@@ -192,10 +530,11 @@ csc_load_matrix_mtx(const char *filename)
 		return NULL;
 	}
 
-	int is_coordinate = (strcmp(format, "coordinate") == 0);
-	//int is_array      = (strcmp(format, "array") == 0);
+	MtxCtx c;
+	memset(&c, 0, sizeof(c));
 
-	int is_pattern = (strcmp(field, "pattern") == 0);
+	c.is_coordinate = (strcmp(format, "coordinate") == 0);
+	c.is_pattern = (strcmp(field, "pattern") == 0);
 
 	int symmetric   = (strcmp(symmetry, "symmetric") == 0);
 	int skew        = (strcmp(symmetry, "skew-symmetric") == 0);
@@ -207,141 +546,200 @@ csc_load_matrix_mtx(const char *filename)
 		fclose(f);
 		return NULL;
 	}
+	c.mirror = symmetric;
 
 	/* --- Sizes --------------------------------------------------------- */
 	mm_skip_comments(f);
 
-	size_t nrows, ncols, nnz;
-	if (is_coordinate) {
-		if (fscanf(f, "%zu %zu %zu", &nrows, &ncols, &nnz) != 3) {
+	size_t nnz;
+	if (c.is_coordinate) {
+		if (fscanf(f, "%zu %zu %zu", &c.nrows, &c.ncols, &nnz) != 3) {
 			print_error(__func__, "invalid size line", 0);
 			fclose(f);
 			return NULL;
 		}
 	} else { /* array */
-		if (fscanf(f, "%zu %zu", &nrows, &ncols) != 2) {
+		if (fscanf(f, "%zu %zu", &c.nrows, &c.ncols) != 2) {
 			print_error(__func__, "invalid array size line", 0);
 			fclose(f);
 			return NULL;
 		}
-		nnz = nrows * ncols; /* will filter zeroes later */
+		nnz = c.nrows * c.ncols; /* will filter zeroes later */
 	}
 
-	/* Allocate temporary COO arrays */
-	size_t max_nnz = nnz * (symmetric ? 2 : 1) + 5;
-	uint32_t *coo_i = malloc(max_nnz * sizeof(uint32_t));
-	uint32_t *coo_j = malloc(max_nnz * sizeof(uint32_t));
-	if (!coo_i || !coo_j) {
-		print_error(__func__, "malloc failed", errno);
+	if (c.nrows > UINT32_MAX || c.ncols >= UINT32_MAX) {
+		print_error(__func__, "matrix too large for 32-bit indices", 0);
+		fclose(f);
+		return NULL;
+	}
+	if (symmetric && c.nrows != c.ncols) {
+		print_error(__func__, "symmetric matrix is not square", 0);
 		fclose(f);
-		free(coo_i); free(coo_j);
 		return NULL;
 	}
 
-	size_t count = 0;
-
-	/* --- Read entries -------------------------------------------------- */
-	if (is_coordinate) {
-		/* i j [value] */
-		for (size_t k = 0; k < nnz; k++) {
-			size_t i, j;
-			double val = 1.0;
-
-			if (is_pattern) {
-				if (fscanf(f, "%zu %zu", &i, &j) != 2) {
-					print_error(__func__, "bad coordinate entry", 0);
-					goto fail;
-				}
-			} else {
-				if (fscanf(f, "%zu %zu %lf", &i, &j, &val) != 3) {
-					print_error(__func__, "bad coordinate entry", 0);
-					goto fail;
-				}
-			}
+	/* --- Map the entries ----------------------------------------------- */
+	struct stat st;
+	long body = ftell(f);
+	if (body < 0 || fstat(fileno(f), &st) != 0) {
+		print_error(__func__, "failed to stat .mtx file", errno);
+		fclose(f);
+		return NULL;
+	}
+	c.body = (size_t)body;
+	c.size = (size_t)st.st_size;
+	c.fd = fileno(f);
+	c.page = (size_t)sysconf(_SC_PAGESIZE);
+
+	/* Array entries are located by their position: parse them as one chunk */
+	c.chunk = c.is_coordinate ? MTX_CHUNK : c.size - c.body;
+	const size_t n_chunks = c.chunk ? (c.size - c.body + c.chunk - 1) / c.chunk : 0;
+	CSCBinaryMatrix *m = calloc(1, sizeof(CSCBinaryMatrix));
+	c.chunks = calloc(n_chunks ? n_chunks : 1, sizeof(MtxChunk));
+	c.col_ptr = calloc(c.ncols + 1, sizeof(uint32_t));
+	if (!m || !c.chunks || !c.col_ptr) {
+		print_error(__func__, "calloc() failed", errno);
+		goto fail;
+	}
 
-			if (val != 0.0) {
-				coo_i[count] = i - 1;
-				coo_j[count] = j - 1;
-				count++;
+	/* --- Pass 1: count the entries of each column ---------------------- */
+	parallel_for(n_chunks, 1, n_threads, mm_parse_chunks, &c);
 
-				if (symmetric && i != j) {
-					coo_i[count] = j - 1;
-					coo_j[count] = i - 1;
-					count++;
-				}
-			}
+	size_t entries = 0, count = 0;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		if (c.chunks[ch].failed == MTX_MAP_FAILED) {
+			print_error(__func__, "failed to map .mtx file", 0);
+			goto fail;
 		}
-	}
-	else {
-		/* array: dense stored column-major */
-		for (size_t j = 0; j < ncols; j++) {
-			for (size_t i = 0; i < nrows; i++) {
-				double val;
-				if (fscanf(f, "%lf", &val) != 1)
-					goto fail;
-
-				if (val != 0.0) {
-					coo_i[count] = i;
-					coo_j[count] = j;
-					count++;
-				}
-			}
+		if (c.chunks[ch].failed) {
+			print_error(__func__, c.is_coordinate ? "bad coordinate entry"
+			                                      : "bad array entry", 0);
+			goto fail;
 		}
+		entries += c.chunks[ch].entries;
+		count += c.chunks[ch].stored;
+	}
+	if (entries != nnz) {
+		print_error(__func__, "entry count does not match the size line", 0);
+		goto fail;
+	}
+	if (count > UINT32_MAX) {
+		print_error(__func__, "too many entries for 32-bit indices", 0);
+		goto fail;
 	}
 
-	fclose(f);
+	for (size_t j = 0; j < c.ncols; j++)
+		c.col_ptr[j + 1] += c.col_ptr[j];
 
-	/* --- Convert COO → CSC binary -------------------------------------- */
-	CSCBinaryMatrix *m = malloc(sizeof(CSCBinaryMatrix));
-	if (!m) goto fail;
+	/* --- Pass 2: scatter the rows -------------------------------------- */
+	c.row_idx = malloc((count ? count : 1) * sizeof(uint32_t));
+	if (!c.row_idx) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
 
-	m->nrows = nrows;
-	m->ncols = ncols;
-	m->nnz   = count;
+	parallel_for(n_chunks, 1, n_threads, mm_parse_chunks, &c);
 
-	m->row_idx = malloc(count * sizeof(uint32_t));
-	m->col_ptr = malloc((ncols + 1) * sizeof(uint32_t));
+	/* Each column start now holds the start of the next column */
+	memmove(c.col_ptr + 1, c.col_ptr, c.ncols * sizeof(uint32_t));
+	c.col_ptr[0] = 0;
 
-	if (!m->row_idx || !m->col_ptr) {
-		print_error(__func__, "malloc failed", errno);
-		csc_free_matrix(m);
-		goto fail;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		if (c.chunks[ch].failed) {
+			print_error(__func__, "failed to map .mtx file", 0);
+			goto fail;
+		}
 	}
+	fclose(f);
+	free(c.chunks);
 
-	/* count entries per column */
-	memset(m->col_ptr, 0, (ncols + 1) * sizeof(uint32_t));
+	m->nrows = c.nrows;
+	m->ncols = c.ncols;
+	m->nnz   = count;
+	m->row_idx = c.row_idx;
+	m->col_ptr = c.col_ptr;
+	m->bipartite = 0;
+	m->vertex_ids = NULL;
+	m->edge_mask = NULL;
 
-	for (size_t k = 0; k < count; k++)
-		m->col_ptr[coo_j[k] + 1]++;
+	return m;
 
-	for (size_t j = 0; j < ncols; j++)
-		m->col_ptr[j+1] += m->col_ptr[j];
+fail:
+	fclose(f);
+	free(c.chunks);
+	free(c.col_ptr);
+	free(c.row_idx);
+	free(m);
+	return NULL;
+}
 
-	/* fill rows */
-	uint32_t *col_fill = calloc(ncols, sizeof(uint32_t));
-	if (!col_fill) goto fail2;
+/**
+ * @brief Load a CSC matrix from the binary cache format.
+ *
+ * @param filename Path to the .csc file.
+ * @return Newly allocated CSCBinaryMatrix on success, NULL on error.
+ */
+static CSCBinaryMatrix*
+csc_load_matrix_bin(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	if (!f) {
+		print_error(__func__, "failed to open .csc file", errno);
+		return NULL;
+	}
 
-	for (size_t k = 0; k < count; k++) {
-		uint32_t j = coo_j[k];
-		uint32_t dest = m->col_ptr[j] + col_fill[j];
-		m->row_idx[dest] = coo_i[k];
-		col_fill[j]++;
+	CSCBinaryHeader h;
+	if (fread(&h, sizeof(h), 1, f) != 1 ||
+	    memcmp(h.magic, CSC_BINARY_MAGIC, sizeof(h.magic)) != 0)
+	{
+		print_error(__func__, "invalid binary CSC header", 0);
+		fclose(f);
+		return NULL;
 	}
 
-	free(col_fill);
-	free(coo_i);
-	free(coo_j);
+	if (h.nnz > UINT32_MAX || h.nrows > UINT32_MAX || h.ncols > UINT32_MAX) {
+		print_error(__func__, "matrix exceeds 32-bit index range", 0);
+		fclose(f);
+		return NULL;
+	}
 
-	return m;
+	CSCBinaryMatrix *m = malloc(sizeof(CSCBinaryMatrix));
+	if (!m) {
+		print_error(__func__, "malloc() failed", errno);
+		fclose(f);
+		return NULL;
+	}
 
-fail2:
-	csc_free_matrix(m);    
+	m->nrows = h.nrows;
+	m->ncols = h.ncols;
+	m->nnz   = h.nnz;
+	m->bipartite = 0;
+	m->vertex_ids = NULL;
+	m->edge_mask = NULL;
+	m->map = NULL;
+	m->map_size = 0;
+
+	m->row_idx = malloc(sizeof(uint32_t) * (m->nnz ? m->nnz : 1));
+	m->col_ptr = malloc(sizeof(uint32_t) * (m->ncols + 1));
+
+	if (!m->row_idx || !m->col_ptr) {
+		print_error(__func__, "malloc() failed", errno);
+		csc_free_matrix(m);
+		fclose(f);
+		return NULL;
+	}
+
+	if (fread(m->col_ptr, sizeof(uint32_t), m->ncols + 1, f) != m->ncols + 1 ||
+	    fread(m->row_idx, sizeof(uint32_t), m->nnz, f) != m->nnz)
+	{
+		print_error(__func__, "truncated binary CSC file", 0);
+		csc_free_matrix(m);
+		fclose(f);
+		return NULL;
+	}
 
-fail:
 	fclose(f);
-	free(coo_i);
-	free(coo_j);
-	return NULL;
+	return m;
 }
 
 /**
@@ -368,6 +766,223 @@ ext_is(const char *filename, const char *ext)
 }
 
 
+/* ------------------------------------------------------------------------- */
+/*                               Edge Streams                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief State of a CSCEdgeStream.
+ *
+ * A `.csc` file is read through two cursors, one over the column pointers
+ * and one over the row indices. A `.mtx` file is parsed line by line.
+ */
+struct CSCEdgeStream {
+	FILE *f;             /* .mtx entries, or .csc row indices */
+	FILE *fc;            /* .csc column pointers (NULL for .mtx) */
+	int is_pattern;      /* .mtx entries carry no value */
+	size_t nrows;        /* Bounds of the indices */
+	size_t ncols;
+	size_t remaining;    /* Entries left to read */
+	uint32_t col;        /* .csc: current column */
+	uint32_t col_end;    /* .csc: end of the current column in row_idx */
+	uint32_t pos;        /* .csc: next position in row_idx */
+	long base;           /* .csc: bytes before the row indices */
+};
+
+/**
+ * @brief Open the header of a coordinate .mtx file for streaming.
+ */
+static int
+open_edges_mtx(CSCEdgeStream *s, CSCBinaryMatrix *shape)
+{
+	char format[64], field[64], symmetry[64];
+
+	if (fscanf(s->f, "%%%%MatrixMarket matrix %63s %63s %63s",
+	           format, field, symmetry) != 3)
+	{
+		print_error(__func__, "invalid MatrixMarket header", 0);
+		return 1;
+	}
+
+	if (strcmp(format, "coordinate") != 0) {
+		print_error(__func__, "only coordinate .mtx files can be streamed", 0);
+		return 1;
+	}
+	s->is_pattern = (strcmp(field, "pattern") == 0);
+
+	mm_skip_comments(s->f);
+	if (fscanf(s->f, "%zu %zu %zu", &shape->nrows, &shape->ncols, &shape->nnz) != 3) {
+		print_error(__func__, "invalid size line", 0);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Open the header of a .csc file for streaming.
+ */
+static int
+open_edges_bin(CSCEdgeStream *s, const char *path, CSCBinaryMatrix *shape)
+{
+	CSCBinaryHeader h;
+	if (fread(&h, sizeof(h), 1, s->f) != 1 ||
+	    memcmp(h.magic, CSC_BINARY_MAGIC, sizeof(h.magic)) != 0)
+	{
+		print_error(__func__, "invalid binary CSC header", 0);
+		return 1;
+	}
+
+	if (h.nnz > UINT32_MAX || h.nrows > UINT32_MAX || h.ncols > UINT32_MAX) {
+		print_error(__func__, "matrix exceeds 32-bit index range", 0);
+		return 1;
+	}
+
+	shape->nrows = h.nrows;
+	shape->ncols = h.ncols;
+	shape->nnz   = h.nnz;
+
+	s->fc = fopen(path, "rb");
+	if (!s->fc) {
+		print_error(__func__, "failed to open .csc file", errno);
+		return 1;
+	}
+
+	/* Column pointers follow the header, row indices follow them */
+	s->base = (long)(sizeof(h) + (h.ncols + 1) * sizeof(uint32_t));
+	if (fseek(s->fc, (long)sizeof(h), SEEK_SET) != 0 ||
+	    fseek(s->f, s->base, SEEK_SET) != 0 ||
+	    fread(&s->col_end, sizeof(uint32_t), 1, s->fc) != 1)
+	{
+		print_error(__func__, "truncated binary CSC file", 0);
+		return 1;
+	}
+
+	/* col_end now holds col_ptr[0]; the first column starts there */
+	s->pos = s->col_end;
+	s->col = UINT32_MAX;
+	return 0;
+}
+
+/**
+ * @copydoc csc_open_edges()
+ */
+CSCEdgeStream*
+csc_open_edges(const char *path, CSCBinaryMatrix *shape)
+{
+	int is_mtx = ext_is(path, "mtx");
+	if (!is_mtx && !ext_is(path, "csc")) {
+		print_error(__func__, "only .mtx and .csc files can be streamed", 0);
+		return NULL;
+	}
+
+	CSCEdgeStream *s = calloc(1, sizeof(CSCEdgeStream));
+	if (!s) {
+		print_error(__func__, "calloc() failed", errno);
+		return NULL;
+	}
+
+	s->f = fopen(path, is_mtx ? "r" : "rb");
+	if (!s->f) {
+		print_error(__func__, "failed to open matrix file", errno);
+		free(s);
+		return NULL;
+	}
+
+	shape->row_idx = NULL;
+	shape->col_ptr = NULL;
+	shape->bipartite = 0;
+	shape->vertex_ids = NULL;
+	shape->edge_mask = NULL;
+	shape->map = NULL;
+	shape->map_size = 0;
+	if (is_mtx ? open_edges_mtx(s, shape) : open_edges_bin(s, path, shape)) {
+		csc_close_edges(s);
+		return NULL;
+	}
+
+	s->nrows = shape->nrows;
+	s->ncols = shape->ncols;
+	s->remaining = shape->nnz;
+	return s;
+}
+
+/**
+ * @copydoc csc_read_edges()
+ */
+long
+csc_read_edges(CSCEdgeStream *s, uint32_t *row, uint32_t *col, size_t max)
+{
+	size_t count = 0;
+
+	while (count < max && s->remaining > 0) {
+		if (s->fc) {
+			/* Advance to the column holding the next entry */
+			while (s->pos == s->col_end) {
+				if (fread(&s->col_end, sizeof(uint32_t), 1, s->fc) != 1)
+					goto truncated;
+				s->col++;
+			}
+			if (fread(&row[count], sizeof(uint32_t), 1, s->f) != 1)
+				goto truncated;
+			col[count] = s->col;
+			s->pos++;
+			s->remaining--;
+		} else {
+			size_t i, j;
+			double val = 1.0;
+			int ok = s->is_pattern ? fscanf(s->f, "%zu %zu", &i, &j) == 2
+			                       : fscanf(s->f, "%zu %zu %lf", &i, &j, &val) == 3;
+			if (!ok)
+				goto truncated;
+			s->remaining--;
+			if (val == 0.0)
+				continue;
+			row[count] = (uint32_t)(i - 1);
+			col[count] = (uint32_t)(j - 1);
+		}
+
+		if (row[count] >= s->nrows || col[count] >= s->ncols) {
+			print_error(__func__, "entry out of range", 0);
+			return -1;
+		}
+		count++;
+	}
+
+	return (long)count;
+
+truncated:
+	print_error(__func__, "truncated matrix file", 0);
+	return -1;
+}
+
+/**
+ * @copydoc csc_edges_bytes()
+ */
+uint64_t
+csc_edges_bytes(const CSCEdgeStream *s)
+{
+	long bytes = ftell(s->f);
+	if (s->fc)  /* Header and column pointers, then the row indices read */
+		bytes = ftell(s->fc) + (bytes - s->base);
+	return bytes > 0 ? (uint64_t)bytes : 0;
+}
+
+/**
+ * @copydoc csc_close_edges()
+ */
+void
+csc_close_edges(CSCEdgeStream *s)
+{
+	if (!s)
+		return;
+	if (s->f)
+		fclose(s->f);
+	if (s->fc)
+		fclose(s->fc);
+	free(s);
+}
+
 /* ------------------------------------------------------------------------- */
 /*                           Public API Functions                             */
 /* ------------------------------------------------------------------------- */
@@ -378,18 +993,37 @@ ext_is(const char *filename, const char *ext)
  * Automatically dispatches to:
  * - csc_load_matrix_mtx() if the file ends in ".mtx"
  * - csc_load_matrix_mat() if the file ends in ".mat"
+ * - csc_load_matrix_bin() if the file ends in ".csc"
+ * - csc_load_edgelist() if the file ends in ".el"
+ *
+ * on a single thread (see csc_load_matrix_parallel()).
  *
  * @param path Path to the matrix file.
  * @return Newly allocated CSCBinaryMatrix, or NULL on failure.
  */
 CSCBinaryMatrix*
 csc_load_matrix(const char *path)
+{
+	return csc_load_matrix_parallel(path, 1);
+}
+
+/**
+ * @copydoc csc_load_matrix_parallel()
+ */
+CSCBinaryMatrix*
+csc_load_matrix_parallel(const char *path, unsigned int n_threads)
 {
 	if (ext_is(path, "mtx")) {
-		return csc_load_matrix_mtx(path);
+		return csc_load_matrix_mtx(path, n_threads);
 	}
 	else if (ext_is(path, "mat")) {
-		return csc_load_matrix_mat(path);
+		return csc_load_matrix_mat(path, n_threads);
+	}
+	else if (ext_is(path, "csc")) {
+		return csc_load_matrix_bin(path);
+	}
+	else if (ext_is(path, "el")) {
+		return csc_load_edgelist(path, n_threads);
 	} else {
 		print_error(__func__, "Unrecognized matrix file extention", 0);
 	}
@@ -397,6 +1031,175 @@ csc_load_matrix(const char *path)
 	return NULL;
 }
 
+/**
+ * @brief Save a matrix in the binary CSC cache format.
+ *
+ * @param m Matrix to save.
+ * @param path Destination path.
+ * @return 0 on success, 1 on error.
+ */
+int
+csc_save_matrix(const CSCBinaryMatrix *m, const char *path)
+{
+	CSCBinaryHeader h;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CSC_BINARY_MAGIC, sizeof(h.magic));
+	h.nrows = m->nrows;
+	h.ncols = m->ncols;
+	h.nnz   = m->nnz;
+
+	FILE *f = fopen(path, "wb");
+	if (!f) {
+		print_error(__func__, "failed to create .csc file", errno);
+		return 1;
+	}
+
+	if (fwrite(&h, sizeof(h), 1, f) != 1 ||
+	    fwrite(m->col_ptr, sizeof(uint32_t), m->ncols + 1, f) != m->ncols + 1 ||
+	    fwrite(m->row_idx, sizeof(uint32_t), m->nnz, f) != m->nnz)
+	{
+		print_error(__func__, "write failed", errno);
+		fclose(f);
+		remove(path);
+		return 1;
+	}
+
+	if (fclose(f) != 0) {
+		print_error(__func__, "fclose() failed", errno);
+		remove(path);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @copydoc csc_share_matrix()
+ */
+int
+csc_share_matrix(const CSCBinaryMatrix *m)
+{
+	CSCBinaryHeader h;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, CSC_BINARY_MAGIC, sizeof(h.magic));
+	h.nrows = m->nrows;
+	h.ncols = m->ncols;
+	h.nnz   = m->nnz;
+
+	const size_t cols = (m->ncols + 1) * sizeof(uint32_t);
+	const size_t rows = m->nnz * sizeof(uint32_t);
+	const size_t size = sizeof(h) + cols + rows;
+
+	/* The name only lives until the read-only descriptor is open */
+	char name[64];
+	snprintf(name, sizeof(name), "/cc-matrix-%ld", (long)getpid());
+
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+	if (fd < 0) {
+		print_error(__func__, "shm_open() failed", errno);
+		return -1;
+	}
+	int ro = shm_open(name, O_RDONLY, 0);
+	const int open_errno = errno;
+	shm_unlink(name);
+	if (ro < 0) {
+		print_error(__func__, "shm_open() failed", open_errno);
+		close(fd);
+		return -1;
+	}
+
+	if (ftruncate(fd, (off_t)size) != 0) {
+		print_error(__func__, "ftruncate() failed", errno);
+		goto fail;
+	}
+
+	char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		print_error(__func__, "mmap() failed", errno);
+		goto fail;
+	}
+	memcpy(map, &h, sizeof(h));
+	memcpy(map + sizeof(h), m->col_ptr, cols);
+	memcpy(map + sizeof(h) + cols, m->row_idx, rows);
+	munmap(map, size);
+	close(fd);
+
+	/* shm_open() sets close-on-exec; the children need the descriptor */
+	if (fcntl(ro, F_SETFD, 0) != 0) {
+		print_error(__func__, "fcntl() failed", errno);
+		close(ro);
+		return -1;
+	}
+	return ro;
+
+fail:
+	close(fd);
+	close(ro);
+	return -1;
+}
+
+/**
+ * @copydoc csc_map_matrix_fd()
+ */
+CSCBinaryMatrix*
+csc_map_matrix_fd(int fd)
+{
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		print_error(__func__, "fstat() failed", errno);
+		return NULL;
+	}
+
+	CSCBinaryHeader h;
+	const size_t size = (size_t)st.st_size;
+	if (size < sizeof(h)) {
+		print_error(__func__, "invalid binary CSC header", 0);
+		return NULL;
+	}
+
+	char *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		print_error(__func__, "mmap() failed", errno);
+		return NULL;
+	}
+
+	memcpy(&h, map, sizeof(h));
+	if (memcmp(h.magic, CSC_BINARY_MAGIC, sizeof(h.magic)) != 0) {
+		print_error(__func__, "invalid binary CSC header", 0);
+		munmap(map, size);
+		return NULL;
+	}
+	if (h.nnz > UINT32_MAX || h.nrows > UINT32_MAX || h.ncols > UINT32_MAX) {
+		print_error(__func__, "matrix exceeds 32-bit index range", 0);
+		munmap(map, size);
+		return NULL;
+	}
+	if (size != sizeof(h) + (h.ncols + 1 + h.nnz) * sizeof(uint32_t)) {
+		print_error(__func__, "truncated binary CSC file", 0);
+		munmap(map, size);
+		return NULL;
+	}
+
+	CSCBinaryMatrix *m = calloc(1, sizeof(CSCBinaryMatrix));
+	if (!m) {
+		print_error(__func__, "calloc() failed", errno);
+		munmap(map, size);
+		return NULL;
+	}
+
+	m->nrows = h.nrows;
+	m->ncols = h.ncols;
+	m->nnz   = h.nnz;
+	m->col_ptr = (uint32_t *)(map + sizeof(h));
+	m->row_idx = m->col_ptr + m->ncols + 1;
+	m->map = map;
+	m->map_size = size;
+
+	return m;
+}
+
 /**
  * @brief Free a CSCBinaryMatrix and its associated memory.
  *
@@ -410,6 +1213,13 @@ csc_free_matrix(CSCBinaryMatrix *m)
 	if (!m)
 		return;
 
+	/* The arrays of a mapped matrix live in the mapping */
+	if (m->map) {
+		munmap(m->map, m->map_size);
+		m->row_idx = NULL;
+		m->col_ptr = NULL;
+	}
+
 	if(m->row_idx){
 		free(m->row_idx);
 		m->row_idx = NULL;
@@ -420,6 +1230,9 @@ csc_free_matrix(CSCBinaryMatrix *m)
 		m->col_ptr = NULL;
 	}
 
+	free(m->vertex_ids);
+	free(m->edge_mask);
+
 	free(m);
 	m = NULL;
 }
@@ -24,11 +24,52 @@ typedef struct {
 	size_t nnz;         /**< Number of non-zero (1) entries */
 	uint32_t *row_idx;  /**< Row indices of non-zero elements (length nnz) */
 	uint32_t *col_ptr;  /**< Column pointers (length ncols + 1) */
+	int bipartite;      /**< Rows and columns are distinct vertices (see below) */
+	uint64_t *vertex_ids; /**< Original id of each vertex of a compacted edge list (length nrows), or NULL */
+	uint64_t *edge_mask;  /**< Edge subsets of each entry, one bit each (length nnz), or NULL */
+	void *map;            /**< Private mapping holding row_idx and col_ptr (see csc_map_matrix_fd()), or NULL */
+	size_t map_size;      /**< Bytes mapped at map */
 } CSCBinaryMatrix;
 
-/** @brief Load a sparse binary matrix from a .mat or .mtx file.
+/** @brief Number of edge subsets an edge mask can hold. */
+#define CSC_MAX_SUBSETS 64
+
+/*
+ * Vertex numbering
+ *
+ * By default the matrix is an adjacency matrix: row i and column i are the
+ * same vertex, and a rectangular matrix has max(nrows, ncols) vertices so
+ * that every index is in range. With `bipartite` set, rows and columns are
+ * the two sides of a bipartite graph sharing one label array: row r is
+ * vertex r and column c is vertex nrows + c.
+ */
+
+/**
+ * @brief Number of vertices (label array length) of a matrix.
+ */
+static inline size_t
+csc_num_vertices(const CSCBinaryMatrix *m)
+{
+	if (m->bipartite)
+		return m->nrows + m->ncols;
+	return m->nrows > m->ncols ? m->nrows : m->ncols;
+}
+
+/**
+ * @brief Vertex of column 0; column c is vertex csc_col_offset(m) + c.
+ */
+static inline size_t
+csc_col_offset(const CSCBinaryMatrix *m)
+{
+	return m->bipartite ? m->nrows : 0;
+}
+
+/** @brief Load a sparse binary matrix from a .mat, .mtx, .csc or .el file.
  *
- * Dispatches automatically based on file extension.
+ * Dispatches automatically based on file extension. The `.csc` extension
+ * denotes the binary cache format written by csc_save_matrix(), and `.el`
+ * a text edge list with sparse 64-bit vertex ids. Everything is loaded on
+ * one thread (see csc_load_matrix_parallel()).
  *
  * @param path Path to the matrix file.
  * @return Newly allocated CSCBinaryMatrix, or NULL on failure.
@@ -37,6 +78,101 @@ typedef struct {
  */
 CSCBinaryMatrix *csc_load_matrix(const char *path);
 
+/**
+ * @brief Load a sparse binary matrix, using several threads where possible.
+ *
+ * Same as csc_load_matrix(), except that coordinate Matrix Market files
+ * are parsed, edge lists compacted and MATLAB v7.3 files (with HDF5
+ * support) decompressed on @p n_threads threads.
+ *
+ * @param path Path to the matrix file.
+ * @param n_threads Number of threads.
+ * @return Newly allocated CSCBinaryMatrix, or NULL on failure.
+ */
+CSCBinaryMatrix *csc_load_matrix_parallel(const char *path, unsigned int n_threads);
+
+/**
+ * @brief Save a matrix in the binary CSC cache format.
+ *
+ * The file holds a fixed 64-byte header followed by the raw `col_ptr` and
+ * `row_idx` arrays, so it can be loaded back without any parsing. The
+ * `vertex_ids` and `edge_mask` of a compacted edge list are not saved.
+ *
+ * @param m Matrix to save.
+ * @param path Destination path (conventionally ending in ".csc").
+ * @return 0 on success, 1 on error.
+ */
+int csc_save_matrix(const CSCBinaryMatrix *m, const char *path);
+
+/**
+ * @brief Copy a matrix into an anonymous shared-memory segment.
+ *
+ * The segment holds the binary CSC cache layout (see csc_save_matrix()) and
+ * is returned as a read-only descriptor, without close-on-exec, so that
+ * child processes can map it with csc_map_matrix_fd() instead of loading
+ * the matrix again. The segment is freed once every descriptor and mapping
+ * of it is gone.
+ *
+ * @param m Matrix to share.
+ * @return Read-only descriptor of the segment, or -1 on error.
+ */
+int csc_share_matrix(const CSCBinaryMatrix *m);
+
+/**
+ * @brief Map a matrix in the binary CSC cache layout from a descriptor.
+ *
+ * The mapping is private and copy-on-write: the arrays are read straight
+ * from the segment, and in-place edits such as csc_reorder() stay local
+ * to the process. The descriptor is not closed.
+ *
+ * @param fd Descriptor from csc_share_matrix(), or of an open .csc file.
+ * @return Newly allocated CSCBinaryMatrix, or NULL on failure.
+ *
+ * @note The returned matrix must be freed using csc_free_matrix().
+ */
+CSCBinaryMatrix* csc_map_matrix_fd(int fd);
+
+/**
+ * @brief Opaque sequential reader of the non-zeros of a matrix file.
+ */
+typedef struct CSCEdgeStream CSCEdgeStream;
+
+/**
+ * @brief Open a matrix file for streaming its non-zeros.
+ *
+ * Only the header is read here; the entries are then read in batches with
+ * csc_read_edges(), so the matrix is never held in memory. Supported for
+ * `.csc` files and coordinate `.mtx` files. Symmetric Matrix Market
+ * entries are returned once, as stored, and explicit zeros are skipped.
+ *
+ * @param path Path to the matrix file.
+ * @param shape Output: dimensions and stored entry count of the matrix,
+ *              with `row_idx` and `col_ptr` set to NULL.
+ * @return Stream, or NULL on error.
+ */
+CSCEdgeStream *csc_open_edges(const char *path, CSCBinaryMatrix *shape);
+
+/**
+ * @brief Read the next batch of non-zeros from a stream.
+ *
+ * @param s Stream from csc_open_edges().
+ * @param row Output: 0-based row indices (at least @p max entries).
+ * @param col Output: 0-based column indices (at least @p max entries).
+ * @param max Batch size.
+ * @return Number of entries read (0 at the end), or -1 on error.
+ */
+long csc_read_edges(CSCEdgeStream *s, uint32_t *row, uint32_t *col, size_t max);
+
+/**
+ * @brief Bytes read from the file of a stream so far.
+ */
+uint64_t csc_edges_bytes(const CSCEdgeStream *s);
+
+/**
+ * @brief Close an edge stream. Safe to call with NULL.
+ */
+void csc_close_edges(CSCEdgeStream *s);
+
 /**
  * @brief Free a CSCBinaryMatrix and its associated memory.
  *
@@ -0,0 +1,278 @@
+/**
+ * @file memplan.c
+ * @brief Memory planning for runs under a memory limit.
+ *
+ * The per-format and per-variant costs below follow the allocations of
+ * the loaders in matrix.c and edgelist.c and of the algorithms, in bytes
+ * per entry and per vertex. They are meant to stay on the high side.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "memplan.h"
+#include "matrix.h"
+#include "mat73.h"
+#include "error.h"
+
+#define PLAN_READ_BLOCK  (1u << 20)  /* Bytes per read when counting lines */
+#define PLAN_EXT_SHARE   8           /* cc_external() gets 7/8 of what is left */
+#define PLAN_EXT_MIN     (1u << 20)  /* Smallest budget cc_external() accepts */
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static int
+has_ext(const char *path, const char *ext)
+{
+	const char *dot = strrchr(path, '.');
+	return dot && strcmp(dot + 1, ext) == 0;
+}
+
+/**
+ * @brief Peak resident memory of the process so far.
+ */
+static size_t
+resident_bytes(void)
+{
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+	return (size_t)usage.ru_maxrss * 1024;
+}
+
+/**
+ * @brief Reads the shape of a .mtx file from its header.
+ *
+ * Symmetric files count their mirrored entries, and array files every
+ * entry, as the loader could store them all.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+plan_mtx(const char *path, MemPlan *p, size_t *file_size)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		print_error(__func__, "failed to open .mtx file", errno);
+		return 1;
+	}
+
+	char format[64], field[64], symmetry[64];
+	int ok = fscanf(f, "%%%%MatrixMarket matrix %63s %63s %63s", format, field, symmetry) == 3;
+
+	/* Skip the comments before the size line */
+	int c;
+	while (ok && (c = fgetc(f)) != EOF) {
+		if (c == '%') {
+			while ((c = fgetc(f)) != '\n' && c != EOF);
+		} else if (c != '\n' && c != '\r' && c != ' ' && c != '\t') {
+			ungetc(c, f);
+			break;
+		}
+	}
+
+	const int coordinate = ok && strcmp(format, "coordinate") == 0;
+	if (coordinate)
+		ok = fscanf(f, "%zu %zu %zu", &p->nrows, &p->ncols, &p->nnz) == 3;
+	else if (ok)
+		ok = fscanf(f, "%zu %zu", &p->nrows, &p->ncols) == 2;
+
+	struct stat st;
+	if (ok && fstat(fileno(f), &st) == 0)
+		*file_size = (size_t)st.st_size;
+	fclose(f);
+
+	if (!ok) {
+		print_error(__func__, "invalid MatrixMarket header", 0);
+		return 1;
+	}
+
+	if (!coordinate)
+		p->nnz = p->nrows * p->ncols;
+	else if (strcmp(symmetry, "symmetric") == 0)
+		p->nnz *= 2;
+	p->streamable = coordinate;
+	return 0;
+}
+
+/**
+ * @brief Counts the lines of an edge list, an upper bound on its edges.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+plan_edgelist(const char *path, size_t *lines)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		print_error(__func__, "failed to open edge list", errno);
+		return 1;
+	}
+
+	char *block = malloc(PLAN_READ_BLOCK);
+	if (!block) {
+		print_error(__func__, "malloc() failed", errno);
+		fclose(f);
+		return 1;
+	}
+
+	size_t got, count = 0;
+	int last = '\n';
+	while ((got = fread(block, 1, PLAN_READ_BLOCK, f)) > 0) {
+		for (const char *q = block; (q = memchr(q, '\n', got - (size_t)(q - block))); q++)
+			count++;
+		last = block[got - 1];
+	}
+	int err = ferror(f);
+	fclose(f);
+	free(block);
+
+	if (err) {
+		print_error(__func__, "failed to read edge list", errno);
+		return 1;
+	}
+	*lines = count + (last != '\n');
+	return 0;
+}
+
+/**
+ * @brief Working memory of an algorithm variant.
+ *
+ * @param n Vertices
+ * @param nnz Entries
+ * @param seg Largest of the row and column counts
+ */
+static size_t
+algorithm_bytes(unsigned int variant, size_t n, size_t nnz, size_t nrows, size_t seg)
+{
+	switch (variant) {
+	case 1:
+		/* Union-find labels */
+		return 4 * n;
+	case 2:
+		/* Symmetric adjacency (8 per entry, 8 per vertex for the offsets),
+		 * the per-vertex arrays of a level (about 40 per vertex), and the
+		 * contraction of a cut of about 2 * beta of the edges: its hash table
+		 * and its adjacency (about 13 per entry) */
+		return 21 * nnz + 56 * n;
+	default:
+		/* Labels, two frontiers and the marks of the SpMV engine, its
+		 * cursors, and the CSR copy built for pulls */
+		return 13 * n + 4 * seg + 4 * (nrows + 1) + 4 * nnz;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc mem_strategy_name()
+ */
+const char *
+mem_strategy_name(MemStrategy s)
+{
+	return s == MEM_EXTERNAL ? "external" : "in-memory";
+}
+
+/**
+ * @copydoc mem_plan()
+ */
+int
+mem_plan(const char *path, int bipartite, unsigned int variant,
+         size_t budget, MemPlan *p)
+{
+	memset(p, 0, sizeof(*p));
+	p->budget = budget;
+	p->base = resident_bytes();
+
+	size_t file_size = 0, ids = 0;
+
+	if (has_ext(path, "csc")) {
+		CSCBinaryMatrix shape;
+		CSCEdgeStream *s = csc_open_edges(path, &shape);
+		if (!s)
+			return 1;
+		csc_close_edges(s);
+		p->nrows = shape.nrows;
+		p->ncols = shape.ncols;
+		p->nnz = shape.nnz;
+		p->streamable = 1;
+	} else if (has_ext(path, "mtx")) {
+		if (plan_mtx(path, p, &file_size))
+			return 1;
+	} else if (has_ext(path, "el")) {
+		size_t edges;
+		if (plan_edgelist(path, &edges))
+			return 1;
+		p->nnz = edges;
+		p->nrows = p->ncols = ids = 2 * edges;
+#if defined(CC_HAVE_HDF5)
+	} else if (has_ext(path, "mat") && csc_is_mat73(path)) {
+		CSCBinaryMatrix shape;
+		if (csc_shape_mat73(path, &shape))
+			return 1;
+		p->nrows = shape.nrows;
+		p->ncols = shape.ncols;
+		p->nnz = shape.nnz;
+#endif
+	} else {
+		/* matio decodes a whole variable to learn its entry count */
+		print_error(__func__, "memory budgets need a .csc, .mtx, .el or v7.3 .mat file (HDF5=1)", 0);
+		return 1;
+	}
+
+	const size_t n = bipartite ? p->nrows + p->ncols
+	                           : (p->nrows > p->ncols ? p->nrows : p->ncols);
+	const size_t seg = p->nrows > p->ncols ? p->nrows : p->ncols;
+
+	/* Loaded matrix: column pointers and row indices, plus the ids of an
+	 * edge list */
+	p->matrix = 4 * (p->ncols + 1) + 4 * p->nnz + 8 * ids;
+
+	if (has_ext(path, "el")) {
+		/* Edge arrays grown by doubling (up to 32 per edge), radix sort
+		 * keys and buffer (32), the mapped endpoints (8), then the matrix */
+		p->load_peak = 72 * p->nnz + p->matrix;
+	} else {
+		/* Read straight into place; a .mtx file is mapped while parsed,
+		 * and a v7.3 .mat file decompressed a chunk per thread at a time */
+		p->load_peak = p->matrix + file_size;
+	}
+
+	p->algorithm = algorithm_bytes(variant, n, p->nnz, p->nrows, seg);
+
+	const size_t running = p->matrix + p->algorithm;
+	p->in_memory = p->base + (p->load_peak > running ? p->load_peak : running);
+
+	if (p->in_memory <= budget) {
+		p->strategy = MEM_IN_MEMORY;
+		p->projected = p->in_memory;
+		return 0;
+	}
+
+	/* Streaming keeps the edges on disk; leave room for its buffers */
+	if (p->streamable && budget > p->base) {
+		p->ext_budget = (budget - p->base) / PLAN_EXT_SHARE * (PLAN_EXT_SHARE - 1);
+		if (p->ext_budget >= PLAN_EXT_MIN) {
+			p->strategy = MEM_EXTERNAL;
+			p->projected = p->base + p->ext_budget;
+			return 0;
+		}
+	}
+
+	char err[192];
+	snprintf(err, sizeof(err), "no strategy fits %.1f MiB: in memory needs about %.1f MiB%s",
+	         budget / (1024.0 * 1024.0), p->in_memory / (1024.0 * 1024.0),
+	         p->streamable ? "" : ", and this file cannot be streamed");
+	print_error(__func__, err, 0);
+	return 1;
+}
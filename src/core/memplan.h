@@ -0,0 +1,78 @@
+/**
+ * @file memplan.h
+ * @brief Memory planning for runs under a memory limit.
+ *
+ * Before anything large is allocated, the peak memory of each way of
+ * running is projected from the size of the input: loading the matrix
+ * (per file format) followed by the working memory of the algorithm
+ * variant, or streaming the edges through the external-memory engine
+ * (see cc_external()). The first strategy that fits the budget is chosen,
+ * so a run that would exceed a cgroup limit fails up front, or falls back
+ * to streaming, instead of being killed midway.
+ *
+ * The projections are upper estimates of the heap and of the mapped input
+ * (which counts towards the resident set), on top of what the process
+ * already holds when planning. The working memory of the low-diameter
+ * decomposition depends on the cut it finds, so its projection assumes a
+ * typical cut.
+ */
+
+#ifndef MEMPLAN_H
+#define MEMPLAN_H
+
+#include <stddef.h>
+
+/**
+ * @enum MemStrategy
+ * @brief Ways of running, in order of preference.
+ */
+typedef enum {
+	MEM_IN_MEMORY = 0,   /**< Load the matrix, run the chosen variant */
+	MEM_EXTERNAL,        /**< Stream the edges through cc_external() */
+} MemStrategy;
+
+/**
+ * @struct MemPlan
+ * @brief Projected memory use of a run, in bytes.
+ */
+typedef struct {
+	size_t budget;          /**< Memory budget */
+	size_t base;            /**< Already resident when planning */
+	size_t nrows;           /**< Projected shape (nnz includes mirrored entries) */
+	size_t ncols;
+	size_t nnz;
+	size_t load_peak;       /**< Peak while loading, loaded matrix included */
+	size_t matrix;          /**< Loaded matrix */
+	size_t algorithm;       /**< Working memory of the variant */
+	size_t in_memory;       /**< Projected peak in memory, base included */
+	int streamable;         /**< The file can be streamed by cc_external() */
+	MemStrategy strategy;   /**< Chosen strategy */
+	size_t projected;       /**< Projected peak of the chosen strategy */
+	size_t ext_budget;      /**< Budget given to cc_external(), if chosen */
+} MemPlan;
+
+/**
+ * @brief Name of a strategy ("in-memory" or "external").
+ */
+const char *mem_strategy_name(MemStrategy s);
+
+/**
+ * @brief Projects the memory of a run and picks a strategy that fits.
+ *
+ * Only the header of `.csc` and `.mtx` files is read, and the HDF5
+ * metadata of v7.3 `.mat` files (see csc_shape_mat73()); edge lists are
+ * scanned once to count their lines. Older `.mat` files, and v7.3 files
+ * without HDF5 support, go through matio, which only knows their shape
+ * once it has decoded them, so they cannot be planned.
+ *
+ * @param path Matrix file
+ * @param bipartite Rows and columns are distinct vertices (see matrix.h)
+ * @param variant Algorithm variant (see args.h)
+ * @param budget Memory budget in bytes
+ * @param plan Output: projections and the chosen strategy
+ * @return 0 if a strategy fits, 1 otherwise (reported with print_error())
+ */
+int mem_plan(const char *path, int bipartite, unsigned int variant,
+             size_t budget, MemPlan *plan);
+
+#endif /* MEMPLAN_H */
@@ -0,0 +1,290 @@
+/**
+ * @file omptool.c
+ * @brief OMPT tool measuring OpenMP runtime overheads of the OpenMP backend.
+ *
+ * Every OpenMP thread gets its own cache-line-sized slot when the runtime
+ * announces it, and only that thread writes to it, so the callbacks take
+ * no locks. A region's start time travels in its parallel_data, which the
+ * runtime hands to every callback of the region.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <string.h>
+
+#include "omptool.h"
+
+#if defined(CC_OMPT)
+
+#include <stdint.h>
+#include <time.h>
+#include <omp.h>
+#include <omp-tools.h>
+
+/**
+ * @brief Raw counters of one thread, in nanoseconds.
+ */
+typedef struct {
+	_Alignas(64) uint64_t fork_ns;
+	uint64_t wait_ns;
+	uint64_t join_ns;
+	uint64_t dispatches;
+	uint64_t regions;
+	uint64_t region_ns;
+	uint64_t wait_start;      /* Start of the barrier being waited in, or 0 */
+	uint64_t wait_end;        /* End of the last barrier wait */
+} Slot;
+
+static Slot slots[OMPTOOL_MAX_THREADS];
+static unsigned int n_slots;
+static _Thread_local Slot *self;
+
+static int started;           /* The runtime initialised the tool */
+static int active;            /* Callbacks record (see omptool_enable()) */
+static int has_dispatch;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Monotonic time in nanoseconds, never 0.
+ */
+static uint64_t
+now_ns(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec + 1;
+}
+
+static int
+recording(void)
+{
+	return self && __atomic_load_n(&active, __ATOMIC_RELAXED);
+}
+
+static int
+implicit_barrier(ompt_sync_region_t kind)
+{
+	return kind == ompt_sync_region_barrier_implicit ||
+	       kind == ompt_sync_region_barrier_implicit_workshare ||
+	       kind == ompt_sync_region_barrier_implicit_parallel;
+}
+
+static void
+on_thread_begin(ompt_thread_t type, ompt_data_t *thread_data)
+{
+	(void)type;
+	(void)thread_data;
+	unsigned int k = __atomic_fetch_add(&n_slots, 1, __ATOMIC_RELAXED);
+	self = k < OMPTOOL_MAX_THREADS ? &slots[k] : NULL;
+}
+
+static void
+on_parallel_begin(ompt_data_t *task_data, const ompt_frame_t *task_frame,
+                  ompt_data_t *parallel_data, unsigned int requested, int flags,
+                  const void *codeptr)
+{
+	(void)task_data;
+	(void)task_frame;
+	(void)requested;
+	(void)flags;
+	(void)codeptr;
+	parallel_data->value = recording() ? now_ns() : 0;
+}
+
+static void
+on_parallel_end(ompt_data_t *parallel_data, ompt_data_t *task_data, int flags,
+                const void *codeptr)
+{
+	(void)task_data;
+	(void)flags;
+	(void)codeptr;
+	const uint64_t start = parallel_data->value;
+	if (!start || !recording())
+		return;
+
+	const uint64_t now = now_ns();
+	self->regions++;
+	self->region_ns += now - start;
+	if (self->wait_end > start)
+		self->join_ns += now - self->wait_end;
+}
+
+static void
+on_implicit_task(ompt_scope_endpoint_t endpoint, ompt_data_t *parallel_data,
+                 ompt_data_t *task_data, unsigned int parallelism,
+                 unsigned int index, int flags)
+{
+	(void)task_data;
+	(void)parallelism;
+	(void)index;
+	if (endpoint != ompt_scope_begin || (flags & ompt_task_initial) ||
+	    !parallel_data || !parallel_data->value || !recording())
+		return;
+
+	self->fork_ns += now_ns() - parallel_data->value;
+}
+
+static void
+on_sync_region_wait(ompt_sync_region_t kind, ompt_scope_endpoint_t endpoint,
+                    ompt_data_t *parallel_data, ompt_data_t *task_data,
+                    const void *codeptr)
+{
+	(void)parallel_data;
+	(void)task_data;
+	(void)codeptr;
+	if (!implicit_barrier(kind) || !recording())
+		return;
+
+	const uint64_t now = now_ns();
+	if (endpoint == ompt_scope_begin) {
+		self->wait_start = now;
+	} else if (self->wait_start) {
+		self->wait_ns += now - self->wait_start;
+		self->wait_start = 0;
+		self->wait_end = now;
+	}
+}
+
+static void
+on_dispatch(ompt_data_t *parallel_data, ompt_data_t *task_data,
+            ompt_dispatch_t kind, ompt_data_t instance)
+{
+	(void)parallel_data;
+	(void)task_data;
+	(void)instance;
+	if (kind == ompt_dispatch_iteration && recording())
+		self->dispatches++;
+}
+
+static int
+tool_initialize(ompt_function_lookup_t lookup, int device, ompt_data_t *tool_data)
+{
+	(void)device;
+	(void)tool_data;
+	ompt_set_callback_t set = (ompt_set_callback_t)lookup("ompt_set_callback");
+	if (!set)
+		return 0;
+
+	set(ompt_callback_thread_begin, (ompt_callback_t)on_thread_begin);
+	set(ompt_callback_parallel_begin, (ompt_callback_t)on_parallel_begin);
+	set(ompt_callback_parallel_end, (ompt_callback_t)on_parallel_end);
+	set(ompt_callback_implicit_task, (ompt_callback_t)on_implicit_task);
+	set(ompt_callback_sync_region_wait, (ompt_callback_t)on_sync_region_wait);
+	has_dispatch = set(ompt_callback_dispatch, (ompt_callback_t)on_dispatch) >= ompt_set_sometimes;
+
+	started = 1;
+	return 1;
+}
+
+static void
+tool_finalize(ompt_data_t *tool_data)
+{
+	(void)tool_data;
+	__atomic_store_n(&active, 0, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Entry point looked up by the OpenMP runtime when it initialises.
+ */
+ompt_start_tool_result_t *
+ompt_start_tool(unsigned int omp_version, const char *runtime_version)
+{
+	static ompt_start_tool_result_t result = { tool_initialize, tool_finalize, { 0 } };
+	(void)omp_version;
+	(void)runtime_version;
+	return &result;
+}
+
+/**
+ * @copydoc omptool_enable()
+ */
+int
+omptool_enable(void)
+{
+	/* The runtime starts the tool on its first use */
+	(void)omp_get_max_threads();
+	if (!started)
+		return 1;
+
+	__atomic_store_n(&active, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+/**
+ * @copydoc omptool_reset()
+ */
+void
+omptool_reset(void)
+{
+	for (unsigned int k = 0; k < OMPTOOL_MAX_THREADS; k++) {
+		Slot *s = &slots[k];
+		s->fork_ns = s->wait_ns = s->join_ns = 0;
+		s->dispatches = s->regions = s->region_ns = 0;
+	}
+}
+
+/**
+ * @copydoc omptool_collect()
+ */
+int
+omptool_collect(OmptStats *out, unsigned int trials)
+{
+	if (!__atomic_load_n(&active, __ATOMIC_RELAXED))
+		return 0;
+
+	const double per = 1.0 / (trials ? trials : 1);
+	const unsigned int n = __atomic_load_n(&n_slots, __ATOMIC_RELAXED);
+
+	memset(out, 0, sizeof(*out));
+	out->has_dispatch = (unsigned int)has_dispatch;
+	out->n_threads = n < OMPTOOL_MAX_THREADS ? n : OMPTOOL_MAX_THREADS;
+	for (unsigned int k = 0; k < out->n_threads; k++) {
+		const Slot *s = &slots[k];
+		out->regions += s->regions * per;
+		out->region_s += s->region_ns * 1e-9 * per;
+		out->thread[k].fork_s = s->fork_ns * 1e-9 * per;
+		out->thread[k].barrier_wait_s = s->wait_ns * 1e-9 * per;
+		out->thread[k].join_s = s->join_ns * 1e-9 * per;
+		out->thread[k].dispatches = s->dispatches * per;
+	}
+	return 1;
+}
+
+#else
+
+/**
+ * @copydoc omptool_enable()
+ */
+int
+omptool_enable(void)
+{
+	return 1;
+}
+
+/**
+ * @copydoc omptool_reset()
+ */
+void
+omptool_reset(void)
+{
+}
+
+/**
+ * @copydoc omptool_collect()
+ */
+int
+omptool_collect(OmptStats *out, unsigned int trials)
+{
+	(void)out;
+	(void)trials;
+	return 0;
+}
+
+#endif
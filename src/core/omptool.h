@@ -0,0 +1,76 @@
+/**
+ * @file omptool.h
+ * @brief OMPT tool measuring OpenMP runtime overheads of the OpenMP backend.
+ *
+ * Built into the OpenMP backend with `make OMPT=1`, which defines CC_OMPT
+ * and links LLVM's libomp (GNU libgomp has no OMPT support). The runtime
+ * starts the tool when it initialises; its callbacks return at once until
+ * `--ompt` enables them, so an OMPT build without the flag times the same
+ * as a plain one apart from an indirect call per event.
+ *
+ * Per thread, it records:
+ *
+ * - fork: from the start of a parallel region until the thread begins its
+ *   implicit task, i.e. waking a pooled worker,
+ * - barrier wait: time spent waiting in implicit barriers, at the end of
+ *   worksharing loops and parallel regions,
+ * - join: from the end of the closing barrier until the region ends,
+ *   charged to the thread that forked the region,
+ * - dispatches: loop chunks (iterations in some runtimes) handed out by
+ *   the worksharing scheduler, where the runtime reports them.
+ *
+ * The sums cover the timed trials and are reported per trial.
+ */
+
+#ifndef OMPTOOL_H
+#define OMPTOOL_H
+
+/** @brief Threads reported separately; later threads are not recorded. */
+#define OMPTOOL_MAX_THREADS 64
+
+/**
+ * @struct OmptThreadStats
+ * @brief Runtime overheads seen by one OpenMP thread, per trial.
+ */
+typedef struct {
+	double fork_s;            /**< From region start to the thread's implicit task */
+	double barrier_wait_s;    /**< Waiting in implicit barriers */
+	double join_s;            /**< From the closing barrier to the region end (forking thread only) */
+	double dispatches;        /**< Loop chunks dispatched to the thread */
+} OmptThreadStats;
+
+/**
+ * @struct OmptStats
+ * @brief Runtime overheads of a run, per trial.
+ */
+typedef struct {
+	double regions;           /**< Parallel regions forked */
+	double region_s;          /**< Time from region start to end, summed over regions */
+	unsigned int has_dispatch;/**< The runtime reports loop chunk dispatches (reported as null otherwise) */
+	unsigned int n_threads;   /**< Threads recorded in thread[] */
+	OmptThreadStats thread[OMPTOOL_MAX_THREADS]; /**< By order of first appearance */
+} OmptStats;
+
+/**
+ * @brief Initialises the OpenMP runtime and starts recording.
+ *
+ * @return 0 on success, 1 if the tool is not built in (CC_OMPT) or the
+ *         runtime did not start it
+ */
+int omptool_enable(void);
+
+/**
+ * @brief Clears the recorded overheads, e.g. after the warm-up run.
+ */
+void omptool_reset(void);
+
+/**
+ * @brief Reports the recorded overheads, per trial.
+ *
+ * @param out Output statistics
+ * @param trials Trials the records cover
+ * @return 1 if @p out was filled, 0 if nothing was recorded
+ */
+int omptool_collect(OmptStats *out, unsigned int trials);
+
+#endif /* OMPTOOL_H */
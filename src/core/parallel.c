@@ -0,0 +1,118 @@
+/**
+ * @file parallel.c
+ * @brief Backend-neutral parallel loop implementation.
+ *
+ * Selected at compile time by the same definitions as the backends:
+ * - USE_OPENMP:   dynamically scheduled `omp for` over chunks
+ * - USE_CILK:     `cilk_for` over chunks
+ * - USE_PTHREADS: worker threads claiming chunks from an atomic counter
+ * - otherwise:    a single sequential call
+ */
+
+#include <stdint.h>
+
+#include "parallel.h"
+
+#if defined(USE_OPENMP)
+#include <omp.h>
+#elif defined(USE_CILK)
+#include <cilk/cilk.h>
+#elif defined(USE_PTHREADS)
+#include <pthread.h>
+#include <stdatomic.h>
+#endif
+
+#define PARALLEL_DEFAULT_GRAIN 4096
+
+#if defined(USE_PTHREADS)
+
+/**
+ * @struct parallel_args_t
+ * @brief Shared state of the Pthreads workers of one parallel_for() call.
+ */
+typedef struct {
+	parallel_body_t body;    /* Loop body */
+	void *ctx;               /* Body context */
+	size_t n;                /* Number of indices */
+	size_t grain;            /* Indices per chunk */
+	atomic_size_t next;      /* Next unclaimed index */
+} parallel_args_t;
+
+/**
+ * @brief Claims chunks until the range is exhausted.
+ */
+static void *
+parallel_worker(void *arg)
+{
+	parallel_args_t *args = arg;
+
+	for (;;) {
+		size_t begin = atomic_fetch_add(&args->next, args->grain);
+		if (begin >= args->n)
+			break;
+		size_t end = begin + args->grain < args->n ? begin + args->grain : args->n;
+		args->body(args->ctx, begin, end);
+	}
+
+	return NULL;
+}
+
+#endif
+
+/**
+ * @copydoc parallel_for()
+ */
+void
+parallel_for(size_t n, size_t grain, unsigned int n_threads,
+             parallel_body_t body, void *ctx)
+{
+	if (n == 0)
+		return;
+	if (grain == 0)
+		grain = PARALLEL_DEFAULT_GRAIN;
+
+	const size_t n_chunks = (n + grain - 1) / grain;
+
+	/* A single chunk (or thread) is not worth waking the workers for */
+#if defined(USE_CILK)
+	(void)n_threads;  /* The runtime chooses the number of workers */
+	if (n_chunks == 1) {
+#else
+	if (n_chunks == 1 || n_threads <= 1) {
+#endif
+		body(ctx, 0, n);
+		return;
+	}
+
+#if defined(USE_OPENMP)
+	#pragma omp parallel for num_threads(n_threads) schedule(dynamic, 1)
+	for (size_t c = 0; c < n_chunks; c++) {
+		size_t end = (c + 1) * grain < n ? (c + 1) * grain : n;
+		body(ctx, c * grain, end);
+	}
+#elif defined(USE_CILK)
+	cilk_for (size_t c = 0; c < n_chunks; c++) {
+		size_t end = (c + 1) * grain < n ? (c + 1) * grain : n;
+		body(ctx, c * grain, end);
+	}
+#elif defined(USE_PTHREADS)
+	if (n_threads > n_chunks)
+		n_threads = (unsigned int)n_chunks;
+
+	parallel_args_t args = { .body = body, .ctx = ctx, .n = n, .grain = grain };
+	atomic_init(&args.next, 0);
+
+	/* The calling thread is the last worker */
+	pthread_t threads[n_threads - 1];
+	unsigned int started = 0;
+	for (; started < n_threads - 1; started++)
+		if (pthread_create(&threads[started], NULL, parallel_worker, &args) != 0)
+			break;  /* Fewer threads only slow the loop down */
+
+	parallel_worker(&args);
+	for (unsigned int i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+#else
+	body(ctx, 0, n);
+#endif
+}
@@ -0,0 +1,40 @@
+/**
+ * @file parallel.h
+ * @brief Backend-neutral parallel loop used by the core modules.
+ *
+ * The core sources are compiled once per backend, so the same loop runs on
+ * OpenMP, Pthreads, OpenCilk or sequentially depending on which of
+ * USE_OPENMP, USE_PTHREADS, USE_CILK or USE_SEQUENTIAL is defined.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+/**
+ * @brief Loop body run on the half-open range [begin, end).
+ *
+ * @param ctx Caller context passed through parallel_for()
+ * @param begin First index of the chunk
+ * @param end One past the last index of the chunk
+ */
+typedef void (*parallel_body_t)(void *ctx, size_t begin, size_t end);
+
+/**
+ * @brief Runs body over [0, n) in chunks of grain indices.
+ *
+ * Chunks are handed out dynamically, so bodies with uneven work per index
+ * (e.g. graph columns of varying degree) stay balanced. Returns once every
+ * chunk has completed.
+ *
+ * @param n Number of indices
+ * @param grain Indices per chunk (0 selects a default)
+ * @param n_threads Number of threads (ignored by the Cilk and sequential builds)
+ * @param body Loop body
+ * @param ctx Context passed to body
+ */
+void parallel_for(size_t n, size_t grain, unsigned int n_threads,
+                  parallel_body_t body, void *ctx);
+
+#endif /* PARALLEL_H */
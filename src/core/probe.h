@@ -0,0 +1,133 @@
+/**
+ * @file probe.h
+ * @brief USDT static tracepoints for production tracing.
+ *
+ * CC_PROBE*() marks a point in the code as a SystemTap/USDT probe of the
+ * `cc` provider. A probe compiles to a single `nop` plus an entry in the
+ * `.note.stapsdt` ELF section naming it and describing where its arguments
+ * live, so it costs next to nothing until a tracer attaches:
+ *
+ *     bpftrace -e 'usdt:bin/connected_components_openmp:cc:lp__iteration
+ *                  { printf("%d %d\n", arg0, arg1); }'
+ *     perf buildid-cache --add bin/connected_components_openmp
+ *     perf probe sdt_cc:union__retry
+ *
+ * Probes:
+ * - `phase__start(name)`, `phase__end(name)`: algorithm phase boundaries,
+ *   also measured by Cilkscale in the instrumented build (see workspan.h)
+ * - `lp__iteration(iteration, changed, sparse)`: end of a propagation pass
+ * - `lp__done(iterations)`: label propagation converged
+ * - `union__retry(a, b)`: a union lost its compare-and-swap race and looks
+ *   the roots of a and b up again
+ *
+ * `<sys/sdt.h>` is used when available. Otherwise, on x86-64 and AArch64
+ * with GCC or Clang, an equivalent note is emitted here. Elsewhere, or with
+ * `-DCC_NO_PROBES`, the probes compile to nothing. Arguments must be
+ * integers; pointers are passed as uintptr_t.
+ */
+
+#ifndef PROBE_H
+#define PROBE_H
+
+#include <stdint.h>
+
+#include "workspan.h"
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define CC_HAVE_SYS_SDT_H
+#endif
+#endif
+
+#if defined(CC_NO_PROBES)
+
+#define CC_PROBE_ENABLED 0
+
+#elif defined(CC_HAVE_SYS_SDT_H)
+
+#include <sys/sdt.h>
+#define CC_PROBE_ENABLED 1
+#define CC_PROBE0(name)             DTRACE_PROBE(cc, name)
+#define CC_PROBE1(name, a)          DTRACE_PROBE1(cc, name, a)
+#define CC_PROBE2(name, a, b)       DTRACE_PROBE2(cc, name, a, b)
+#define CC_PROBE3(name, a, b, c)    DTRACE_PROBE3(cc, name, a, b, c)
+
+#elif (defined(__x86_64__) || defined(__aarch64__)) && defined(__GNUC__)
+
+#define CC_PROBE_ENABLED 1
+
+/*
+ * Same layout as sys/sdt.h (note type 3, version 3): probe address, base
+ * address for prelink adjustment, semaphore (none), provider, name and an
+ * argument string of `size@operand` pairs, where a negative size marks a
+ * signed argument. `%c` prints the size without immediate punctuation.
+ */
+#define CC_PROBE_ARG(i, x)                                                    \
+	[s##i] "n" ((((__typeof__(x))-1) < 1 ? -1 : 1) * (int)sizeof(x)),    \
+	[a##i] "nor" (x)
+#define CC_PROBE_FMT(i)   "%c[s" #i "]@%[a" #i "]"
+
+#define CC_PROBE_ASM(name, args, ...)                                         \
+	__asm__ __volatile__(                                                 \
+		"990: nop\n"                                                  \
+		".pushsection .note.stapsdt,\"?\",\"note\"\n"                 \
+		".balign 4\n"                                                 \
+		".4byte 992f-991f, 994f-993f, 3\n"                            \
+		"991: .asciz \"stapsdt\"\n"                                   \
+		"992: .balign 4\n"                                            \
+		"993: .8byte 990b\n"                                          \
+		".8byte _.stapsdt.base\n"                                     \
+		".8byte 0\n"                                                  \
+		".asciz \"cc\"\n"                                             \
+		".asciz \"" #name "\"\n"                                      \
+		".asciz \"" args "\"\n"                                       \
+		"994: .balign 4\n"                                            \
+		".popsection\n"                                               \
+		".ifndef _.stapsdt.base\n"                                    \
+		".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+		".weak _.stapsdt.base\n"                                      \
+		".hidden _.stapsdt.base\n"                                    \
+		"_.stapsdt.base: .space 1\n"                                  \
+		".size _.stapsdt.base, 1\n"                                   \
+		".popsection\n"                                               \
+		".endif\n"                                                    \
+		:: __VA_ARGS__)
+
+#define CC_PROBE0(name)                                                       \
+	CC_PROBE_ASM(name, "", )
+#define CC_PROBE1(name, a)                                                    \
+	CC_PROBE_ASM(name, CC_PROBE_FMT(1), CC_PROBE_ARG(1, a))
+#define CC_PROBE2(name, a, b)                                                 \
+	CC_PROBE_ASM(name, CC_PROBE_FMT(1) " " CC_PROBE_FMT(2),               \
+	             CC_PROBE_ARG(1, a), CC_PROBE_ARG(2, b))
+#define CC_PROBE3(name, a, b, c)                                              \
+	CC_PROBE_ASM(name, CC_PROBE_FMT(1) " " CC_PROBE_FMT(2) " " CC_PROBE_FMT(3), \
+	             CC_PROBE_ARG(1, a), CC_PROBE_ARG(2, b), CC_PROBE_ARG(3, c))
+
+#else
+
+#define CC_PROBE_ENABLED 0
+
+#endif
+
+#if !CC_PROBE_ENABLED
+#define CC_PROBE0(name)             ((void)0)
+#define CC_PROBE1(name, a)          ((void)(a))
+#define CC_PROBE2(name, a, b)       ((void)(a), (void)(b))
+#define CC_PROBE3(name, a, b, c)    ((void)(a), (void)(b), (void)(c))
+#endif
+
+/* Phase boundaries, named by a string literal; the Cilkscale build also
+ * measures their work and span (see workspan.h) */
+#define CC_PROBE_PHASE_START(phase)                                           \
+	do {                                                                  \
+		CC_PROBE1(phase__start, (uintptr_t)(phase));                  \
+		CC_WORKSPAN_START(phase);                                     \
+	} while (0)
+#define CC_PROBE_PHASE_END(phase)                                             \
+	do {                                                                  \
+		CC_WORKSPAN_END(phase);                                       \
+		CC_PROBE1(phase__end, (uintptr_t)(phase));                    \
+	} while (0)
+
+#endif /* PROBE_H */
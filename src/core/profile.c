@@ -0,0 +1,363 @@
+/**
+ * @file profile.c
+ * @brief Parallel graph profiling.
+ *
+ * The streaming pass gives every chunk of columns its own partial sums,
+ * which are reduced in chunk order afterwards, so the profile does not
+ * depend on the schedule. Duplicates are found by comparing neighbours in
+ * each column, after sorting a scratch copy of the columns stored out of
+ * order.
+ *
+ * Each breadth-first sweep keeps, per vertex, the bits of the searches
+ * that have reached it: `visited` is updated by the SpMSpV push from the
+ * frontier, while the pushed values come from `settled`, which lags one
+ * level behind. Every search thus advances exactly one level per pass.
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile.h"
+#include "parallel.h"
+#include "spmv.h"
+#include "error.h"
+
+#define PROFILE_GRAIN    4096   /* Columns per chunk */
+#define PROFILE_SOURCES  32     /* Searches per sweep, one per bit */
+
+/**
+ * @struct ChunkSums
+ * @brief Partial results of one chunk of columns.
+ */
+typedef struct {
+	uint32_t degree_min;
+	uint32_t degree_max;
+	double sum1, sum2, sum3;    /* Sums of degree, degree^2 and degree^3 */
+	size_t empty_cols;
+	size_t self_loops;
+	size_t duplicates;
+	uint64_t hash;              /* Sum of the hashes of the entries */
+	uint64_t hash_t;            /* Same, for the transposed entries */
+	int failed;
+} ChunkSums;
+
+/**
+ * @struct ProfileCtx
+ * @brief State shared by the parallel passes of one profile.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;
+	ChunkSums *chunks;
+
+	/* Breadth-first sweeps */
+	uint32_t *visited;          /* Searches that reached each vertex */
+	uint32_t *settled;          /* Same, as of the previous level */
+	const SpmvFrontier *reached;/* Vertices reached by the last pass */
+	uint32_t level_bits;        /* Searches that advanced this level */
+	uint32_t far[PROFILE_SOURCES]; /* Last vertex reached by each search */
+} ProfileCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Hash of an entry (splitmix64 finaliser of row and column).
+ */
+static inline uint64_t
+entry_hash(uint64_t row, uint64_t col)
+{
+	uint64_t z = (row << 32 | col) + 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static int
+cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Counts the entries of a column equal to an earlier one.
+ *
+ * @param scratch Buffer of at least @p len entries, grown as needed
+ * @return Number of duplicates, or (size_t)-1 on allocation failure
+ */
+static size_t
+column_duplicates(const uint32_t *rows, size_t len, uint32_t **scratch, size_t *cap)
+{
+	size_t k = 1;
+	while (k < len && rows[k - 1] < rows[k])
+		k++;
+	if (k >= len)
+		return 0;
+
+	/* Out of order or repeated: sort a copy */
+	if (*cap < len) {
+		uint32_t *buf = realloc(*scratch, len * sizeof(uint32_t));
+		if (!buf)
+			return (size_t)-1;
+		*scratch = buf;
+		*cap = len;
+	}
+	memcpy(*scratch, rows, len * sizeof(uint32_t));
+	qsort(*scratch, len, sizeof(uint32_t), cmp_u32);
+
+	size_t dups = 0;
+	for (size_t i = 1; i < len; i++)
+		dups += ((*scratch)[i] == (*scratch)[i - 1]);
+	return dups;
+}
+
+static void
+profile_columns(void *arg, size_t begin, size_t end)
+{
+	ProfileCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	uint32_t *scratch = NULL;
+	size_t cap = 0;
+
+	for (size_t cb = begin; cb < end; cb += PROFILE_GRAIN) {
+		size_t ce = cb + PROFILE_GRAIN < end ? cb + PROFILE_GRAIN : end;
+		ChunkSums *s = &c->chunks[cb / PROFILE_GRAIN];
+		s->degree_min = UINT32_MAX;
+
+		for (size_t j = cb; j < ce; j++) {
+			const uint32_t *rows = m->row_idx + m->col_ptr[j];
+			const uint32_t d = m->col_ptr[j + 1] - m->col_ptr[j];
+			const double dd = d;
+
+			if (d < s->degree_min)
+				s->degree_min = d;
+			if (d > s->degree_max)
+				s->degree_max = d;
+			s->sum1 += dd;
+			s->sum2 += dd * dd;
+			s->sum3 += dd * dd * dd;
+			s->empty_cols += (d == 0);
+
+			for (uint32_t k = 0; k < d; k++) {
+				s->self_loops += (!m->bipartite && rows[k] == j);
+				s->hash += entry_hash(rows[k], j);
+				s->hash_t += entry_hash(j, rows[k]);
+			}
+
+			size_t dups = column_duplicates(rows, d, &scratch, &cap);
+			if (dups == (size_t)-1)
+				s->failed = 1;
+			else
+				s->duplicates += dups;
+		}
+	}
+
+	free(scratch);
+}
+
+/**
+ * @brief Records the searches that reached each vertex of the last pass.
+ */
+static void
+settle_level(void *arg, size_t begin, size_t end)
+{
+	ProfileCtx *c = arg;
+	uint32_t bits = 0;
+
+	for (size_t k = begin; k < end; k++) {
+		const uint32_t v = c->reached->idx[k];
+		uint32_t fresh = c->visited[v] & ~c->settled[v];
+		c->settled[v] = c->visited[v];
+		bits |= fresh;
+		for (; fresh; fresh &= fresh - 1)
+			__atomic_store_n(&c->far[__builtin_ctz(fresh)], v, __ATOMIC_RELAXED);
+	}
+
+	__atomic_fetch_or(&c->level_bits, bits, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Runs one search from each source at once.
+ *
+ * On return c->far[b] is a vertex farthest from source b.
+ *
+ * @return Largest eccentricity of the sources, or -1 on allocation failure
+ */
+static long
+bfs_sweep(ProfileCtx *c, SpmvEngine *e, unsigned int n_threads,
+          const uint32_t *sources, unsigned int n_sources,
+          SpmvFrontier *cur, SpmvFrontier *next)
+{
+	const size_t n = spmv_num_vertices(e);
+	memset(c->visited, 0, n * sizeof(uint32_t));
+	memset(c->settled, 0, n * sizeof(uint32_t));
+
+	cur->len = 0;
+	for (unsigned int b = 0; b < n_sources; b++) {
+		const uint32_t v = sources[b];
+		if (!c->visited[v])
+			cur->idx[cur->len++] = v;
+		c->visited[v] |= 1u << b;
+		c->settled[v] = c->visited[v];
+		c->far[b] = v;
+	}
+
+	long ecc = 0;
+	for (long level = 1; cur->len > 0; level++) {
+		if (spmv_sparse(e, SPMV_OR_AND, SPMV_BOTH, c->settled, cur, c->visited, next) < 0)
+			return -1;
+
+		c->reached = next;
+		c->level_bits = 0;
+		parallel_for(next->len, 0, n_threads, settle_level, c);
+		if (c->level_bits)
+			ecc = level;
+
+		SpmvFrontier tmp = *cur;
+		*cur = *next;
+		*next = tmp;
+	}
+
+	return ecc;
+}
+
+/**
+ * @brief Picks up to PROFILE_SOURCES non-empty columns spread over the matrix.
+ *
+ * @return Number of sources
+ */
+static unsigned int
+pick_sources(const CSCBinaryMatrix *m, uint32_t *sources)
+{
+	unsigned int k = 0;
+	size_t next = 0;
+
+	for (unsigned int b = 0; b < PROFILE_SOURCES; b++) {
+		size_t j = b * m->ncols / PROFILE_SOURCES;
+		if (j < next)
+			j = next;
+		while (j < m->ncols && m->col_ptr[j] == m->col_ptr[j + 1])
+			j++;
+		if (j >= m->ncols)
+			break;
+		sources[k++] = (uint32_t)(csc_col_offset(m) + j);
+		next = j + 1;
+	}
+
+	return k;
+}
+
+/**
+ * @brief Estimates the diameter by a double sweep.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+estimate_diameter(const CSCBinaryMatrix *m, unsigned int n_threads, GraphProfile *p)
+{
+	uint32_t sources[PROFILE_SOURCES];
+	unsigned int n_sources = pick_sources(m, sources);
+	if (n_sources == 0)
+		return 0;
+
+	ProfileCtx c = { .m = m };
+	SpmvFrontier cur = { NULL, 0 }, next = { NULL, 0 };
+	int ret = 1;
+
+	SpmvEngine *e = spmv_init(m, n_threads);
+	if (!e)
+		return 1;
+	const size_t n = spmv_num_vertices(e);
+	c.visited = malloc(n * sizeof(uint32_t));
+	c.settled = malloc(n * sizeof(uint32_t));
+	if (!c.visited || !c.settled) {
+		print_error(__func__, "malloc() failed", errno);
+		goto out;
+	}
+	if (spmv_frontier_init(e, &cur) || spmv_frontier_init(e, &next))
+		goto out;
+
+	/* Then again from the farthest vertices of the first sweep */
+	for (int sweep = 0; sweep < 2; sweep++) {
+		long ecc = bfs_sweep(&c, e, n_threads, sources, n_sources, &cur, &next);
+		if (ecc < 0)
+			goto out;
+		if ((unsigned long)ecc > p->diameter_estimate)
+			p->diameter_estimate = (unsigned int)ecc;
+		p->bfs_sources += n_sources;
+		memcpy(sources, c.far, n_sources * sizeof(uint32_t));
+	}
+	ret = 0;
+
+out:
+	spmv_frontier_free(&cur);
+	spmv_frontier_free(&next);
+	free(c.visited);
+	free(c.settled);
+	spmv_free(e);
+	return ret;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc csc_profile()
+ */
+int
+csc_profile(const CSCBinaryMatrix *m, unsigned int n_threads, GraphProfile *p)
+{
+	memset(p, 0, sizeof(*p));
+
+	const size_t n_chunks = (m->ncols + PROFILE_GRAIN - 1) / PROFILE_GRAIN;
+	ProfileCtx c = { .m = m };
+	c.chunks = calloc(n_chunks ? n_chunks : 1, sizeof(ChunkSums));
+	if (!c.chunks) {
+		print_error(__func__, "calloc() failed", errno);
+		return 1;
+	}
+
+	parallel_for(m->ncols, PROFILE_GRAIN, n_threads, profile_columns, &c);
+
+	double sum1 = 0.0, sum2 = 0.0, sum3 = 0.0;
+	uint64_t hash = 0, hash_t = 0;
+	p->degree_min = m->ncols ? UINT32_MAX : 0;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		const ChunkSums *s = &c.chunks[ch];
+		if (s->failed) {
+			print_error(__func__, "malloc() failed", ENOMEM);
+			free(c.chunks);
+			return 1;
+		}
+		if (s->degree_min < p->degree_min)
+			p->degree_min = s->degree_min;
+		if (s->degree_max > p->degree_max)
+			p->degree_max = s->degree_max;
+		sum1 += s->sum1;
+		sum2 += s->sum2;
+		sum3 += s->sum3;
+		p->empty_cols += s->empty_cols;
+		p->self_loops += s->self_loops;
+		p->duplicates += s->duplicates;
+		hash += s->hash;
+		hash_t += s->hash_t;
+	}
+	free(c.chunks);
+
+	if (m->ncols) {
+		const double mean = sum1 / m->ncols;
+		const double var = sum2 / m->ncols - mean * mean;
+		p->degree_mean = mean;
+		if (var > 0.0) {
+			const double third = sum3 / m->ncols - 3.0 * mean * var - mean * mean * mean;
+			p->degree_skew = third / (var * sqrt(var));
+		}
+	}
+	p->symmetric = !m->bipartite && m->nrows == m->ncols && hash == hash_t;
+
+	return estimate_diameter(m, n_threads, p);
+}
@@ -0,0 +1,54 @@
+/**
+ * @file profile.h
+ * @brief Structural profile of a loaded graph.
+ *
+ * Computed on request from the loaded CSC arrays, in one parallel
+ * streaming pass over the columns plus a few breadth-first sweeps on the
+ * SpMV engine. The sweeps run 32 searches at once, one per bit of the
+ * or-and semiring, and start a second time from the farthest vertices the
+ * first one found (a double sweep), so the diameter estimate is a lower
+ * bound that is usually tight.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * @struct GraphProfile
+ * @brief Degree distribution and structural properties of a graph.
+ *
+ * Degrees are the number of entries of each column.
+ */
+typedef struct {
+	unsigned int degree_min;        /**< Smallest column degree */
+	unsigned int degree_max;        /**< Largest column degree */
+	double degree_mean;             /**< Mean column degree */
+	double degree_skew;             /**< Skewness of the column degrees (0 if all equal) */
+	unsigned int empty_cols;        /**< Columns without entries */
+	unsigned int self_loops;        /**< Entries on the diagonal (none if bipartite) */
+	unsigned int duplicates;        /**< Entries repeating an earlier one of their column */
+	unsigned int symmetric;         /**< Square, not bipartite, and equal to its transpose */
+	unsigned int diameter_estimate; /**< Largest eccentricity seen by the sweeps */
+	unsigned int bfs_sources;       /**< Breadth-first searches run for the estimate */
+} GraphProfile;
+
+/**
+ * @brief Profiles a matrix.
+ *
+ * Symmetry is decided by comparing order-independent 64-bit hashes of the
+ * entries and of the transposed entries, so a non-symmetric matrix is
+ * reported symmetric with probability about 2^-64.
+ *
+ * @param m Input matrix (its vertex numbering, including `bipartite`, is used)
+ * @param n_threads Number of threads
+ * @param p Output: profile
+ * @return 0 on success, 1 on allocation failure
+ */
+int csc_profile(const CSCBinaryMatrix *m, unsigned int n_threads, GraphProfile *p);
+
+#endif /* PROFILE_H */
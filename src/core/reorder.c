@@ -0,0 +1,346 @@
+/**
+ * @file reorder.c
+ * @brief Seeded reordering of a loaded graph.
+ *
+ * Renumbering goes through a fresh copy of the CSC arrays: the new column
+ * pointers are the old degrees at the permuted positions, and each column
+ * is then copied whole to its new place with its rows renumbered. Columns
+ * are shuffled in place with a generator seeded by the seed and the column
+ * index, and the hub order swaps the hub's entries forward in place.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "reorder.h"
+#include "parallel.h"
+#include "error.h"
+
+#define REORDER_GRAIN  4096  /* Columns per chunk */
+#define PERM_ROUNDS    4     /* Feistel rounds */
+
+/**
+ * @struct Perm
+ * @brief Seeded permutation of 0 .. n-1.
+ */
+typedef struct {
+	uint64_t n;
+	unsigned int half;          /* Bits of each Feistel half */
+	uint64_t mask;              /* (1 << half) - 1 */
+	uint64_t key[PERM_ROUNDS];
+} Perm;
+
+/**
+ * @struct ReorderCtx
+ * @brief State shared by the parallel passes of one reordering.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;
+	uint64_t seed;
+	Perm cols;                  /* New position of each column */
+	Perm rows;                  /* New id of each row */
+	int renumber_rows;
+
+	/* Renumbered copy */
+	uint32_t *col_ptr;
+	uint32_t *row_idx;
+	uint64_t *edge_mask;
+	uint64_t *vertex_ids;
+
+	/* Hub order */
+	uint32_t *row_count;
+	uint32_t hub;
+} ReorderCtx;
+
+static const char *const order_names[] = {
+	[CSC_ORDER_FILE] = "file",
+	[CSC_ORDER_COLS] = "cols",
+	[CSC_ORDER_IDS]  = "ids",
+	[CSC_ORDER_ROWS] = "rows",
+	[CSC_ORDER_HUB]  = "hub",
+};
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief splitmix64 finaliser.
+ */
+static inline uint64_t
+mix64(uint64_t z)
+{
+	z += 0x9e3779b97f4a7c15ULL;
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+static void
+perm_init(Perm *p, uint64_t n, uint64_t seed)
+{
+	unsigned int bits = 2;
+	while (bits < 64 && ((uint64_t)1 << bits) < n)
+		bits += 2;
+
+	p->n = n;
+	p->half = bits / 2;
+	p->mask = ((uint64_t)1 << p->half) - 1;
+	for (int r = 0; r < PERM_ROUNDS; r++)
+		p->key[r] = mix64(seed * PERM_ROUNDS + (uint64_t)r);
+}
+
+/**
+ * @brief Image of @p x under the permutation.
+ *
+ * The Feistel network permutes 0 .. 4^half - 1, at most four times n
+ * values. Applying it again until the value falls below n (cycle walking)
+ * keeps it a permutation of 0 .. n-1.
+ */
+static inline uint64_t
+perm_apply(const Perm *p, uint64_t x)
+{
+	do {
+		uint64_t l = x >> p->half, r = x & p->mask;
+		for (int k = 0; k < PERM_ROUNDS; k++) {
+			uint64_t t = l ^ (mix64(r ^ p->key[k]) & p->mask);
+			l = r;
+			r = t;
+		}
+		x = l << p->half | r;
+	} while (x >= p->n);
+
+	return x;
+}
+
+static void
+place_cols(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	for (size_t j = begin; j < end; j++)
+		c->col_ptr[perm_apply(&c->cols, j) + 1] = c->m->col_ptr[j + 1] - c->m->col_ptr[j];
+}
+
+static void
+copy_cols(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		const uint32_t src = m->col_ptr[j], len = m->col_ptr[j + 1] - src;
+		const uint32_t dst = c->col_ptr[perm_apply(&c->cols, j)];
+
+		if (c->renumber_rows) {
+			for (uint32_t k = 0; k < len; k++)
+				c->row_idx[dst + k] = (uint32_t)perm_apply(&c->rows, m->row_idx[src + k]);
+		} else {
+			memcpy(c->row_idx + dst, m->row_idx + src, len * sizeof(uint32_t));
+		}
+		if (c->edge_mask)
+			memcpy(c->edge_mask + dst, m->edge_mask + src, len * sizeof(uint64_t));
+	}
+}
+
+static void
+copy_ids(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->vertex_ids[perm_apply(&c->cols, v)] = c->m->vertex_ids[v];
+}
+
+/**
+ * @brief Fisher-Yates shuffle of each column, seeded by its index.
+ */
+static void
+shuffle_cols(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		uint32_t *rows = m->row_idx + m->col_ptr[j];
+		uint64_t *mask = m->edge_mask ? m->edge_mask + m->col_ptr[j] : NULL;
+		uint64_t state = mix64(c->seed ^ mix64(j));
+
+		for (uint32_t k = m->col_ptr[j + 1] - m->col_ptr[j]; k > 1; k--) {
+			state = mix64(state);
+			const uint32_t r = (uint32_t)(state % k);
+			uint32_t t = rows[k - 1];
+			rows[k - 1] = rows[r];
+			rows[r] = t;
+			if (mask) {
+				uint64_t b = mask[k - 1];
+				mask[k - 1] = mask[r];
+				mask[r] = b;
+			}
+		}
+	}
+}
+
+static void
+count_rows(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+	for (size_t k = m->col_ptr[begin]; k < m->col_ptr[end]; k++)
+		__atomic_fetch_add(&c->row_count[m->row_idx[k]], 1, __ATOMIC_RELAXED);
+}
+
+static void
+hub_first(void *arg, size_t begin, size_t end)
+{
+	ReorderCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t j = begin; j < end; j++) {
+		uint32_t front = m->col_ptr[j];
+		for (uint32_t k = front; k < m->col_ptr[j + 1]; k++) {
+			if (m->row_idx[k] != c->hub)
+				continue;
+			m->row_idx[k] = m->row_idx[front];
+			m->row_idx[front] = c->hub;
+			if (m->edge_mask) {
+				uint64_t b = m->edge_mask[k];
+				m->edge_mask[k] = m->edge_mask[front];
+				m->edge_mask[front] = b;
+			}
+			front++;
+		}
+	}
+}
+
+/**
+ * @brief Renumbers the vertices into a fresh copy of the arrays.
+ */
+static int
+renumber(CSCBinaryMatrix *m, ReorderCtx *c, CSCOrder order, unsigned int n_threads)
+{
+	size_t nrows = m->nrows, ncols = m->ncols;
+
+	if (m->bipartite) {
+		perm_init(&c->cols, ncols, c->seed);
+		perm_init(&c->rows, nrows, ~c->seed);
+		c->renumber_rows = (order == CSC_ORDER_IDS);
+	} else {
+		/* Row and column j are vertex j */
+		nrows = ncols = csc_num_vertices(m);
+		perm_init(&c->cols, ncols, c->seed);
+		c->rows = c->cols;
+		c->renumber_rows = 1;
+	}
+
+	c->col_ptr = calloc(ncols + 1, sizeof(uint32_t));
+	c->row_idx = malloc((m->nnz ? m->nnz : 1) * sizeof(uint32_t));
+	if (m->edge_mask)
+		c->edge_mask = malloc((m->nnz ? m->nnz : 1) * sizeof(uint64_t));
+	if (m->vertex_ids)
+		c->vertex_ids = malloc((ncols ? ncols : 1) * sizeof(uint64_t));
+	if (!c->col_ptr || !c->row_idx || (m->edge_mask && !c->edge_mask) ||
+	    (m->vertex_ids && !c->vertex_ids)) {
+		print_error(__func__, "malloc() failed", errno);
+		free(c->col_ptr);
+		free(c->row_idx);
+		free(c->edge_mask);
+		free(c->vertex_ids);
+		return 1;
+	}
+
+	parallel_for(m->ncols, REORDER_GRAIN, n_threads, place_cols, c);
+	for (size_t j = 0; j < ncols; j++)
+		c->col_ptr[j + 1] += c->col_ptr[j];
+	parallel_for(m->ncols, REORDER_GRAIN, n_threads, copy_cols, c);
+	if (m->vertex_ids)
+		parallel_for(ncols, 0, n_threads, copy_ids, c);
+
+	if (m->map) {
+		munmap(m->map, m->map_size);
+		m->map = NULL;
+	} else {
+		free(m->col_ptr);
+		free(m->row_idx);
+	}
+	free(m->edge_mask);
+	free(m->vertex_ids);
+	m->col_ptr = c->col_ptr;
+	m->row_idx = c->row_idx;
+	m->edge_mask = c->edge_mask;
+	m->vertex_ids = c->vertex_ids;
+	m->nrows = nrows;
+	m->ncols = ncols;
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc csc_order_parse()
+ */
+int
+csc_order_parse(const char *name, CSCOrder *order)
+{
+	for (size_t k = 0; k < sizeof(order_names) / sizeof(order_names[0]); k++) {
+		if (strcmp(name, order_names[k]) == 0) {
+			*order = (CSCOrder)k;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+ * @copydoc csc_order_name()
+ */
+const char *
+csc_order_name(CSCOrder order)
+{
+	return order_names[order];
+}
+
+/**
+ * @copydoc csc_reorder()
+ */
+int
+csc_reorder(CSCBinaryMatrix *m, CSCOrder order, uint64_t seed, unsigned int n_threads)
+{
+	ReorderCtx c;
+	memset(&c, 0, sizeof(c));
+	c.m = m;
+	c.seed = seed;
+
+	switch (order) {
+	case CSC_ORDER_FILE:
+		return 0;
+
+	case CSC_ORDER_COLS:
+	case CSC_ORDER_IDS:
+		return renumber(m, &c, order, n_threads);
+
+	case CSC_ORDER_ROWS:
+		parallel_for(m->ncols, REORDER_GRAIN, n_threads, shuffle_cols, &c);
+		return 0;
+
+	case CSC_ORDER_HUB:
+		c.row_count = calloc(m->nrows ? m->nrows : 1, sizeof(uint32_t));
+		if (!c.row_count) {
+			print_error(__func__, "calloc() failed", errno);
+			return 1;
+		}
+		parallel_for(m->ncols, REORDER_GRAIN, n_threads, count_rows, &c);
+		for (size_t r = 1; r < m->nrows; r++)
+			if (c.row_count[r] > c.row_count[c.hub])
+				c.hub = (uint32_t)r;
+		free(c.row_count);
+		parallel_for(m->ncols, REORDER_GRAIN, n_threads, hub_first, &c);
+		return 0;
+	}
+
+	return 0;
+}
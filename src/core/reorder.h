@@ -0,0 +1,73 @@
+/**
+ * @file reorder.h
+ * @brief Seeded reordering of a loaded graph, for edge-order stress runs.
+ *
+ * The components of a graph do not depend on the order of its edges, but
+ * the time to find them does: a column-sorted graph and a shuffled one
+ * cause very different contention on the union-find roots. These orders
+ * are applied to the loaded CSC arrays before the timed trials, so every
+ * backend and variant can be run on the same permuted input.
+ *
+ * Permutations of vertex ids are Feistel networks keyed by the seed, with
+ * cycle walking to stay within range, so each id is mapped independently
+ * and the result does not depend on the number of threads.
+ */
+
+#ifndef REORDER_H
+#define REORDER_H
+
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * @enum CSCOrder
+ * @brief Edge orders applied by csc_reorder().
+ */
+typedef enum {
+	CSC_ORDER_FILE = 0,  /**< As loaded */
+	CSC_ORDER_COLS,      /**< Columns shuffled */
+	CSC_ORDER_IDS,       /**< Vertex ids shuffled */
+	CSC_ORDER_ROWS,      /**< Entries shuffled within each column */
+	CSC_ORDER_HUB,       /**< Entries of the busiest row first in every column */
+} CSCOrder;
+
+/**
+ * @brief Looks up an order by name ("file", "cols", "ids", "rows" or "hub").
+ *
+ * @return 0 on success, 1 if the name is unknown
+ */
+int csc_order_parse(const char *name, CSCOrder *order);
+
+/**
+ * @brief Name of an order, as accepted by csc_order_parse().
+ */
+const char *csc_order_name(CSCOrder order);
+
+/**
+ * @brief Reorders a matrix in place.
+ *
+ * - CSC_ORDER_COLS moves column j to a random position. Without
+ *   `bipartite`, column j and row j are the same vertex, so the rows are
+ *   renumbered alike and this is the same as CSC_ORDER_IDS.
+ * - CSC_ORDER_IDS renumbers all the vertices at random: rows and columns
+ *   with one permutation, or with one each if `bipartite`. A rectangular
+ *   matrix that is not bipartite becomes square, with empty rows or
+ *   columns up to its number of vertices.
+ * - CSC_ORDER_ROWS shuffles the entries of each column.
+ * - CSC_ORDER_HUB moves the entries of the row with the most entries to
+ *   the front of their columns, so that every thread starts by uniting
+ *   with the same vertex.
+ *
+ * `vertex_ids` and `edge_mask` follow the vertices and entries they
+ * describe. The same seed gives the same order on any number of threads.
+ *
+ * @param m Matrix to reorder (`bipartite` must already be set)
+ * @param order Order to apply
+ * @param seed Seed of the shuffles
+ * @param n_threads Number of threads
+ * @return 0 on success, 1 on allocation failure
+ */
+int csc_reorder(CSCBinaryMatrix *m, CSCOrder order, uint64_t seed, unsigned int n_threads);
+
+#endif /* REORDER_H */
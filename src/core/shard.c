@@ -0,0 +1,520 @@
+/**
+ * @file shard.c
+ * @brief Per-component shard construction and output.
+ *
+ * The split runs in four parallel phases:
+ * 1. Number the components densely (roots ranked by a chunked prefix sum)
+ *    and count their vertices
+ * 2. Assign components to shards, packing small ones into bins
+ * 3. Stable counting sort of the vertices by shard, with one histogram
+ *    per chunk, giving every vertex its local id
+ * 4. One pass over the edges, each column copying its relabelled rows to
+ *    its slot in its shard
+ *
+ * Phase 3 runs once per side of a bipartite matrix (rows and columns are
+ * numbered separately) and once for a regular one.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "shard.h"
+#include "parallel.h"
+#include "error.h"
+
+#define SHARD_GRAIN        65536       /* Vertices per chunk */
+#define SHARD_HIST_ENTRIES (1u << 22)  /* Bound on chunks x shards histogram entries */
+#define SHARD_NONE         UINT32_MAX
+
+/**
+ * @struct SplitCtx
+ * @brief State shared by the parallel phases of one split.
+ */
+typedef struct {
+	const CSCBinaryMatrix *m;
+	const uint32_t *label;
+	size_t off;                /* Vertex of column 0 */
+	size_t grain;              /* Vertices per chunk of the current phase */
+	uint32_t *shard;           /* Component, then shard, of every vertex */
+	uint32_t *local;           /* Local id of every vertex within its shard */
+	uint32_t *order;           /* Vertices grouped by shard, per side */
+	uint32_t *chunk_count;     /* Roots per chunk */
+	uint32_t *comp_vertices;   /* Vertices per component */
+	uint32_t *comp_shard;      /* Shard of every component */
+	uint32_t *hist;            /* Per-chunk shard histograms */
+	size_t n_shards;
+	size_t side_begin;         /* First vertex of the side being sorted */
+	uint32_t *side_start;      /* First position of every shard in order */
+	ComponentShard *out;
+	int failed;
+} SplitCtx;
+
+/* ------------------------------------------------------------------------- */
+/*                            Component Numbering                            */
+/* ------------------------------------------------------------------------- */
+
+static void
+count_roots(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		uint32_t count = 0;
+		for (size_t v = cb; v < ce; v++)
+			count += c->label[v] == v;
+		c->chunk_count[cb / c->grain] = count;
+	}
+}
+
+static void
+rank_roots(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		uint32_t rank = c->chunk_count[cb / c->grain];
+		for (size_t v = cb; v < ce; v++)
+			if (c->label[v] == v)
+				c->shard[v] = rank++;
+	}
+}
+
+static void
+rank_members(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t v = begin; v < end; v++) {
+		if (c->label[v] != v)
+			c->shard[v] = c->shard[c->label[v]];
+		__atomic_fetch_add(&c->comp_vertices[c->shard[v]], 1, __ATOMIC_RELAXED);
+	}
+}
+
+static void
+map_shards(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t v = begin; v < end; v++)
+		c->shard[v] = c->comp_shard[c->shard[v]];
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Counting Sort by Shard                         */
+/* ------------------------------------------------------------------------- */
+
+static void
+histogram_side(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		uint32_t *h = c->hist + (cb / c->grain) * c->n_shards;
+		for (size_t i = cb; i < ce; i++)
+			h[c->shard[c->side_begin + i]]++;
+	}
+}
+
+static void
+place_side(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	for (size_t cb = begin; cb < end; cb += c->grain) {
+		size_t ce = cb + c->grain < end ? cb + c->grain : end;
+		uint32_t *h = c->hist + (cb / c->grain) * c->n_shards;
+		for (size_t i = cb; i < ce; i++) {
+			const size_t v = c->side_begin + i;
+			const uint32_t s = c->shard[v];
+			const uint32_t pos = h[s]++;
+			c->order[pos] = (uint32_t)v;
+			c->local[v] = pos - c->side_start[s];
+		}
+	}
+}
+
+/**
+ * @brief Groups the vertices [begin, begin + len) by shard.
+ *
+ * On return order[side_start[s] .. side_start[s + 1]) holds the vertices of
+ * shard s in ascending order, and local[v] is the rank of v among them.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+sort_side(SplitCtx *c, size_t begin, size_t len, unsigned int n_threads)
+{
+	const size_t S = c->n_shards;
+
+	/* Enough vertices per chunk to keep chunks x shards histograms bounded */
+	size_t max_chunks = SHARD_HIST_ENTRIES / (S ? S : 1);
+	if (max_chunks == 0)
+		max_chunks = 1;
+	c->grain = SHARD_GRAIN;
+	if ((len + c->grain - 1) / c->grain > max_chunks)
+		c->grain = (len + max_chunks - 1) / max_chunks;
+
+	const size_t n_chunks = len ? (len + c->grain - 1) / c->grain : 1;
+	c->hist = calloc(n_chunks * S + 1, sizeof(uint32_t));
+	if (!c->hist) {
+		print_error(__func__, "calloc() failed", errno);
+		return 1;
+	}
+
+	c->side_begin = begin;
+	parallel_for(len, c->grain, n_threads, histogram_side, c);
+
+	/* Exclusive scan, shard-major: positions ascend by shard, then chunk */
+	uint32_t pos = 0;
+	for (size_t s = 0; s < S; s++) {
+		c->side_start[s] = pos;
+		for (size_t ch = 0; ch < n_chunks; ch++) {
+			uint32_t count = c->hist[ch * S + s];
+			c->hist[ch * S + s] = pos;
+			pos += count;
+		}
+	}
+	c->side_start[S] = pos;
+
+	parallel_for(len, c->grain, n_threads, place_side, c);
+
+	free(c->hist);
+	c->hist = NULL;
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                              Shard Assembly                               */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Allocates the matrices of shards [begin, end) and fills col_ptr.
+ *
+ * Uses the column-side order left in ctx->order by sort_side().
+ */
+static void
+build_col_ptr(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t s = begin; s < end; s++) {
+		CSCBinaryMatrix *sm = c->out[s].matrix;
+		const uint32_t first = c->side_start[s];
+
+		sm->col_ptr = malloc((sm->ncols + 1) * sizeof(uint32_t));
+		if (!sm->col_ptr) {
+			__atomic_store_n(&c->failed, 1, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		uint32_t nnz = 0;
+		sm->col_ptr[0] = 0;
+		for (size_t lc = 0; lc < sm->ncols; lc++) {
+			const size_t col = c->order[first + lc] - c->off;
+			if (col < m->ncols)
+				nnz += m->col_ptr[col + 1] - m->col_ptr[col];
+			sm->col_ptr[lc + 1] = nnz;
+		}
+
+		sm->nnz = nnz;
+		sm->row_idx = malloc((nnz ? nnz : 1) * sizeof(uint32_t));
+		if (!sm->row_idx)
+			__atomic_store_n(&c->failed, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * @brief Copies the relabelled rows of columns [begin, end) to their shards.
+ */
+static void
+fill_edges(void *arg, size_t begin, size_t end)
+{
+	SplitCtx *c = arg;
+	const CSCBinaryMatrix *m = c->m;
+
+	for (size_t col = begin; col < end; col++) {
+		const size_t v = c->off + col;
+		const CSCBinaryMatrix *sm = c->out[c->shard[v]].matrix;
+		uint32_t *dst = sm->row_idx + sm->col_ptr[c->local[v]];
+
+		for (uint32_t j = m->col_ptr[col]; j < m->col_ptr[col + 1]; j++)
+			*dst++ = c->local[m->row_idx[j]];
+	}
+}
+
+/**
+ * @brief Assigns every component to a shard, packing small ones into bins.
+ *
+ * @return Number of shards
+ */
+static size_t
+assign_shards(SplitCtx *c, size_t n_comps, size_t bin_vertices, size_t *shard_comps)
+{
+	size_t n_shards = 0, bin = SHARD_NONE, bin_fill = 0;
+
+	for (size_t k = 0; k < n_comps; k++) {
+		if (c->comp_vertices[k] >= bin_vertices) {
+			shard_comps[n_shards] = 1;
+			c->comp_shard[k] = (uint32_t)n_shards++;
+			continue;
+		}
+
+		if (bin == SHARD_NONE) {
+			bin = n_shards++;
+			shard_comps[bin] = 0;
+		}
+		c->comp_shard[k] = (uint32_t)bin;
+		shard_comps[bin]++;
+		bin_fill += c->comp_vertices[k];
+		if (bin_fill >= bin_vertices) {
+			bin = SHARD_NONE;
+			bin_fill = 0;
+		}
+	}
+
+	return n_shards;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public Functions                               */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc csc_split_components()
+ */
+ComponentShard *
+csc_split_components(const CSCBinaryMatrix *m, const uint32_t *label,
+                     size_t bin_vertices, unsigned int n_threads,
+                     size_t *n_shards)
+{
+	const size_t n = csc_num_vertices(m);
+	const size_t n_chunks = (n + SHARD_GRAIN - 1) / SHARD_GRAIN;
+	SplitCtx c = { .m = m, .label = label, .off = csc_col_offset(m), .grain = SHARD_GRAIN };
+	ComponentShard *out = NULL;
+	size_t *shard_comps = NULL;
+	size_t S = 0;
+
+	*n_shards = 0;
+	if (bin_vertices == 0)
+		bin_vertices = 1;
+
+	c.shard = malloc((n ? n : 1) * sizeof(uint32_t));
+	c.local = malloc((n ? n : 1) * sizeof(uint32_t));
+	c.order = malloc((n ? n : 1) * sizeof(uint32_t));
+	c.chunk_count = malloc((n_chunks ? n_chunks : 1) * sizeof(uint32_t));
+	if (!c.shard || !c.local || !c.order || !c.chunk_count) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+
+	/* Phase 1: dense component numbers and sizes */
+	parallel_for(n, c.grain, n_threads, count_roots, &c);
+	uint32_t n_comps = 0;
+	for (size_t ch = 0; ch < n_chunks; ch++) {
+		uint32_t count = c.chunk_count[ch];
+		c.chunk_count[ch] = n_comps;
+		n_comps += count;
+	}
+	parallel_for(n, c.grain, n_threads, rank_roots, &c);
+
+	c.comp_vertices = calloc(n_comps ? n_comps : 1, sizeof(uint32_t));
+	c.comp_shard = malloc((n_comps ? n_comps : 1) * sizeof(uint32_t));
+	shard_comps = malloc((n_comps ? n_comps : 1) * sizeof(size_t));
+	if (!c.comp_vertices || !c.comp_shard || !shard_comps) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+	parallel_for(n, c.grain, n_threads, rank_members, &c);
+
+	/* Phase 2: components to shards */
+	S = assign_shards(&c, n_comps, bin_vertices, shard_comps);
+	c.n_shards = S;
+	parallel_for(n, c.grain, n_threads, map_shards, &c);
+
+	out = calloc(S ? S : 1, sizeof(ComponentShard));
+	c.side_start = malloc((S + 1) * sizeof(uint32_t));
+	if (!out || !c.side_start) {
+		print_error(__func__, "malloc() failed", errno);
+		goto fail;
+	}
+	c.out = out;
+	for (size_t s = 0; s < S; s++) {
+		out[s].n_components = shard_comps[s];
+		out[s].matrix = calloc(1, sizeof(CSCBinaryMatrix));
+		if (!out[s].matrix) {
+			print_error(__func__, "calloc() failed", errno);
+			goto fail;
+		}
+		out[s].matrix->bipartite = m->bipartite;
+	}
+
+	/* Phase 3: local ids, rows first (a bipartite matrix numbers them apart) */
+	if (m->bipartite) {
+		if (sort_side(&c, 0, m->nrows, n_threads))
+			goto fail;
+		for (size_t s = 0; s < S; s++) {
+			const size_t rows = c.side_start[s + 1] - c.side_start[s];
+			out[s].matrix->nrows = rows;
+			out[s].vertex = malloc((rows ? rows : 1) * sizeof(uint32_t));
+			if (!out[s].vertex) {
+				print_error(__func__, "malloc() failed", errno);
+				goto fail;
+			}
+			memcpy(out[s].vertex, c.order + c.side_start[s], rows * sizeof(uint32_t));
+			out[s].n_vertices = rows;
+		}
+	}
+
+	const size_t col_begin = m->bipartite ? m->nrows : 0;
+	if (sort_side(&c, col_begin, n - col_begin, n_threads))
+		goto fail;
+	for (size_t s = 0; s < S; s++) {
+		const size_t cols = c.side_start[s + 1] - c.side_start[s];
+		uint32_t *vertex = realloc(out[s].vertex, (out[s].n_vertices + cols + 1) * sizeof(uint32_t));
+		if (!vertex) {
+			print_error(__func__, "realloc() failed", errno);
+			goto fail;
+		}
+		memcpy(vertex + out[s].n_vertices, c.order + c.side_start[s], cols * sizeof(uint32_t));
+		out[s].vertex = vertex;
+		out[s].n_vertices += cols;
+		out[s].matrix->ncols = cols;
+		if (!m->bipartite)
+			out[s].matrix->nrows = cols;
+	}
+
+	/* Original ids of a compacted edge list follow the vertices */
+	for (size_t s = 0; m->vertex_ids && !m->bipartite && s < S; s++) {
+		const size_t nv = out[s].n_vertices;
+		out[s].matrix->vertex_ids = malloc((nv ? nv : 1) * sizeof(uint64_t));
+		if (!out[s].matrix->vertex_ids) {
+			print_error(__func__, "malloc() failed", errno);
+			goto fail;
+		}
+		for (size_t k = 0; k < nv; k++)
+			out[s].matrix->vertex_ids[k] = m->vertex_ids[out[s].vertex[k]];
+	}
+
+	/* Phase 4: one pass over the edges */
+	parallel_for(S, 1, n_threads, build_col_ptr, &c);
+	if (c.failed) {
+		print_error(__func__, "malloc() failed", ENOMEM);
+		goto fail;
+	}
+	parallel_for(m->ncols, 1024, n_threads, fill_edges, &c);
+
+	free(c.shard);
+	free(c.local);
+	free(c.order);
+	free(c.chunk_count);
+	free(c.comp_vertices);
+	free(c.comp_shard);
+	free(c.side_start);
+	free(shard_comps);
+	*n_shards = S;
+	return out;
+
+fail:
+	csc_free_shards(out, S);
+	free(c.shard);
+	free(c.local);
+	free(c.order);
+	free(c.chunk_count);
+	free(c.comp_vertices);
+	free(c.comp_shard);
+	free(c.side_start);
+	free(shard_comps);
+	return NULL;
+}
+
+/**
+ * @copydoc csc_save_shards()
+ */
+int
+csc_save_shards(const ComponentShard *shards, size_t n_shards, const char *dir)
+{
+	if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+		print_error(__func__, "failed to create shard directory", errno);
+		return 1;
+	}
+
+	char path[4096];
+	snprintf(path, sizeof(path), "%s/index.tsv", dir);
+	FILE *index = fopen(path, "w");
+	if (!index) {
+		print_error(__func__, "failed to create index.tsv", errno);
+		return 1;
+	}
+	fprintf(index, "shard\tcomponents\tvertices\tnnz\tfile\n");
+
+	for (size_t s = 0; s < n_shards; s++) {
+		const ComponentShard *sh = &shards[s];
+
+		int len = snprintf(path, sizeof(path), "%s/shard_%06zu.ids", dir, s);
+		if (len < 0 || (size_t)len >= sizeof(path)) {
+			print_error(__func__, "shard path too long", 0);
+			fclose(index);
+			return 1;
+		}
+
+		FILE *f = fopen(path, "wb");
+		if (!f || fwrite(sh->vertex, sizeof(uint32_t), sh->n_vertices, f) != sh->n_vertices) {
+			print_error(__func__, "failed to write shard ids", errno);
+			if (f)
+				fclose(f);
+			fclose(index);
+			return 1;
+		}
+		fclose(f);
+
+		if (sh->matrix->vertex_ids) {
+			memcpy(path + len - 3, "vid", 3);
+			f = fopen(path, "wb");
+			if (!f || fwrite(sh->matrix->vertex_ids, sizeof(uint64_t), sh->n_vertices, f) !=
+			          sh->n_vertices) {
+				print_error(__func__, "failed to write shard vertex ids", errno);
+				if (f)
+					fclose(f);
+				fclose(index);
+				return 1;
+			}
+			fclose(f);
+		}
+
+		memcpy(path + len - 3, "csc", 3);
+		if (csc_save_matrix(sh->matrix, path)) {
+			fclose(index);
+			return 1;
+		}
+
+		fprintf(index, "%zu\t%zu\t%zu\t%zu\tshard_%06zu.csc\n", s, sh->n_components,
+		        sh->n_vertices, sh->matrix->nnz, s);
+	}
+
+	if (fclose(index) != 0) {
+		print_error(__func__, "fclose() failed", errno);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @copydoc csc_free_shards()
+ */
+void
+csc_free_shards(ComponentShard *shards, size_t n_shards)
+{
+	if (!shards)
+		return;
+
+	for (size_t s = 0; s < n_shards; s++) {
+		csc_free_matrix(shards[s].matrix);
+		free(shards[s].vertex);
+	}
+	free(shards);
+}
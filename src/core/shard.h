@@ -0,0 +1,74 @@
+/**
+ * @file shard.h
+ * @brief Splitting a graph into per-component shard matrices.
+ *
+ * Given a component label for every vertex, the columns (and rows) of a
+ * CSCBinaryMatrix are counting-sorted by component and every component,
+ * or bin of small components, is emitted as its own relabelled matrix in a
+ * single pass over the edges. Shards can then be processed independently
+ * without rescanning the whole graph.
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * @struct ComponentShard
+ * @brief One shard: a component, or a bin of small components.
+ *
+ * Local vertex ids follow the original vertex order. A bipartite input
+ * gives bipartite shards, whose local rows and columns are numbered
+ * separately.
+ */
+typedef struct {
+	CSCBinaryMatrix *matrix;  /**< Relabelled shard matrix */
+	uint32_t *vertex;         /**< Original vertex of each local vertex (rows, then columns if bipartite) */
+	size_t n_vertices;        /**< Length of vertex */
+	size_t n_components;      /**< Components in the shard */
+} ComponentShard;
+
+/**
+ * @brief Splits a matrix into per-component shards.
+ *
+ * Components with at least @p bin_vertices vertices get a shard of their
+ * own; smaller ones are packed, in label order, into bins that are closed
+ * once they reach @p bin_vertices vertices.
+ *
+ * @param m Input matrix
+ * @param label Component label of every vertex: the smallest vertex of its
+ *              component, as computed by cc_labels()
+ * @param bin_vertices Smallest component kept on its own (at least 1)
+ * @param n_threads Number of threads
+ * @param n_shards Output: number of shards
+ * @return Array of shards (free with csc_free_shards()), or NULL on error
+ */
+ComponentShard *csc_split_components(const CSCBinaryMatrix *m, const uint32_t *label,
+                                     size_t bin_vertices, unsigned int n_threads,
+                                     size_t *n_shards);
+
+/**
+ * @brief Writes shards to a directory.
+ *
+ * Shard i is written as `shard_<i>.csc` (binary CSC format, see
+ * csc_save_matrix()) and `shard_<i>.ids` (its vertex array as raw
+ * native-endian uint32_t). Shards of a compacted edge list also get
+ * `shard_<i>.vid`, the original 64-bit id of each local vertex as raw
+ * native-endian uint64_t. `index.tsv` lists the components, vertices,
+ * non-zeros and file name of every shard. The directory is created if
+ * needed.
+ *
+ * @return 0 on success, 1 on error
+ */
+int csc_save_shards(const ComponentShard *shards, size_t n_shards, const char *dir);
+
+/**
+ * @brief Frees an array of shards. Safe to call with NULL.
+ */
+void csc_free_shards(ComponentShard *shards, size_t n_shards);
+
+#endif /* SHARD_H */
@@ -0,0 +1,827 @@
+/**
+ * @file spmv.c
+ * @brief Semiring SpMV/SpMSpV kernels over CSCBinaryMatrix graphs.
+ *
+ * Both storage forms of A are handled through one "segment view": a
+ * compressed array of segments (columns of the CSC form, or rows of the
+ * CSR form) together with the vertex numbers of the segments and of the
+ * indices they hold. Push scatters along the segments of the view whose
+ * segments are the sources, pull gathers along the view whose segments
+ * are the destinations:
+ *
+ *     direction   push over   pull over
+ *     FORWARD     CSC         CSR
+ *     BACKWARD    CSR         CSC
+ *
+ * The kernels are written once and specialised per semiring by inlining
+ * with a constant semiring argument.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spmv.h"
+#include "parallel.h"
+#include "error.h"
+
+/* ------------------------------------------------------------------------- */
+/*                              Configuration                                */
+/* ------------------------------------------------------------------------- */
+
+#define SPMV_SEGMENT_GRAIN  1024       /* Segments per parallel chunk */
+#define SPMV_FRONTIER_GRAIN 256        /* Frontier vertices per parallel chunk */
+#define SPMV_EMIT_BUFFER    256        /* Changed vertices buffered per chunk */
+#define SPMV_BLOCK_SOURCES  (1u << 18) /* Sources per pull block (1 MiB of labels) */
+#define SPMV_TRANSPOSE_GRAIN 4096      /* Columns per chunk of the CSR build */
+#define SPMV_TRANSPOSE_HIST (1u << 22) /* Bound on chunks x rows histogram entries */
+
+/* Label updates are atomic only when other threads may touch them */
+#if defined(USE_OPENMP) || defined(USE_PTHREADS) || defined(USE_CILK)
+#define SPMV_LOAD(p)          __atomic_load_n((p), __ATOMIC_RELAXED)
+#define SPMV_STORE(p, v)      __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+#define SPMV_CAS(p, e, v)     __atomic_compare_exchange_n((p), (e), (v), 0, \
+                              __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#define SPMV_FETCH_OR(p, v)   __atomic_fetch_or((p), (v), __ATOMIC_RELAXED)
+#define SPMV_FETCH_ADD(p, v)  __atomic_fetch_add((p), (v), __ATOMIC_RELAXED)
+#define SPMV_EXCHANGE(p, v)   __atomic_exchange_n((p), (v), __ATOMIC_RELAXED)
+#else
+#define SPMV_LOAD(p)          (*(p))
+#define SPMV_STORE(p, v)      (*(p) = (v))
+#define SPMV_CAS(p, e, v)     (*(p) == *(e) ? (*(p) = (v), 1) : (*(e) = *(p), 0))
+#define SPMV_FETCH_OR(p, v)   spmv_plain_fetch_or((p), (v))
+#define SPMV_FETCH_ADD(p, v)  ((*(p) += (v)) - (v))
+#define SPMV_EXCHANGE(p, v)   spmv_plain_exchange((p), (v))
+
+static inline uint32_t
+spmv_plain_fetch_or(uint32_t *p, uint32_t v)
+{
+	uint32_t old = *p;
+	*p = old | v;
+	return old;
+}
+
+static inline uint8_t
+spmv_plain_exchange(uint8_t *p, uint8_t v)
+{
+	uint8_t old = *p;
+	*p = v;
+	return old;
+}
+#endif
+
+/* ------------------------------------------------------------------------- */
+/*                              Engine State                                 */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @struct SpmvView
+ * @brief One storage form of A as a list of segments.
+ *
+ * Segment s is vertex seg_off + s; the index idx[j] of one of its entries
+ * is vertex nbr_off + idx[j].
+ */
+typedef struct {
+	const uint32_t *ptr;  /**< Segment pointers (length n_seg + 1) */
+	const uint32_t *idx;  /**< Neighbour indices */
+	size_t n_seg;         /**< Number of segments */
+	size_t n_nbr;         /**< Range of neighbour indices */
+	size_t seg_off;       /**< Vertex of segment 0 */
+	size_t nbr_off;       /**< Vertex of neighbour index 0 */
+	int sorted;           /**< Indices ascend within every segment (-1: not checked yet) */
+} SpmvView;
+
+struct SpmvEngine {
+	const CSCBinaryMatrix *m;
+	size_t n;              /* Number of vertices */
+	size_t off;            /* Vertex of column 0 */
+	unsigned int n_threads;
+	SpmvView csc;          /* Columns -> rows */
+	SpmvView csr;          /* Rows -> columns, valid once csr_built */
+	int csr_built;
+	uint32_t *row_ptr;     /* CSR storage */
+	uint32_t *col_idx;
+	uint32_t *cursor;      /* Per-segment position of blocked pulls */
+	uint8_t *mark;         /* Per-vertex "already in the changed frontier" */
+};
+
+/**
+ * @struct SpmvPass
+ * @brief Arguments of one kernel pass, shared by its parallel chunks.
+ */
+typedef struct {
+	SpmvEngine *e;
+	SpmvSemiring s;
+	const SpmvView *view;
+	const uint32_t *x;
+	uint32_t *y;
+	const SpmvFrontier *in;   /* Sparse input, or NULL */
+	SpmvFrontier *out;        /* Changed entries, or NULL */
+	int dirs;                 /* Directions (sparse pushes) */
+	uint32_t block_begin;     /* Source range of a blocked pull */
+	uint32_t block_end;
+	size_t changed;           /* Total changes, summed by the chunks */
+} SpmvPass;
+
+/**
+ * @struct SpmvEmitter
+ * @brief Chunk-local buffer of changed vertices.
+ */
+typedef struct {
+	uint32_t buf[SPMV_EMIT_BUFFER];
+	size_t len;
+	size_t changed;
+} SpmvEmitter;
+
+/**
+ * @struct SpmvTranspose
+ * @brief State of the CSR build, shared by its parallel chunks.
+ */
+typedef struct {
+	SpmvEngine *e;
+	uint32_t *hist;           /* Per-chunk row histograms, then fill positions */
+	size_t n_chunks;
+	size_t chunk_cols;        /* Columns per chunk */
+} SpmvTranspose;
+
+/* ------------------------------------------------------------------------- */
+/*                            Semiring Operations                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Identity of the accumulation (the value that changes nothing).
+ */
+static inline __attribute__((always_inline)) uint32_t
+sr_identity(SpmvSemiring s)
+{
+	return s == SPMV_MIN_SELECT ? UINT32_MAX : 0;
+}
+
+/**
+ * @brief Accumulates b into a.
+ */
+static inline __attribute__((always_inline)) uint32_t
+sr_add(SpmvSemiring s, uint32_t a, uint32_t b)
+{
+	switch (s) {
+	case SPMV_MIN_SELECT:
+		return a < b ? a : b;
+	case SPMV_OR_AND:
+		return a | b;
+	default:
+		return a + b;
+	}
+}
+
+/**
+ * @brief Accumulates v into *p, atomically in parallel builds.
+ *
+ * @return 1 if *p changed
+ */
+static inline __attribute__((always_inline)) int
+sr_update(SpmvSemiring s, uint32_t *p, uint32_t v)
+{
+	switch (s) {
+	case SPMV_MIN_SELECT: {
+		uint32_t cur = SPMV_LOAD(p);
+		while (v < cur)
+			if (SPMV_CAS(p, &cur, v))
+				return 1;
+		return 0;
+	}
+	case SPMV_OR_AND: {
+		uint32_t cur = SPMV_LOAD(p);
+		if ((cur | v) == cur)
+			return 0;
+		cur = SPMV_FETCH_OR(p, v);
+		return (cur | v) != cur;
+	}
+	default:
+		if (!v)
+			return 0;
+		(void)SPMV_FETCH_ADD(p, v);
+		return 1;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           Changed-Entry Output                            */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Appends the buffered vertices to the output frontier.
+ */
+static void
+emit_flush(SpmvPass *p, SpmvEmitter *em)
+{
+	if (em->len) {
+		size_t pos = SPMV_FETCH_ADD(&p->out->len, em->len);
+		memcpy(p->out->idx + pos, em->buf, em->len * sizeof(uint32_t));
+		em->len = 0;
+	}
+}
+
+/**
+ * @brief Records that entry v of y changed.
+ *
+ * With an output frontier, the first thread to mark v adds it; later
+ * changes of v in the same call are not counted again.
+ */
+static inline void
+emit(SpmvPass *p, SpmvEmitter *em, uint32_t v)
+{
+	if (p->out) {
+		uint8_t *mark = &p->e->mark[v];
+		if (SPMV_LOAD(mark) || SPMV_EXCHANGE(mark, 1))
+			return;
+		em->buf[em->len++] = v;
+		if (em->len == SPMV_EMIT_BUFFER)
+			emit_flush(p, em);
+	}
+	em->changed++;
+}
+
+/**
+ * @brief Publishes a chunk's buffered vertices and change count.
+ */
+static void
+emit_finish(SpmvPass *p, SpmvEmitter *em)
+{
+	if (p->out)
+		emit_flush(p, em);
+	(void)SPMV_FETCH_ADD(&p->changed, em->changed);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                 Kernels                                   */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Pull over segments [begin, end): each segment reduces its sources.
+ *
+ * Sources outside [block_begin, block_end) are left for other blocks; the
+ * unblocked pass uses the full range and skips the cursor bookkeeping.
+ * In place, reads of x race with the stores to y of other chunks, so they
+ * are atomic (@p inplace); any value read is an earlier, still valid value,
+ * and callers iterate to a fixpoint. Otherwise the reduction uses plain
+ * loads, which the compiler vectorises with gathers.
+ */
+static inline __attribute__((always_inline)) void
+pull_segments(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end, int inplace)
+{
+	const SpmvView *v = p->view;
+	const uint32_t *x = p->x + v->nbr_off;
+	uint32_t *y = p->y + v->seg_off;
+	const uint32_t ident = sr_identity(s);
+	const int blocked = p->block_end < v->n_nbr || p->block_begin > 0;
+	SpmvEmitter em = { .len = 0, .changed = 0 };
+
+	for (size_t seg = begin; seg < end; seg++) {
+		uint32_t acc = ident;
+
+		if (!blocked) {
+			for (uint32_t j = v->ptr[seg]; j < v->ptr[seg + 1]; j++)
+				acc = sr_add(s, acc, inplace ? SPMV_LOAD(&x[v->idx[j]]) : x[v->idx[j]]);
+		} else {
+			uint32_t j = p->block_begin ? p->e->cursor[seg] : v->ptr[seg];
+			const uint32_t stop = v->ptr[seg + 1];
+			for (; j < stop && v->idx[j] < p->block_end; j++)
+				acc = sr_add(s, acc, inplace ? SPMV_LOAD(&x[v->idx[j]]) : x[v->idx[j]]);
+			p->e->cursor[seg] = j;
+		}
+
+		if (acc == ident)
+			continue;
+		uint32_t old = inplace ? SPMV_LOAD(&y[seg]) : y[seg];
+		uint32_t val = sr_add(s, old, acc);
+		if (val != old) {
+			SPMV_STORE(&y[seg], val);
+			emit(p, &em, (uint32_t)(v->seg_off + seg));
+		}
+	}
+
+	emit_finish(p, &em);
+}
+
+/**
+ * @brief Pull over segments [begin, end): each segment reduces its sources.
+ */
+static inline __attribute__((always_inline)) void
+pull_range(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end)
+{
+	if (p->x == p->y)
+		pull_segments(p, s, begin, end, 1);
+	else
+		pull_segments(p, s, begin, end, 0);
+}
+
+/**
+ * @brief Push over segments [begin, end): each segment scatters its value.
+ */
+static inline __attribute__((always_inline)) void
+push_range(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end)
+{
+	const SpmvView *v = p->view;
+	uint32_t *y = p->y + v->nbr_off;
+	const uint32_t ident = sr_identity(s);
+	SpmvEmitter em = { .len = 0, .changed = 0 };
+
+	for (size_t seg = begin; seg < end; seg++) {
+		const uint32_t val = SPMV_LOAD(&p->x[v->seg_off + seg]);
+		if (val == ident)
+			continue;
+		for (uint32_t j = v->ptr[seg]; j < v->ptr[seg + 1]; j++)
+			if (sr_update(s, &y[v->idx[j]], val))
+				emit(p, &em, (uint32_t)(v->nbr_off + v->idx[j]));
+	}
+
+	emit_finish(p, &em);
+}
+
+/**
+ * @brief In-place push both ways over CSC columns [begin, end).
+ *
+ * Without an output frontier the rows are updated with plain stores, as the
+ * sweeps of a label propagation loop: a smaller value stored at the same
+ * time by another chunk may be overwritten, but the overwriting chunk
+ * counts a change, so the caller sweeps again and the edge is relaxed
+ * then. A sweep with no changes stored nothing and is a fixpoint. With an
+ * output frontier (@p exact) every update is a compare-and-swap, since the
+ * frontier must hold every entry whose decrease is not yet pushed.
+ */
+static inline __attribute__((always_inline)) void
+push_both_inplace(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end,
+                  SpmvEmitter *em, int exact)
+{
+	const uint32_t *ptr = p->e->csc.ptr;
+	const uint32_t *idx = p->e->csc.idx;
+	const size_t off = p->e->csc.seg_off;
+	uint32_t *y = p->y;
+
+	for (size_t seg = begin; seg < end; seg++) {
+		const size_t col = off + seg;
+		const uint32_t old = SPMV_LOAD(&y[col]);
+		const uint32_t stop = ptr[seg + 1];
+		uint32_t val = old;
+
+		for (uint32_t j = ptr[seg]; j < stop; j++) {
+			const uint32_t row = idx[j];
+			uint32_t cur = SPMV_LOAD(&y[row]);
+			/* Equal ends leave val alone: no dependency between the
+			 * loads of the common case */
+			if (cur == val)
+				continue;
+			const uint32_t acc = sr_add(s, val, cur);
+			val = acc;
+			if (acc == cur)
+				continue;
+			if (!exact)
+				SPMV_STORE(&y[row], acc);
+			else if (!SPMV_CAS(&y[row], &cur, acc) && !sr_update(s, &y[row], acc))
+				continue;
+			emit(p, em, row);
+		}
+
+		if (val == old)
+			continue;
+		if (!exact)
+			SPMV_STORE(&y[col], val);
+		else if (!sr_update(s, &y[col], val))
+			continue;
+		emit(p, em, (uint32_t)col);
+	}
+}
+
+/**
+ * @brief Push both ways over CSC columns [begin, end) in a single pass.
+ *
+ * Every edge is visited once: the column gathers its rows and scatters its
+ * own value to them. In place under an idempotent semiring both happen in
+ * one load per edge, with the column carrying the running accumulation, so
+ * a minimum found in a column reaches the rows after it in the same sweep
+ * (see push_both_inplace()).
+ */
+static inline __attribute__((always_inline)) void
+push_both_range(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end)
+{
+	const SpmvView *v = &p->e->csc;
+	const uint32_t ident = sr_identity(s);
+	uint32_t *y = p->y;
+	SpmvEmitter em = { .len = 0, .changed = 0 };
+
+	if (p->x == y && s != SPMV_PLUS_TIMES) {
+		if (p->out)
+			push_both_inplace(p, s, begin, end, &em, 1);
+		else
+			push_both_inplace(p, s, begin, end, &em, 0);
+	} else {
+		for (size_t seg = begin; seg < end; seg++) {
+			const size_t col = v->seg_off + seg;
+			const uint32_t val = SPMV_LOAD(&p->x[col]);
+			uint32_t acc = ident;
+
+			for (uint32_t j = v->ptr[seg]; j < v->ptr[seg + 1]; j++) {
+				const uint32_t row = v->idx[j];
+				acc = sr_add(s, acc, p->x[row]);
+				if (val != ident && sr_update(s, &y[row], val))
+					emit(p, &em, row);
+			}
+
+			if (acc != ident && sr_update(s, &y[col], acc))
+				emit(p, &em, (uint32_t)col);
+		}
+	}
+
+	emit_finish(p, &em);
+}
+
+/**
+ * @brief Sparse push of frontier entries [begin, end) in every direction.
+ */
+static inline __attribute__((always_inline)) void
+push_frontier_range(SpmvPass *p, SpmvSemiring s, size_t begin, size_t end)
+{
+	const SpmvEngine *e = p->e;
+	const uint32_t ident = sr_identity(s);
+	SpmvEmitter em = { .len = 0, .changed = 0 };
+
+	for (size_t i = begin; i < end; i++) {
+		const uint32_t vertex = p->in->idx[i];
+		const uint32_t val = SPMV_LOAD(&p->x[vertex]);
+		if (val == ident)
+			continue;
+
+		for (int d = 0; d < 2; d++) {
+			const SpmvView *v = d == 0 ? &e->csc : &e->csr;
+			if (!(p->dirs & (d == 0 ? SPMV_FORWARD : SPMV_BACKWARD)))
+				continue;
+			if (vertex < v->seg_off || vertex - v->seg_off >= v->n_seg)
+				continue;
+
+			const size_t seg = vertex - v->seg_off;
+			uint32_t *y = p->y + v->nbr_off;
+			for (uint32_t j = v->ptr[seg]; j < v->ptr[seg + 1]; j++)
+				if (sr_update(s, &y[v->idx[j]], val))
+					emit(p, &em, (uint32_t)(v->nbr_off + v->idx[j]));
+		}
+	}
+
+	emit_finish(p, &em);
+}
+
+/* Per-semiring instances, chosen once per pass */
+#define SPMV_BODIES(kernel)                                                   \
+static void kernel##_min(void *c, size_t b, size_t e)                         \
+	{ kernel##_range(c, SPMV_MIN_SELECT, b, e); }                         \
+static void kernel##_or(void *c, size_t b, size_t e)                          \
+	{ kernel##_range(c, SPMV_OR_AND, b, e); }                             \
+static void kernel##_plus(void *c, size_t b, size_t e)                        \
+	{ kernel##_range(c, SPMV_PLUS_TIMES, b, e); }                         \
+static const parallel_body_t kernel##_bodies[] = {                            \
+	[SPMV_MIN_SELECT] = kernel##_min,                                     \
+	[SPMV_OR_AND] = kernel##_or,                                          \
+	[SPMV_PLUS_TIMES] = kernel##_plus                                     \
+};
+
+SPMV_BODIES(pull)
+SPMV_BODIES(push)
+SPMV_BODIES(push_both)
+SPMV_BODIES(push_frontier)
+
+/**
+ * @brief Clears a frontier's marks after a pass.
+ */
+static void
+clear_marks(void *ctx, size_t begin, size_t end)
+{
+	SpmvPass *p = ctx;
+	for (size_t i = begin; i < end; i++)
+		p->e->mark[p->out->idx[i]] = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                           Static Helper Functions                         */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Checks whether the indices of every segment ascend.
+ */
+static int
+segments_sorted(const uint32_t *ptr, const uint32_t *idx, size_t n_seg)
+{
+	for (size_t s = 0; s < n_seg; s++)
+		for (uint32_t j = ptr[s] + 1; j < ptr[s + 1]; j++)
+			if (idx[j] < idx[j - 1])
+				return 0;
+	return 1;
+}
+
+static void
+transpose_count(void *arg, size_t begin, size_t end)
+{
+	SpmvTranspose *t = arg;
+	const CSCBinaryMatrix *m = t->e->m;
+	for (size_t ch = begin; ch < end; ch++) {
+		const size_t cb = ch * t->chunk_cols;
+		const size_t ce = cb + t->chunk_cols < m->ncols ? cb + t->chunk_cols : m->ncols;
+		uint32_t *h = t->hist + ch * m->nrows;
+		if (cb < ce)
+			for (uint32_t j = m->col_ptr[cb]; j < m->col_ptr[ce]; j++)
+				h[m->row_idx[j]]++;
+	}
+}
+
+static void
+transpose_offsets(void *arg, size_t begin, size_t end)
+{
+	SpmvTranspose *t = arg;
+	const size_t R = t->e->m->nrows;
+	for (size_t r = begin; r < end; r++) {
+		/* Exclusive scan across chunks, relative to the start of the row */
+		uint32_t pos = 0;
+		for (size_t ch = 0; ch < t->n_chunks; ch++) {
+			uint32_t count = t->hist[ch * R + r];
+			t->hist[ch * R + r] = pos;
+			pos += count;
+		}
+		t->e->row_ptr[r + 1] = pos;
+	}
+}
+
+static void
+transpose_place(void *arg, size_t begin, size_t end)
+{
+	SpmvTranspose *t = arg;
+	SpmvEngine *e = t->e;
+	const CSCBinaryMatrix *m = e->m;
+	for (size_t ch = begin; ch < end; ch++) {
+		const size_t cb = ch * t->chunk_cols;
+		const size_t ce = cb + t->chunk_cols < m->ncols ? cb + t->chunk_cols : m->ncols;
+		uint32_t *h = t->hist + ch * m->nrows;
+		for (size_t c = cb; c < ce; c++)
+			for (uint32_t j = m->col_ptr[c]; j < m->col_ptr[c + 1]; j++) {
+				const uint32_t r = m->row_idx[j];
+				e->col_idx[e->row_ptr[r] + h[r]++] = (uint32_t)c;
+			}
+	}
+}
+
+/**
+ * @brief Builds the CSR form of the matrix by a parallel counting sort.
+ *
+ * Each chunk of columns counts its entries per row, the counts are scanned
+ * chunk by chunk within every row and then over the rows, and each chunk
+ * scatters its columns in ascending order into its own slice of every row.
+ * Chunks are column-ordered, so the column indices of every row come out
+ * sorted, as blocked pulls require.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+build_csr(SpmvEngine *e)
+{
+	const CSCBinaryMatrix *m = e->m;
+
+	/* Enough columns per chunk to keep chunks x rows histograms within
+	 * the larger of a fixed bound and the size of the matrix */
+	const size_t hist_max = m->nnz > SPMV_TRANSPOSE_HIST ? m->nnz : SPMV_TRANSPOSE_HIST;
+	size_t max_chunks = hist_max / (m->nrows ? m->nrows : 1);
+	if (max_chunks == 0)
+		max_chunks = 1;
+	SpmvTranspose t = { .e = e, .chunk_cols = SPMV_TRANSPOSE_GRAIN };
+	if ((m->ncols + t.chunk_cols - 1) / t.chunk_cols > max_chunks)
+		t.chunk_cols = (m->ncols + max_chunks - 1) / max_chunks;
+	t.n_chunks = m->ncols ? (m->ncols + t.chunk_cols - 1) / t.chunk_cols : 1;
+
+	e->row_ptr = calloc(m->nrows + 1, sizeof(uint32_t));
+	e->col_idx = malloc((m->nnz ? m->nnz : 1) * sizeof(uint32_t));
+	t.hist = calloc(t.n_chunks * m->nrows + 1, sizeof(uint32_t));
+	if (!e->row_ptr || !e->col_idx || !t.hist) {
+		print_error(__func__, "malloc() failed", errno);
+		free(e->row_ptr);
+		free(e->col_idx);
+		free(t.hist);
+		e->row_ptr = e->col_idx = NULL;
+		return 1;
+	}
+
+	parallel_for(t.n_chunks, 1, e->n_threads, transpose_count, &t);
+	parallel_for(m->nrows, SPMV_SEGMENT_GRAIN, e->n_threads, transpose_offsets, &t);
+	for (size_t r = 0; r < m->nrows; r++)
+		e->row_ptr[r + 1] += e->row_ptr[r];
+	parallel_for(t.n_chunks, 1, e->n_threads, transpose_place, &t);
+	free(t.hist);
+
+	e->csr = (SpmvView){
+		.ptr = e->row_ptr, .idx = e->col_idx,
+		.n_seg = m->nrows, .n_nbr = m->ncols,
+		.seg_off = 0, .nbr_off = e->off,
+		.sorted = 1
+	};
+	e->csr_built = 1;
+	return 0;
+}
+
+/**
+ * @brief Runs a pull pass over a view, in source blocks when worthwhile.
+ *
+ * Blocking keeps the part of x being read cache-resident at the price of
+ * one cursor check per segment and block, so it is used only when x
+ * exceeds a block and the average segment is long enough to pay for the
+ * extra checks.
+ */
+static void
+pull_view(SpmvPass *p, SpmvView *v)
+{
+	const size_t n_blocks = (v->n_nbr + SPMV_BLOCK_SOURCES - 1) / SPMV_BLOCK_SOURCES;
+	const size_t nnz = v->ptr[v->n_seg];
+
+	p->view = v;
+	if (n_blocks > 1 && v->sorted < 0)
+		v->sorted = segments_sorted(v->ptr, v->idx, v->n_seg);
+	if (n_blocks <= 1 || !v->sorted || nnz < v->n_seg * n_blocks) {
+		p->block_begin = 0;
+		p->block_end = (uint32_t)v->n_nbr;
+		parallel_for(v->n_seg, SPMV_SEGMENT_GRAIN, p->e->n_threads, pull_bodies[p->s], p);
+		return;
+	}
+
+	for (size_t b = 0; b < n_blocks; b++) {
+		p->block_begin = (uint32_t)(b * SPMV_BLOCK_SOURCES);
+		p->block_end = (uint32_t)((b + 1) * SPMV_BLOCK_SOURCES < v->n_nbr
+		                          ? (b + 1) * SPMV_BLOCK_SOURCES : v->n_nbr);
+		parallel_for(v->n_seg, SPMV_SEGMENT_GRAIN, p->e->n_threads, pull_bodies[p->s], p);
+	}
+}
+
+/**
+ * @brief Prepares a pass and the CSR form if the directions need it.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+static int
+pass_begin(SpmvPass *p, SpmvEngine *e, SpmvSemiring s, int dirs,
+           const uint32_t *x, uint32_t *y, SpmvFrontier *changed, int need_csr)
+{
+	if (need_csr && !e->csr_built && build_csr(e))
+		return 1;
+
+	*p = (SpmvPass){ .e = e, .s = s, .x = x, .y = y, .out = changed, .dirs = dirs };
+	if (changed)
+		changed->len = 0;
+	return 0;
+}
+
+/**
+ * @brief Clears the marks of the changed frontier and returns the count.
+ */
+static long
+pass_end(SpmvPass *p)
+{
+	if (p->out)
+		parallel_for(p->out->len, SPMV_SEGMENT_GRAIN * 4, p->e->n_threads, clear_marks, p);
+	return (long)p->changed;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public Functions                               */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc spmv_init()
+ */
+SpmvEngine *
+spmv_init(const CSCBinaryMatrix *m, unsigned int n_threads)
+{
+	SpmvEngine *e = calloc(1, sizeof(SpmvEngine));
+	if (!e) {
+		print_error(__func__, "calloc() failed", errno);
+		return NULL;
+	}
+
+	e->m = m;
+	e->n = csc_num_vertices(m);
+	e->off = csc_col_offset(m);
+	e->n_threads = n_threads ? n_threads : 1;
+
+	const size_t max_seg = m->nrows > m->ncols ? m->nrows : m->ncols;
+	e->cursor = malloc((max_seg ? max_seg : 1) * sizeof(uint32_t));
+	e->mark = calloc(e->n ? e->n : 1, sizeof(uint8_t));
+	if (!e->cursor || !e->mark) {
+		print_error(__func__, "malloc() failed", errno);
+		spmv_free(e);
+		return NULL;
+	}
+
+	e->csc = (SpmvView){
+		.ptr = m->col_ptr, .idx = m->row_idx,
+		.n_seg = m->ncols, .n_nbr = m->nrows,
+		.seg_off = e->off, .nbr_off = 0,
+		.sorted = -1
+	};
+
+	return e;
+}
+
+/**
+ * @copydoc spmv_free()
+ */
+void
+spmv_free(SpmvEngine *e)
+{
+	if (!e)
+		return;
+
+	free(e->row_ptr);
+	free(e->col_idx);
+	free(e->cursor);
+	free(e->mark);
+	free(e);
+}
+
+/**
+ * @copydoc spmv_num_vertices()
+ */
+size_t
+spmv_num_vertices(const SpmvEngine *e)
+{
+	return e->n;
+}
+
+/**
+ * @copydoc spmv_frontier_init()
+ */
+int
+spmv_frontier_init(const SpmvEngine *e, SpmvFrontier *f)
+{
+	f->len = 0;
+	f->idx = malloc((e->n ? e->n : 1) * sizeof(uint32_t));
+	if (!f->idx) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @copydoc spmv_frontier_free()
+ */
+void
+spmv_frontier_free(SpmvFrontier *f)
+{
+	free(f->idx);
+	f->idx = NULL;
+	f->len = 0;
+}
+
+/**
+ * @copydoc spmv_dense()
+ */
+long
+spmv_dense(SpmvEngine *e, SpmvSemiring s, int dirs, SpmvKernel kernel,
+           const uint32_t *x, uint32_t *y, SpmvFrontier *changed)
+{
+	/* Pull forward and push backward alone walk the rows */
+	const int need_csr = (kernel == SPMV_PULL) ? (dirs & SPMV_FORWARD) : (dirs == SPMV_BACKWARD);
+	SpmvPass p;
+	if (pass_begin(&p, e, s, dirs, x, y, changed, need_csr))
+		return -1;
+
+	if (kernel == SPMV_PULL) {
+		if (dirs & SPMV_FORWARD)
+			pull_view(&p, &e->csr);
+		if (dirs & SPMV_BACKWARD)
+			pull_view(&p, &e->csc);
+	} else if (dirs == SPMV_BOTH) {
+		p.view = &e->csc;
+		parallel_for(e->csc.n_seg, SPMV_SEGMENT_GRAIN, e->n_threads, push_both_bodies[s], &p);
+	} else {
+		if (dirs & SPMV_FORWARD) {
+			p.view = &e->csc;
+			parallel_for(e->csc.n_seg, SPMV_SEGMENT_GRAIN, e->n_threads, push_bodies[s], &p);
+		}
+		if (dirs & SPMV_BACKWARD) {
+			p.view = &e->csr;
+			parallel_for(e->csr.n_seg, SPMV_SEGMENT_GRAIN, e->n_threads, push_bodies[s], &p);
+		}
+	}
+
+	return pass_end(&p);
+}
+
+/**
+ * @copydoc spmv_sparse()
+ */
+long
+spmv_sparse(SpmvEngine *e, SpmvSemiring s, int dirs, const uint32_t *x,
+            const SpmvFrontier *in, uint32_t *y, SpmvFrontier *changed)
+{
+	SpmvPass p;
+	if (pass_begin(&p, e, s, dirs, x, y, changed, dirs & SPMV_BACKWARD))
+		return -1;
+
+	p.in = in;
+	parallel_for(in->len, SPMV_FRONTIER_GRAIN, e->n_threads, push_frontier_bodies[s], &p);
+
+	return pass_end(&p);
+}
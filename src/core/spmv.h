@@ -0,0 +1,151 @@
+/**
+ * @file spmv.h
+ * @brief Semiring sparse matrix-vector engine over CSCBinaryMatrix graphs.
+ *
+ * Computes y = y (+) A (x) x for the binary matrix A of a graph under one of
+ * a few semirings, where (+) accumulates and (x) combines an edge with its
+ * source value. Since A is binary, (x) simply passes the source value on,
+ * and every kernel reduces to "accumulate x over the neighbours of each
+ * vertex". Label propagation is repeated min-select SpMV; BFS and
+ * reachability are repeated or-and SpMV.
+ *
+ * Vectors are dense uint32_t arrays indexed by vertex, numbered as in
+ * matrix.h (see csc_num_vertices() and csc_col_offset()). An edge stored
+ * in column c and row r links column vertex csc_col_offset() + c with row
+ * vertex r; the direction mask selects which way values flow along it.
+ *
+ * Two kernel families are provided:
+ * - Push: scatters each source value along its out-edges with atomic
+ *   updates. The sparse (SpMSpV) form visits only the vertices of an
+ *   input frontier.
+ * - Pull: gathers and reduces the neighbours of each destination and
+ *   writes it once, without atomics. Inner loops are plain reductions
+ *   that the compiler vectorises with gathers, and when the source vector
+ *   is larger than the cache the sources are processed in cache-sized
+ *   blocks.
+ *
+ * Push over columns and pull over rows use the CSC and CSR forms of A;
+ * the CSR form is built on first use, by a parallel counting sort, and kept
+ * by the engine.
+ *
+ * The kernels run in parallel on whichever backend the core is compiled
+ * for (see parallel.h).
+ */
+
+#ifndef SPMV_H
+#define SPMV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "matrix.h"
+
+/**
+ * @enum SpmvSemiring
+ * @brief Accumulation rule applied to y.
+ */
+typedef enum {
+	SPMV_MIN_SELECT,  /**< y = min(y, x_j): label propagation */
+	SPMV_OR_AND,      /**< y = y | x_j (bitwise): BFS, reachability, 32 searches at once */
+	SPMV_PLUS_TIMES   /**< y = y + x_j (mod 2^32): path and degree counting */
+} SpmvSemiring;
+
+/**
+ * @enum SpmvKernel
+ * @brief Kernel family used by spmv_dense().
+ */
+typedef enum {
+	SPMV_PUSH,  /**< Scatter from sources with atomic updates */
+	SPMV_PULL   /**< Gather into destinations, blocked for cache reuse */
+} SpmvKernel;
+
+/* Edge directions (bit mask) */
+#define SPMV_FORWARD  1  /**< Column vertex to row vertex: y (+)= A x */
+#define SPMV_BACKWARD 2  /**< Row vertex to column vertex: y (+)= A^T x */
+#define SPMV_BOTH     3  /**< Both ways: the graph as undirected */
+
+/**
+ * @struct SpmvFrontier
+ * @brief Sparse vector given as a list of vertices.
+ *
+ * Values are read from (or written to) the dense vector passed alongside;
+ * the frontier only names the active entries.
+ */
+typedef struct {
+	uint32_t *idx;    /**< Vertex ids (capacity: number of vertices) */
+	size_t len;       /**< Number of vertices */
+} SpmvFrontier;
+
+/** @brief Opaque engine state for one matrix. */
+typedef struct SpmvEngine SpmvEngine;
+
+/**
+ * @brief Creates an engine for a matrix.
+ *
+ * The matrix must outlive the engine. Its vertex numbering (including
+ * `bipartite`) is fixed at this point.
+ *
+ * @param m Input matrix
+ * @param n_threads Number of threads used by the kernels
+ * @return Engine, or NULL on allocation failure
+ */
+SpmvEngine *spmv_init(const CSCBinaryMatrix *m, unsigned int n_threads);
+
+/**
+ * @brief Frees an engine. Safe to call with NULL.
+ */
+void spmv_free(SpmvEngine *e);
+
+/**
+ * @brief Number of vertices, i.e. the length of every vector.
+ */
+size_t spmv_num_vertices(const SpmvEngine *e);
+
+/**
+ * @brief Allocates an empty frontier able to hold every vertex.
+ *
+ * @return 0 on success, 1 on allocation failure
+ */
+int spmv_frontier_init(const SpmvEngine *e, SpmvFrontier *f);
+
+/**
+ * @brief Frees the storage of a frontier.
+ */
+void spmv_frontier_free(SpmvFrontier *f);
+
+/**
+ * @brief Dense SpMV: y (+)= A (x) x over every edge.
+ *
+ * x and y may be the same array for the idempotent semirings (min-select
+ * and or-and), giving an in-place (asynchronous) sweep. Plus-times needs
+ * distinct arrays.
+ *
+ * @param e Engine
+ * @param s Semiring
+ * @param dirs SPMV_FORWARD, SPMV_BACKWARD or SPMV_BOTH
+ * @param kernel SPMV_PUSH or SPMV_PULL
+ * @param x Input vector
+ * @param y Output vector, accumulated into
+ * @param changed Output: the distinct entries of y that changed, or NULL
+ * @return Number of changed entries of y (without @p changed, an entry
+ *         updated several times may be counted more than once, and an
+ *         in-place push may lose a concurrent update to a worse one, to be
+ *         made good by the next sweep; 0 still means a fixpoint), or -1 on
+ *         allocation failure
+ */
+long spmv_dense(SpmvEngine *e, SpmvSemiring s, int dirs, SpmvKernel kernel,
+                const uint32_t *x, uint32_t *y, SpmvFrontier *changed);
+
+/**
+ * @brief Sparse SpMSpV: y (+)= A (x) x over the edges of the frontier.
+ *
+ * Push kernel over the out-edges of the vertices in @p in only, with
+ * values read from x. The same aliasing rules as spmv_dense() apply;
+ * @p changed must not be @p in.
+ *
+ * @return As for spmv_dense()
+ */
+long spmv_sparse(SpmvEngine *e, SpmvSemiring s, int dirs, const uint32_t *x,
+                 const SpmvFrontier *in, uint32_t *y, SpmvFrontier *changed);
+
+#endif /* SPMV_H */
@@ -0,0 +1,132 @@
+/**
+ * @file workspan.c
+ * @brief Per-phase work and span of the Cilk backend, measured by Cilkscale.
+ *
+ * Phases are looked up by name in a small table, in serial code only, so
+ * no locking is needed. Cilkscale's default timer counts nanoseconds.
+ */
+
+#include <string.h>
+
+#include "workspan.h"
+
+#if defined(CC_CILKSCALE)
+
+#include <cilk/cilkscale.h>
+
+/**
+ * @brief Sums of one phase and the reading at its open start.
+ */
+typedef struct {
+	const char *name;
+	wsp_t start;
+	wsp_t sum;
+	int open;
+} Phase;
+
+static Phase phases[WORKSPAN_MAX_PHASES];
+static size_t n_phases;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Finds a phase, adding it if it is new and there is room.
+ *
+ * @return The phase, or NULL if the table is full
+ */
+static Phase *
+find_phase(const char *name)
+{
+	for (size_t k = 0; k < n_phases; k++)
+		if (strcmp(phases[k].name, name) == 0)
+			return &phases[k];
+
+	if (n_phases == WORKSPAN_MAX_PHASES)
+		return NULL;
+
+	Phase *p = &phases[n_phases++];
+	p->name = name;
+	p->sum = wsp_zero();
+	p->open = 0;
+	return p;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc workspan_start()
+ */
+void
+workspan_start(const char *phase)
+{
+	Phase *p = find_phase(phase);
+	if (!p)
+		return;
+
+	p->open = 1;
+	p->start = wsp_getworkspan();
+}
+
+/**
+ * @copydoc workspan_end()
+ */
+void
+workspan_end(const char *phase)
+{
+	wsp_t now = wsp_getworkspan();
+	Phase *p = find_phase(phase);
+	if (!p || !p->open)
+		return;
+
+	p->sum = wsp_add(p->sum, wsp_sub(now, p->start));
+	p->open = 0;
+}
+
+/**
+ * @copydoc workspan_reset()
+ */
+void
+workspan_reset(void)
+{
+	for (size_t k = 0; k < n_phases; k++)
+		phases[k].sum = wsp_zero();
+}
+
+/**
+ * @copydoc workspan_collect()
+ */
+size_t
+workspan_collect(PhaseWorkSpan *out, size_t max, unsigned int trials)
+{
+	const double scale = 1e-9 / (trials ? trials : 1);
+	size_t n = n_phases < max ? n_phases : max;
+
+	for (size_t k = 0; k < n; k++) {
+		strncpy(out[k].phase, phases[k].name, sizeof(out[k].phase) - 1);
+		out[k].phase[sizeof(out[k].phase) - 1] = '\0';
+		out[k].work_s = phases[k].sum.work * scale;
+		out[k].span_s = phases[k].sum.span * scale;
+		out[k].burdened_span_s = phases[k].sum.bspan * scale;
+	}
+	return n;
+}
+
+#else
+
+/**
+ * @copydoc workspan_collect()
+ */
+size_t
+workspan_collect(PhaseWorkSpan *out, size_t max, unsigned int trials)
+{
+	(void)out;
+	(void)max;
+	(void)trials;
+	return 0;
+}
+
+#endif
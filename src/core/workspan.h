@@ -0,0 +1,91 @@
+/**
+ * @file workspan.h
+ * @brief Per-phase work and span of the Cilk backend, measured by Cilkscale.
+ *
+ * In the instrumented Cilk build (`make cilkscale`, which defines
+ * CC_CILKSCALE and compiles with `-fcilktool=cilkscale`) every phase marked
+ * with CC_PROBE_PHASE_START()/CC_PROBE_PHASE_END() (see probe.h) also reads
+ * wsp_getworkspan() at both ends, and the benchmark loop does the same
+ * around each timed trial as the phase `total`. The differences are summed
+ * per phase and reported per trial next to the wall time:
+ *
+ * - work: total time of all strands, the time on one core,
+ * - span: time of the longest chain of dependent strands, the time on
+ *   infinitely many cores,
+ * - burdened span: the span charged with a spawn and steal overhead per
+ *   parallel continuation.
+ *
+ * work / span is the parallelism, an upper bound on the speedup on any
+ * number of cores. work / burdened span bounds it from below: on P cores a
+ * greedy scheduler takes at most work / P + burdened span. A union-find
+ * phase whose parallelism is far above the core count but whose speedup is
+ * poor is held back by memory, not by its dependency structure.
+ *
+ * In every other build the markers compile to nothing and
+ * workspan_collect() reports no phases.
+ */
+
+#ifndef WORKSPAN_H
+#define WORKSPAN_H
+
+#include <stddef.h>
+
+/** @brief Phases a run can report. */
+#define WORKSPAN_MAX_PHASES 8
+
+/**
+ * @struct PhaseWorkSpan
+ * @brief Work and span of one phase, per trial.
+ */
+typedef struct {
+	char phase[16];         /**< Phase name, or "total" for the whole trial */
+	double work_s;          /**< Work in seconds */
+	double span_s;          /**< Span in seconds */
+	double burdened_span_s; /**< Span with spawn and steal overheads, in seconds */
+} PhaseWorkSpan;
+
+#if defined(CC_CILKSCALE)
+
+/**
+ * @brief Starts measuring a phase.
+ *
+ * Must be called from serial code, with the matching workspan_end() in the
+ * same function. Phases may nest but not recurse.
+ *
+ * @param phase Phase name (a string literal)
+ */
+void workspan_start(const char *phase);
+
+/**
+ * @brief Stops measuring a phase and adds the difference to its sums.
+ */
+void workspan_end(const char *phase);
+
+/**
+ * @brief Clears the sums, e.g. after the warm-up run.
+ */
+void workspan_reset(void);
+
+#define CC_WORKSPAN_START(phase) workspan_start(phase)
+#define CC_WORKSPAN_END(phase)   workspan_end(phase)
+#define CC_WORKSPAN_RESET()      workspan_reset()
+
+#else
+
+#define CC_WORKSPAN_START(phase) ((void)0)
+#define CC_WORKSPAN_END(phase)   ((void)0)
+#define CC_WORKSPAN_RESET()      ((void)0)
+
+#endif
+
+/**
+ * @brief Reports the measured phases, per trial.
+ *
+ * @param out Output: one entry per phase, in order of first use
+ * @param max Entries available in @p out
+ * @param trials Trials the sums cover
+ * @return Number of entries written; 0 unless built with CC_CILKSCALE
+ */
+size_t workspan_collect(PhaseWorkSpan *out, size_t max, unsigned int trials);
+
+#endif /* WORKSPAN_H */
@@ -21,8 +21,22 @@
  * Usage: ./connected_components [-t n_threads] [-n n_trials] ./data_filepath
  */
 
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
 #include "connected_components.h"
+#include "edgelist.h"
+#include "linestream.h"
 #include "matrix.h"
+#include "memplan.h"
+#include "omptool.h"
+#include "profile.h"
+#include "reorder.h"
+#include "shard.h"
 #include "error.h"
 #include "benchmark.h"
 #include "args.h"
@@ -41,15 +55,268 @@
 
 const char *program_name = "connected_components";
 
+/**
+ * @brief Labels the components of a matrix and writes them out as shards.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+write_shards(const CSCBinaryMatrix *matrix, const Args *args)
+{
+	uint32_t *label = malloc(csc_num_vertices(matrix) * sizeof(uint32_t));
+	if (!label) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	size_t n_shards = 0;
+	ComponentShard *shards = NULL;
+	int ret = 1;
+
+	if (cc_labels(matrix, args->n_threads, label))
+		goto out;
+
+	shards = csc_split_components(matrix, label, args->shard_bin, args->n_threads, &n_shards);
+	if (!shards)
+		goto out;
+
+	if (csc_save_shards(shards, n_shards, args->shard_dir))
+		goto out;
+
+	fprintf(stderr, "Wrote %zu shards to %s\n", n_shards, args->shard_dir);
+	ret = 0;
+
+out:
+	csc_free_shards(shards, n_shards);
+	free(label);
+	return ret;
+}
+
+/**
+ * @brief Trial state of an external-memory benchmark.
+ */
+typedef struct {
+	const Args *args;
+	ExternalStats stats;
+} ExternalRun;
+
+static long
+run_external(void *ctx, unsigned int n_threads)
+{
+	ExternalRun *r = ctx;
+	(void)n_threads;  /* The engine is sequential */
+	return cc_external(r->args->filepath, r->args->bipartite,
+	                   (size_t)r->args->ext_mem_mb << 20, &r->stats);
+}
+
+/**
+ * @brief Records the memory plan of a budgeted run in its result.
+ */
+static void
+record_plan(Benchmark *benchmark, const MemPlan *plan)
+{
+	benchmark->result.has_plan = 1;
+	benchmark->result.plan.budget_mb = plan->budget / (1024.0 * 1024.0);
+	benchmark->result.plan.projected_peak_mb = plan->projected / (1024.0 * 1024.0);
+	snprintf(benchmark->result.plan.strategy, sizeof(benchmark->result.plan.strategy),
+	         "%s", mem_strategy_name(plan->strategy));
+}
+
+/**
+ * @brief Benchmarks the external-memory engine, which streams the matrix
+ * from disk instead of loading it.
+ *
+ * @param plan Memory plan that chose this mode, or NULL
+ * @return 0 on success, nonzero as for benchmark_func()
+ */
+static int
+benchmark_external(const Args *args, const MemPlan *plan)
+{
+	/* Only the header is needed for the matrix information */
+	CSCBinaryMatrix shape;
+	CSCEdgeStream *s = csc_open_edges(args->filepath, &shape);
+	if (!s)
+		return 1;
+	csc_close_edges(s);
+	shape.bipartite = args->bipartite;
+
+	Benchmark *benchmark = benchmark_init(IMPLEMENTATION_NAME, args->filepath, args->n_trials,
+	                                      args->n_threads, args->algorithm_variant, &shape);
+	if (!benchmark)
+		return 1;
+
+	ExternalRun run = { .args = args };
+	int ret = benchmark_func(run_external, NULL, &run, benchmark);
+
+	/* Every trial does the same I/O; report the last one */
+	benchmark->result.has_io = 1;
+	benchmark->result.io.budget_mb = args->ext_mem_mb;
+	benchmark->result.io.read_mb = run.stats.bytes_read / (1024.0 * 1024.0);
+	benchmark->result.io.written_mb = run.stats.bytes_written / (1024.0 * 1024.0);
+	benchmark->result.io.passes = run.stats.passes;
+	benchmark->result.io.levels = run.stats.levels;
+	if (plan)
+		record_plan(benchmark, plan);
+
+	benchmark_print(benchmark);
+	benchmark_free(benchmark);
+	return ret;
+}
+
+/**
+ * @brief Applies the edge order of the run to a loaded matrix and records
+ * it in the benchmark info.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+apply_order(CSCBinaryMatrix *matrix, const Args *args, Benchmark *benchmark)
+{
+	CSCOrder order;
+	if (!args->order || csc_order_parse(args->order, &order))
+		return 0;
+
+	if (csc_reorder(matrix, order, args->order_seed, args->n_threads))
+		return 1;
+
+	snprintf(benchmark->benchmark_info.order, sizeof(benchmark->benchmark_info.order),
+	         "%s", args->order);
+	benchmark->benchmark_info.order_seed = args->order_seed;
+	return 0;
+}
+
+/**
+ * @brief Trial state of an edge subset benchmark.
+ */
+typedef struct {
+	const CSCBinaryMatrix *matrix;
+	unsigned int n_subsets;
+	uint32_t counts[CSC_MAX_SUBSETS];
+} SubsetRun;
+
+static long
+run_subsets(void *ctx, unsigned int n_threads)
+{
+	SubsetRun *r = ctx;
+	if (cc_subsets(r->matrix, n_threads, r->n_subsets, r->counts))
+		return -1;
+	return r->counts[0];
+}
+
+/**
+ * @brief Benchmarks the components of the edge subsets of a masked edge
+ * list, all counted in each trial.
+ *
+ * The result's component count is that of subset 0; every subset is
+ * listed in `subset_components`.
+ *
+ * @return 0 on success, nonzero as for benchmark_func()
+ */
+static int
+benchmark_subsets(const Args *args)
+{
+	CSCBinaryMatrix *matrix = csc_load_edgelist_masked(args->filepath, args->n_threads);
+	if (!matrix)
+		return 1;
+
+	Benchmark *benchmark = benchmark_init(IMPLEMENTATION_NAME, args->filepath, args->n_trials,
+	                                      args->n_threads, args->algorithm_variant, matrix);
+	if (!benchmark) {
+		csc_free_matrix(matrix);
+		return 1;
+	}
+
+	int ret = 0;
+	if (args->profile) {
+		ret = csc_profile(matrix, args->n_threads, &benchmark->matrix_info.profile);
+		benchmark->matrix_info.has_profile = !ret;
+	}
+	if (!ret)
+		ret = apply_order(matrix, args, benchmark);
+
+	SubsetRun run = { .matrix = matrix, .n_subsets = args->subsets };
+	if (!ret)
+		ret = benchmark_func(run_subsets, NULL, &run, benchmark);
+
+	benchmark->result.n_subsets = run.n_subsets;
+	for (unsigned int s = 0; s < run.n_subsets; s++)
+		benchmark->result.subset_components[s] = run.counts[s];
+
+	benchmark_print(benchmark);
+	benchmark_free(benchmark);
+	csc_free_matrix(matrix);
+	return ret;
+}
+
+/**
+ * @brief State of a streamed run.
+ */
+typedef struct {
+	const Args *args;
+	StreamStats stats;
+} StreamRun;
+
+static long
+run_stream(void *ctx, unsigned int n_threads)
+{
+	StreamRun *r = ctx;
+	return cc_stream(r->args->filepath, r->args->bipartite, n_threads, &r->stats);
+}
+
+/**
+ * @brief Benchmarks a graph read once from a pipe or standard input.
+ *
+ * The input cannot be read again, so the run is a single trial without
+ * warm-up, with concurrent union-find whatever the variant. The shape is
+ * only known once the input has been read.
+ *
+ * @return 0 on success, 1 on error
+ */
+static int
+benchmark_stream(const Args *args)
+{
+	CSCBinaryMatrix shape;
+	memset(&shape, 0, sizeof(shape));
+	shape.bipartite = args->bipartite;
+
+	Benchmark *benchmark = benchmark_init(IMPLEMENTATION_NAME, args->filepath, 1,
+	                                      args->n_threads, 1, &shape);
+	if (!benchmark)
+		return 1;
+
+	StreamRun run = { .args = args };
+	int ret = benchmark_once(run_stream, &run, benchmark);
+
+	benchmark->matrix_info.rows = run.stats.nrows;
+	benchmark->matrix_info.cols = run.stats.ncols;
+	benchmark->matrix_info.nnz = run.stats.entries;
+
+	benchmark_print(benchmark);
+	benchmark_free(benchmark);
+	return ret;
+}
+
+/**
+ * @brief Trial state of a composed algorithm.
+ */
+typedef struct {
+	const CSCBinaryMatrix *matrix;
+	CCComposition comp;
+} ComposeRun;
+
+static long
+run_compose(void *ctx, unsigned int n_threads)
+{
+	ComposeRun *r = ctx;
+	return cc_compose(r->matrix, n_threads, r->comp);
+}
+
 int
 main(int argc, char *argv[])
 {
 	CSCBinaryMatrix *matrix;
 	Benchmark *benchmark = NULL;
-	char *filepath;
-	unsigned int n_trials;
-	unsigned int n_threads;
-	unsigned int algorithm_variant;
+	Args args;
 	int ret = 0;
 	int (*cc_func)(const CSCBinaryMatrix*, const unsigned int, const unsigned int);
 
@@ -57,21 +324,163 @@ main(int argc, char *argv[])
 	set_program_name(argv[0]);
 
 	/* Parse command line arguments */
-	if (parseargs(argc, argv, &n_threads, &n_trials, &algorithm_variant, &filepath)) {
+	if (parseargs(argc, argv, &args)) {
+		return 1;
+	}
+
+	if (args.manifest || args.history) {
+		print_error(__func__, "campaigns and history are handled by benchmark_runner", 0);
+		return 1;
+	}
+
+	/* A composed algorithm replaces the variant on the loaded matrix */
+	CCComposition comp;
+	if (args.composition) {
+		if (cc_compose_parse(args.composition, &comp)) {
+			print_error(__func__, "-a must be [none|kout|bfs|ldd+]rem|rand|lp|sv", 0);
+			return 1;
+		}
+		if (args.ext_mem_mb || args.mem_budget_mb || args.subsets) {
+			print_error(__func__, "composed algorithms cannot be combined with -X, --mem-budget or --subsets", 0);
+			return 1;
+		}
+	}
+
+	/* Runtime overheads are recorded by the OMPT tool of the OpenMP backend */
+	if (args.ompt && omptool_enable()) {
+		print_error(__func__, "--ompt needs the OpenMP backend built with OMPT=1 on an OMPT runtime", 0);
+		return 1;
+	}
+
+	/* A matrix handed over by the runner is mapped, never read from the path */
+	if (args.matrix_fd >= 0 && (args.ext_mem_mb || args.mem_budget_mb || args.subsets)) {
+		print_error(__func__, "--matrix-fd cannot be combined with -X, --mem-budget or --subsets", 0);
+		return 1;
+	}
+
+	/* Pipes are read once, straight into the union-find */
+	if (args.matrix_fd < 0 && line_stream_is_pipe(args.filepath)) {
+		if (args.ext_mem_mb || args.mem_budget_mb || args.profile || args.subsets ||
+		    args.order || args.shard_dir || args.composition || args.checkpoint) {
+			print_error(__func__, "streamed input cannot be combined with -X, --mem-budget, --profile, --subsets, --order, -S, -a or --checkpoint", 0);
+			return 1;
+		}
+		return benchmark_stream(&args);
+	}
+
+	/* Label propagation checkpoints, resuming the first trial if asked;
+	 * only variant 0 on the loaded matrix propagates labels */
+	if (args.checkpoint && (args.algorithm_variant != 0 || args.composition ||
+	                        args.ext_mem_mb || args.subsets)) {
+		print_error(__func__, "--checkpoint needs label propagation (-v 0) and cannot be combined with -a, -X or --subsets", 0);
+		return 1;
+	}
+	if (args.checkpoint)
+		checkpoint_configure(args.checkpoint, args.checkpoint_interval, args.resume);
+
+	/* External-memory mode streams the matrix instead of loading it */
+	if (args.ext_mem_mb && (args.profile || args.subsets || args.order)) {
+		print_error(__func__, "profiles, edge subsets and edge orders need the loaded matrix, not external-memory mode", 0);
 		return 1;
 	}
+	if (args.ext_mem_mb)
+		return benchmark_external(&args, NULL);
+
+	/* Under a memory budget, project the peak and pick a strategy that fits */
+	MemPlan plan;
+	if (args.mem_budget_mb) {
+		if (args.profile || args.subsets || args.order || args.shard_dir) {
+			print_error(__func__, "memory budgets cannot be combined with profiles, edge subsets, edge orders or -S", 0);
+			return 1;
+		}
+		if (mem_plan(args.filepath, args.bipartite, args.algorithm_variant,
+		             (size_t)args.mem_budget_mb << 20, &plan))
+			return 1;
+		if (plan.strategy == MEM_EXTERNAL && args.checkpoint) {
+			print_error(__func__, "the memory budget needs external-memory mode, which cannot be checkpointed", 0);
+			return 1;
+		}
+		if (plan.strategy == MEM_EXTERNAL) {
+			args.ext_mem_mb = (unsigned int)(plan.ext_budget >> 20);
+			return benchmark_external(&args, &plan);
+		}
+	}
+
+	/* Shards would report the reordered vertex numbers */
+	if (args.order && args.shard_dir) {
+		print_error(__func__, "edge orders cannot be combined with -S", 0);
+		return 1;
+	}
+
+	/* Edge subsets are read from the masks of an edge list */
+	if (args.subsets && (args.bipartite || args.shard_dir)) {
+		print_error(__func__, "edge subsets cannot be combined with -b or -S", 0);
+		return 1;
+	}
+	if (args.subsets)
+		return benchmark_subsets(&args);
 	
-	/* Load the sparse matrix */
-	matrix = csc_load_matrix(filepath);
+	/* Edge lists are graphs, without separate row and column vertices */
+	const char *ext = strrchr(args.filepath, '.');
+	if (args.bipartite && ext && strcmp(ext, ".el") == 0) {
+		print_error(__func__, "edge lists cannot be loaded in bipartite mode", 0);
+		return 1;
+	}
+
+	/* Load the sparse matrix, on the run's threads where the format allows,
+	 * or map the copy the runner has already loaded */
+	if (args.matrix_fd >= 0) {
+		matrix = csc_map_matrix_fd(args.matrix_fd);
+		close(args.matrix_fd);
+	} else {
+		matrix = csc_load_matrix_parallel(args.filepath, args.n_threads);
+	}
 	if (!matrix)
 		return 1;
 
+	/* Rows and columns become separate vertex ranges in bipartite mode */
+	matrix->bipartite = args.bipartite;
+	if (csc_num_vertices(matrix) > UINT32_MAX) {
+		print_error(__func__, "too many vertices for 32-bit labels", 0);
+		csc_free_matrix(matrix);
+		return 1;
+	}
+
 	/* Initialize benchmarking structure */
-	benchmark = benchmark_init(IMPLEMENTATION_NAME, filepath, n_trials, n_threads, algorithm_variant, matrix);
+	benchmark = benchmark_init(IMPLEMENTATION_NAME, args.filepath, args.n_trials, args.n_threads, args.algorithm_variant, matrix);
 	if (!benchmark) {
 		csc_free_matrix(matrix);
 		return 1;
 	}
+	if (args.mem_budget_mb)
+		record_plan(benchmark, &plan);
+
+	/* A warm-up would resume from the checkpoint in place of the first trial */
+	benchmark->benchmark_info.no_warmup = args.resume;
+
+	/* Optionally profile the graph before the trials */
+	if (args.profile) {
+		if (csc_profile(matrix, args.n_threads, &benchmark->matrix_info.profile)) {
+			benchmark_free(benchmark);
+			csc_free_matrix(matrix);
+			return 1;
+		}
+		benchmark->matrix_info.has_profile = 1;
+	}
+
+	/* Optionally reorder the edges, after profiling the graph as loaded */
+	if (apply_order(matrix, &args, benchmark)) {
+		benchmark_free(benchmark);
+		csc_free_matrix(matrix);
+		return 1;
+	}
+
+	/* Checkpoints resume only on this matrix, in this order */
+	if (args.checkpoint && checkpoint_identify(matrix, args.order, args.order_seed, args.n_threads)) {
+		benchmark_free(benchmark);
+		csc_free_matrix(matrix);
+		return 1;
+	}
 
 	/* Implementation is selected by the preproccesor.
 	 * (definitions made through compiler flags)
@@ -87,10 +496,21 @@ main(int argc, char *argv[])
 	#endif
 
 	/* Actually run the benchmark */
-	ret = benchmark_cc(cc_func, matrix, benchmark);
+	if (args.composition) {
+		ComposeRun run = { .matrix = matrix, .comp = comp };
+		cc_compose_name(comp, benchmark->benchmark_info.composition,
+		                sizeof(benchmark->benchmark_info.composition));
+		ret = benchmark_func(run_compose, NULL, &run, benchmark);
+	} else {
+		ret = benchmark_cc(cc_func, matrix, benchmark);
+	}
 
 	benchmark_print(benchmark);
 
+	/* Optionally split the graph into per-component shards */
+	if (!ret && args.shard_dir && write_shards(matrix, &args))
+		ret = 1;
+
 	/* Cleanup */
 	benchmark_free(benchmark);
 	csc_free_matrix(matrix);
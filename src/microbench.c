@@ -0,0 +1,495 @@
+/**
+ * @file microbench.c
+ * @brief Micro-benchmarks for the union-find and bitmap counting primitives.
+ *
+ * Times the union-find kernels and `count_labels_bitmap()` from
+ * cc_primitives.h in isolation, on synthetic workloads with controlled
+ * access patterns:
+ *
+ * - find:   forests of stars or chains, queried in sequential or random order
+ * - union:  sequential pairs, random pairs, and pairs with one endpoint in a
+ *           hot set of 1, 64 or 4096 nodes (increasing contention)
+ * - bitmap: label arrays from L1-sized to DRAM-sized
+ *
+ * find and union run once per compression strategy (full, halving,
+ * splitting) and are swept over 1, 2, 4, ... threads up to -t. Trials
+ * are timed with benchmark_func() and summarised with the same statistics
+ * and JSON fields as a full benchmark run; throughput is in operations per
+ * second (the `nnz` of each case is its operation count).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <omp.h>
+
+#include "benchmark.h"
+#include "cc_primitives.h"
+#include "error.h"
+#include "json.h"
+
+#define CHAIN_LEN 64    /* Nodes per tree in the find forests */
+#define SEED 0x9E3779B97F4A7C15ULL
+
+const char *program_name = "microbench";
+
+/**
+ * @brief Primitive exercised by a case.
+ */
+typedef enum {
+	KIND_FIND,
+	KIND_UNION,
+	KIND_BITMAP
+} Kind;
+
+/**
+ * @brief Compression strategies, in the order of strategy_names.
+ */
+typedef enum {
+	STRATEGY_FULL,
+	STRATEGY_HALVING,
+	STRATEGY_SPLITTING,
+	STRATEGY_COUNT
+} Strategy;
+
+static const char *strategy_names[STRATEGY_COUNT] = { "full", "halving", "splitting" };
+
+static const char *kind_names[] = { "find", "union", "bitmap" };
+
+/**
+ * @struct MicroCase
+ * @brief Static description of one micro-benchmark case.
+ */
+typedef struct {
+	const char *name;   /**< Access pattern, part of the reported name */
+	Kind kind;          /**< Primitive under test */
+	int chain;          /**< find: chains (1) or stars (0) */
+	int random;         /**< find: random query order; union: random pairs */
+	uint32_t hot;       /**< union: size of the hot endpoint set, 0 for none */
+	unsigned log2_div;  /**< bitmap: size is 2^(scale - log2_div) */
+} MicroCase;
+
+static const MicroCase cases[] = {
+	{ "star/seq",   KIND_FIND,   0, 0, 0,    0  },
+	{ "star/rand",  KIND_FIND,   0, 1, 0,    0  },
+	{ "chain/seq",  KIND_FIND,   1, 0, 0,    0  },
+	{ "chain/rand", KIND_FIND,   1, 1, 0,    0  },
+	{ "seq",        KIND_UNION,  0, 0, 0,    0  },
+	{ "rand",       KIND_UNION,  0, 1, 0,    0  },
+	{ "hot4096",    KIND_UNION,  0, 1, 4096, 0  },
+	{ "hot64",      KIND_UNION,  0, 1, 64,   0  },
+	{ "hot1",       KIND_UNION,  0, 1, 1,    0  },
+	{ "l1",         KIND_BITMAP, 0, 0, 0,    10 },
+	{ "l2",         KIND_BITMAP, 0, 0, 0,    6  },
+	{ "llc",        KIND_BITMAP, 0, 0, 0,    2  },
+	{ "dram",       KIND_BITMAP, 0, 0, 0,    0  },
+};
+
+/**
+ * @struct Workload
+ * @brief Inputs of the case being run, shared by its setup and timed body.
+ */
+typedef struct {
+	const MicroCase *c;
+	Strategy strategy;   /**< Kernel specialisation under test */
+	char name[32];       /**< Reported as the result's algorithm name */
+	uint32_t n;          /**< Number of nodes/labels */
+	uint32_t m;          /**< Number of operations */
+	uint32_t *label;     /**< Union-find parent array, or bitmap labels */
+	uint32_t *ops;       /**< find: query nodes; union: m (a, b) pairs */
+} Workload;
+
+/* ------------------------------------------------------------------------- */
+/*                          Kernel Specialisations                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Instantiates find/union for one strategy and their timed loops.
+ *
+ * find loops return the number of queries that hit a root, union loops the
+ * number of merging unions; both are independent of scheduling.
+ */
+#define DEFINE_STRATEGY(strategy, suffix)                                     \
+CC_DEFINE_FIND(find_##suffix, uint32_t, strategy, RELAXED)                    \
+CC_DEFINE_UNION(union_##suffix, uint32_t, find_##suffix, RELAXED)             \
+                                                                              \
+static long                                                                   \
+find_loop_##suffix(const Workload *w, unsigned int n_threads)                 \
+{                                                                             \
+	long hits = 0;                                                        \
+	_Pragma("omp parallel for num_threads(n_threads) schedule(dynamic, 1024) reduction(+:hits)") \
+	for (uint32_t i = 0; i < w->m; i++) {                                 \
+		uint32_t x = w->ops[i];                                       \
+		if (find_##suffix(w->label, x) == x)                          \
+			hits++;                                               \
+	}                                                                     \
+	return hits;                                                          \
+}                                                                             \
+                                                                              \
+static long                                                                   \
+union_loop_##suffix(const Workload *w, unsigned int n_threads)                \
+{                                                                             \
+	long merged = 0;                                                      \
+	_Pragma("omp parallel for num_threads(n_threads) schedule(dynamic, 1024) reduction(+:merged)") \
+	for (uint32_t i = 0; i < w->m; i++)                                   \
+		merged += union_##suffix(w->label, w->ops[2 * i], w->ops[2 * i + 1]); \
+	return merged;                                                        \
+}
+
+DEFINE_STRATEGY(FULL, full)
+DEFINE_STRATEGY(HALVING, halving)
+DEFINE_STRATEGY(SPLITTING, splitting)
+
+static long (*const find_loops[STRATEGY_COUNT])(const Workload *, unsigned int) = {
+	find_loop_full, find_loop_halving, find_loop_splitting
+};
+
+static long (*const union_loops[STRATEGY_COUNT])(const Workload *, unsigned int) = {
+	union_loop_full, union_loop_halving, union_loop_splitting
+};
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+		"Usage: %s [OPTIONS]\n\n"
+		"Options:\n"
+		"  -t <threads>  Maximum number of threads (default: 8)\n"
+		"  -n <trials>   Number of trials per case (default: 10)\n"
+		"  -s <scale>    log2 of the number of nodes (default: 20)\n"
+		"  -o <file>     Write JSON results to a file (default: stdout)\n"
+		"  -h            Show this help message and exit\n",
+		program_name);
+}
+
+/**
+ * @brief xorshift64* step; deterministic so every run sees the same input.
+ */
+static inline uint64_t
+next_rand(uint64_t *s)
+{
+	*s ^= *s >> 12;
+	*s ^= *s << 25;
+	*s ^= *s >> 27;
+	return *s * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Parses a positive integer option value.
+ * @return 0 on success, 1 on error.
+ */
+static int
+parse_uint(const char *s, unsigned int min, unsigned int max, unsigned int *out)
+{
+	char *end;
+	errno = 0;
+	unsigned long val = strtoul(s, &end, 10);
+	if (errno || *end != '\0' || val < min || val > max)
+		return 1;
+	*out = (unsigned int)val;
+	return 0;
+}
+
+/**
+ * @brief Builds the operation stream of a case.
+ * @return 0 on success, 1 on allocation failure.
+ */
+static int
+workload_init(Workload *w, const MicroCase *c, Strategy strategy, unsigned int scale)
+{
+	uint64_t s = SEED;
+
+	w->c = c;
+	w->strategy = strategy;
+	if (c->kind == KIND_BITMAP)
+		snprintf(w->name, sizeof(w->name), "%s/%s", kind_names[c->kind], c->name);
+	else
+		snprintf(w->name, sizeof(w->name), "%s/%s/%s", kind_names[c->kind],
+		         strategy_names[strategy], c->name);
+	w->n = (c->kind == KIND_BITMAP) ? 1u << (scale - c->log2_div) : 1u << scale;
+	w->m = w->n;
+	w->label = malloc((size_t)w->n * sizeof(uint32_t));
+	w->ops = NULL;
+	if (!w->label)
+		goto fail;
+
+	switch (c->kind) {
+	case KIND_FIND:
+		w->ops = malloc((size_t)w->m * sizeof(uint32_t));
+		if (!w->ops)
+			goto fail;
+		for (uint32_t i = 0; i < w->m; i++)
+			w->ops[i] = i;
+		if (c->random) {
+			/* Fisher-Yates shuffle of the query order */
+			for (uint32_t i = w->m - 1; i > 0; i--) {
+				uint32_t j = (uint32_t)(next_rand(&s) % (i + 1));
+				uint32_t t = w->ops[i];
+				w->ops[i] = w->ops[j];
+				w->ops[j] = t;
+			}
+		}
+		break;
+
+	case KIND_UNION:
+		w->ops = malloc((size_t)w->m * 2 * sizeof(uint32_t));
+		if (!w->ops)
+			goto fail;
+		for (uint32_t i = 0; i < w->m; i++) {
+			uint32_t a, b;
+			if (!c->random) {
+				a = i;
+				b = (i + 1 < w->n) ? i + 1 : i;
+			} else {
+				a = (uint32_t)(next_rand(&s) % w->n);
+				b = (uint32_t)(next_rand(&s) % (c->hot ? c->hot : w->n));
+			}
+			w->ops[2 * i] = a;
+			w->ops[2 * i + 1] = b;
+		}
+		break;
+
+	case KIND_BITMAP:
+		/* Labels drawn from [0, n): as many distinct values as a typical run */
+		for (uint32_t i = 0; i < w->n; i++)
+			w->label[i] = (uint32_t)(next_rand(&s) % w->n);
+		break;
+	}
+
+	return 0;
+
+fail:
+	print_error(__func__, "malloc() failed", errno);
+	free(w->label);
+	free(w->ops);
+	return 1;
+}
+
+static void
+workload_free(Workload *w)
+{
+	free(w->label);
+	free(w->ops);
+}
+
+/**
+ * @brief Restores the initial union-find state before each trial.
+ *
+ * find cases start from a forest of CHAIN_LEN-node trees rooted at their
+ * first node: stars point every node at the root, chains point every node
+ * at its predecessor. union cases start from singletons.
+ */
+static int
+setup_trial(void *ctx)
+{
+	Workload *w = ctx;
+
+	if (w->c->kind == KIND_BITMAP)
+		return 0;
+
+	for (uint32_t i = 0; i < w->n; i++) {
+		uint32_t root = i - i % CHAIN_LEN;
+		if (w->c->kind == KIND_UNION || i == root)
+			w->label[i] = i;
+		else
+			w->label[i] = w->c->chain ? i - 1 : root;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Timed body of a case.
+ *
+ * Returns a checksum that must not change between trials: the number of
+ * queries that hit a root for find, the number of merging unions for
+ * union, and the number of distinct labels for bitmap.
+ */
+static long
+run_trial(void *ctx, unsigned int n_threads)
+{
+	Workload *w = ctx;
+
+	switch (w->c->kind) {
+	case KIND_FIND:
+		return find_loops[w->strategy](w, n_threads);
+
+	case KIND_UNION:
+		return union_loops[w->strategy](w, n_threads);
+
+	case KIND_BITMAP:
+		return count_labels_bitmap(w->label, w->n);
+	}
+
+	return -1;
+}
+
+/**
+ * @brief Prints one finished case as an element of the "runs" array.
+ */
+static void
+print_run(FILE *f, const Benchmark *b, int first)
+{
+	fprintf(f, first ? "\n" : ",\n");
+	fprintf(f, "    {\n");
+	print_matrix_info(f, &b->matrix_info, 6);
+	fprintf(f, ",\n");
+	print_benchmark_info(f, &b->benchmark_info, 6);
+	fprintf(f, ",\n");
+	fprintf(f, "      \"results\": [\n");
+	print_result(f, &b->result, 8);
+	fprintf(f, "\n      ]\n");
+	fprintf(f, "    }");
+}
+
+/**
+ * @brief Runs a case at one thread count and appends it to the output.
+ * @return 0 on success, 1 on error.
+ */
+static int
+run_case(FILE *out, Workload *w, unsigned int n_threads, unsigned int n_trials,
+         double *baseline, int *first)
+{
+	/* Only the dimensions are read from the matrix */
+	CSCBinaryMatrix shape = { .nrows = w->n, .ncols = w->n, .nnz = w->m };
+	char path[64];
+	snprintf(path, sizeof(path), "synthetic/%s/%s", kind_names[w->c->kind], w->c->name);
+
+	Benchmark *b = benchmark_init(w->name, path, n_trials, n_threads, 0, &shape);
+	if (!b)
+		return 1;
+
+	int ret = benchmark_func(run_trial, setup_trial, w, b);
+	if (ret) {
+		print_error(__func__, "micro-benchmark failed", 0);
+		benchmark_free(b);
+		return 1;
+	}
+
+	benchmark_finalize(b);
+
+	/* Speedup is relative to the single-thread run of the same case */
+	if (n_threads == 1) {
+		*baseline = b->result.stats.mean_time_s;
+	} else if (*baseline > 0.0) {
+		b->result.speedup = *baseline / b->result.stats.mean_time_s;
+		b->result.efficiency = b->result.speedup / n_threads;
+		b->result.has_metrics = 1;
+	}
+
+	fprintf(stderr, "%-28s %3u threads  %10.3f Mops/s\n", w->name, n_threads,
+	        b->result.throughput_edges_per_sec / 1e6);
+
+	if (*first) {
+		fprintf(out, "{\n");
+		print_sys_info(out, &b->sys_info, 2);
+		fprintf(out, ",\n");
+		fprintf(out, "  \"runs\": [");
+	}
+	print_run(out, b, *first);
+	*first = 0;
+
+	benchmark_free(b);
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                   Main                                    */
+/* ------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int max_threads = 8, n_trials = 10, scale = 20;
+	const char *output = NULL;
+
+	set_program_name(argv[0]);
+	opterr = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:n:s:o:h")) != -1) {
+		switch (opt) {
+		case 't':
+			if (parse_uint(optarg, 1, 1024, &max_threads)) {
+				print_error(__func__, "-t must be between 1 and 1024", 0);
+				return 1;
+			}
+			break;
+		case 'n':
+			if (parse_uint(optarg, 1, 100000, &n_trials)) {
+				print_error(__func__, "-n must be a positive integer", 0);
+				return 1;
+			}
+			break;
+		case 's':
+			if (parse_uint(optarg, 10, 30, &scale)) {
+				print_error(__func__, "-s must be between 10 and 30", 0);
+				return 1;
+			}
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'h':
+			usage();
+			return 0;
+		default: {
+			char err[64];
+			snprintf(err, sizeof(err), "invalid option '-%c'", optopt ? optopt : '?');
+			print_error(__func__, err, 0);
+			usage();
+			return 1;
+		}
+		}
+	}
+
+	FILE *out = stdout;
+	if (output && !(out = fopen(output, "w"))) {
+		print_error(__func__, "failed to create output file", errno);
+		return 1;
+	}
+
+	int ret = 0, first = 1;
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]) && !ret; i++) {
+		const MicroCase *c = &cases[i];
+		if (c->kind == KIND_BITMAP && c->log2_div >= scale)
+			continue;
+
+		/* The bitmap count is sequential in every backend */
+		unsigned int n_strategies = (c->kind == KIND_BITMAP) ? 1 : STRATEGY_COUNT;
+		unsigned int top = (c->kind == KIND_BITMAP) ? 1 : max_threads;
+
+		for (unsigned int st = 0; st < n_strategies && !ret; st++) {
+			Workload w;
+			if (workload_init(&w, c, (Strategy)st, scale)) {
+				ret = 1;
+				break;
+			}
+
+			double baseline = 0.0;
+			for (unsigned int t = 1; t <= top && !ret; t = (t < top && 2 * t > top) ? top : 2 * t)
+				ret = run_case(out, &w, t, n_trials, &baseline, &first);
+
+			workload_free(&w);
+		}
+	}
+
+	if (!first)
+		fprintf(out, "\n  ]\n}\n");
+
+	if (out != stdout && fclose(out) != 0) {
+		print_error(__func__, "failed to write output file", errno);
+		ret = 1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,487 @@
+/**
+ * @file query.c
+ * @brief Query and summary tool for the JSONL results history
+ *
+ * Reads a history written by `benchmark_runner -H`, filters the records,
+ * groups them and summarises one metric per group. For example, the
+ * median throughput of OpenMP union-find on orkut over its last 30 runs:
+ *
+ *     results_query -f algorithm=OpenMP -f variant=1 -f matrix=orkut \
+ *                   -l 30 -m throughput benchmarks/history.jsonl
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "error.h"
+#include "json.h"
+
+#define MAX_FILTERS 16
+#define MAX_GROUP_FIELDS 8
+#define MAX_KEY 256
+
+const char *program_name = "results_query";
+
+/**
+ * @brief Record fields usable in filters and groupings.
+ */
+typedef enum {
+	FIELD_ALGORITHM,
+	FIELD_VARIANT,
+	FIELD_MATRIX,
+	FIELD_THREADS,
+	FIELD_HOST,
+	FIELD_REVISION,
+	FIELD_COUNT
+} Field;
+
+static const char *field_names[FIELD_COUNT] = {
+	"algorithm", "variant", "matrix", "threads", "host", "revision"
+};
+
+/**
+ * @brief Metrics that can be summarised.
+ */
+typedef enum {
+	METRIC_THROUGHPUT,
+	METRIC_MEAN_TIME,
+	METRIC_MEDIAN_TIME,
+	METRIC_MIN_TIME,
+	METRIC_MEMORY,
+	METRIC_SPEEDUP,
+	METRIC_EFFICIENCY,
+	METRIC_COUNT
+} Metric;
+
+static const char *metric_names[METRIC_COUNT] = {
+	"throughput", "mean_time", "median_time", "min_time",
+	"memory", "speedup", "efficiency"
+};
+
+typedef struct {
+	Field field;
+	char value[MAX_KEY];
+} Filter;
+
+/**
+ * @struct Group
+ * @brief Metric samples of one group, in history order.
+ */
+typedef struct {
+	char key[MAX_KEY];
+	double *values;
+	size_t count;
+	size_t capacity;
+} Group;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+		"Usage: %s [OPTIONS] <history.jsonl>\n\n"
+		"Options:\n"
+		"  -f <field>=<value>  Keep records whose field matches (repeatable)\n"
+		"  -g <f1,f2,...>      Group by fields (default: algorithm,variant,matrix)\n"
+		"  -m <metric>         Metric to summarise (default: throughput)\n"
+		"  -l <N>              Only use the last N runs of each group\n"
+		"  -h                  Show this help message and exit\n\n"
+		"Fields:  algorithm, variant, matrix, threads, host, revision\n"
+		"         (matrix matches any case-insensitive substring of the path)\n"
+		"Metrics: throughput, mean_time, median_time, min_time, memory,\n"
+		"         speedup, efficiency\n\n"
+		"Example:\n"
+		"  %s -f algorithm=OpenMP -f variant=1 -f matrix=orkut -l 30 history.jsonl\n",
+		program_name, program_name);
+}
+
+/**
+ * @brief Looks up a field by name.
+ * @return Field index, or -1 if unknown.
+ */
+static int
+field_from_name(const char *name, size_t len)
+{
+	for (int i = 0; i < FIELD_COUNT; i++)
+		if (strlen(field_names[i]) == len && strncmp(field_names[i], name, len) == 0)
+			return i;
+	return -1;
+}
+
+/**
+ * @brief Formats the value of a field of a record as a string.
+ */
+static void
+field_value(const HistoryRecord *rec, Field field, char *out, size_t size)
+{
+	switch (field) {
+	case FIELD_ALGORITHM:
+		snprintf(out, size, "%s", rec->data.result.algorithm);
+		break;
+	case FIELD_VARIANT:
+		snprintf(out, size, "%u", rec->data.result.algorithm_variant);
+		break;
+	case FIELD_MATRIX: {
+		const char *base = strrchr(rec->data.matrix_info.path, '/');
+		snprintf(out, size, "%s", base ? base + 1 : rec->data.matrix_info.path);
+		break;
+	}
+	case FIELD_THREADS:
+		snprintf(out, size, "%u", rec->data.benchmark_info.threads);
+		break;
+	case FIELD_HOST:
+		snprintf(out, size, "%s", rec->host.hostname);
+		break;
+	case FIELD_REVISION:
+		snprintf(out, size, "%s", rec->git_revision);
+		break;
+	default:
+		out[0] = '\0';
+		break;
+	}
+}
+
+/**
+ * @brief Case-insensitive substring search.
+ */
+static int
+contains_nocase(const char *haystack, const char *needle)
+{
+	size_t n = strlen(needle);
+
+	for (; *haystack; haystack++) {
+		size_t i = 0;
+		while (i < n && haystack[i] &&
+		       tolower((unsigned char)haystack[i]) == tolower((unsigned char)needle[i]))
+			i++;
+		if (i == n)
+			return 1;
+	}
+
+	return n == 0;
+}
+
+/**
+ * @brief Checks a record against all filters.
+ */
+static int
+matches(const HistoryRecord *rec, const Filter *filters, size_t n_filters)
+{
+	char value[MAX_KEY];
+
+	for (size_t i = 0; i < n_filters; i++) {
+		if (filters[i].field == FIELD_MATRIX) {
+			if (!contains_nocase(rec->data.matrix_info.path, filters[i].value))
+				return 0;
+			continue;
+		}
+
+		field_value(rec, filters[i].field, value, sizeof(value));
+		if (filters[i].field == FIELD_ALGORITHM || filters[i].field == FIELD_HOST) {
+			if (strlen(value) != strlen(filters[i].value) || !contains_nocase(value, filters[i].value))
+				return 0;
+		} else if (strcmp(value, filters[i].value) != 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Extracts a metric from a record.
+ * @return 1 if the record carries the metric, 0 otherwise.
+ */
+static int
+metric_value(const HistoryRecord *rec, Metric metric, double *out)
+{
+	const Result *r = &rec->data.result;
+
+	switch (metric) {
+	case METRIC_THROUGHPUT:  *out = r->throughput_edges_per_sec / 1e6; return 1;
+	case METRIC_MEAN_TIME:   *out = r->stats.mean_time_s; return 1;
+	case METRIC_MEDIAN_TIME: *out = r->stats.median_time_s; return 1;
+	case METRIC_MIN_TIME:    *out = r->stats.min_time_s; return 1;
+	case METRIC_MEMORY:      *out = r->memory_peak_mb; return 1;
+	case METRIC_SPEEDUP:     *out = r->speedup; return r->has_metrics;
+	case METRIC_EFFICIENCY:  *out = r->efficiency; return r->has_metrics;
+	default:                 return 0;
+	}
+}
+
+/**
+ * @brief Comparison function for sorting doubles.
+ */
+static int
+cmp_double(const void *a, const void *b)
+{
+	double da = *(const double *)a;
+	double db = *(const double *)b;
+	return (da > db) - (da < db);
+}
+
+/**
+ * @brief Appends a sample to a group.
+ * @return 0 on success, 1 on allocation failure.
+ */
+static int
+group_push(Group *g, double value)
+{
+	if (g->count == g->capacity) {
+		size_t cap = g->capacity ? 2 * g->capacity : 16;
+		double *tmp = realloc(g->values, cap * sizeof(double));
+		if (!tmp) {
+			print_error(__func__, "realloc() failed", errno);
+			return 1;
+		}
+		g->values = tmp;
+		g->capacity = cap;
+	}
+
+	g->values[g->count++] = value;
+	return 0;
+}
+
+/**
+ * @brief Prints the summary line of a group.
+ *
+ * The trend compares the mean of the newer half of the samples with the
+ * mean of the older half.
+ */
+static int
+print_group(const Group *g, size_t last)
+{
+	size_t first = (last && g->count > last) ? g->count - last : 0;
+	size_t n = g->count - first;
+	const double *v = g->values + first;
+
+	double *sorted = malloc(n * sizeof(double));
+	if (!sorted) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+	memcpy(sorted, v, n * sizeof(double));
+	qsort(sorted, n, sizeof(double), cmp_double);
+
+	double sum = 0.0, sum_sq = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		sum += v[i];
+		sum_sq += v[i] * v[i];
+	}
+
+	double mean = sum / n;
+	double median = (n % 2) ? sorted[n / 2] : (sorted[n / 2] + sorted[n / 2 - 1]) / 2.0;
+	double std_dev = (n > 1) ? sqrt(fmax(0.0, (sum_sq - n * mean * mean) / (n - 1))) : 0.0;
+
+	printf("%-48.48s %6zu %12.4f %12.4f %12.4f %12.4f %12.4f ",
+	       g->key, n, median, mean, sorted[0], sorted[n - 1], std_dev);
+
+	if (n >= 4) {
+		double old_sum = 0.0, new_sum = 0.0;
+		size_t half = n / 2;
+		for (size_t i = 0; i < half; i++) old_sum += v[i];
+		for (size_t i = n - half; i < n; i++) new_sum += v[i];
+		double old_mean = old_sum / half;
+		if (old_mean != 0.0)
+			printf("%+7.1f%%\n", (new_sum / half - old_mean) / old_mean * 100.0);
+		else
+			printf("%8s\n", "-");
+	} else {
+		printf("%8s\n", "-");
+	}
+
+	free(sorted);
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                   Main                                    */
+/* ------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[])
+{
+	Filter filters[MAX_FILTERS];
+	size_t n_filters = 0;
+	Field group_by[MAX_GROUP_FIELDS] = {FIELD_ALGORITHM, FIELD_VARIANT, FIELD_MATRIX};
+	size_t n_group_by = 3;
+	Metric metric = METRIC_THROUGHPUT;
+	size_t last = 0;
+
+	set_program_name(argv[0]);
+	opterr = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "f:g:m:l:h")) != -1) {
+		switch (opt) {
+		case 'f': {
+			char *eq = strchr(optarg, '=');
+			int field = eq ? field_from_name(optarg, eq - optarg) : -1;
+			if (field < 0 || n_filters == MAX_FILTERS) {
+				print_error(__func__, "invalid filter (expected <field>=<value>)", 0);
+				usage();
+				return 1;
+			}
+			filters[n_filters].field = (Field)field;
+			snprintf(filters[n_filters].value, MAX_KEY, "%s", eq + 1);
+			n_filters++;
+			break;
+		}
+		case 'g': {
+			n_group_by = 0;
+			char *save;
+			for (char *tok = strtok_r(optarg, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+				int field = field_from_name(tok, strlen(tok));
+				if (field < 0 || n_group_by == MAX_GROUP_FIELDS) {
+					print_error(__func__, "invalid group field", 0);
+					usage();
+					return 1;
+				}
+				group_by[n_group_by++] = (Field)field;
+			}
+			break;
+		}
+		case 'm': {
+			int found = 0;
+			for (int i = 0; i < METRIC_COUNT; i++) {
+				if (strcmp(optarg, metric_names[i]) == 0) {
+					metric = (Metric)i;
+					found = 1;
+				}
+			}
+			if (!found) {
+				print_error(__func__, "unknown metric", 0);
+				usage();
+				return 1;
+			}
+			break;
+		}
+		case 'l': {
+			char *end;
+			unsigned long val = strtoul(optarg, &end, 10);
+			if (*end != '\0' || val == 0) {
+				print_error(__func__, "-l must be a positive integer", 0);
+				usage();
+				return 1;
+			}
+			last = val;
+			break;
+		}
+		case 'h':
+			usage();
+			return 0;
+		default: {
+			char err[64];
+			snprintf(err, sizeof(err), "invalid option '-%c'", optopt ? optopt : '?');
+			print_error(__func__, err, 0);
+			usage();
+			return 1;
+		}
+		}
+	}
+
+	if (optind >= argc) {
+		print_error(__func__, "no history file specified", 0);
+		usage();
+		return 1;
+	}
+
+	FILE *f = fopen(argv[optind], "r");
+	if (!f) {
+		print_error(__func__, "failed to open history file", errno);
+		return 1;
+	}
+
+	Group *groups = NULL;
+	size_t n_groups = 0, cap_groups = 0;
+	size_t n_records = 0, n_skipped = 0;
+	int ret = 0;
+
+	char *line = NULL;
+	size_t cap = 0;
+	HistoryRecord rec;
+
+	while (getline(&line, &cap, f) != -1) {
+		if (!parse_history_record(line, &rec)) {
+			n_skipped++;
+			continue;
+		}
+
+		double value;
+		if (!matches(&rec, filters, n_filters) || !metric_value(&rec, metric, &value))
+			continue;
+		n_records++;
+
+		char key[MAX_KEY] = "";
+		for (size_t i = 0; i < n_group_by; i++) {
+			char value_str[MAX_KEY];
+			size_t len = strlen(key);
+			field_value(&rec, group_by[i], value_str, sizeof(value_str));
+			if (snprintf(key + len, sizeof(key) - len, "%s%s=%s", i ? "," : "",
+			             field_names[group_by[i]], value_str) >= (int)(sizeof(key) - len))
+				break;  /* Key truncated: remaining fields do not fit */
+		}
+		if (!n_group_by)
+			snprintf(key, sizeof(key), "all");
+
+		size_t g;
+		for (g = 0; g < n_groups; g++)
+			if (strcmp(groups[g].key, key) == 0)
+				break;
+
+		if (g == n_groups) {
+			if (n_groups == cap_groups) {
+				size_t new_cap = cap_groups ? 2 * cap_groups : 16;
+				Group *tmp = realloc(groups, new_cap * sizeof(Group));
+				if (!tmp) {
+					print_error(__func__, "realloc() failed", errno);
+					ret = 1;
+					break;
+				}
+				groups = tmp;
+				cap_groups = new_cap;
+			}
+			memset(&groups[g], 0, sizeof(Group));
+			snprintf(groups[g].key, sizeof(groups[g].key), "%s", key);
+			n_groups++;
+		}
+
+		if (group_push(&groups[g], value)) {
+			ret = 1;
+			break;
+		}
+	}
+
+	free(line);
+	fclose(f);
+
+	if (!ret) {
+		if (n_skipped)
+			fprintf(stderr, "%s: skipped %zu malformed line(s)\n", program_name, n_skipped);
+
+		printf("Metric: %s over %zu matching run(s)", metric_names[metric], n_records);
+		if (last)
+			printf(", last %zu per group", last);
+		printf("\n\n%-48s %6s %12s %12s %12s %12s %12s %8s\n",
+		       "Group", "Runs", "Median", "Mean", "Min", "Max", "StdDev", "Trend");
+
+		for (size_t g = 0; g < n_groups && !ret; g++)
+			ret = print_group(&groups[g], last);
+	}
+
+	for (size_t g = 0; g < n_groups; g++)
+		free(groups[g].values);
+	free(groups);
+
+	return ret;
+}
@@ -1,6 +1,12 @@
 /**
  * @file runner.c
  * @brief Unified benchmark runner
+ *
+ * Runs every backend binary on one matrix and merges their JSON output.
+ * The matrix is loaded once and handed to the backends in shared memory.
+ * With `-c <manifest>` it instead runs a campaign: the cross-product of
+ * matrices x edge orders x backends x variants x thread counts listed in a
+ * manifest, with resumable progress and one consolidated results file.
  */
 
 #define _POSIX_C_SOURCE 200809L
@@ -9,15 +15,22 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <errno.h>
 
 #include "args.h"
 #include "error.h"
+#include "history.h"
 #include "json.h"
+#include "matrix.h"
+#include "linestream.h"
+#include "reorder.h"
 
 #define MAX_BUFFER 65536
 #define MAX_RESULTS 4
+#define MAX_MANIFEST_ITEMS 64
+#define MAX_PATH 4096
 
 const char *program_name = "runner";
 
@@ -29,12 +42,75 @@ typedef struct {
 	int success;
 } BenchmarkResult;
 
+/**
+ * @brief Backend binaries, in the order they are run.
+ *
+ * The sequential backend comes first so that it provides the baseline
+ * for speedup and efficiency.
+ */
+static const struct {
+	const char *name;
+	const char *key;
+	const char *binary_path;
+} backends[MAX_RESULTS] = {
+	{"Sequential", "sequential", "bin/connected_components_sequential"},
+	{"OpenMP",     "openmp",     "bin/connected_components_openmp"},
+	{"Pthreads",   "pthreads",   "bin/connected_components_pthreads"},
+	{"Cilk",       "cilk",       "bin/connected_components_cilk"}
+};
+
+/**
+ * @struct Manifest
+ * @brief Parsed campaign manifest.
+ */
+typedef struct {
+	char *matrices[MAX_MANIFEST_ITEMS];     /**< Matrix paths */
+	size_t n_matrices;
+	unsigned int backends[MAX_RESULTS];     /**< Indices into backends[] */
+	size_t n_backends;
+	unsigned int variants[MAX_MANIFEST_ITEMS];
+	size_t n_variants;
+	unsigned int threads[MAX_MANIFEST_ITEMS];
+	size_t n_threads;
+	unsigned int trials;
+	int bipartite;                          /**< Rows and columns are distinct vertices */
+	CSCOrder orders[MAX_MANIFEST_ITEMS];    /**< Edge orders (see csc_reorder()) */
+	size_t n_orders;
+	unsigned int order_seed;
+	char output[MAX_PATH];                  /**< Consolidated results file */
+	char history[MAX_PATH];                 /**< JSONL history file, or "" */
+	char cache_dir[MAX_PATH];               /**< Binary cache directory, or "" */
+} Manifest;
+
+/**
+ * @struct CampaignRun
+ * @brief One job of a campaign and its parsed result.
+ */
+typedef struct {
+	size_t matrix;          /**< Index into Manifest.matrices */
+	unsigned int backend;   /**< Index into backends[] */
+	unsigned int variant;
+	unsigned int threads;
+	CSCOrder order;
+	BenchmarkData data;
+	int done;               /**< Completed (now or in a previous session) */
+	int fresh;              /**< Completed in this session */
+	int failed;             /**< Attempted in this session and failed */
+} CampaignRun;
+
 /**
  * @brief Executes a single benchmark binary and captures its output.
+ *
+ * @param matrix_fd Shared matrix the backend maps instead of loading
+ *                  matrix_file (see csc_share_matrix()), or -1
+ * @param order Edge order to pass on, or NULL for the file order
+ * @param composition Composed algorithm to pass on, or NULL for the variant
  */
 static int
-run_benchmark(const char *binary, const char *matrix_file,
-              int threads, int trials, int algorithm_variant, char **output)
+run_benchmark(const char *binary, const char *matrix_file, int matrix_fd,
+              int threads, int trials, int algorithm_variant, int bipartite,
+              const char *order, unsigned int order_seed, const char *composition,
+              char **output)
 {
 	int pipe_fd[2];
 	if (pipe(pipe_fd) == -1) {
@@ -57,12 +133,43 @@ run_benchmark(const char *binary, const char *matrix_file,
 		dup2(pipe_fd[1], STDERR_FILENO);
 		close(pipe_fd[1]);
 
-		char threads_str[16], trials_str[16], variant_str[16];
+		char threads_str[16], trials_str[16], variant_str[16], seed_str[16], fd_str[16];
 		snprintf(threads_str, sizeof(threads_str), "%d", threads);
 		snprintf(trials_str, sizeof(trials_str), "%d", trials);
 		snprintf(variant_str, sizeof(variant_str), "%u", algorithm_variant);
+		snprintf(seed_str, sizeof(seed_str), "%u", order_seed);
+		snprintf(fd_str, sizeof(fd_str), "%d", matrix_fd);
+		setenv("CILK_NWORKERS", threads_str, 1);
+
+		char *argv[20];
+		int argc = 0;
+		argv[argc++] = (char *)binary;
+		argv[argc++] = "-t";
+		argv[argc++] = threads_str;
+		argv[argc++] = "-n";
+		argv[argc++] = trials_str;
+		argv[argc++] = "-v";
+		argv[argc++] = variant_str;
+		if (bipartite)
+			argv[argc++] = "-b";
+		if (composition) {
+			argv[argc++] = "-a";
+			argv[argc++] = (char *)composition;
+		}
+		if (order) {
+			argv[argc++] = "--order";
+			argv[argc++] = (char *)order;
+			argv[argc++] = "--order-seed";
+			argv[argc++] = seed_str;
+		}
+		if (matrix_fd >= 0) {
+			argv[argc++] = "--matrix-fd";
+			argv[argc++] = fd_str;
+		}
+		argv[argc++] = (char *)matrix_file;
+		argv[argc] = NULL;
 
-		execl(binary, binary, "-t", threads_str, "-n", trials_str, "-v", variant_str, matrix_file, NULL);
+		execv(binary, argv);
 		exit(1);
 	}
 
@@ -164,11 +271,11 @@ print_combined_results(BenchmarkResult *results, int count)
 	
 	// Print combined JSON
 	printf("{\n");
-	print_sys_info(&first->sys_info, 2);
+	print_sys_info(stdout, &first->sys_info, 2);
 	printf(",\n");
-	print_matrix_info(&first->matrix_info, 2);
+	print_matrix_info(stdout, &first->matrix_info, 2);
 	printf(",\n");
-	print_benchmark_info(&first->benchmark_info, 2);
+	print_benchmark_info(stdout, &first->benchmark_info, 2);
 	printf(",\n");
 	
 	printf("  \"results\": [\n");
@@ -178,7 +285,7 @@ print_combined_results(BenchmarkResult *results, int count)
 		if (!results[i].success || !results[i].data.valid) continue;
 		
 		if (!first_result) printf(",\n");
-		print_result(&results[i].data.result, 4);
+		print_result(stdout, &results[i].data.result, 4);
 		first_result = 0;
 	}
 	
@@ -186,24 +293,643 @@ print_combined_results(BenchmarkResult *results, int count)
 	printf("}\n");
 }
 
+/* ------------------------------------------------------------------------- */
+/*                              Campaign Mode                                */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Returns whether @p val is among the first @p n entries of @p list.
+ */
+static int
+contains_uint(const unsigned int *list, size_t n, unsigned int val)
+{
+	for (size_t k = 0; k < n; k++)
+		if (list[k] == val)
+			return 1;
+	return 0;
+}
+
+/**
+ * @brief Parses a list of distinct unsigned integers into @p out.
+ *
+ * @return Number of values parsed, or 0 on error (including a repeated value).
+ */
+static size_t
+parse_uint_list(char *list, unsigned int *out, size_t max)
+{
+	size_t n = 0;
+	char *save;
+
+	for (char *tok = strtok_r(list, " \t,", &save); tok; tok = strtok_r(NULL, " \t,", &save)) {
+		char *end;
+		unsigned long val = strtoul(tok, &end, 10);
+		if (*end != '\0' || n == max || contains_uint(out, n, (unsigned int)val))
+			return 0;
+		out[n++] = (unsigned int)val;
+	}
+
+	return n;
+}
+
+/**
+ * @brief Reads a campaign manifest.
+ *
+ * The manifest is line based; `#` starts a comment. Recognised keys:
+ *
+ *     matrix   <path>                 (repeatable)
+ *     backends sequential openmp ...  (default: all; each at most once)
+ *     variants 0 1                    (default: -v)
+ *     threads  1 2 4 8                (default: -t)
+ *     trials   10                     (default: -n)
+ *     bipartite yes|no                (default: -b, if given)
+ *     orders   file ids rows hub      (default: --order, or file)
+ *     order-seed 7                    (default: --order-seed)
+ *     output   <path>                 (default: <manifest>.json)
+ *     cache    <dir>                  (default: next to each matrix)
+ *     history  <path>                 (default: -H, if given)
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int
+parse_manifest(const char *path, const Args *args, Manifest *m)
+{
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		print_error(__func__, "failed to open manifest", errno);
+		return 1;
+	}
+
+	memset(m, 0, sizeof(*m));
+	m->trials = args->n_trials;
+	m->bipartite = args->bipartite;
+	m->order_seed = args->order_seed;
+	snprintf(m->output, sizeof(m->output), "%s.json", path);
+	if (args->history)
+		snprintf(m->history, sizeof(m->history), "%s", args->history);
+
+	char *line = NULL;
+	size_t cap = 0;
+	unsigned int lineno = 0;
+	int ret = 0;
+
+	while (getline(&line, &cap, f) != -1) {
+		lineno++;
+		line[strcspn(line, "#\r\n")] = '\0';
+
+		char *save;
+		char *key = strtok_r(line, " \t", &save);
+		if (!key)
+			continue;
+
+		char *rest = save + strspn(save, " \t");
+		size_t len = strlen(rest);
+		while (len && (rest[len - 1] == ' ' || rest[len - 1] == '\t'))
+			rest[--len] = '\0';
+
+		int ok = 1;
+		if (strcmp(key, "matrix") == 0) {
+			if (!len || m->n_matrices == MAX_MANIFEST_ITEMS || !(m->matrices[m->n_matrices++] = strdup(rest)))
+				ok = 0;
+		} else if (strcmp(key, "backends") == 0) {
+			for (char *tok = strtok_r(rest, " \t,", &save); tok && ok; tok = strtok_r(NULL, " \t,", &save)) {
+				ok = 0;
+				for (unsigned int b = 0; b < MAX_RESULTS; b++) {
+					/* A backend listed twice would run every job twice */
+					if (strcmp(tok, backends[b].key) == 0 && m->n_backends < MAX_RESULTS &&
+					    !contains_uint(m->backends, m->n_backends, b)) {
+						m->backends[m->n_backends++] = b;
+						ok = 1;
+					}
+				}
+			}
+		} else if (strcmp(key, "variants") == 0) {
+			m->n_variants = parse_uint_list(rest, m->variants, MAX_MANIFEST_ITEMS);
+			ok = m->n_variants > 0;
+			for (size_t k = 0; k < m->n_variants; k++)
+				if (m->variants[k] > 2) ok = 0;
+		} else if (strcmp(key, "threads") == 0) {
+			m->n_threads = parse_uint_list(rest, m->threads, MAX_MANIFEST_ITEMS);
+			ok = m->n_threads > 0;
+			for (size_t k = 0; k < m->n_threads; k++)
+				if (!m->threads[k]) ok = 0;
+		} else if (strcmp(key, "trials") == 0) {
+			unsigned int trials[1];
+			ok = parse_uint_list(rest, trials, 1) == 1 && trials[0] > 0;
+			if (ok) m->trials = trials[0];
+		} else if (strcmp(key, "bipartite") == 0) {
+			if (strcmp(rest, "yes") == 0 || strcmp(rest, "1") == 0)
+				m->bipartite = 1;
+			else if (strcmp(rest, "no") == 0 || strcmp(rest, "0") == 0)
+				m->bipartite = 0;
+			else
+				ok = 0;
+		} else if (strcmp(key, "orders") == 0) {
+			ok = 0;
+			for (char *tok = strtok_r(rest, " \t,", &save); tok; tok = strtok_r(NULL, " \t,", &save)) {
+				ok = m->n_orders < MAX_MANIFEST_ITEMS && !csc_order_parse(tok, &m->orders[m->n_orders++]);
+				if (!ok)
+					break;
+			}
+		} else if (strcmp(key, "order-seed") == 0) {
+			unsigned int seed[1];
+			ok = parse_uint_list(rest, seed, 1) == 1;
+			if (ok) m->order_seed = seed[0];
+		} else if (strcmp(key, "output") == 0) {
+			ok = len > 0 && len < sizeof(m->output);
+			if (ok) memcpy(m->output, rest, len + 1);
+		} else if (strcmp(key, "history") == 0) {
+			ok = len > 0 && len < sizeof(m->history);
+			if (ok) memcpy(m->history, rest, len + 1);
+		} else if (strcmp(key, "cache") == 0) {
+			ok = len > 0 && len < sizeof(m->cache_dir);
+			if (ok) memcpy(m->cache_dir, rest, len + 1);
+		} else {
+			ok = 0;
+		}
+
+		if (!ok) {
+			char err[128];
+			snprintf(err, sizeof(err), "%s:%u: invalid \"%s\" entry", path, lineno, key);
+			print_error(__func__, err, 0);
+			ret = 1;
+			break;
+		}
+	}
+
+	free(line);
+	fclose(f);
+
+	if (ret)
+		return ret;
+
+	if (!m->n_matrices) {
+		print_error(__func__, "manifest lists no matrices", 0);
+		return 1;
+	}
+
+	if (!m->n_backends)
+		for (unsigned int b = 0; b < MAX_RESULTS; b++)
+			m->backends[m->n_backends++] = b;
+
+	if (!m->n_variants)
+		m->variants[m->n_variants++] = args->algorithm_variant;
+
+	if (!m->n_threads)
+		m->threads[m->n_threads++] = args->n_threads;
+
+	if (!m->n_orders) {
+		m->orders[0] = CSC_ORDER_FILE;
+		if (args->order)
+			csc_order_parse(args->order, &m->orders[0]);
+		m->n_orders = 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Frees the strings owned by a manifest.
+ */
+static void
+free_manifest(Manifest *m)
+{
+	for (size_t i = 0; i < m->n_matrices; i++)
+		free(m->matrices[i]);
+}
+
+/**
+ * @brief Builds the progress-file key identifying a campaign job.
+ *
+ * The key holds every setting that changes the measurement, trials
+ * included, so a job whose settings changed is run again.
+ */
+static void
+run_key(const Manifest *m, const CampaignRun *r, char *key, size_t size)
+{
+	int n = snprintf(key, size, "%s|%s|%u|%u|%u%s", m->matrices[r->matrix],
+	                 backends[r->backend].key, r->variant, r->threads, m->trials,
+	                 m->bipartite ? "|bipartite" : "");
+	if (r->order != CSC_ORDER_FILE && n > 0 && (size_t)n < size)
+		snprintf(key + n, size - (size_t)n, "|%s:%u", csc_order_name(r->order), m->order_seed);
+}
+
+/**
+ * @brief Marks the jobs already recorded in the progress file as done.
+ *
+ * Each progress line holds a job key, a tab, and the backend's JSON output
+ * collapsed onto a single line.
+ */
+static void
+load_progress(const char *path, const Manifest *m, CampaignRun *runs, size_t n_runs)
+{
+	FILE *f = fopen(path, "r");
+	if (!f)
+		return;
+
+	char *line = NULL;
+	size_t cap = 0;
+	char key[MAX_PATH + 64];
+
+	while (getline(&line, &cap, f) != -1) {
+		char *tab = strchr(line, '\t');
+		if (!tab)
+			continue;
+		*tab = '\0';
+
+		for (size_t i = 0; i < n_runs; i++) {
+			run_key(m, &runs[i], key, sizeof(key));
+			if (strcmp(key, line) == 0 && parse_benchmark_data(tab + 1, &runs[i].data)) {
+				runs[i].done = 1;
+				break;
+			}
+		}
+	}
+
+	free(line);
+	fclose(f);
+}
+
+/**
+ * @brief Appends a completed job to the progress file.
+ */
+static void
+save_progress(FILE *f, const char *key, const char *output)
+{
+	fprintf(f, "%s\t", key);
+	for (const char *p = output; *p; p++)
+		fputc((*p == '\n' || *p == '\t') ? ' ' : *p, f);
+	fputc('\n', f);
+	fflush(f);
+}
+
+/**
+ * @brief Returns the binary cache path of a matrix, converting it if needed.
+ *
+ * Matrices already in the `.csc` format are used as-is. Otherwise the
+ * cache is `<matrix>.csc`, placed in the manifest's cache directory if one
+ * is set, and is rebuilt whenever it is older than the source file.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int
+prepare_cache(const Manifest *m, const char *matrix, char *cache, size_t size)
+{
+	size_t len = strlen(matrix);
+	if (len > 4 && strcmp(matrix + len - 4, ".csc") == 0) {
+		snprintf(cache, size, "%s", matrix);
+		return 0;
+	}
+
+	int n;
+	if (m->cache_dir[0]) {
+		const char *base = strrchr(matrix, '/');
+		n = snprintf(cache, size, "%s/%s.csc", m->cache_dir, base ? base + 1 : matrix);
+	} else {
+		n = snprintf(cache, size, "%s.csc", matrix);
+	}
+
+	if (n < 0 || (size_t)n >= size) {
+		print_error(__func__, "cache path too long", 0);
+		return 1;
+	}
+
+	struct stat src, dst;
+	if (stat(matrix, &src) != 0) {
+		char err[MAX_PATH + 32];
+		snprintf(err, sizeof(err), "cannot access matrix \"%s\"", matrix);
+		print_error(__func__, err, errno);
+		return 1;
+	}
+
+	if (stat(cache, &dst) == 0 && dst.st_mtime >= src.st_mtime)
+		return 0;
+
+	fprintf(stderr, "[cache] Converting %s -> %s\n", matrix, cache);
+
+	CSCBinaryMatrix *mat = csc_load_matrix(matrix);
+	if (!mat)
+		return 1;
+
+	int ret = csc_save_matrix(mat, cache);
+	csc_free_matrix(mat);
+	return ret;
+}
+
+/**
+ * @brief Computes speedup and efficiency of every run.
+ *
+ * The baseline of a run is the sequential run on the same matrix with the
+ * same variant and edge order.
+ */
+static void
+compute_campaign_metrics(CampaignRun *runs, size_t n_runs)
+{
+	for (size_t i = 0; i < n_runs; i++) {
+		runs[i].data.result.has_metrics = 0;
+		if (!runs[i].done)
+			continue;
+
+		for (size_t j = 0; j < n_runs; j++) {
+			if (!runs[j].done || runs[j].backend != 0 ||
+			    runs[j].matrix != runs[i].matrix || runs[j].variant != runs[i].variant ||
+			    runs[j].order != runs[i].order)
+				continue;
+
+			double seq = runs[j].data.result.stats.mean_time_s;
+			double mean = runs[i].data.result.stats.mean_time_s;
+			if (seq > 0 && mean > 0) {
+				runs[i].data.result.speedup = seq / mean;
+				runs[i].data.result.efficiency = runs[i].data.result.speedup / runs[i].threads;
+				runs[i].data.result.has_metrics = 1;
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Writes the consolidated campaign results file.
+ *
+ * @return 0 on success, 1 on error.
+ */
+static int
+write_campaign_results(const char *manifest_path, const Manifest *m,
+                       const CampaignRun *runs, size_t n_runs)
+{
+	FILE *f = fopen(m->output, "w");
+	if (!f) {
+		print_error(__func__, "failed to create results file", errno);
+		return 1;
+	}
+
+	size_t completed = 0, failed = 0;
+	const BenchmarkData *first = NULL;
+	for (size_t i = 0; i < n_runs; i++) {
+		if (runs[i].done) {
+			completed++;
+			if (!first) first = &runs[i].data;
+		}
+		if (runs[i].failed) failed++;
+	}
+
+	fprintf(f, "{\n");
+	if (first) {
+		print_sys_info(f, &first->sys_info, 2);
+		fprintf(f, ",\n");
+	}
+	fprintf(f, "  \"campaign\": {\n");
+	fprintf(f, "    \"manifest\": ");
+	print_json_string(f, manifest_path);
+	fprintf(f, ",\n");
+	fprintf(f, "    \"jobs\": %zu,\n", n_runs);
+	fprintf(f, "    \"completed\": %zu,\n", completed);
+	fprintf(f, "    \"failed\": %zu\n", failed);
+	fprintf(f, "  },\n");
+	fprintf(f, "  \"runs\": [");
+
+	int first_run = 1;
+	for (size_t i = 0; i < n_runs; i++) {
+		if (!runs[i].done) continue;
+
+		fprintf(f, first_run ? "\n" : ",\n");
+		fprintf(f, "    {\n");
+		print_matrix_info(f, &runs[i].data.matrix_info, 6);
+		fprintf(f, ",\n");
+		print_benchmark_info(f, &runs[i].data.benchmark_info, 6);
+		fprintf(f, ",\n");
+		fprintf(f, "      \"results\": [\n");
+		print_result(f, &runs[i].data.result, 8);
+		fprintf(f, "\n      ]\n");
+		fprintf(f, "    }");
+		first_run = 0;
+	}
+
+	fprintf(f, "\n  ]\n}\n");
+
+	if (fclose(f) != 0) {
+		print_error(__func__, "failed to write results file", errno);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Prints a human-readable summary table of a campaign to stdout.
+ */
+static void
+print_campaign_summary(const Manifest *m, const CampaignRun *runs, size_t n_runs)
+{
+	printf("%-32s %-5s %-10s %3s %4s %12s %12s %8s %8s %10s\n",
+	       "Matrix", "Order", "Backend", "Var", "Thr", "Mean (s)", "Medges/s",
+	       "Speedup", "Eff", "Components");
+
+	for (size_t i = 0; i < n_runs; i++) {
+		const char *path = m->matrices[runs[i].matrix];
+		const char *base = strrchr(path, '/');
+		base = base ? base + 1 : path;
+
+		printf("%-32.32s %-5s %-10s %3u %4u ", base, csc_order_name(runs[i].order),
+		       backends[runs[i].backend].name, runs[i].variant, runs[i].threads);
+
+		if (!runs[i].done) {
+			printf("%12s\n", runs[i].failed ? "FAILED" : "pending");
+			continue;
+		}
+
+		const Result *r = &runs[i].data.result;
+		printf("%12.6f %12.1f ", r->stats.mean_time_s, r->throughput_edges_per_sec / 1e6);
+		if (r->has_metrics)
+			printf("%7.2fx %7.1f%% ", r->speedup, r->efficiency * 100.0);
+		else
+			printf("%8s %8s ", "-", "-");
+		printf("%10u\n", r->connected_components);
+	}
+}
+
+/**
+ * @brief Runs a benchmark campaign described by a manifest.
+ *
+ * Jobs already recorded in `<output>.progress` are skipped, so an
+ * interrupted campaign resumes where it stopped. Each matrix is converted
+ * to the binary cache at most once and every backend loads the cache.
+ *
+ * @return 0 if every job completed, 1 otherwise.
+ */
+static int
+run_campaign(const Args *args)
+{
+	Manifest m;
+	if (parse_manifest(args->manifest, args, &m))
+		return 1;
+
+	/* Sequential runs ignore the thread count: schedule them once */
+	size_t max_runs = m.n_matrices * m.n_orders * m.n_variants * m.n_threads * m.n_backends;
+	CampaignRun *runs = calloc(max_runs, sizeof(CampaignRun));
+	if (!runs) {
+		print_error(__func__, "calloc() failed", errno);
+		free_manifest(&m);
+		return 1;
+	}
+
+	size_t n_runs = 0;
+	for (size_t mi = 0; mi < m.n_matrices; mi++) {
+		for (size_t oi = 0; oi < m.n_orders; oi++) {
+			for (size_t vi = 0; vi < m.n_variants; vi++) {
+				for (size_t bi = 0; bi < m.n_backends; bi++) {
+					for (size_t ti = 0; ti < m.n_threads; ti++) {
+						if (m.backends[bi] == 0 && ti > 0)
+							break;
+						CampaignRun *r = &runs[n_runs++];
+						r->matrix = mi;
+						r->order = m.orders[oi];
+						r->backend = m.backends[bi];
+						r->variant = m.variants[vi];
+						r->threads = m.backends[bi] == 0 ? 1 : m.threads[ti];
+					}
+				}
+			}
+		}
+	}
+
+	char progress_path[MAX_PATH + 16];
+	snprintf(progress_path, sizeof(progress_path), "%s.progress", m.output);
+	load_progress(progress_path, &m, runs, n_runs);
+
+	FILE *progress = fopen(progress_path, "a");
+	if (!progress) {
+		print_error(__func__, "failed to open progress file", errno);
+		free(runs);
+		free_manifest(&m);
+		return 1;
+	}
+
+	size_t pending = 0;
+	for (size_t i = 0; i < n_runs; i++)
+		if (!runs[i].done) pending++;
+
+	fprintf(stderr, "Campaign: %zu jobs, %zu already completed\n\n", n_runs, n_runs - pending);
+
+	char cache[2 * MAX_PATH];
+	char key[MAX_PATH + 64];
+	size_t cached_matrix = (size_t)-1;
+	int cache_ok = 0;
+	size_t job = 0;
+
+	for (size_t i = 0; i < n_runs; i++) {
+		CampaignRun *r = &runs[i];
+		if (r->done)
+			continue;
+
+		job++;
+		const char *name = backends[r->backend].name;
+
+		if (r->matrix != cached_matrix) {
+			cached_matrix = r->matrix;
+			cache_ok = !prepare_cache(&m, m.matrices[r->matrix], cache, sizeof(cache));
+		}
+
+		fprintf(stderr, "[%zu/%zu] %s v%u t%u %s: %s\n", job, pending, name,
+		        r->variant, r->threads, csc_order_name(r->order), m.matrices[r->matrix]);
+
+		if (!cache_ok || access(backends[r->backend].binary_path, X_OK) != 0) {
+			fprintf(stderr, "[%s] %s\n", name, cache_ok ? "Binary not found or not executable" : "Matrix unavailable");
+			r->failed = 1;
+			continue;
+		}
+
+		char *output = NULL;
+		int ret = run_benchmark(backends[r->backend].binary_path, cache, -1,
+		                        r->threads, m.trials, r->variant, m.bipartite,
+		                        r->order == CSC_ORDER_FILE ? NULL : csc_order_name(r->order),
+		                        m.order_seed, NULL, &output);
+
+		if (ret == 0 && parse_benchmark_data(output, &r->data)) {
+			r->done = 1;
+			r->fresh = 1;
+			run_key(&m, r, key, sizeof(key));
+			save_progress(progress, key, output);
+		} else {
+			r->failed = 1;
+			fprintf(stderr, "[%s] Failed with exit code %d\n", name, ret);
+			if (output && strlen(output) > 0)
+				fprintf(stderr, "[%s] Output:\n%s\n", name, output);
+		}
+
+		free(output);
+	}
+
+	fclose(progress);
+
+	/* Report the source matrix rather than its cache */
+	for (size_t i = 0; i < n_runs; i++) {
+		if (!runs[i].done) continue;
+		snprintf(runs[i].data.matrix_info.path, sizeof(runs[i].data.matrix_info.path),
+		         "%s", m.matrices[runs[i].matrix]);
+	}
+
+	compute_campaign_metrics(runs, n_runs);
+
+	if (m.history[0])
+		for (size_t i = 0; i < n_runs; i++)
+			if (runs[i].fresh)
+				history_append(m.history, &runs[i].data);
+
+	int ret = write_campaign_results(args->manifest, &m, runs, n_runs);
+	if (!ret)
+		fprintf(stderr, "\nResults written to %s\n\n", m.output);
+
+	print_campaign_summary(&m, runs, n_runs);
+
+	for (size_t i = 0; i < n_runs; i++)
+		if (!runs[i].done) ret = 1;
+
+	free(runs);
+	free_manifest(&m);
+	return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
 	set_program_name(argv[0]);
 
-	char *matrix_file = NULL;
-	unsigned int threads;
-	unsigned int trials;
-	unsigned int algorithm_variant;
+	Args args;
 
-	int parse_status = parseargs(argc, argv, &threads, &trials, &algorithm_variant, &matrix_file);
+	int parse_status = parseargs(argc, argv, &args);
 	if (parse_status != 0) return parse_status == -1 ? 0 : 1;
 
+	if (args.shard_dir || args.ext_mem_mb || args.checkpoint || args.profile || args.subsets ||
+	    args.mem_budget_mb || args.ompt) {
+		print_error(__func__, "shard output, external-memory mode, checkpoints, profiles, edge subsets, memory budgets and OMPT overheads are handled by the backends", 0);
+		return 1;
+	}
+
+	/* Campaigns sweep variants, not compositions */
+	if (args.manifest && args.composition) {
+		print_error(__func__, "composed algorithms cannot be combined with -c", 0);
+		return 1;
+	}
+
+	if (args.manifest)
+		return run_campaign(&args);
+
+	char *matrix_file = args.filepath;
+	unsigned int threads = args.n_threads;
+	unsigned int trials = args.n_trials;
+	unsigned int algorithm_variant = args.algorithm_variant;
+
 	if (threads <= 0 || trials <= 0) {
 		print_error(__func__, "threads and trials must be positive integers", 0);
 		return 1;
 	}
 
+	/* Every backend reads the matrix again */
+	if (line_stream_is_pipe(matrix_file)) {
+		print_error(__func__, "pipes and standard input can be read only once; run a backend on them", 0);
+		return 1;
+	}
+
 	if (access(matrix_file, R_OK) != 0) {
 		char err[MAX_BUFFER];
 		snprintf(err, sizeof(err), "Error: cannot access matrix file '%s': %s",
@@ -212,12 +938,23 @@ main(int argc, char *argv[])
 		return 1;
 	}
 
-	BenchmarkResult results[MAX_RESULTS] = {
-		{.name = "Sequential", .binary_path = "bin/connected_components_sequential"},
-		{.name = "OpenMP",     .binary_path = "bin/connected_components_openmp"},
-		{.name = "Pthreads",   .binary_path = "bin/connected_components_pthreads"},
-		{.name = "Cilk",       .binary_path = "bin/connected_components_cilk"}
-	};
+	/* Load the matrix once; every backend maps the shared copy */
+	CSCBinaryMatrix *matrix = csc_load_matrix_parallel(matrix_file, threads);
+	if (!matrix)
+		return 1;
+	int matrix_fd = csc_share_matrix(matrix);
+	if (matrix_fd >= 0)
+		fprintf(stderr, "[share] Loaded %s once (%.1f MiB shared with the backends)\n", matrix_file,
+		        (double)((matrix->ncols + 1 + matrix->nnz) * sizeof(uint32_t)) / (1 << 20));
+	else
+		fprintf(stderr, "[share] Shared memory unavailable; each backend loads the matrix\n");
+	csc_free_matrix(matrix);
+
+	BenchmarkResult results[MAX_RESULTS] = {0};
+	for (int i = 0; i < MAX_RESULTS; i++) {
+		results[i].name = (char *)backends[i].name;
+		results[i].binary_path = (char *)backends[i].binary_path;
+	}
 
 	fprintf(stderr, "Running benchmarks for: %s\n", matrix_file);
 	fprintf(stderr, "Threads: %d, Trials: %d\n\n", threads, trials);
@@ -233,8 +970,10 @@ main(int argc, char *argv[])
 
 		fprintf(stderr, "[%s] Running...\n", results[i].name);
 		
-		int ret = run_benchmark(results[i].binary_path, matrix_file,
-		                        threads, trials, algorithm_variant, &results[i].output);
+		int ret = run_benchmark(results[i].binary_path, matrix_file, matrix_fd,
+		                        threads, trials, algorithm_variant, args.bipartite,
+		                        args.order, args.order_seed, args.composition,
+		                        &results[i].output);
 		
 		if (ret == 0) {
 			// Parse the output
@@ -254,9 +993,17 @@ main(int argc, char *argv[])
 		}
 	}
 
+	if (matrix_fd >= 0)
+		close(matrix_fd);
+
 	// Compute speedup and efficiency
 	compute_performance_metrics(results, MAX_RESULTS, threads);
 
+	if (args.history)
+		for (int i = 0; i < MAX_RESULTS; i++)
+			if (results[i].success && results[i].data.valid)
+				history_append(args.history, &results[i].data);
+
 	fprintf(stderr, "\n");
 	print_combined_results(results, MAX_RESULTS);
 
@@ -9,16 +9,47 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <errno.h>
+#include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include "args.h"
+#include "reorder.h"
 #include "error.h"
 
 extern const char *program_name;
 
+/* Values returned by getopt_long() for options without a short form */
+enum {
+	OPT_CHECKPOINT = 256,
+	OPT_CHECKPOINT_INTERVAL,
+	OPT_RESUME,
+	OPT_PROFILE,
+	OPT_SUBSETS,
+	OPT_ORDER,
+	OPT_ORDER_SEED,
+	OPT_MEM_BUDGET,
+	OPT_MATRIX_FD,
+	OPT_OMPT,
+};
+
+static const struct option long_options[] = {
+	{ "checkpoint",          required_argument, NULL, OPT_CHECKPOINT },
+	{ "checkpoint-interval", required_argument, NULL, OPT_CHECKPOINT_INTERVAL },
+	{ "resume",              no_argument,       NULL, OPT_RESUME },
+	{ "profile",             no_argument,       NULL, OPT_PROFILE },
+	{ "subsets",             required_argument, NULL, OPT_SUBSETS },
+	{ "order",               required_argument, NULL, OPT_ORDER },
+	{ "order-seed",          required_argument, NULL, OPT_ORDER_SEED },
+	{ "mem-budget",          required_argument, NULL, OPT_MEM_BUDGET },
+	{ "matrix-fd",           required_argument, NULL, OPT_MATRIX_FD },
+	{ "ompt",                no_argument,       NULL, OPT_OMPT },
+	{ "help",                no_argument,       NULL, 'h' },
+	{ NULL, 0, NULL, 0 }
+};
+
 /**
  * @brief Checks if a string represents an unsigned integer.
  *
@@ -51,13 +82,43 @@ usage(void) {
 		"Options:\n"
 		"  -t <threads>       Number of threads to use (default: 8)\n"
 		"  -n <trials>        Number of benchmark trials (default: 3)\n"
-		"  -v <variant>       Algorithm variant (0=standard, 1=optimized, default: 0)\n"
+		"  -v <variant>       Algorithm variant (0=label propagation, 1=union-find,\n"
+		"                     2=low-diameter decomposition, default: 0)\n"
+		"  -a <sample+finish> Composed algorithm instead of a variant: sampling none,\n"
+		"                     kout, bfs or ldd, then finish rem, rand, lp or sv\n"
+		"  -b                 Bipartite mode: rows and columns are distinct vertices\n"
+		"  -S <dir>           Write per-component shard files to dir (backends only)\n"
+		"  -B <vertices>      Bin components smaller than this together (default: 65536)\n"
+		"  -X <MiB>           External-memory mode with this memory budget (backends only)\n"
+		"  --checkpoint <file>\n"
+		"                     Checkpoint label propagation to file (backends only)\n"
+		"  --checkpoint-interval <seconds>\n"
+		"                     Minimum time between checkpoints (default: 60)\n"
+		"  --resume           Resume label propagation from the checkpoint file\n"
+		"  --profile          Report degree, symmetry and diameter statistics (backends only)\n"
+		"  --subsets <k>      Count components of edge subsets 0..k-1 (1-64) of an edge list\n"
+		"                     with a subset mask per edge (backends only)\n"
+		"  --order <order>    Reorder the graph before the trials: cols or ids (shuffled\n"
+		"                     columns or vertex ids), rows (shuffled within columns) or\n"
+		"                     hub (the busiest vertex first in every column)\n"
+		"  --order-seed <n>   Seed of the shuffled orders (default: 1)\n"
+		"  --mem-budget <MiB> Project the peak memory and run in memory or, if that does\n"
+		"                     not fit, in external-memory mode (backends only; .mat\n"
+		"                     files only in v7.3 with HDF5=1)\n"
+		"  --ompt             Report OpenMP barrier, dispatch and fork/join overheads\n"
+		"                     (OpenMP backend built with OMPT=1)\n"
+		"  --matrix-fd <fd>   Map the matrix shared by benchmark_runner from this inherited\n"
+		"                     descriptor; matrix_file only names it (backends only)\n"
+		"  -c <manifest>      Run a benchmark campaign (benchmark_runner only)\n"
+		"  -H <history>       Append results to a JSONL history (benchmark_runner only)\n"
 		"  -h                 Show this help message and exit\n\n"
 		"Arguments:\n"
-		"  matrix_file Path to the input matrix file (Matlab Matrix format)\n\n"
+		"  matrix_file Path to the input matrix file (Matlab Matrix format), or a named\n"
+		"              pipe or - (standard input) streaming an edge list or Matrix Market\n\n"
 		"Example:\n"
-		"  %s -t 4 -n 10 -v 1 ./data/matrix.mat\n",
-		program_name, program_name
+		"  %s -t 4 -n 10 -v 1 ./data/matrix.mat\n"
+		"  %s -c campaign.manifest\n",
+		program_name, program_name, program_name
 	);
 }
 
@@ -65,24 +126,40 @@ usage(void) {
  * @copydoc parseargs()
  */
 int
-parseargs(int argc, char *argv[],
-          unsigned int *n_threads,
-          unsigned int *n_trials,
-          unsigned int *algorithm_variant,
-          char **filepath)
+parseargs(int argc, char *argv[], Args *args)
 {
-	*n_threads = 8;
-	*n_trials = 3;
-	*algorithm_variant = 0;
-	*filepath = NULL;
+	args->n_threads = 8;
+	args->n_trials = 3;
+	args->algorithm_variant = 0;
+	args->composition = NULL;
+	args->bipartite = 0;
+	args->shard_dir = NULL;
+	args->shard_bin = 65536;
+	args->ext_mem_mb = 0;
+	args->checkpoint = NULL;
+	args->checkpoint_interval = 60;
+	args->resume = 0;
+	args->profile = 0;
+	args->subsets = 0;
+	args->order = NULL;
+	args->order_seed = 1;
+	args->mem_budget_mb = 0;
+	args->matrix_fd = -1;
+	args->ompt = 0;
+	args->filepath = NULL;
+	args->manifest = NULL;
+	args->history = NULL;
 
 	opterr = 0;
 
 	int opt;
-	while ((opt = getopt(argc, argv, "+t:n:v:h")) != -1) {
+	while ((opt = getopt_long(argc, argv, "+t:n:v:a:c:H:S:B:X:bh",
+	                          long_options, NULL)) != -1) {
 		switch (opt) {
 		case 't':
-		case 'n': {
+		case 'n':
+		case 'B':
+		case 'X': {
 			if (!optarg || !isuint(optarg)) {
 				char err[128];
 				snprintf(err, sizeof(err), "invalid or missing argument for -%c", opt);
@@ -93,13 +170,17 @@ parseargs(int argc, char *argv[],
 			int val = atoi(optarg);
 			if (!val) {
 				char err[128];
-				snprintf(err, sizeof(err), "%s must be > 0", (opt == 't') ? "threads" : "trials");
+				snprintf(err, sizeof(err), "%s must be > 0",
+				         (opt == 't') ? "threads" : (opt == 'n') ? "trials" :
+				         (opt == 'B') ? "bin size" : "memory budget");
 				print_error(__func__, err, 0);
 				usage();
 				return 1;
 			}
-			if (opt == 't') *n_threads = val;
-			else *n_trials = val;
+			if (opt == 't') args->n_threads = val;
+			else if (opt == 'n') args->n_trials = val;
+			else if (opt == 'B') args->shard_bin = val;
+			else args->ext_mem_mb = val;
 			break;
 		}
 		case 'h':
@@ -108,27 +189,132 @@ parseargs(int argc, char *argv[],
 		
 		case 'v': {
 			if (!optarg || !isuint(optarg)) {
-				print_error(__func__, "invalid argument for -v (must be 0 or 1)", 0);
+				print_error(__func__, "invalid argument for -v (must be 0, 1 or 2)", 0);
 				usage();
 				return 1;
 			}
 			int val = atoi(optarg);
-			if (val < 0 || val > 1) {
-				print_error(__func__, "variant must be 0 or 1", 0);
+			if (val < 0 || val > 2) {
+				print_error(__func__, "variant must be 0, 1 or 2", 0);
 				usage();
 				return 1;
 			}
-			*algorithm_variant = (unsigned int)val;
+			args->algorithm_variant = (unsigned int)val;
 			break;
 		}
 
+		case 'a':
+			args->composition = optarg;
+			break;
+
+		case 'b':
+			args->bipartite = 1;
+			break;
+
+		case 'c':
+			if (access(optarg, R_OK) != 0) {
+				char err[256];
+				snprintf(err, sizeof(err), "cannot access manifest: \"%s\"", optarg);
+				print_error(__func__, err, errno);
+				return 1;
+			}
+			args->manifest = optarg;
+			break;
+
+		case 'H':
+			args->history = optarg;
+			break;
+
+		case 'S':
+			args->shard_dir = optarg;
+			break;
+
+		case OPT_CHECKPOINT:
+			args->checkpoint = optarg;
+			break;
+
+		case OPT_CHECKPOINT_INTERVAL:
+			if (!isuint(optarg)) {
+				print_error(__func__, "invalid argument for --checkpoint-interval", 0);
+				usage();
+				return 1;
+			}
+			args->checkpoint_interval = (unsigned int)atoi(optarg);
+			break;
+
+		case OPT_RESUME:
+			args->resume = 1;
+			break;
+
+		case OPT_PROFILE:
+			args->profile = 1;
+			break;
+
+		case OPT_SUBSETS:
+			if (!isuint(optarg) || atoi(optarg) < 1 || atoi(optarg) > 64) {
+				print_error(__func__, "--subsets must be between 1 and 64", 0);
+				usage();
+				return 1;
+			}
+			args->subsets = (unsigned int)atoi(optarg);
+			break;
+
+		case OPT_ORDER: {
+			CSCOrder order;
+			if (csc_order_parse(optarg, &order)) {
+				print_error(__func__, "--order must be file, cols, ids, rows or hub", 0);
+				usage();
+				return 1;
+			}
+			args->order = (order == CSC_ORDER_FILE) ? NULL : optarg;
+			break;
+		}
+
+		case OPT_ORDER_SEED:
+			if (!isuint(optarg)) {
+				print_error(__func__, "invalid argument for --order-seed", 0);
+				usage();
+				return 1;
+			}
+			args->order_seed = (unsigned int)strtoul(optarg, NULL, 10);
+			break;
+
+		case OPT_MEM_BUDGET:
+			if (!isuint(optarg) || atoi(optarg) < 1) {
+				print_error(__func__, "--mem-budget must be > 0", 0);
+				usage();
+				return 1;
+			}
+			args->mem_budget_mb = (unsigned int)atoi(optarg);
+			break;
+
+		case OPT_OMPT:
+			args->ompt = 1;
+			break;
+
+		case OPT_MATRIX_FD:
+			if (!isuint(optarg) || strlen(optarg) > 9) {
+				print_error(__func__, "invalid argument for --matrix-fd", 0);
+				usage();
+				return 1;
+			}
+			args->matrix_fd = atoi(optarg);
+			break;
+
 		case '?':
 		default: {
 			char err[128];
-			if (optopt == 't' || optopt == 'n')
+			if (optopt == 't' || optopt == 'n' || optopt == 'v' || optopt == 'a' || optopt == 'c' || optopt == 'H' ||
+			    optopt == 'S' || optopt == 'B' || optopt == 'X')
 				snprintf(err, sizeof(err), "missing argument for -%c", optopt);
+			else if (optopt == OPT_CHECKPOINT || optopt == OPT_CHECKPOINT_INTERVAL ||
+			         optopt == OPT_SUBSETS || optopt == OPT_ORDER || optopt == OPT_ORDER_SEED ||
+			         optopt == OPT_MEM_BUDGET || optopt == OPT_MATRIX_FD)
+				snprintf(err, sizeof(err), "missing argument for %s", argv[optind - 1]);
+			else if (optopt)
+				snprintf(err, sizeof(err), "unknown option '-%c'", optopt);
 			else
-				snprintf(err, sizeof(err), "unknown option '-%c'", optopt ? optopt : '?');
+				snprintf(err, sizeof(err), "unknown option '%s'", argv[optind - 1]);
 			print_error(__func__, err, 0);
 			usage();
 			return 1;
@@ -136,16 +322,22 @@ parseargs(int argc, char *argv[],
 		}
 	}
 
+	if (args->resume && !args->checkpoint) {
+		print_error(__func__, "--resume requires --checkpoint", 0);
+		usage();
+		return 1;
+	}
+
 	if (optind < argc) {
-		*filepath = argv[optind];
-		if (access(*filepath, R_OK) != 0) {
+		args->filepath = argv[optind];
+		if (strcmp(args->filepath, "-") != 0 && access(args->filepath, R_OK) != 0) {
 			char err[256];
-			snprintf(err, sizeof(err), "cannot access file: \"%s\"", *filepath);
+			snprintf(err, sizeof(err), "cannot access file: \"%s\"", args->filepath);
 			print_error(__func__, err, errno);
 			usage();
 			return 1;
 		}
-	} else {
+	} else if (!args->manifest) {
 		print_error(__func__, "no input file specified", 0);
 		usage();
 		return 1;
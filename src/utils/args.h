@@ -10,28 +10,82 @@
 #ifndef ARGS_H
 #define ARGS_H
 
+/**
+ * @struct Args
+ * @brief Parsed command-line options.
+ */
+typedef struct {
+	unsigned int n_threads;          /**< Number of threads */
+	unsigned int n_trials;           /**< Number of benchmark trials */
+	unsigned int algorithm_variant;  /**< Variant of the algorithm */
+	char *composition;               /**< Composed algorithm (see cc_compose_parse()), or NULL */
+	int bipartite;                   /**< Treat rows and columns as distinct vertices */
+	char *shard_dir;                 /**< Write per-component shards here (backends only), or NULL */
+	unsigned int shard_bin;          /**< Smallest component given its own shard */
+	unsigned int ext_mem_mb;         /**< External-memory budget in MiB (backends only), or 0 */
+	char *checkpoint;                /**< Label propagation checkpoint file (backends only), or NULL */
+	unsigned int checkpoint_interval;/**< Minimum seconds between checkpoints */
+	int resume;                      /**< Resume the first run from the checkpoint file */
+	int profile;                     /**< Profile the graph after loading it (backends only) */
+	unsigned int subsets;            /**< Edge subsets to count from a masked edge list (backends only), or 0 */
+	char *order;                     /**< Edge order applied before the trials (see csc_order_parse()), or NULL */
+	unsigned int order_seed;         /**< Seed of the edge order */
+	unsigned int mem_budget_mb;      /**< Plan the run to fit this many MiB (backends only), or 0 */
+	int ompt;                        /**< Report OpenMP runtime overheads (OpenMP backend built with OMPT=1) */
+	int matrix_fd;                   /**< Inherited shared matrix to map instead of loading filepath (backends only), or -1 */
+	char *filepath;                  /**< Path to the input matrix file */
+	char *manifest;                  /**< Campaign manifest (runner only), or NULL */
+	char *history;                   /**< JSONL history to append to (runner only), or NULL */
+} Args;
+
 /**
  * @brief Parses command-line arguments.
  *
  * Supported options:
  *   -t <threads>   Number of threads (default: 8)
  *   -n <trials>    Number of trials (default: 3)
- *   -v <variant>   Algorithm variant: 0=standard, 1=optimized (default: 0)
+ *   -v <variant>   Algorithm variant: 0=label propagation, 1=union-find,
+ *                  2=low-diameter decomposition (default: 0)
+ *   -a <sample+finish>
+ *                  Composed algorithm run instead of the variant, validated by
+ *                  the backends (see cc_compose_parse())
+ *   -b             Bipartite mode: rows and columns are distinct vertices
+ *   -S <dir>       Write per-component shard files to dir (backends only)
+ *   -B <vertices>  Components smaller than this are binned together (default: 65536)
+ *   -X <MiB>       Stream the matrix from disk with this memory budget (backends only)
+ *   --checkpoint <file>
+ *                  Periodically checkpoint label propagation to file (backends only)
+ *   --checkpoint-interval <seconds>
+ *                  Minimum time between checkpoints (default: 60)
+ *   --resume       Resume label propagation from the checkpoint file
+ *   --profile      Report a structural profile of the graph (backends only)
+ *   --subsets <k>  Count components of edge subsets 0..k-1 of a masked edge list (backends only)
+ *   --order <order>
+ *                  Reorder the loaded graph before the trials: file, cols, ids, rows or hub
+ *   --order-seed <n>
+ *                  Seed of the shuffled orders (default: 1)
+ *   --mem-budget <MiB>
+ *                  Pick a strategy whose projected peak fits the budget (backends only)
+ *   --ompt         Report OpenMP barrier, dispatch and fork/join overheads
+ *                  (OpenMP backend built with OMPT=1)
+ *   --matrix-fd <fd>
+ *                  Map the matrix from an inherited descriptor in the binary CSC
+ *                  layout, as handed over by the runner (backends only)
+ *   -c <manifest>  Run a benchmark campaign from a manifest (runner only)
+ *   -H <history>   Append results to a JSONL history file (runner only)
  *   -h             Show usage and exit
  *
  * Arguments:
- * filepath Path to the input matrix file (Matlab Matrix format)
+ * filepath Path to the input matrix file (Matlab Matrix format), or `-`
+ *          for standard input. Not required when a campaign manifest is given.
  *
  * It validates each argument and reports errors using `print_error()`.
  *
  * @param argc Argument count
  * @param argv Argument vector
- * @param n_threads Output: number of threads
- * @param n_trials Output: number of trials
- * @param algorithm_variant Output: variant of algorithm
- * @param filepath Output: path to matrix file
+ * @param args Output: parsed options
  * @return 0 on success, -1 if help requested, 1 on error
  */
-int parseargs(int argc, char *argv[], unsigned int *n_threads, unsigned int *n_trials, unsigned int *algorithm_variant, char **filepath);
+int parseargs(int argc, char *argv[], Args *args);
 
 #endif /* ARGS_H */
@@ -17,6 +17,8 @@
 #include "error.h"
 #include "benchmark.h"
 #include "json.h"
+#include "workspan.h"
+#include "omptool.h"
 
 /* ------------------------------------------------------------------------- */
 /*                            Static Helper Functions                        */
@@ -186,15 +188,26 @@ benchmark_init(const char *name,
 	b->matrix_info.cols = mat->ncols;
 	b->matrix_info.rows = mat->nrows;
 	b->matrix_info.nnz = mat->nnz;
+	b->matrix_info.has_profile = 0;
 	strncpy(b->matrix_info.path, filepath, sizeof(b->matrix_info.path));
 	b->matrix_info.path[sizeof(b->matrix_info.path) - 1] = '\0';
 
 	// Add benchmark info
 	b->benchmark_info.threads = n_threads;
 	b->benchmark_info.trials  = n_trials;
+	b->benchmark_info.bipartite = mat->bipartite ? 1 : 0;
+	b->benchmark_info.order[0] = '\0';
+	b->benchmark_info.order_seed = 0;
+	b->benchmark_info.composition[0] = '\0';
+	b->benchmark_info.no_warmup = 0;
 
 	// Add result
 	b->result.has_metrics = 0;
+	b->result.has_io = 0;
+	b->result.has_plan = 0;
+	b->result.n_subsets = 0;
+	b->result.n_workspan = 0;
+	b->result.has_ompt = 0;
 	b->result.algorithm_variant = algorithm_variant;
 	strncpy(b->result.algorithm, name, sizeof(b->result.algorithm));
 	b->result.algorithm[sizeof(b->result.algorithm) - 1] = '\0';
@@ -222,6 +235,22 @@ benchmark_free(Benchmark *b)
 	free(b);
 }
 
+/**
+ * @brief Adapts a connected components function to benchmark_func().
+ */
+typedef struct {
+	int (*cc_func)(const CSCBinaryMatrix*, const unsigned int, const unsigned int);
+	const CSCBinaryMatrix *m;
+	unsigned int variant;
+} CCContext;
+
+static long
+run_cc(void *ctx, unsigned int n_threads)
+{
+	CCContext *c = ctx;
+	return c->cc_func(c->m, n_threads, c->variant);
+}
+
 /**
  * @copydoc benchmark_cc()
  */
@@ -229,24 +258,54 @@ int
 benchmark_cc(int (*cc_func)(const CSCBinaryMatrix*, const unsigned int, const unsigned int),
              const CSCBinaryMatrix *m,
              Benchmark *b)
+{
+	CCContext ctx = { cc_func, m, b->result.algorithm_variant };
+	return benchmark_func(run_cc, NULL, &ctx, b);
+}
+
+/**
+ * @copydoc benchmark_func()
+ */
+int
+benchmark_func(long (*func)(void *ctx, unsigned int n_threads),
+               int (*setup)(void *ctx),
+               void *ctx,
+               Benchmark *b)
 {
 	long result;
 
-	result = cc_func(m, b->benchmark_info.threads, b->result.algorithm_variant); /* warm-up run */
+	if (!b->benchmark_info.no_warmup) {
+		if (setup && setup(ctx))
+			return 1;
+
+		result = func(ctx, b->benchmark_info.threads); /* warm-up run */
 
-	if (result < 0)
-		return 1;
+		if (result < 0)
+			return 1;
 
-	b->result.connected_components = result;
+		b->result.connected_components = result;
+	}
+	CC_WORKSPAN_RESET();
+#if defined(CC_OMPT)
+	omptool_reset();
+#endif
 
 	for (unsigned int i = 0; i < b->benchmark_info.trials; i++) {
+		if (setup && setup(ctx))
+			return 1;
+
 		double start_time = now_sec();
-		result = cc_func(m, b->benchmark_info.threads, b->result.algorithm_variant);
+		CC_WORKSPAN_START("total");
+		result = func(ctx, b->benchmark_info.threads);
+		CC_WORKSPAN_END("total");
 		b->times[i] = now_sec() - start_time;
 
 		if (result < 0)
 			return 1;
 
+		if (i == 0 && b->benchmark_info.no_warmup)
+			b->result.connected_components = result;
+
 		if (result != b->result.connected_components) {
 			printf("[%s] Components between retries don't match\n", b->result.algorithm);
 			return 2;
@@ -257,30 +316,70 @@ benchmark_cc(int (*cc_func)(const CSCBinaryMatrix*, const unsigned int, const un
 }
 
 /**
- * @copydoc benchmark_print()
+ * @copydoc benchmark_once()
+ */
+int
+benchmark_once(long (*func)(void *ctx, unsigned int n_threads),
+               void *ctx,
+               Benchmark *b)
+{
+	double start_time = now_sec();
+	CC_WORKSPAN_START("total");
+	long result = func(ctx, b->benchmark_info.threads);
+	CC_WORKSPAN_END("total");
+	b->times[0] = now_sec() - start_time;
+
+	if (result < 0)
+		return 1;
+
+	b->result.connected_components = result;
+	return 0;
+}
+
+/**
+ * @copydoc benchmark_finalize()
  */
 void
-benchmark_print(Benchmark *b)
+benchmark_finalize(Benchmark *b)
 {
 	if (!b) return;
 
 	calculate_time_statistics(b);
-	
+
 	get_iso_timestamp(b);
 	get_cpu_info(b);
 	get_memory_info(b);
 	b->result.throughput_edges_per_sec = b->matrix_info.nnz / b->result.stats.mean_time_s;
 	get_peak_rss_mb(b);
 
+#if defined(CC_CILKSCALE)
+	b->result.n_workspan = workspan_collect(b->result.workspan, WORKSPAN_MAX_PHASES,
+	                                        b->benchmark_info.trials);
+#endif
+#if defined(CC_OMPT)
+	b->result.has_ompt = (unsigned int)omptool_collect(&b->result.ompt, b->benchmark_info.trials);
+#endif
+}
+
+/**
+ * @copydoc benchmark_print()
+ */
+void
+benchmark_print(Benchmark *b)
+{
+	if (!b) return;
+
+	benchmark_finalize(b);
+
 	printf("{\n");
-	print_sys_info(&(b->sys_info), 2);
+	print_sys_info(stdout, &(b->sys_info), 2);
 	printf(",\n");
-	print_matrix_info(&(b->matrix_info), 2);
+	print_matrix_info(stdout, &(b->matrix_info), 2);
 	printf(",\n");
-	print_benchmark_info(&(b->benchmark_info), 2);
+	print_benchmark_info(stdout, &(b->benchmark_info), 2);
 	printf(",\n");
 	printf("  \"results\": [\n");
-	print_result(&(b->result), 4);
+	print_result(stdout, &(b->result), 4);
 	printf("\n  ]\n");
 	printf("}\n");
 }
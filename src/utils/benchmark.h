@@ -11,6 +11,9 @@
 #define BENCHMARK_H
 
 #include "matrix.h"
+#include "profile.h"
+#include "workspan.h"
+#include "omptool.h"
 
 /**
  * @struct Statistics
@@ -27,6 +30,28 @@ typedef struct {
 	double max_time_s;     /**< Maximum execution time in seconds */
 } Statistics;
 
+/**
+ * @struct IOInfo
+ * @brief Disk traffic of an external-memory run.
+ */
+typedef struct {
+	double budget_mb;      /**< Memory budget in megabytes */
+	double read_mb;        /**< Data read from the input and temporary files */
+	double written_mb;     /**< Data written to temporary files */
+	unsigned int passes;   /**< Sequential passes over on-disk data */
+	unsigned int levels;   /**< Depth of the contraction recursion */
+} IOInfo;
+
+/**
+ * @struct PlanInfo
+ * @brief Strategy chosen under a memory budget (see memplan.h).
+ */
+typedef struct {
+	double budget_mb;          /**< Memory budget in megabytes */
+	double projected_peak_mb;  /**< Projected peak of the strategy */
+	char strategy[16];         /**< "in-memory" or "external" */
+} PlanInfo;
+
 /**
  * @struct Result
  * @brief Complete benchmark result for a single algorithm
@@ -43,6 +68,16 @@ typedef struct {
 	double speedup;                      /**< Speedup relative to sequential baseline */
 	double efficiency;                   /**< Parallel efficiency (speedup / threads) */
 	unsigned int has_metrics;            /**< Flag indicating if speedup/efficiency are valid */
+	IOInfo io;                           /**< Disk traffic of an external-memory run */
+	unsigned int has_io;                 /**< Flag indicating if io is valid */
+	PlanInfo plan;                       /**< Memory plan of a budgeted run */
+	unsigned int has_plan;               /**< Flag indicating if plan is valid */
+	unsigned int subset_components[CSC_MAX_SUBSETS]; /**< Components of each edge subset */
+	unsigned int n_subsets;              /**< Edge subsets counted (0 unless --subsets) */
+	PhaseWorkSpan workspan[WORKSPAN_MAX_PHASES]; /**< Work and span per phase (see workspan.h) */
+	unsigned int n_workspan;             /**< Phases measured (0 unless built with Cilkscale) */
+	OmptStats ompt;                      /**< OpenMP runtime overheads (see omptool.h) */
+	unsigned int has_ompt;               /**< Flag indicating if ompt is valid */
 } Result;
 
 /**
@@ -68,9 +103,11 @@ typedef struct {
  */
 typedef struct {
 	char path[256];     /**< File path to the matrix */
-	unsigned int rows;  /**< Number of rows in the matrix */
-	unsigned int cols;  /**< Number of columns in the matrix */
-	unsigned int nnz;   /**< Number of non-zero elements (edges in graph) */
+	uint64_t rows;      /**< Number of rows in the matrix */
+	uint64_t cols;      /**< Number of columns in the matrix */
+	uint64_t nnz;       /**< Number of non-zero elements (edges in graph); 64-bit for streamed inputs */
+	GraphProfile profile;      /**< Structural profile (see csc_profile()) */
+	unsigned int has_profile;  /**< Flag indicating if profile is valid */
 } MatrixInfo;
 
 /**
@@ -82,6 +119,11 @@ typedef struct {
 typedef struct {
 	unsigned int threads;  /**< Number of threads used for parallel execution */
 	unsigned int trials;   /**< Number of benchmark trials performed */
+	unsigned int bipartite;/**< Rows and columns were distinct vertices */
+	char order[8];         /**< Edge order of the trials (see csc_reorder()), or "" as loaded */
+	unsigned int order_seed;/**< Seed of the edge order */
+	char composition[24];  /**< Composed algorithm (see cc_compose()), or "" for the variant */
+	unsigned int no_warmup;/**< Skip the warm-up run, e.g. to resume the first trial from a checkpoint */
 } BenchmarkInfo;
 
 /**
@@ -140,6 +182,60 @@ void benchmark_free(Benchmark *b);
  */
 int benchmark_cc(int (*cc_func)(const CSCBinaryMatrix*, const unsigned int, const unsigned int), const CSCBinaryMatrix *m, Benchmark *b);
 
+/**
+ * @brief Runs a generic timed benchmark.
+ *
+ * Same trial loop as benchmark_cc() for workloads that are not a full
+ * connected components run, such as the micro-benchmarks. The value
+ * returned by @p func is stored as the result's component count and must
+ * be identical across trials. If @p setup is given, it is called before
+ * the warm-up and before every trial, outside the timed region. The
+ * warm-up is skipped if the benchmark's `no_warmup` is set.
+ *
+ * @param func Timed workload; returns a checksum, or a negative value on error.
+ * @param setup Untimed per-trial preparation (may be NULL); returns 0 on success.
+ * @param ctx Opaque context passed to @p func and @p setup.
+ * @param b Benchmark object containing configuration and result storage.
+ *
+ * @return
+ * - `0` on success,
+ * - `1` on workload or setup failure,
+ * - `2` if results differ between trials.
+ */
+int benchmark_func(long (*func)(void *ctx, unsigned int n_threads),
+                   int (*setup)(void *ctx),
+                   void *ctx,
+                   Benchmark *b);
+
+/**
+ * @brief Runs a workload that can only run once.
+ *
+ * For inputs consumed by the run, such as pipes: a single timed trial
+ * with no warm-up. The benchmark must have been initialised for one
+ * trial.
+ *
+ * @param func Timed workload; returns a checksum, or a negative value on error.
+ * @param ctx Opaque context passed to @p func.
+ * @param b Benchmark object containing configuration and result storage.
+ *
+ * @return `0` on success, `1` on workload failure.
+ */
+int benchmark_once(long (*func)(void *ctx, unsigned int n_threads),
+                   void *ctx,
+                   Benchmark *b);
+
+/**
+ * @brief Computes statistics and collects system information.
+ *
+ * Fills in the timing statistics, throughput (nnz per second), peak
+ * memory and system information of a benchmark whose trials have run.
+ * Called by benchmark_print(); callers emitting their own JSON layout
+ * call it directly.
+ *
+ * @param b Pointer to the Benchmark structure with populated times.
+ */
+void benchmark_finalize(Benchmark *b);
+
 /**
  * @brief Prints benchmark results in structured JSON format.
  *
@@ -0,0 +1,127 @@
+/**
+ * @file history.c
+ * @brief Implementation of the JSONL results history.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+
+#include "error.h"
+#include "history.h"
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Feeds a string into a 64-bit FNV-1a hash.
+ */
+static uint64_t
+fnv1a(uint64_t h, const char *s)
+{
+	for (; *s; s++) {
+		h ^= (unsigned char)*s;
+		h *= 0x100000001b3ULL;
+	}
+	return h;
+}
+
+/**
+ * @brief Retrieves the revision of the source tree in the working directory.
+ *
+ * Uses `git describe --always --dirty`, so uncommitted changes are
+ * visible in the recorded revision. Falls back to "unknown".
+ */
+static void
+get_git_revision(char *rev, size_t size)
+{
+	snprintf(rev, size, "unknown");
+
+	FILE *p = popen("git describe --always --dirty 2>/dev/null", "r");
+	if (!p)
+		return;
+
+	char line[48];
+	if (fgets(line, sizeof(line), p)) {
+		line[strcspn(line, "\n")] = '\0';
+		if (line[0])
+			snprintf(rev, size, "%s", line);
+	}
+	pclose(p);
+}
+
+/**
+ * @brief Collects host identification and computes its fingerprint.
+ *
+ * The fingerprint also covers the CPU model and RAM reported by the
+ * benchmark, so hosts sharing a name but not hardware are told apart.
+ */
+static void
+get_host_info(HostInfo *host, const SystemInfo *sys)
+{
+	struct utsname u;
+
+	if (gethostname(host->hostname, sizeof(host->hostname)) != 0)
+		snprintf(host->hostname, sizeof(host->hostname), "unknown");
+	host->hostname[sizeof(host->hostname) - 1] = '\0';
+
+	if (uname(&u) != 0 ||
+	    snprintf(host->kernel, sizeof(host->kernel), "%s %s %s", u.sysname, u.release, u.machine) < 0)
+		snprintf(host->kernel, sizeof(host->kernel), "unknown");
+
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	host->cores = cores > 0 ? (unsigned int)cores : 0;
+
+	char extra[96];
+	snprintf(extra, sizeof(extra), "|%u|%.0f|", host->cores, sys->ram_mb);
+
+	uint64_t h = 0xcbf29ce484222325ULL;
+	h = fnv1a(h, host->hostname);
+	h = fnv1a(h, host->kernel);
+	h = fnv1a(h, sys->cpu_info);
+	h = fnv1a(h, extra);
+	snprintf(host->fingerprint, sizeof(host->fingerprint), "%016llx", (unsigned long long)h);
+}
+
+/* ------------------------------------------------------------------------- */
+/*                            Public API Implementation                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @copydoc history_append()
+ */
+int
+history_append(const char *path, const BenchmarkData *data)
+{
+	static HistoryRecord rec;
+	static int initialized = 0;
+
+	if (!initialized) {
+		get_git_revision(rec.git_revision, sizeof(rec.git_revision));
+		get_host_info(&rec.host, &data->sys_info);
+		initialized = 1;
+	}
+
+	rec.data = *data;
+
+	FILE *f = fopen(path, "a");
+	if (!f) {
+		print_error(__func__, "failed to open history file", errno);
+		return 1;
+	}
+
+	print_history_record(f, &rec);
+
+	if (fclose(f) != 0) {
+		print_error(__func__, "failed to write history file", errno);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+/**
+ * @file history.h
+ * @brief Append-only JSONL history of benchmark results.
+ *
+ * Every benchmark result produced by the runner can be appended to a
+ * history file, one JSON object per line, tagged with the source revision
+ * and a fingerprint of the host. The history is queried with the
+ * `results_query` tool.
+ */
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "json.h"
+
+/**
+ * @brief Append a benchmark result to a JSONL history file.
+ *
+ * The git revision and host information are collected on the first call
+ * and reused afterwards. The file is created if it does not exist.
+ *
+ * @param path Path to the history file.
+ * @param data Benchmark data holding the result to record.
+ * @return 0 on success, 1 on error.
+ */
+int history_append(const char *path, const BenchmarkData *data);
+
+#endif /* HISTORY_H */
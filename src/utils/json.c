@@ -47,6 +47,49 @@ expect_char(const char **p, char c)
 	return 0;
 }
 
+/**
+ * @brief Parse the four hex digits of a \\u escape.
+ * @param s First digit
+ * @param c Output code unit
+ * @return 1 on success, 0 if a digit is missing
+ */
+static int
+parse_hex4(const char *s, unsigned int *c)
+{
+	*c = 0;
+	for (int k = 0; k < 4; k++) {
+		const char h = s[k];
+		*c <<= 4;
+		if (h >= '0' && h <= '9') *c |= (unsigned int)(h - '0');
+		else if (h >= 'a' && h <= 'f') *c |= (unsigned int)(h - 'a' + 10);
+		else if (h >= 'A' && h <= 'F') *c |= (unsigned int)(h - 'A' + 10);
+		else return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief Encode a code point as UTF-8, if it fits.
+ * @param dest Output buffer
+ * @param room Bytes left in dest
+ * @param c Code point
+ * @return Bytes written (0 if it does not fit)
+ */
+static size_t
+put_utf8(char *dest, size_t room, unsigned int c)
+{
+	static const unsigned char lead[] = { 0x00, 0x00, 0xc0, 0xe0, 0xf0 };
+	const size_t len = c < 0x80 ? 1 : c < 0x800 ? 2 : c < 0x10000 ? 3 : 4;
+	if (len > room)
+		return 0;
+	for (size_t k = len - 1; k > 0; k--) {
+		dest[k] = (char)(0x80 | (c & 0x3f));
+		c >>= 6;
+	}
+	dest[0] = (char)(lead[len] | c);
+	return len;
+}
+
 /**
  * @brief Parse a quoted JSON string.
  * 
@@ -64,7 +107,34 @@ parse_string(const char **p, char *dest, size_t max_len)
 	
 	size_t i = 0;
 	while (**p && **p != '"' && i < max_len - 1) {
-		if (**p == '\\' && (*p)[1]) (*p)++;  /**< Handle escape character */
+		if (**p == '\\' && (*p)[1] == 'u') {
+			unsigned int c;
+			if (!parse_hex4(*p + 2, &c))
+				return 0;
+			*p += 6;
+			/* Surrogate pair */
+			unsigned int lo;
+			if (c >= 0xd800 && c < 0xdc00 && (*p)[0] == '\\' && (*p)[1] == 'u' &&
+			    parse_hex4(*p + 2, &lo) && lo >= 0xdc00 && lo < 0xe000) {
+				c = 0x10000 + ((c - 0xd800) << 10) + (lo - 0xdc00);
+				*p += 6;
+			}
+			i += put_utf8(dest + i, max_len - 1 - i, c);
+			continue;
+		}
+		if (**p == '\\' && (*p)[1]) {
+			(*p)++;
+			switch (**p) {
+			case 'b': dest[i++] = '\b'; break;
+			case 'f': dest[i++] = '\f'; break;
+			case 'n': dest[i++] = '\n'; break;
+			case 'r': dest[i++] = '\r'; break;
+			case 't': dest[i++] = '\t'; break;
+			default:  dest[i++] = **p; break;  /* \" \\ \/ */
+			}
+			(*p)++;
+			continue;
+		}
 		dest[i++] = **p;
 		(*p)++;
 	}
@@ -112,6 +182,24 @@ parse_uint(const char **p, unsigned int *value)
 	return 1;
 }
 
+/**
+ * @brief Parse an unsigned 64-bit integer.
+ * @param p Pointer to JSON stream
+ * @param value Output parsed value
+ * @return 1 on success, 0 on parse error
+ */
+static int
+parse_u64(const char **p, uint64_t *value)
+{
+	skip_whitespace(p);
+	char *end;
+	unsigned long long val = strtoull(*p, &end, 10);
+	if (end == *p) return 0;
+	*value = (uint64_t)val;
+	*p = end;
+	return 1;
+}
+
 /**
  * @brief Locate a JSON key and position the pointer after the colon.
  * 
@@ -181,12 +269,15 @@ parse_matrix_info(const char *json, MatrixInfo *info)
 	
 	if (find_key(&p, "path") && !parse_string(&p, info->path, sizeof(info->path)))
 		return 0;
-	if (find_key(&p, "rows") && !parse_uint(&p, &info->rows))
+	if (find_key(&p, "rows") && !parse_u64(&p, &info->rows))
 		return 0;
-	if (find_key(&p, "cols") && !parse_uint(&p, &info->cols))
+	if (find_key(&p, "cols") && !parse_u64(&p, &info->cols))
 		return 0;
-	if (find_key(&p, "nnz") && !parse_uint(&p, &info->nnz))
+	if (find_key(&p, "nnz") && !parse_u64(&p, &info->nnz))
 		return 0;
+
+	/* The profile is not carried over */
+	info->has_profile = 0;
 	
 	return 1;
 }
@@ -208,6 +299,29 @@ parse_benchmark_info(const char *json, BenchmarkInfo *info)
 		return 0;
 	if (find_key(&p, "trials") && !parse_uint(&p, &info->trials))
 		return 0;
+
+	/* Optional, only present for bipartite runs */
+	const char *end = strchr(p, '}');
+	const char *q = p;
+	info->bipartite = 0;
+	if (find_key(&q, "bipartite") && (!end || q < end) && !parse_uint(&q, &info->bipartite))
+		return 0;
+
+	/* Optional, only present for reordered runs */
+	q = p;
+	info->order[0] = '\0';
+	info->order_seed = 0;
+	if (find_key(&q, "order") && (!end || q < end) &&
+	    (!parse_string(&q, info->order, sizeof(info->order)) ||
+	     !find_key(&q, "order_seed") || !parse_uint(&q, &info->order_seed)))
+		return 0;
+
+	/* Optional, only present for composed algorithms */
+	q = p;
+	info->composition[0] = '\0';
+	if (find_key(&q, "composition") && (!end || q < end) &&
+	    !parse_string(&q, info->composition, sizeof(info->composition)))
+		return 0;
 	
 	return 1;
 }
@@ -253,6 +367,11 @@ parse_result(const char *json, Result *result)
 	if (!expect_char(&p, '{')) return 0;
 	
 	result->has_metrics = 0;
+	result->has_io = 0;
+	result->has_plan = 0;
+	result->n_subsets = 0;
+	result->n_workspan = 0;
+	result->has_ompt = 0;
 	
 	if (find_key(&p, "algorithm") && !parse_string(&p, result->algorithm, sizeof(result->algorithm)))
 		return 0;
@@ -270,6 +389,31 @@ parse_result(const char *json, Result *result)
 	return 1;
 }
 
+/**
+ * @brief Parse the "host" JSON object of a history record.
+ * @param json Input JSON string
+ * @param info Output structure to populate
+ * @return 1 on success, 0 on failure
+ */
+static int
+parse_host_info(const char *json, HostInfo *info)
+{
+	const char *p = json;
+	if (!find_key(&p, "host")) return 0;
+	if (!expect_char(&p, '{')) return 0;
+
+	if (find_key(&p, "hostname") && !parse_string(&p, info->hostname, sizeof(info->hostname)))
+		return 0;
+	if (find_key(&p, "kernel") && !parse_string(&p, info->kernel, sizeof(info->kernel)))
+		return 0;
+	if (find_key(&p, "cores") && !parse_uint(&p, &info->cores))
+		return 0;
+	if (find_key(&p, "fingerprint") && !parse_string(&p, info->fingerprint, sizeof(info->fingerprint)))
+		return 0;
+
+	return 1;
+}
+
 /* ------------------------------------------------------------------------- */
 /*                             Public API                                    */
 /* ------------------------------------------------------------------------- */
@@ -298,77 +442,346 @@ parse_benchmark_data(const char *json, BenchmarkData *data)
 	return 1;
 }
 
+/**
+ * @brief Parse one line of the JSONL results history.
+ *
+ * The record embeds the regular benchmark sections, so they are parsed
+ * with parse_benchmark_data(). Speedup and efficiency are optional.
+ *
+ * @param line Input JSON line
+ * @param rec Output structure to populate
+ * @return 1 on success, 0 on failure
+ */
+int
+parse_history_record(const char *line, HistoryRecord *rec)
+{
+	const char *p = line;
+
+	memset(rec, 0, sizeof(*rec));
+
+	if (!find_key(&p, "git_revision") ||
+	    !parse_string(&p, rec->git_revision, sizeof(rec->git_revision)))
+		return 0;
+	if (!parse_host_info(line, &rec->host)) return 0;
+	if (!parse_benchmark_data(line, &rec->data)) return 0;
+
+	p = line;
+	if (find_key(&p, "speedup") && parse_double(&p, &rec->data.result.speedup)) {
+		p = line;
+		if (find_key(&p, "efficiency") && parse_double(&p, &rec->data.result.efficiency))
+			rec->data.result.has_metrics = 1;
+	}
+
+	return 1;
+}
+
 /* ------------------------------------------------------------------------- */
 /*                           JSON Print Helpers                              */
 /* ------------------------------------------------------------------------- */
 
+/**
+ * @brief Print a string as a quoted JSON string.
+ */
+void
+print_json_string(FILE *f, const char *s)
+{
+	fputc('"', f);
+	for (; *s; s++) {
+		const unsigned char c = (unsigned char)*s;
+		if (c == '"' || c == '\\')
+			fprintf(f, "\\%c", c);
+		else if (c < 0x20)
+			fprintf(f, "\\u%04x", c);
+		else
+			fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+/**
+ * @brief Print a history record as a single line of JSON.
+ */
+void
+print_history_record(FILE *f, const HistoryRecord *rec)
+{
+	const BenchmarkData *d = &rec->data;
+	const Result *r = &d->result;
+
+	fprintf(f, "{\"git_revision\":");
+	print_json_string(f, rec->git_revision);
+	fprintf(f, ",\"host\":{\"hostname\":");
+	print_json_string(f, rec->host.hostname);
+	fprintf(f, ",\"kernel\":");
+	print_json_string(f, rec->host.kernel);
+	fprintf(f, ",\"cores\":%u,\"fingerprint\":", rec->host.cores);
+	print_json_string(f, rec->host.fingerprint);
+	fprintf(f, "},\"sys_info\":{\"timestamp\":");
+	print_json_string(f, d->sys_info.timestamp);
+	fprintf(f, ",\"cpu_info\":");
+	print_json_string(f, d->sys_info.cpu_info);
+	fprintf(f, ",\"ram_mb\":%.2f,\"swap_mb\":%.2f},", d->sys_info.ram_mb, d->sys_info.swap_mb);
+	fprintf(f, "\"matrix_info\":{\"path\":");
+	print_json_string(f, d->matrix_info.path);
+	fprintf(f, ",\"rows\":%llu,\"cols\":%llu,\"nnz\":%llu},",
+	        (unsigned long long)d->matrix_info.rows, (unsigned long long)d->matrix_info.cols,
+	        (unsigned long long)d->matrix_info.nnz);
+	fprintf(f, "\"benchmark_info\":{\"threads\":%u,\"trials\":%u%s",
+	        d->benchmark_info.threads, d->benchmark_info.trials,
+	        d->benchmark_info.bipartite ? ",\"bipartite\":1" : "");
+	if (d->benchmark_info.order[0]) {
+		fprintf(f, ",\"order\":");
+		print_json_string(f, d->benchmark_info.order);
+		fprintf(f, ",\"order_seed\":%u", d->benchmark_info.order_seed);
+	}
+	if (d->benchmark_info.composition[0]) {
+		fprintf(f, ",\"composition\":");
+		print_json_string(f, d->benchmark_info.composition);
+	}
+	fprintf(f, "},");
+	fprintf(f, "\"results\":[{\"algorithm\":");
+	print_json_string(f, r->algorithm);
+	fprintf(f, ",\"algorithm_variant\":%u,\"connected_components\":%u,",
+	        r->algorithm_variant, r->connected_components);
+	fprintf(f, "\"statistics\":{\"mean_time_s\":%.6f,\"std_dev_s\":%.6f,\"median_time_s\":%.6f,\"min_time_s\":%.6f,\"max_time_s\":%.6f},",
+	        r->stats.mean_time_s, r->stats.std_dev_s, r->stats.median_time_s,
+	        r->stats.min_time_s, r->stats.max_time_s);
+	fprintf(f, "\"throughput_edges_per_sec\":%.2f,\"memory_peak_mb\":%.2f",
+	        r->throughput_edges_per_sec, r->memory_peak_mb);
+	if (r->has_metrics)
+		fprintf(f, ",\"speedup\":%.4f,\"efficiency\":%.4f", r->speedup, r->efficiency);
+	fprintf(f, "}]}\n");
+}
+
 /**
  * @brief Print system information as formatted JSON.
  */
 void
-print_sys_info(const SystemInfo *info, int indent_level)
+print_sys_info(FILE *f, const SystemInfo *info, int indent_level)
 {
-	printf("%*s\"sys_info\": {\n", indent_level, "");
-	printf("%*s\"timestamp\": \"%s\",\n", indent_level + 2, "", info->timestamp);
-	printf("%*s\"cpu_info\": \"%s\",\n", indent_level + 2, "", info->cpu_info);
-	printf("%*s\"ram_mb\": %.2f,\n", indent_level + 2, "", info->ram_mb);
-	printf("%*s\"swap_mb\": %.2f\n", indent_level + 2, "", info->swap_mb);
-	printf("%*s}", indent_level, "");
+	fprintf(f, "%*s\"sys_info\": {\n", indent_level, "");
+	fprintf(f, "%*s\"timestamp\": ", indent_level + 2, "");
+	print_json_string(f, info->timestamp);
+	fprintf(f, ",\n%*s\"cpu_info\": ", indent_level + 2, "");
+	print_json_string(f, info->cpu_info);
+	fprintf(f, ",\n");
+	fprintf(f, "%*s\"ram_mb\": %.2f,\n", indent_level + 2, "", info->ram_mb);
+	fprintf(f, "%*s\"swap_mb\": %.2f\n", indent_level + 2, "", info->swap_mb);
+	fprintf(f, "%*s}", indent_level, "");
 }
 
 /**
  * @brief Print matrix information as formatted JSON.
  */
 void
-print_matrix_info(const MatrixInfo *info, int indent_level)
+print_matrix_info(FILE *f, const MatrixInfo *info, int indent_level)
 {
-	printf("%*s\"matrix_info\": {\n", indent_level, "");
-	printf("%*s\"path\": \"%s\",\n", indent_level + 2, "", info->path);
-	printf("%*s\"rows\": %u,\n", indent_level + 2, "", info->rows);
-	printf("%*s\"cols\": %u,\n", indent_level + 2, "", info->cols);
-	printf("%*s\"nnz\": %u\n", indent_level + 2, "", info->nnz);
-	printf("%*s}", indent_level, "");
+	fprintf(f, "%*s\"matrix_info\": {\n", indent_level, "");
+	fprintf(f, "%*s\"path\": ", indent_level + 2, "");
+	print_json_string(f, info->path);
+	fprintf(f, ",\n");
+	fprintf(f, "%*s\"rows\": %llu,\n", indent_level + 2, "", (unsigned long long)info->rows);
+	fprintf(f, "%*s\"cols\": %llu,\n", indent_level + 2, "", (unsigned long long)info->cols);
+	fprintf(f, "%*s\"nnz\": %llu", indent_level + 2, "", (unsigned long long)info->nnz);
+
+	if (info->has_profile) {
+		const GraphProfile *p = &info->profile;
+		fprintf(f, ",\n");
+		fprintf(f, "%*s\"profile\": {\n", indent_level + 2, "");
+		fprintf(f, "%*s\"degree_min\": %u,\n", indent_level + 4, "", p->degree_min);
+		fprintf(f, "%*s\"degree_max\": %u,\n", indent_level + 4, "", p->degree_max);
+		fprintf(f, "%*s\"degree_mean\": %.4f,\n", indent_level + 4, "", p->degree_mean);
+		fprintf(f, "%*s\"degree_skew\": %.4f,\n", indent_level + 4, "", p->degree_skew);
+		fprintf(f, "%*s\"empty_cols\": %u,\n", indent_level + 4, "", p->empty_cols);
+		fprintf(f, "%*s\"self_loops\": %u,\n", indent_level + 4, "", p->self_loops);
+		fprintf(f, "%*s\"duplicates\": %u,\n", indent_level + 4, "", p->duplicates);
+		fprintf(f, "%*s\"symmetric\": %u,\n", indent_level + 4, "", p->symmetric);
+		fprintf(f, "%*s\"diameter_estimate\": %u,\n", indent_level + 4, "", p->diameter_estimate);
+		fprintf(f, "%*s\"bfs_sources\": %u\n", indent_level + 4, "", p->bfs_sources);
+		fprintf(f, "%*s}", indent_level + 2, "");
+	}
+
+	fprintf(f, "\n%*s}", indent_level, "");
 }
 
 /**
  * @brief Print benchmark parameters as formatted JSON.
  */
 void
-print_benchmark_info(const BenchmarkInfo *info, int indent_level)
+print_benchmark_info(FILE *f, const BenchmarkInfo *info, int indent_level)
 {
-	printf("%*s\"benchmark_info\": {\n", indent_level, "");
-	printf("%*s\"threads\": %u,\n", indent_level + 2, "", info->threads);
-	printf("%*s\"trials\": %u\n", indent_level + 2, "", info->trials);
-	printf("%*s}", indent_level, "");
+	fprintf(f, "%*s\"benchmark_info\": {\n", indent_level, "");
+	fprintf(f, "%*s\"threads\": %u,\n", indent_level + 2, "", info->threads);
+	fprintf(f, "%*s\"trials\": %u", indent_level + 2, "", info->trials);
+	if (info->bipartite)
+		fprintf(f, ",\n%*s\"bipartite\": 1", indent_level + 2, "");
+	if (info->order[0]) {
+		fprintf(f, ",\n%*s\"order\": ", indent_level + 2, "");
+		print_json_string(f, info->order);
+		fprintf(f, ",\n%*s\"order_seed\": %u", indent_level + 2, "", info->order_seed);
+	}
+	if (info->composition[0]) {
+		fprintf(f, ",\n%*s\"composition\": ", indent_level + 2, "");
+		print_json_string(f, info->composition);
+	}
+	fprintf(f, "\n");
+	fprintf(f, "%*s}", indent_level, "");
+}
+
+/**
+ * @brief Print the work and span of each phase, and the speedup bounds the
+ * whole trial's work and span imply on more cores.
+ *
+ * On P cores the speedup is at most min(P, work / span), and at least
+ * work / (work / P + burdened span).
+ */
+static void
+print_workspan(FILE *f, const Result *result, int indent_level)
+{
+	static const unsigned int cores[] = { 2, 4, 8, 16, 32, 64, 128, 256 };
+	const PhaseWorkSpan *total = NULL;
+
+	fprintf(f, "%*s\"workspan\": {\n", indent_level, "");
+	fprintf(f, "%*s\"phases\": [\n", indent_level + 2, "");
+	for (unsigned int k = 0; k < result->n_workspan; k++) {
+		const PhaseWorkSpan *w = &result->workspan[k];
+		if (strcmp(w->phase, "total") == 0)
+			total = w;
+		fprintf(f, "%*s{ \"phase\": ", indent_level + 4, "");
+		print_json_string(f, w->phase);
+		fprintf(f, ", \"work_s\": %.6f, \"span_s\": %.6f, "
+		        "\"burdened_span_s\": %.6f, \"parallelism\": %.2f, \"burdened_parallelism\": %.2f }%s\n",
+		        w->work_s, w->span_s, w->burdened_span_s,
+		        w->span_s > 0 ? w->work_s / w->span_s : 0.0,
+		        w->burdened_span_s > 0 ? w->work_s / w->burdened_span_s : 0.0,
+		        k + 1 < result->n_workspan ? "," : "");
+	}
+	fprintf(f, "%*s]", indent_level + 2, "");
+
+	if (total && total->span_s > 0) {
+		const double parallelism = total->work_s / total->span_s;
+		fprintf(f, ",\n%*s\"projection\": [\n", indent_level + 2, "");
+		for (size_t k = 0; k < sizeof(cores) / sizeof(cores[0]); k++) {
+			const double p = cores[k];
+			fprintf(f, "%*s{ \"cores\": %u, \"speedup_min\": %.2f, \"speedup_max\": %.2f }%s\n",
+			        indent_level + 4, "", cores[k],
+			        total->work_s / (total->work_s / p + total->burdened_span_s),
+			        p < parallelism ? p : parallelism,
+			        k + 1 < sizeof(cores) / sizeof(cores[0]) ? "," : "");
+		}
+		fprintf(f, "%*s]", indent_level + 2, "");
+	}
+
+	fprintf(f, "\n%*s}", indent_level, "");
+}
+
+/**
+ * @brief Print the OpenMP runtime overheads, totalled and per thread.
+ */
+static void
+print_ompt(FILE *f, const OmptStats *o, int indent_level)
+{
+	OmptThreadStats sum = { 0 };
+	for (unsigned int k = 0; k < o->n_threads; k++) {
+		sum.fork_s += o->thread[k].fork_s;
+		sum.barrier_wait_s += o->thread[k].barrier_wait_s;
+		sum.join_s += o->thread[k].join_s;
+		sum.dispatches += o->thread[k].dispatches;
+	}
+
+	fprintf(f, "%*s\"ompt\": {\n", indent_level, "");
+	fprintf(f, "%*s\"regions\": %.1f,\n", indent_level + 2, "", o->regions);
+	fprintf(f, "%*s\"region_s\": %.6f,\n", indent_level + 2, "", o->region_s);
+	fprintf(f, "%*s\"fork_s\": %.6f,\n", indent_level + 2, "", sum.fork_s);
+	fprintf(f, "%*s\"barrier_wait_s\": %.6f,\n", indent_level + 2, "", sum.barrier_wait_s);
+	fprintf(f, "%*s\"join_s\": %.6f,\n", indent_level + 2, "", sum.join_s);
+	/* null where the runtime does not report dispatches, rather than 0 */
+	if (o->has_dispatch)
+		fprintf(f, "%*s\"dispatches\": %.1f,\n", indent_level + 2, "", sum.dispatches);
+	else
+		fprintf(f, "%*s\"dispatches\": null,\n", indent_level + 2, "");
+	fprintf(f, "%*s\"threads\": [\n", indent_level + 2, "");
+	for (unsigned int k = 0; k < o->n_threads; k++) {
+		const OmptThreadStats *t = &o->thread[k];
+		fprintf(f, "%*s{ \"thread\": %u, \"fork_s\": %.6f, \"barrier_wait_s\": %.6f, \"join_s\": %.6f",
+		        indent_level + 4, "", k, t->fork_s, t->barrier_wait_s, t->join_s);
+		if (o->has_dispatch)
+			fprintf(f, ", \"dispatches\": %.1f", t->dispatches);
+		else
+			fprintf(f, ", \"dispatches\": null");
+		fprintf(f, " }%s\n", k + 1 < o->n_threads ? "," : "");
+	}
+	fprintf(f, "%*s]\n", indent_level + 2, "");
+	fprintf(f, "%*s}", indent_level, "");
 }
 
 /**
  * @brief Print algorithm result as formatted JSON.
  */
 void
-print_result(const Result *result, int indent_level)
+print_result(FILE *f, const Result *result, int indent_level)
 {
-	printf("%*s{\n", indent_level, "");
-	printf("%*s\"algorithm\": \"%s\",\n", indent_level + 2, "", result->algorithm);
-	printf("%*s\"algorithm_variant\": %u,\n", indent_level + 2, "", result->algorithm_variant);
-	printf("%*s\"connected_components\": %u,\n", indent_level + 2, "", result->connected_components);
-	printf("%*s\"statistics\": {\n", indent_level + 2, "");
-	printf("%*s\"mean_time_s\": %.6f,\n", indent_level + 4, "", result->stats.mean_time_s);
-	printf("%*s\"std_dev_s\": %.6f,\n", indent_level + 4, "", result->stats.std_dev_s);
-	printf("%*s\"median_time_s\": %.6f,\n", indent_level + 4, "", result->stats.median_time_s);
-	printf("%*s\"min_time_s\": %.6f,\n", indent_level + 4, "", result->stats.min_time_s);
-	printf("%*s\"max_time_s\": %.6f\n", indent_level + 4, "", result->stats.max_time_s);
-	printf("%*s},\n", indent_level + 2, "");
-	printf("%*s\"throughput_edges_per_sec\": %.2f,\n", indent_level + 2, "", result->throughput_edges_per_sec);
-	printf("%*s\"memory_peak_mb\": %.2f", indent_level + 2, "", result->memory_peak_mb);
+	fprintf(f, "%*s{\n", indent_level, "");
+	fprintf(f, "%*s\"algorithm\": ", indent_level + 2, "");
+	print_json_string(f, result->algorithm);
+	fprintf(f, ",\n");
+	fprintf(f, "%*s\"algorithm_variant\": %u,\n", indent_level + 2, "", result->algorithm_variant);
+	fprintf(f, "%*s\"connected_components\": %u,\n", indent_level + 2, "", result->connected_components);
+	fprintf(f, "%*s\"statistics\": {\n", indent_level + 2, "");
+	fprintf(f, "%*s\"mean_time_s\": %.6f,\n", indent_level + 4, "", result->stats.mean_time_s);
+	fprintf(f, "%*s\"std_dev_s\": %.6f,\n", indent_level + 4, "", result->stats.std_dev_s);
+	fprintf(f, "%*s\"median_time_s\": %.6f,\n", indent_level + 4, "", result->stats.median_time_s);
+	fprintf(f, "%*s\"min_time_s\": %.6f,\n", indent_level + 4, "", result->stats.min_time_s);
+	fprintf(f, "%*s\"max_time_s\": %.6f\n", indent_level + 4, "", result->stats.max_time_s);
+	fprintf(f, "%*s},\n", indent_level + 2, "");
+	fprintf(f, "%*s\"throughput_edges_per_sec\": %.2f,\n", indent_level + 2, "", result->throughput_edges_per_sec);
+	fprintf(f, "%*s\"memory_peak_mb\": %.2f", indent_level + 2, "", result->memory_peak_mb);
+
+	if (result->has_io) {
+		fprintf(f, ",\n");
+		fprintf(f, "%*s\"io\": {\n", indent_level + 2, "");
+		fprintf(f, "%*s\"budget_mb\": %.2f,\n", indent_level + 4, "", result->io.budget_mb);
+		fprintf(f, "%*s\"read_mb\": %.2f,\n", indent_level + 4, "", result->io.read_mb);
+		fprintf(f, "%*s\"written_mb\": %.2f,\n", indent_level + 4, "", result->io.written_mb);
+		fprintf(f, "%*s\"passes\": %u,\n", indent_level + 4, "", result->io.passes);
+		fprintf(f, "%*s\"levels\": %u\n", indent_level + 4, "", result->io.levels);
+		fprintf(f, "%*s}", indent_level + 2, "");
+	}
+
+	if (result->has_plan) {
+		fprintf(f, ",\n");
+		fprintf(f, "%*s\"memory_plan\": {\n", indent_level + 2, "");
+		fprintf(f, "%*s\"budget_mb\": %.2f,\n", indent_level + 4, "", result->plan.budget_mb);
+		fprintf(f, "%*s\"strategy\": ", indent_level + 4, "");
+		print_json_string(f, result->plan.strategy);
+		fprintf(f, ",\n");
+		fprintf(f, "%*s\"projected_peak_mb\": %.2f\n", indent_level + 4, "", result->plan.projected_peak_mb);
+		fprintf(f, "%*s}", indent_level + 2, "");
+	}
+
+	if (result->n_subsets) {
+		fprintf(f, ",\n%*s\"subset_components\": [", indent_level + 2, "");
+		for (unsigned int s = 0; s < result->n_subsets; s++)
+			fprintf(f, "%s%u", s ? ", " : "", result->subset_components[s]);
+		fprintf(f, "]");
+	}
+
+	if (result->n_workspan) {
+		fprintf(f, ",\n");
+		print_workspan(f, result, indent_level + 2);
+	}
+
+	if (result->has_ompt) {
+		fprintf(f, ",\n");
+		print_ompt(f, &result->ompt, indent_level + 2);
+	}
 	
 	if (result->has_metrics) {
-		printf(",\n");
-		printf("%*s\"speedup\": %.4f,\n", indent_level + 2, "", result->speedup);
-		printf("%*s\"efficiency\": %.4f\n", indent_level + 2, "", result->efficiency);
+		fprintf(f, ",\n");
+		fprintf(f, "%*s\"speedup\": %.4f,\n", indent_level + 2, "", result->speedup);
+		fprintf(f, "%*s\"efficiency\": %.4f\n", indent_level + 2, "", result->efficiency);
 	} else {
-		printf("\n");
+		fprintf(f, "\n");
 	}
 	
-	printf("%*s}", indent_level, "");
+	fprintf(f, "%*s}", indent_level, "");
 }
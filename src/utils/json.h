@@ -11,6 +11,8 @@
 #ifndef JSON_H
 #define JSON_H
 
+#include <stdio.h>
+
 #include "benchmark.h"
 
 /**
@@ -28,6 +30,30 @@ typedef struct {
 	int valid;                    /**< Flag indicating successful parsing */
 } BenchmarkData;
 
+/**
+ * @struct HostInfo
+ * @brief Identification of the host a benchmark ran on
+ */
+typedef struct {
+	char hostname[64];      /**< Host name */
+	char kernel[96];        /**< Kernel name, release and machine */
+	unsigned int cores;     /**< Online logical CPUs */
+	char fingerprint[17];   /**< Hex hash of the fields above, CPU model and RAM */
+} HostInfo;
+
+/**
+ * @struct HistoryRecord
+ * @brief One line of the JSONL results history
+ *
+ * A single benchmark result together with the revision and host that
+ * produced it.
+ */
+typedef struct {
+	char git_revision[48];  /**< Source revision of the benchmarked binaries */
+	HostInfo host;          /**< Host identification */
+	BenchmarkData data;     /**< Benchmark data (one result) */
+} HistoryRecord;
+
 /**
  * @brief Parse JSON benchmark output into structured data
  * 
@@ -47,45 +73,73 @@ typedef struct {
  */
 int parse_benchmark_data(const char *json, BenchmarkData *data);
 
+/**
+ * @brief Parse one line of the JSONL results history
+ *
+ * @param line Null-terminated JSON object (a single history line)
+ * @param rec Pointer to HistoryRecord structure to populate
+ * @return 1 on success, 0 on parse failure
+ */
+int parse_history_record(const char *line, HistoryRecord *rec);
+
+/**
+ * @brief Print a string as a quoted JSON string
+ *
+ * Quotes and backslashes are escaped, and control characters are written
+ * as \\u00XX, so paths and other free-form text stay valid JSON.
+ *
+ * @param f Output stream
+ * @param s Null-terminated string to print
+ */
+void print_json_string(FILE *f, const char *s);
+
+/**
+ * @brief Print a history record as a single line of JSON
+ *
+ * The record is terminated by a newline, so consecutive calls produce a
+ * JSONL stream.
+ *
+ * @param f Output stream
+ * @param rec Pointer to HistoryRecord structure to print
+ */
+void print_history_record(FILE *f, const HistoryRecord *rec);
+
 /**
  * @brief Print system information as formatted JSON
  * 
+ * @param f Output stream
  * @param info Pointer to SystemInfo structure to print
  * @param indent_level Number of spaces to indent the output
- * 
- * @note Output is written to stdout
  */
-void print_sys_info(const SystemInfo *info, int indent_level);
+void print_sys_info(FILE *f, const SystemInfo *info, int indent_level);
 
 /**
  * @brief Print matrix information as formatted JSON
  * 
+ * @param f Output stream
  * @param info Pointer to MatrixInfo structure to print
  * @param indent_level Number of spaces to indent the output
- * 
- * @note Output is written to stdout
  */
-void print_matrix_info(const MatrixInfo *info, int indent_level);
+void print_matrix_info(FILE *f, const MatrixInfo *info, int indent_level);
 
 /**
  * @brief Print benchmark parameters as formatted JSON
  * 
+ * @param f Output stream
  * @param info Pointer to BenchmarkInfo structure to print
  * @param indent_level Number of spaces to indent the output
- * 
- * @note Output is written to stdout
  */
-void print_benchmark_info(const BenchmarkInfo *info, int indent_level);
+void print_benchmark_info(FILE *f, const BenchmarkInfo *info, int indent_level);
 
 /**
  * @brief Print algorithm result as formatted JSON
  * 
+ * @param f Output stream
  * @param result Pointer to Result structure to print
  * @param indent_level Number of spaces to indent the output
  * 
  * @note If result->has_metrics is true, speedup and efficiency are included
- * @note Output is written to stdout
  */
-void print_result(const Result *result, int indent_level);
+void print_result(FILE *f, const Result *result, int indent_level);
 
 #endif // JSON_H
@@ -0,0 +1,692 @@
+/**
+ * @file workload.c
+ * @brief Mixed query/update workload benchmark for incremental connectivity.
+ *
+ * Replays a trace of edge insertions and `connected(u, v)` queries against
+ * one shared union-find structure, as a long-running service would see
+ * them, and reports throughput and tail latency per operation type.
+ *
+ * The trace is generated (uniform random endpoints, a given share of
+ * queries, inserts in fixed-size batches) or read from a file with one
+ * operation per line:
+ *
+ *     i <u> <v>    insert the edge (u, v)
+ *     q <u> <v>    ask whether u and v are connected
+ *
+ * Runs of consecutive inserts are applied in batches of up to -B edges.
+ * Lines starting with '#' or '%' are comments, and the vertex count is the
+ * largest id plus one. A generated trace can be written out with -w and
+ * replayed later with -r.
+ *
+ * Threads take operations in trace order from a shared cursor and time
+ * each one on its own, so a slow batch delays only the operations behind
+ * it on the same thread, as with requests served by a thread pool. Inserts
+ * use `union_rem()` and queries `find_compress()` from cc_primitives.h;
+ * a query that races with inserts answers as of some point during its
+ * execution.
+ *
+ * Replays are run with benchmark_func(): a warm-up, then -n timed trials,
+ * each from singletons. Throughput is per mean trial time, and latency
+ * percentiles are taken over the operations of all the timed trials.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <omp.h>
+
+#include "benchmark.h"
+#include "cc_primitives.h"
+#include "error.h"
+#include "json.h"
+
+#define SEED 0x9E3779B97F4A7C15ULL
+
+const char *program_name = "workload_bench";
+
+/* Full path compression and Rem unions, safe under concurrent use */
+CC_DEFINE_FIND(find_compress, uint32_t, FULL, RELAXED)
+CC_DEFINE_UNION(union_rem, uint32_t, find_compress, RELAXED)
+
+/**
+ * @brief Operation types, in the order of kind_names.
+ */
+typedef enum {
+	OP_INSERT,
+	OP_QUERY,
+	OP_COUNT
+} OpKind;
+
+static const char *kind_names[OP_COUNT] = { "insert", "query" };
+
+/**
+ * @struct Op
+ * @brief One timed operation: an insert batch or a single query.
+ */
+typedef struct {
+	uint32_t first;   /**< Index of its first pair */
+	uint32_t count;   /**< Pairs (edges of a batch, 1 for a query) */
+	OpKind kind;
+} Op;
+
+/**
+ * @struct Trace
+ * @brief Operations and the vertex pairs they refer to.
+ */
+typedef struct {
+	uint32_t n;            /**< Vertices */
+	Op *ops;
+	size_t n_ops;
+	size_t cap_ops;
+	uint32_t *pairs;       /**< (u, v) pairs, two entries each */
+	size_t n_pairs;
+	size_t cap_pairs;
+} Trace;
+
+/**
+ * @struct OpStats
+ * @brief Summary of the operations of one type.
+ */
+typedef struct {
+	size_t count;          /**< Operations */
+	size_t pairs;          /**< Edges inserted, or queries */
+	size_t hits;           /**< Merging unions, or queries answered "connected" */
+	double p50_us;
+	double p99_us;
+	double p999_us;
+	double max_us;
+} OpStats;
+
+/**
+ * @struct Replay
+ * @brief Trial state shared by the setup and timed body of a replay.
+ */
+typedef struct {
+	const Trace *t;
+	uint32_t *label;       /**< Union-find parents */
+	uint64_t *latency_ns;  /**< n_ops latencies per round, warm-up first */
+	unsigned int round;    /**< Replays so far (0 is the warm-up) */
+	size_t hits[OP_COUNT]; /**< Merging unions and "connected" answers of the last round */
+} Replay;
+
+/* ------------------------------------------------------------------------- */
+/*                            Static Helper Functions                        */
+/* ------------------------------------------------------------------------- */
+
+static void
+usage(void)
+{
+	fprintf(stderr,
+		"Usage: %s [OPTIONS]\n\n"
+		"Options:\n"
+		"  -t <threads>  Number of threads (default: 8)\n"
+		"  -n <trials>   Number of timed replays, after one warm-up (default: 5)\n"
+		"  -s <scale>    log2 of the number of vertices of a generated trace (default: 20)\n"
+		"  -m <ops>      Operations of a generated trace (default: 1000000)\n"
+		"  -q <percent>  Share of queries in a generated trace (default: 90)\n"
+		"  -B <edges>    Edges per insert batch (default: 64)\n"
+		"  -r <file>     Replay a recorded trace instead of generating one\n"
+		"  -w <file>     Write the generated trace to a file\n"
+		"  -o <file>     Write JSON results to a file (default: stdout)\n"
+		"  -h            Show this help message and exit\n",
+		program_name);
+}
+
+/**
+ * @brief xorshift64* step; deterministic so every run sees the same input.
+ */
+static inline uint64_t
+next_rand(uint64_t *s)
+{
+	*s ^= *s >> 12;
+	*s ^= *s << 25;
+	*s ^= *s >> 27;
+	return *s * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Parses a positive integer option value.
+ * @return 0 on success, 1 on error.
+ */
+static int
+parse_uint(const char *s, unsigned int min, unsigned int max, unsigned int *out)
+{
+	char *end;
+	errno = 0;
+	unsigned long val = strtoul(s, &end, 10);
+	if (errno || *end != '\0' || val < min || val > max)
+		return 1;
+	*out = (unsigned int)val;
+	return 0;
+}
+
+static inline uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void
+trace_free(Trace *t)
+{
+	free(t->ops);
+	free(t->pairs);
+}
+
+/**
+ * @brief Appends the pair (u, v) to the trace, opening a new operation
+ * unless it extends the insert batch at the end.
+ * @return 0 on success, 1 on error.
+ */
+static int
+trace_push(Trace *t, OpKind kind, uint32_t u, uint32_t v, unsigned int batch)
+{
+	if (t->n_pairs == UINT32_MAX) {
+		print_error(__func__, "trace has too many pairs", 0);
+		return 1;
+	}
+	if (t->n_pairs == t->cap_pairs) {
+		size_t cap = t->cap_pairs ? 2 * t->cap_pairs : 4096;
+		uint32_t *p = realloc(t->pairs, cap * 2 * sizeof(uint32_t));
+		if (!p) {
+			print_error(__func__, "realloc() failed", errno);
+			return 1;
+		}
+		t->pairs = p;
+		t->cap_pairs = cap;
+	}
+
+	Op *last = t->n_ops ? &t->ops[t->n_ops - 1] : NULL;
+	if (kind == OP_INSERT && last && last->kind == OP_INSERT && last->count < batch) {
+		last->count++;
+	} else {
+		if (t->n_ops == t->cap_ops) {
+			size_t cap = t->cap_ops ? 2 * t->cap_ops : 4096;
+			Op *o = realloc(t->ops, cap * sizeof(Op));
+			if (!o) {
+				print_error(__func__, "realloc() failed", errno);
+				return 1;
+			}
+			t->ops = o;
+			t->cap_ops = cap;
+		}
+		t->ops[t->n_ops++] = (Op){ .first = (uint32_t)t->n_pairs, .count = 1, .kind = kind };
+	}
+
+	t->pairs[2 * t->n_pairs] = u;
+	t->pairs[2 * t->n_pairs + 1] = v;
+	t->n_pairs++;
+	return 0;
+}
+
+/**
+ * @brief Generates m operations over 2^scale vertices: queries with
+ * probability percent/100, otherwise batches of `batch` random edges.
+ * @return 0 on success, 1 on error.
+ */
+static int
+trace_generate(Trace *t, unsigned int scale, unsigned int m, unsigned int percent,
+               unsigned int batch)
+{
+	uint64_t s = SEED;
+
+	memset(t, 0, sizeof(*t));
+	t->n = 1u << scale;
+
+	for (unsigned int i = 0; i < m; i++) {
+		const int query = next_rand(&s) % 100 < percent;
+		const unsigned int count = query ? 1 : batch;
+
+		/* A full batch is never extended, so each one stays whole */
+		for (unsigned int k = 0; k < count; k++) {
+			uint32_t u = (uint32_t)(next_rand(&s) >> (64 - scale));
+			uint32_t v = (uint32_t)(next_rand(&s) >> (64 - scale));
+			if (trace_push(t, query ? OP_QUERY : OP_INSERT, u, v, batch)) {
+				trace_free(t);
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Reads a recorded trace, batching consecutive inserts.
+ * @return 0 on success, 1 on error.
+ */
+static int
+trace_read(Trace *t, const char *path, unsigned int batch)
+{
+	memset(t, 0, sizeof(*t));
+
+	FILE *f = fopen(path, "r");
+	if (!f) {
+		print_error(__func__, "failed to open trace", errno);
+		return 1;
+	}
+
+	char line[256];
+	size_t lineno = 0;
+	uint64_t max_id = 0;
+	int ret = 0;
+
+	while (!ret && fgets(line, sizeof(line), f)) {
+		lineno++;
+		char *p = line;
+		while (*p == ' ' || *p == '\t')
+			p++;
+		if (*p == '#' || *p == '%' || *p == '\n' || *p == '\r' || *p == '\0')
+			continue;
+
+		char op = *p++;
+		char *mid, *end;
+		errno = 0;
+		unsigned long long u = strtoull(p, &mid, 10);
+		unsigned long long v = strtoull(mid, &end, 10);
+		const int two_ids = (mid != p && end != mid);
+		while (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')
+			end++;
+
+		if ((op != 'i' && op != 'q') || errno || !two_ids || *end != '\0' ||
+		    u >= UINT32_MAX || v >= UINT32_MAX) {
+			char err[64];
+			snprintf(err, sizeof(err), "bad trace line %zu", lineno);
+			print_error(__func__, err, 0);
+			ret = 1;
+			break;
+		}
+
+		if (u > max_id)
+			max_id = u;
+		if (v > max_id)
+			max_id = v;
+		if (trace_push(t, op == 'i' ? OP_INSERT : OP_QUERY, (uint32_t)u, (uint32_t)v, batch))
+			ret = 1;
+	}
+
+	if (!ret && ferror(f)) {
+		print_error(__func__, "failed to read trace", errno);
+		ret = 1;
+	}
+	fclose(f);
+
+	if (!ret && !t->n_ops) {
+		print_error(__func__, "trace has no operations", 0);
+		ret = 1;
+	}
+	if (ret) {
+		trace_free(t);
+		return 1;
+	}
+
+	t->n = (uint32_t)max_id + 1;
+	return 0;
+}
+
+/**
+ * @brief Writes a trace in the format read by trace_read().
+ * @return 0 on success, 1 on error.
+ */
+static int
+trace_write(const Trace *t, const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if (!f) {
+		print_error(__func__, "failed to create trace file", errno);
+		return 1;
+	}
+
+	for (size_t i = 0; i < t->n_ops; i++) {
+		const Op *op = &t->ops[i];
+		for (uint32_t k = op->first; k < op->first + op->count; k++)
+			fprintf(f, "%c %u %u\n", op->kind == OP_INSERT ? 'i' : 'q',
+			        t->pairs[2 * k], t->pairs[2 * k + 1]);
+	}
+
+	if (fclose(f) != 0) {
+		print_error(__func__, "failed to write trace file", errno);
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief Whether u and v are in the same set, under concurrent unions.
+ *
+ * If the root found for u is still a root once the root of v is known,
+ * the two sets were apart at that moment; otherwise u's set was linked
+ * meanwhile and the roots are looked up again.
+ */
+static inline int
+connected(uint32_t *label, uint32_t u, uint32_t v)
+{
+	for (;;) {
+		u = find_compress(label, u);
+		v = find_compress(label, v);
+		if (u == v)
+			return 1;
+		if (__atomic_load_n(&label[u], __ATOMIC_RELAXED) == u)
+			return 0;
+	}
+}
+
+/**
+ * @brief Starts every trial from singletons.
+ */
+static int
+setup_replay(void *ctx)
+{
+	Replay *r = ctx;
+	for (uint32_t v = 0; v < r->t->n; v++)
+		r->label[v] = v;
+	return 0;
+}
+
+/**
+ * @brief Replays the trace and records the latency of every operation.
+ *
+ * Returns the number of components left, which must not change between
+ * trials; the answers of racing queries may.
+ */
+static long
+run_replay(void *ctx, unsigned int n_threads)
+{
+	Replay *r = ctx;
+	const Trace *t = r->t;
+	uint64_t *latency_ns = r->latency_ns + (size_t)r->round++ * t->n_ops;
+	size_t next = 0, merged = 0, found = 0;
+
+	#pragma omp parallel num_threads(n_threads) reduction(+:merged, found)
+	for (;;) {
+		const size_t i = __atomic_fetch_add(&next, 1, __ATOMIC_RELAXED);
+		if (i >= t->n_ops)
+			break;
+
+		const Op *op = &t->ops[i];
+		const uint32_t *pair = t->pairs + 2 * (size_t)op->first;
+		const uint64_t t0 = now_ns();
+
+		if (op->kind == OP_QUERY) {
+			found += connected(r->label, pair[0], pair[1]);
+		} else {
+			for (uint32_t k = 0; k < op->count; k++)
+				merged += union_rem(r->label, pair[2 * k], pair[2 * k + 1]);
+		}
+
+		latency_ns[i] = now_ns() - t0;
+	}
+
+	r->hits[OP_INSERT] = merged;
+	r->hits[OP_QUERY] = found;
+	return (long)(t->n - merged);
+}
+
+static int
+cmp_u64(const void *a, const void *b)
+{
+	const uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Nearest-rank percentile of sorted latencies, in microseconds.
+ */
+static double
+percentile_us(const uint64_t *sorted, size_t n, double p)
+{
+	if (!n)
+		return 0.0;
+	size_t rank = (size_t)(p * (double)n + 0.999999);
+	if (rank < 1)
+		rank = 1;
+	if (rank > n)
+		rank = n;
+	return sorted[rank - 1] / 1e3;
+}
+
+/**
+ * @brief Splits the latencies of the timed trials by operation type and
+ * summarises each.
+ * @return 0 on success, 1 on allocation failure.
+ */
+static int
+summarise(const Replay *r, unsigned int n_trials, OpStats stats[OP_COUNT])
+{
+	const Trace *t = r->t;
+	uint64_t *sorted = malloc(t->n_ops * n_trials * sizeof(uint64_t));
+	if (!sorted) {
+		print_error(__func__, "malloc() failed", errno);
+		return 1;
+	}
+
+	for (unsigned int kind = 0; kind < OP_COUNT; kind++) {
+		OpStats *s = &stats[kind];
+		size_t n = 0;
+		s->count = 0;
+		s->pairs = 0;
+		s->hits = r->hits[kind];
+		for (size_t i = 0; i < t->n_ops; i++) {
+			if (t->ops[i].kind != (OpKind)kind)
+				continue;
+			s->count++;
+			s->pairs += t->ops[i].count;
+			for (unsigned int trial = 1; trial <= n_trials; trial++)
+				sorted[n++] = r->latency_ns[(size_t)trial * t->n_ops + i];
+		}
+
+		qsort(sorted, n, sizeof(uint64_t), cmp_u64);
+		s->p50_us = percentile_us(sorted, n, 0.50);
+		s->p99_us = percentile_us(sorted, n, 0.99);
+		s->p999_us = percentile_us(sorted, n, 0.999);
+		s->max_us = n ? sorted[n - 1] / 1e3 : 0.0;
+	}
+
+	free(sorted);
+	return 0;
+}
+
+/**
+ * @brief Prints the summary of one operation type as a JSON object.
+ */
+static void
+print_op_stats(FILE *f, OpKind kind, const OpStats *s, double elapsed_s, int last)
+{
+	const int insert = (kind == OP_INSERT);
+
+	fprintf(f, "    \"%s\": {\n", kind_names[kind]);
+	fprintf(f, "      \"count\": %zu,\n", s->count);
+	if (insert) {
+		fprintf(f, "      \"edges\": %zu,\n", s->pairs);
+		fprintf(f, "      \"merging_unions\": %zu,\n", s->hits);
+	} else {
+		fprintf(f, "      \"connected\": %zu,\n", s->hits);
+	}
+	fprintf(f, "      \"throughput_ops_per_sec\": %.2f,\n", elapsed_s > 0 ? s->count / elapsed_s : 0.0);
+	if (insert)
+		fprintf(f, "      \"throughput_edges_per_sec\": %.2f,\n", elapsed_s > 0 ? s->pairs / elapsed_s : 0.0);
+	fprintf(f, "      \"latency_p50_us\": %.3f,\n", s->p50_us);
+	fprintf(f, "      \"latency_p99_us\": %.3f,\n", s->p99_us);
+	fprintf(f, "      \"latency_p999_us\": %.3f,\n", s->p999_us);
+	fprintf(f, "      \"latency_max_us\": %.3f\n", s->max_us);
+	fprintf(f, "    }%s\n", last ? "" : ",");
+}
+
+/* ------------------------------------------------------------------------- */
+/*                                   Main                                    */
+/* ------------------------------------------------------------------------- */
+
+int
+main(int argc, char *argv[])
+{
+	unsigned int n_threads = 8, n_trials = 5, scale = 20, n_ops = 1000000, percent = 90, batch = 64;
+	const char *input = NULL, *trace_out = NULL, *output = NULL;
+
+	set_program_name(argv[0]);
+	opterr = 0;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "t:n:s:m:q:B:r:w:o:h")) != -1) {
+		switch (opt) {
+		case 't':
+			if (parse_uint(optarg, 1, 1024, &n_threads)) {
+				print_error(__func__, "-t must be between 1 and 1024", 0);
+				return 1;
+			}
+			break;
+		case 'n':
+			if (parse_uint(optarg, 1, 1000, &n_trials)) {
+				print_error(__func__, "-n must be between 1 and 1000", 0);
+				return 1;
+			}
+			break;
+		case 's':
+			if (parse_uint(optarg, 1, 31, &scale)) {
+				print_error(__func__, "-s must be between 1 and 31", 0);
+				return 1;
+			}
+			break;
+		case 'm':
+			if (parse_uint(optarg, 1, UINT32_MAX, &n_ops)) {
+				print_error(__func__, "-m must be a positive integer", 0);
+				return 1;
+			}
+			break;
+		case 'q':
+			if (parse_uint(optarg, 0, 100, &percent)) {
+				print_error(__func__, "-q must be between 0 and 100", 0);
+				return 1;
+			}
+			break;
+		case 'B':
+			if (parse_uint(optarg, 1, 1u << 20, &batch)) {
+				print_error(__func__, "-B must be between 1 and 1048576", 0);
+				return 1;
+			}
+			break;
+		case 'r':
+			input = optarg;
+			break;
+		case 'w':
+			trace_out = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'h':
+			usage();
+			return 0;
+		default: {
+			char err[64];
+			snprintf(err, sizeof(err), "invalid option '-%c'", optopt ? optopt : '?');
+			print_error(__func__, err, 0);
+			usage();
+			return 1;
+		}
+		}
+	}
+
+	if (input && trace_out) {
+		print_error(__func__, "-w writes generated traces and cannot be combined with -r", 0);
+		return 1;
+	}
+
+	Trace t;
+	if (input ? trace_read(&t, input, batch) : trace_generate(&t, scale, n_ops, percent, batch))
+		return 1;
+	if (trace_out && trace_write(&t, trace_out)) {
+		trace_free(&t);
+		return 1;
+	}
+
+	Replay r = { .t = &t };
+	r.label = malloc((size_t)t.n * sizeof(uint32_t));
+	r.latency_ns = malloc(t.n_ops * (n_trials + 1) * sizeof(uint64_t));
+	if (!r.label || !r.latency_ns) {
+		print_error(__func__, "malloc() failed", errno);
+		free(r.label);
+		free(r.latency_ns);
+		trace_free(&t);
+		return 1;
+	}
+
+	/* Throughput is reported per pair (edge inserted or query answered) */
+	CSCBinaryMatrix shape = { .nrows = t.n, .ncols = t.n, .nnz = t.n_pairs };
+	Benchmark *b = benchmark_init("workload", input ? input : "synthetic/workload",
+	                              n_trials, n_threads, 0, &shape);
+	if (!b) {
+		free(r.label);
+		free(r.latency_ns);
+		trace_free(&t);
+		return 1;
+	}
+
+	OpStats stats[OP_COUNT];
+	int ret = benchmark_func(run_replay, setup_replay, &r, b);
+	if (ret)
+		print_error(__func__, "workload replay failed", 0);
+	else
+		ret = summarise(&r, n_trials, stats);
+
+	FILE *out = stdout;
+	if (!ret && output && !(out = fopen(output, "w"))) {
+		print_error(__func__, "failed to create output file", errno);
+		ret = 1;
+	}
+
+	if (!ret) {
+		benchmark_finalize(b);
+		const double mean_s = b->result.stats.mean_time_s;
+
+		for (unsigned int kind = 0; kind < OP_COUNT; kind++)
+			fprintf(stderr, "%-7s %10zu ops  %12.0f ops/s  p50 %9.3f us  p99 %9.3f us  p999 %9.3f us\n",
+			        kind_names[kind], stats[kind].count,
+			        mean_s > 0 ? stats[kind].count / mean_s : 0.0,
+			        stats[kind].p50_us, stats[kind].p99_us, stats[kind].p999_us);
+
+		fprintf(out, "{\n");
+		print_sys_info(out, &b->sys_info, 2);
+		fprintf(out, ",\n");
+		fprintf(out, "  \"workload\": {\n");
+		fprintf(out, "    \"trace\": ");
+		print_json_string(out, input ? input : "generated");
+		fprintf(out, ",\n");
+		fprintf(out, "    \"vertices\": %u,\n", t.n);
+		fprintf(out, "    \"operations\": %zu,\n", t.n_ops);
+		if (!input)
+			fprintf(out, "    \"query_percent\": %u,\n", percent);
+		fprintf(out, "    \"batch_size\": %u\n", batch);
+		fprintf(out, "  },\n");
+		print_benchmark_info(out, &b->benchmark_info, 2);
+		fprintf(out, ",\n");
+		fprintf(out, "  \"results\": {\n");
+		fprintf(out, "    \"components\": %u,\n", b->result.connected_components);
+		fprintf(out, "    \"mean_time_s\": %.6f,\n", mean_s);
+		fprintf(out, "    \"median_time_s\": %.6f,\n", b->result.stats.median_time_s);
+		fprintf(out, "    \"throughput_ops_per_sec\": %.2f,\n", mean_s > 0 ? t.n_ops / mean_s : 0.0);
+		fprintf(out, "    \"memory_peak_mb\": %.2f,\n", b->result.memory_peak_mb);
+		print_op_stats(out, OP_INSERT, &stats[OP_INSERT], mean_s, 0);
+		print_op_stats(out, OP_QUERY, &stats[OP_QUERY], mean_s, 1);
+		fprintf(out, "  }\n");
+		fprintf(out, "}\n");
+	}
+
+	if (out && out != stdout && fclose(out) != 0) {
+		print_error(__func__, "failed to write output file", errno);
+		ret = 1;
+	}
+
+	benchmark_free(b);
+	free(r.label);
+	free(r.latency_ns);
+	trace_free(&t);
+	return ret;
+}